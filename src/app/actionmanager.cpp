@@ -172,6 +172,18 @@ void ActionManager::setupActions()
     connect(action, &QAction::triggered, m_ui->m_parser, &ParserManager::callSaveAllLogWriter);
     action->setEnabled(false);
 
+    action = new QAction(m_ui);
+    action->setText(tr("&Open scan logs"));
+    action->setIcon(QIcon::fromTheme("document-open", QIcon(":/images/images/folder_open.png")));
+    m_collectionsScanSection.insert("load-action", action);
+    connect(action, &QAction::triggered, m_ui->m_parser, &ParserManager::callLoadLogFiles);
+
+    action = new QAction(m_ui);
+    action->setText(tr("Open scan logs from d&irectory"));
+    action->setIcon(QIcon::fromTheme("document-open-folder", QIcon(":/images/images/document-preview-archive.png")));
+    m_collectionsScanSection.insert("loadDirectory-action", action);
+    connect(action, &QAction::triggered, m_ui->m_parser, &ParserManager::callLoadLogDirectory);
+
     m_menuBookmark = new QMenu(m_ui);
     action = new QAction(m_ui);
     action->setText(tr("&Add host to bookmark"));
@@ -268,6 +280,19 @@ void ActionManager::setupActions()
     m_collectionsVulnerability.insert("stop-act", action);
     connect(action, &QAction::triggered, m_ui->m_vulnerability, &Vulnerability::tabWebStop);
 
+    action = new QAction(m_ui);
+    action->setIcon(QIcon::fromTheme("document-import", QIcon(":/images/images/folder_open.png")));
+    action->setIconText(tr("Import CVE feed"));
+    action->setText(tr("&Import CVE feed"));
+    m_collectionsVulnerability.insert("import-cve-act", action);
+    connect(action, &QAction::triggered, m_ui->m_vulnerability, &Vulnerability::importCveFeeds);
+
+    action = new QAction(m_ui);
+    action->setIcon(QIcon::fromTheme("security-medium", QIcon(":/images/images/viewmag+.png")));
+    action->setIconText(tr("Check all hosts"));
+    m_collectionsVulnerability.insert("check-all-act", action);
+    connect(action, &QAction::triggered, m_ui->m_vulnerability, &Vulnerability::checkAllHosts);
+
     // global QActions
     action = new QAction(m_ui);
     action->setText(tr("&Quit"));
@@ -360,6 +385,10 @@ void ActionManager::setupMenuBar()
     // File menu
     m_menuFile = new QMenu(menubar);
     m_menuFile->setTitle(tr("&File"));
+    m_menuFile->addAction(m_collectionsScanSection.value("load-action"));
+    m_menuFile->addAction(m_collectionsScanSection.value("loadDirectory-action"));
+    m_menuFile->addAction(m_collectionsVulnerability.value("import-cve-act"));
+    m_menuFile->addSeparator();
     m_menuFile->addAction(m_collectionsScanSection.value("quit-action"));
 
     // Settings menu
@@ -500,6 +529,9 @@ void ActionManager::createScanSectionBar()
     QMenu *menuSave = new QMenu(m_ui);
     menuSave->addAction(m_collectionsScanSection.value("save-action"));
     menuSave->addAction(m_collectionsScanSection.value("saveAll-action"));
+    menuSave->addSeparator();
+    menuSave->addAction(m_collectionsScanSection.value("load-action"));
+    menuSave->addAction(m_collectionsScanSection.value("loadDirectory-action"));
     m_saveTool->setMenu(menuSave);
 
     m_scanToolBar->addWidget(m_saveTool);
@@ -567,6 +599,9 @@ void ActionManager::createVulnerabilityBar()
     m_vulnerabilityToolBar->addAction(m_collectionsVulnerability.value("back-act"));
     m_vulnerabilityToolBar->addAction(m_collectionsVulnerability.value("forward-act"));
     m_vulnerabilityToolBar->addAction(m_collectionsVulnerability.value("stop-act"));
+    m_vulnerabilityToolBar->addSeparator();
+    m_vulnerabilityToolBar->addAction(m_collectionsVulnerability.value("import-cve-act"));
+    m_vulnerabilityToolBar->addAction(m_collectionsVulnerability.value("check-all-act"));
 }
 
 void ActionManager::disableBottomUiToggleActions()
@@ -29,7 +29,7 @@ VulnBookmarkWidget::VulnBookmarkWidget(QWidget* parent): QWidget(parent)
 }
 
 BookmarkManager::BookmarkManager(MainWindow* parent)
-    : QObject(parent), m_ui(parent), m_userId(0)
+    : QObject(parent), m_ui(parent), m_userId(0), m_store(new BookmarkStore(this))
 {
 #if !defined(Q_OS_WIN32)
     m_userId = getuid();
@@ -76,6 +76,8 @@ void BookmarkManager::syncSettings()
     QSettings settings("nmapsi4", "nmapsi4");
     settings.setValue("scanBookmarkSplitter", m_scanBookmarkSplitter->saveState());
     settings.setValue("vulnBookmarkSplitter", m_vulnBookmarkSplitter->saveState());
+
+    m_store->flush();
 }
 
 void BookmarkManager::saveHostnameItemToBookmark()
@@ -100,7 +102,7 @@ void BookmarkManager::saveItemToBookmarks(QString value)
 {
     if (m_ui->m_collections->m_collectionsButton.value("scan-sez")->isChecked()) {
         // save list of ip/dns in input
-        History *history_ = new History(m_scanBookmarkWidget->treeLogH, "nmapsi4/urlList", "nmapsi4/urlListTime", -1);
+        History *history_ = new History(m_store, m_scanBookmarkWidget->treeLogH, "nmapsi4/urlList", "nmapsi4/urlListTime", -1);
 
         // save list of address
         QStringList hostList = value.split(' ', QString::KeepEmptyParts);
@@ -116,7 +118,7 @@ void BookmarkManager::saveItemToBookmarks(QString value)
         m_ui->updateComboBook();
         m_ui->m_scanWidget->hostEdit->lineEdit()->setText(value);
     } else {
-        History *history_ = new History(m_vulnBookmarkWidget->treeBookVuln, "nmapsi4/urlListVuln", "nmapsi4/urlListTimeVuln", -1);
+        History *history_ = new History(m_store, m_vulnBookmarkWidget->treeBookVuln, "nmapsi4/urlListVuln", "nmapsi4/urlListTimeVuln", -1);
         history_->addItemHistory(value,QDateTime::currentDateTime().toString("MMMM d yyyy - hh:mm:ss"));
 
         memory::freelist<QTreeWidgetItem*>::itemDeleteAll(m_treebookvulnlist);
@@ -137,13 +139,13 @@ void BookmarkManager::deleteItemFromBookmark()
     History *history_;
 
     if (m_ui->m_collections->m_collectionsButton.value("scan-sez")->isChecked()) {
-        history_ = new History(m_scanBookmarkWidget->treeLogH, "nmapsi4/urlList", "nmapsi4/urlListTime", -1);
+        history_ = new History(m_store, m_scanBookmarkWidget->treeLogH, "nmapsi4/urlList", "nmapsi4/urlListTime", -1);
         history_->deleteItemBookmark(m_scanBookmarkWidget->treeLogH->currentItem()->text(0));
 
         memory::freelist<QTreeWidgetItem*>::itemDeleteAll(m_treeloghlist);
         m_treeloghlist = history_->updateBookMarks();
     } else {
-        history_ = new History(m_vulnBookmarkWidget->treeBookVuln, "nmapsi4/urlListVuln", "nmapsi4/urlListTimeVuln", -1);
+        history_ = new History(m_store, m_vulnBookmarkWidget->treeBookVuln, "nmapsi4/urlListVuln", "nmapsi4/urlListTimeVuln", -1);
         history_->deleteItemBookmark(m_vulnBookmarkWidget->treeBookVuln->currentItem()->text(0));
 
         memory::freelist<QTreeWidgetItem*>::itemDeleteAll(m_treebookvulnlist);
@@ -164,10 +166,10 @@ void BookmarkManager::deleteParametersFromBookmark()
     History *history_;
 
     if (!m_userId) {
-        history_ = new History(m_scanBookmarkWidget->treeBookPar, "nmapsi4/urlListPar", "nmapsi4/urlListTimePar", -1);
+        history_ = new History(m_store, m_scanBookmarkWidget->treeBookPar, "nmapsi4/urlListPar", "nmapsi4/urlListTimePar", -1);
         history_->deleteItemBookmark(m_scanBookmarkWidget->treeBookPar->currentItem()->text(0));
     } else {
-        history_ = new History(m_scanBookmarkWidget->treeBookPar, "nmapsi4/urlListParUser", "nmapsi4/urlListTimeParUser", -1);
+        history_ = new History(m_store, m_scanBookmarkWidget->treeBookPar, "nmapsi4/urlListParUser", "nmapsi4/urlListTimeParUser", -1);
         history_->deleteItemBookmark(m_scanBookmarkWidget->treeBookPar->currentItem()->text(0));
     }
 
@@ -175,6 +177,8 @@ void BookmarkManager::deleteParametersFromBookmark()
     m_treebookparlist = history_->updateBookMarks();
 
     delete history_;
+    // saved profiles are read from the file by ScanProfiles
+    m_store->flush();
     m_ui->buildScanProfileList();
 }
 
@@ -207,7 +211,7 @@ void BookmarkManager::saveParametersToBookmarks(const QString profileName, const
     History *history_;
 
     if (!m_userId) {
-        history_ = new History(m_scanBookmarkWidget->treeBookPar, "nmapsi4/urlListPar", "nmapsi4/urlListTimePar", -1);
+        history_ = new History(m_store, m_scanBookmarkWidget->treeBookPar, "nmapsi4/urlListPar", "nmapsi4/urlListTimePar", -1);
 
         if (!history_->isProfileInHistory(profileName)) {
             history_->addItemHistory(profileParameters, profileName);
@@ -215,7 +219,7 @@ void BookmarkManager::saveParametersToBookmarks(const QString profileName, const
             history_->updateProfile(profileParameters, profileName);
         }
     } else {
-        history_ = new History(m_scanBookmarkWidget->treeBookPar, "nmapsi4/urlListParUser", "nmapsi4/urlListTimeParUser", -1);
+        history_ = new History(m_store, m_scanBookmarkWidget->treeBookPar, "nmapsi4/urlListParUser", "nmapsi4/urlListTimeParUser", -1);
 
         if (!history_->isProfileInHistory(profileName)) {
             history_->addItemHistory(profileParameters, profileName);
@@ -228,6 +232,8 @@ void BookmarkManager::saveParametersToBookmarks(const QString profileName, const
     m_treebookparlist = history_->updateBookMarks();
 
     delete history_;
+    // saved profiles are read from the file by ScanProfiles
+    m_store->flush();
     m_ui->buildScanProfileList();
 }
 
@@ -235,32 +241,32 @@ void BookmarkManager::restoreAllHistoryValues()
 {
     History *newHistory;
     // reload bookmark from history
-    newHistory = new History(m_scanBookmarkWidget->treeLogH, "nmapsi4/urlList", "nmapsi4/urlListTime", -1);
+    newHistory = new History(m_store, m_scanBookmarkWidget->treeLogH, "nmapsi4/urlList", "nmapsi4/urlListTime", -1);
     m_treeloghlist = newHistory->updateBookMarks();
     delete newHistory;
     // check for user or admin parameters bookmarks
     if (!m_userId) {
-        newHistory = new History(m_scanBookmarkWidget->treeBookPar, "nmapsi4/urlListPar", "nmapsi4/urlListTimePar", -1);
+        newHistory = new History(m_store, m_scanBookmarkWidget->treeBookPar, "nmapsi4/urlListPar", "nmapsi4/urlListTimePar", -1);
         m_treebookparlist = newHistory->updateBookMarks();
         delete newHistory;
     } else {
-        newHistory = new History(m_scanBookmarkWidget->treeBookPar, "nmapsi4/urlListParUser", "nmapsi4/urlListTimeParUser", -1);
+        newHistory = new History(m_store, m_scanBookmarkWidget->treeBookPar, "nmapsi4/urlListParUser", "nmapsi4/urlListTimeParUser", -1);
         m_treebookparlist = newHistory->updateBookMarks();
         delete newHistory;
     }
 
-    newHistory = new History(m_vulnBookmarkWidget->treeBookVuln, "nmapsi4/urlListVuln", "nmapsi4/urlListTimeVuln", -1);
+    newHistory = new History(m_store, m_vulnBookmarkWidget->treeBookVuln, "nmapsi4/urlListVuln", "nmapsi4/urlListTimeVuln", -1);
     m_treebookvulnlist = newHistory->updateBookMarks();
     delete newHistory;
 
-    newHistory = new History(m_vulnBookmarkWidget->treeWidgetVulnUrl, "nmapsi4/nameUrlVuln", "nmapsi4/nameUrlAddr", -1);
+    newHistory = new History(m_store, m_vulnBookmarkWidget->treeWidgetVulnUrl, "nmapsi4/nameUrlVuln", "nmapsi4/nameUrlAddr", -1);
     m_treewidgetvulnlist = newHistory->updateBookMarks();
     delete newHistory;
 }
 
 void BookmarkManager::saveAddressToBookmark(const QString addressName, const QString address)
 {
-    History *newHistory = new History(m_vulnBookmarkWidget->treeWidgetVulnUrl, "nmapsi4/nameUrlVuln" , "nmapsi4/nameUrlAddr", -1);
+    History *newHistory = new History(m_store, m_vulnBookmarkWidget->treeWidgetVulnUrl, "nmapsi4/nameUrlVuln" , "nmapsi4/nameUrlAddr", -1);
     newHistory->addItemHistory(addressName, address);
 
     memory::freelist<QTreeWidgetItem*>::itemDeleteAll(m_treewidgetvulnlist);
@@ -270,7 +276,7 @@ void BookmarkManager::saveAddressToBookmark(const QString addressName, const QSt
 
 void BookmarkManager::deleteAddressFromBookmark(const QString addressName)
 {
-    History *newHistory = new History(m_vulnBookmarkWidget->treeWidgetVulnUrl, "nmapsi4/nameUrlVuln" , "nmapsi4/nameUrlAddr", -1);
+    History *newHistory = new History(m_store, m_vulnBookmarkWidget->treeWidgetVulnUrl, "nmapsi4/nameUrlVuln" , "nmapsi4/nameUrlAddr", -1);
     newHistory->deleteItemBookmark(addressName);
 
     memory::freelist<QTreeWidgetItem*>::itemDeleteAll(m_treewidgetvulnlist);
@@ -278,36 +284,24 @@ void BookmarkManager::deleteAddressFromBookmark(const QString addressName)
     delete newHistory;
 }
 
-void BookmarkManager::saveHostToBookmark(const QString hostName, int cacheLimit)
+bool BookmarkManager::saveHostToBookmark(const QString hostName, int cacheLimit, QStringList* evictedHosts)
 {
-    History *newHistory = new History("nmapsi4/cacheHost", cacheLimit);
-    newHistory->addItemHistory(hostName);
-    delete newHistory;
+    return m_store->touchCacheValue("nmapsi4/cacheHost", hostName, cacheLimit, evictedHosts);
 }
 
 void BookmarkManager::saveServiceToBookmark(const QString service, int cacheLimit)
 {
-    History *newHistory = new History("nmapsi4/cacheVuln", cacheLimit);
-    newHistory->addItemHistory(service);
-    delete newHistory;
+    m_store->touchCacheValue("nmapsi4/cacheVuln", service, cacheLimit);
 }
 
 QStringList BookmarkManager::getHostListFromBookmark()
 {
-    History *newHistory = new History("nmapsi4/cacheHost");
-    QStringList hostCache = newHistory->getHostCache();
-    delete newHistory;
-
-    return hostCache;
+    return m_store->cacheValues("nmapsi4/cacheHost");
 }
 
 QStringList BookmarkManager::getServicesListFromBookmark()
 {
-    History *newHistory = new History("nmapsi4/cacheVuln");
-    QStringList hostCache = newHistory->getHostCache();
-    delete newHistory;
-
-    return hostCache;
+    return m_store->cacheValues("nmapsi4/cacheVuln");
 }
 
 bool BookmarkManager::isBookmarkHostListEmpty()
@@ -71,9 +71,10 @@ public:
      */
     void deleteAddressFromBookmark(const QString addressName);
     /**
-     * Save Host (ip or Dns or ip-range) to bookmark
+     * Save Host (ip or Dns or ip-range) to the recent hosts, return true
+     * for a new host. The hosts over cacheLimit are added to evictedHosts.
      */
-    void saveHostToBookmark(const QString hostName, int cacheLimit);
+    bool saveHostToBookmark(const QString hostName, int cacheLimit, QStringList* evictedHosts = 0);
     /**
      * Save Vulnerability service to bookmark
      */
@@ -101,6 +102,7 @@ private:
 
     MainWindow* m_ui;
     int m_userId;
+    BookmarkStore* m_store;
     QList<QTreeWidgetItem*> m_treeloghlist;
     QList<QTreeWidgetItem*> m_treebookparlist;
     QList<QTreeWidgetItem*> m_treebookvulnlist;
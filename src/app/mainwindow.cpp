@@ -123,6 +123,11 @@ void MainWindow::initObject()
     // monitor events
     connect(m_monitor, &Monitor::monitorUpdated,
             this, &MainWindow::updateScanCounter);
+    // after the monitor slot, it can be called from the middle of a scan end
+    connect(m_monitor, &Monitor::monitorUpdated,
+            this, &MainWindow::feedImportedTargets, Qt::QueuedConnection);
+    connect(m_monitor, &Monitor::queueStopped,
+            this, &MainWindow::discardImportedTargets);
 
     // create welcome qml view
     QSpacerItem *verticalSpacer = new QSpacerItem(20, 163, QSizePolicy::Minimum, QSizePolicy::Expanding);
@@ -156,10 +161,16 @@ void MainWindow::initObject()
     // w/o show() call, mainwindow is not visible in mac osx
     show();
 #endif
+
+    resumeInterruptedScans();
 }
 
 MainWindow::~MainWindow()
 {
+    if (m_targetImporter) {
+        m_targetImporter->requestInterruption();
+        m_targetImporter->wait();
+    }
 }
 
 void MainWindow::startPreferencesDialog()
@@ -285,6 +296,21 @@ void MainWindow::quickAddressSelectionEvent()
     }
 }
 
+bool MainWindow::confirmRootOptions()
+{
+    const QStringList rootOptions = m_profileHandler->rootOptions();
+
+    if (rootOptions.isEmpty()) {
+        return true;
+    }
+
+    const QMessageBox::StandardButton answer = QMessageBox::question(this, tr("Warning - Nmapsi4"),
+            tr("These options require root privileges: %1\nScan anyway?").arg(rootOptions.join(" ")),
+            QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
+
+    return answer == QMessageBox::Yes;
+}
+
 void MainWindow::startScan()
 {
     if (m_scanWidget->hostEdit->currentText().isEmpty()) {
@@ -292,6 +318,10 @@ void MainWindow::startScan()
         return;
     }
 
+    if (!confirmRootOptions()) {
+        return;
+    }
+
     QString hostname = m_scanWidget->hostEdit->currentText();
     // check wrong address
     hostname = HostTools::clearHost(hostname);
@@ -363,6 +393,16 @@ void MainWindow::startScan()
 
 }
 
+int MainWindow::userId() const
+{
+    return m_userId;
+}
+
+int MainWindow::lookupType() const
+{
+    return m_lookupType;
+}
+
 void MainWindow::addHostToMonitor(const QString hostname)
 {
     // check for duplicate hostname in the monitor
@@ -371,8 +411,9 @@ void MainWindow::addHostToMonitor(const QString hostname)
         return;
     }
 
-    m_bookmark->saveHostToBookmark(hostname, m_hostCache);
-    updateCompleter();
+    QStringList evictedHosts;
+    m_bookmark->saveHostToBookmark(hostname, m_hostCache, &evictedHosts);
+    updateCompleter(hostname, evictedHosts);
 
     // default action
     m_monitor->m_monitorWidget->monitorStopAllScanButt->setEnabled(true);
@@ -524,6 +565,10 @@ void MainWindow::syncSettings()
     m_collections->m_collectionsScanSection.value("showmenubar-action")->setChecked(settings.value("showMenuBar", false).toBool());
     // update max parallel scan option
     m_monitor->updateMaxParallelScan();
+    m_monitor->updateControlServer();
+    m_monitor->updateTimingTuning();
+    m_monitor->updateResultCache();
+    m_vulnerability->updateWebViewBudget();
 }
 
 void MainWindow::saveSettings()
@@ -576,6 +621,33 @@ void MainWindow::updateCompleter()
     }
 }
 
+void MainWindow::updateCompleter(const QString& hostName, const QStringList& evictedHosts)
+{
+    if (!m_hostModel) {
+        updateCompleter();
+        return;
+    }
+
+    // the model is short, a row is found with a scan of the list
+    for (const QString& host : evictedHosts) {
+        const int row = m_hostModel->stringList().indexOf(host);
+        if (row != -1) {
+            m_hostModel->removeRow(row);
+        }
+    }
+
+    const int row = m_hostModel->stringList().indexOf(hostName);
+
+    if (row == 0) {
+        return;
+    } else if (row != -1) {
+        m_hostModel->removeRow(row);
+    }
+
+    m_hostModel->insertRow(0);
+    m_hostModel->setData(m_hostModel->index(0), hostName);
+}
+
 void MainWindow::restoreSettings()
 {
     // restore window position
@@ -941,51 +1013,127 @@ void MainWindow::updateQmlScanHistory()
 
 void MainWindow::loadTargetListFromFile()
 {
+    if (m_targetImporter) {
+        QMessageBox::information(this, "NmapSI4", tr("Target list import already in progress."), tr("Close"));
+        return;
+    }
+
     const QString& fileName = QFileDialog::getOpenFileName(this, tr("Select the file"), QDir::homePath(), "");
 
-    QFile *targetFile = new QFile(fileName);
+    if (fileName.isEmpty() || !confirmRootOptions()) {
+        return;
+    }
 
-    if (!targetFile->open(QIODevice::ReadOnly)) {
+    /*
+     * The list is parsed on a thread and the targets are queued
+     * in the monitor with the current profile, a block at a time
+     * when the monitor is short of hosts.
+     */
+    m_targetImporterParameters = m_profileHandler->getParameters().join(" ");
+    m_targetImporter = new TargetImporter(fileName);
+
+    connect(m_targetImporter, &TargetImporter::importFinished,
+            this, &MainWindow::targetImportFinished);
+    connect(m_targetImporter, &TargetImporter::importFailed,
+            this, &MainWindow::targetImportFailed);
+    connect(m_targetImporter, &TargetImporter::finished,
+            this, &MainWindow::targetImporterEnd);
+
+    m_targetImporter->start();
+}
+
+void MainWindow::resumeInterruptedScans()
+{
+    const int hostsNumber = m_monitor->interruptedHostsNumber();
+
+    if (!hostsNumber) {
         return;
     }
 
-    QTextStream buffer(targetFile);
-    QString targetListOneLine;
-    QString tmpLine;
-    int lineCounter=0;
+    const QMessageBox::StandardButton answer = QMessageBox::question(this, tr("Resume scan - Nmapsi4"),
+            tr("The last scan was interrupted with %1 hosts not completed.\nResume them?").arg(hostsNumber),
+            QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes);
 
-    while (!buffer.atEnd()) {
-        tmpLine = buffer.readLine();
-        lineCounter++;
+    if (answer == QMessageBox::Yes) {
+        m_monitor->resumeInterruptedHosts();
+    } else {
+        m_monitor->discardInterruptedHosts();
+    }
+}
 
-        tmpLine = tmpLine.remove(" ");
+void MainWindow::feedImportedTargets()
+{
+    // the targets of the importer are read only after its thread
+    if (!m_targetImporter || !m_targetImporter->isFinished()) {
+        return;
+    }
 
-        if (lineCounter >= 2) {
-            targetListOneLine.append(' ');
+    while (!m_targetImporter->isInterruptionRequested() && m_targetImporter->hasTargets()
+            && m_monitor->monitorHostNumber() < TargetImporter::blockSize / 2) {
+        if (!m_monitor->monitorHostNumber()) {
+            m_monitor->clearHostMonitorDetails();
         }
 
-        int tokenCounter = 0;
-        for (const QString& token : tmpLine.split(',')) {
-            // It's a ip or dns
-            QHostAddress addressProtocol(token);
-            if ((addressProtocol.protocol() == QAbstractSocket::IPv4Protocol)
-                || (addressProtocol.protocol() == QAbstractSocket::IPv6Protocol)
-                || (HostTools::isValidDns(token))) {
-                tokenCounter++;
-                if (tokenCounter > 1) {
-                    targetListOneLine.append(' ');
-                }
+        QString exclude;
+        const QStringList targets = m_targetImporter->takeTargets(TargetImporter::blockSize, exclude);
+        QString parameters(m_targetImporterParameters);
 
-                targetListOneLine.append(token);
-            }
+        if (!exclude.isEmpty()) {
+            parameters += QLatin1String(" --exclude ") + exclude;
         }
+
+        m_monitor->enqueueHosts(targets, parameters);
+    }
+
+    if (m_targetImporter->isInterruptionRequested() || !m_targetImporter->hasTargets()) {
+        m_targetImporter->deleteLater();
+        m_targetImporter = 0;
+    }
+}
+
+void MainWindow::discardImportedTargets()
+{
+    if (!m_targetImporter) {
+        return;
+    }
+
+    // a running import is deleted by targetImporterEnd()
+    m_targetImporter->requestInterruption();
+    feedImportedTargets();
+}
+
+void MainWindow::targetImportFinished(int targets, int duplicates, int invalid, int excluded, bool isTruncated)
+{
+#ifndef MAIN_NO_DEBUG
+    qDebug() << "Load list from file:: " << targets << " targets, " << duplicates << " duplicates, "
+             << invalid << " invalid, " << excluded << " excluded";
+#else
+    Q_UNUSED(duplicates);
+    Q_UNUSED(invalid);
+    Q_UNUSED(excluded);
+#endif
+
+    if (!targets) {
+        QMessageBox::warning(this, tr("Warning - Nmapsi4"), tr("No valid targets in the file."), tr("Close"));
+    } else if (isTruncated) {
+        QMessageBox::warning(this, tr("Warning - Nmapsi4"),
+                             tr("The file has more than %1 targets, only the first %1 are scanned.")
+                             .arg(TargetImporter::maxTargets), tr("Close"));
     }
+}
 
-    qDebug() << "Load list from file:: " << targetListOneLine;
+void MainWindow::targetImportFailed(const QString error)
+{
+    QMessageBox::warning(this, tr("Warning - Nmapsi4"), error, tr("Close"));
+}
 
-    delete targetFile;
+void MainWindow::targetImporterEnd()
+{
+    if (!m_targetImporter) {
+        return;
+    }
 
-    // to load the host list in the hostname line edit
-    updateComboHostnameProperties();
-    m_scanWidget->hostEdit->insertItem(0, targetListOneLine);
+    // finished() comes before the end of the thread
+    m_targetImporter->wait();
+    feedImportedTargets();
 }
@@ -25,6 +25,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // Qt5 include
 #include <QtCore/QHash>
 #include <QtCore/QWeakPointer>
+#include <QtCore/QPointer>
 #include <QtCore/QTimer>
 #include <QtCore/QList>
 #include <QtCore/QFile>
@@ -57,6 +58,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "mouseeventfilter.h"
 #include "about.h"
 #include "qmlwelcome.h"
+#include "targetimporter.h"
 
 // system
 #if !defined(Q_OS_WIN32)
@@ -79,7 +81,14 @@ public:
     ~MainWindow();
     void updateComboBook();
     void updateCompleter();
+    /*
+     * Move a scanned host to the top of the completer model
+     * and remove the hosts evicted from the cache.
+     */
+    void updateCompleter(const QString& hostName, const QStringList& evictedHosts);
     void buildScanProfileList();
+    int userId() const;
+    int lookupType() const;
 
     Vulnerability* m_vulnerability;
     DiscoverManager* m_discoverManager;
@@ -101,6 +110,14 @@ private:
     void setDefaultSplitter();
     void updateQmlScanHistory();
     void copyToClipboard(const QString& text);
+    /*
+     * Ask to queue again the hosts of an interrupted scan
+     */
+    void resumeInterruptedScans();
+    /*
+     * Ask to scan anyway with the root options of the profile
+     */
+    bool confirmRootOptions();
 
     QSplitter *m_mainHorizontalSplitter;
     QSplitter *m_mainVerticalSplitter;
@@ -112,6 +129,8 @@ private:
     QByteArray m_scanListWidgetSize;
     QByteArray m_detailsWidgetSize;
     QmlWelcome* m_qmlWelcome;
+    QPointer<TargetImporter> m_targetImporter;
+    QString m_targetImporterParameters;
     QWidget* qmlWelcomeWidget;
 
 protected:
@@ -150,6 +169,14 @@ private slots:
     void resizeHorizontalSplitterEvent();
     void resetComboParameters();
     void loadTargetListFromFile();
+    /*
+     * Queue a block of the imported targets when the monitor is short of hosts
+     */
+    void feedImportedTargets();
+    void discardImportedTargets();
+    void targetImportFinished(int targets, int duplicates, int invalid, int excluded, bool isTruncated);
+    void targetImportFailed(const QString error);
+    void targetImporterEnd();
 
 };
 
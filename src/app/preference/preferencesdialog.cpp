@@ -39,6 +39,14 @@ PreferencesDialog::PreferencesDialog(QWidget *parent)
     comboLookupType->setCurrentIndex(settings.value("lookupType", 1).toInt());
     digVerbosityCombo->setCurrentIndex(settings.value("digVerbosityLevel", 0).toInt());
     spinBoxCache->setValue(settings.value("hostCache", 10).toInt());
+    lineVulnerabilityMirror->setText(settings.value("vulnerabilityMirrorUrl").toString());
+    spinWebViewBudget->setValue(settings.value("webViewMemoryBudget", 600).toInt());
+    spinControlServerPort->setValue(settings.value("controlServerPort", 0).toInt());
+    checkTuneTiming->setChecked(settings.value("tuneTiming", false).toBool());
+    spinResultCache->setValue(settings.value("resultCacheMinutes", 5).toInt());
+    lineNmapPath->setText(settings.value("nmapPath").toString());
+    lineNpingPath->setText(settings.value("npingPath").toString());
+    lineDigPath->setText(settings.value("digPath").toString());
 
     // Create listview items
     listViewOptions->setIconSize(QSize(42, 42));
@@ -83,6 +91,14 @@ void PreferencesDialog::saveValues()
     settings.setValue("maxDiscoverProcess", spinMaxDiscoverProcess->value());
     settings.setValue("lookupType", comboLookupType->currentIndex());
     settings.setValue("digVerbosityLevel", digVerbosityCombo->currentIndex());
+    settings.setValue("vulnerabilityMirrorUrl", lineVulnerabilityMirror->text().trimmed());
+    settings.setValue("webViewMemoryBudget", spinWebViewBudget->value());
+    settings.setValue("controlServerPort", spinControlServerPort->value());
+    settings.setValue("tuneTiming", checkTuneTiming->isChecked());
+    settings.setValue("resultCacheMinutes", spinResultCache->value());
+    settings.setValue("nmapPath", lineNmapPath->text().trimmed());
+    settings.setValue("npingPath", lineNpingPath->text().trimmed());
+    settings.setValue("digPath", lineDigPath->text().trimmed());
 }
 
 
@@ -33,10 +33,13 @@ public:
     QList< QPair<QString, QString> > defaultScanProfile() const;
     QStringList getParameters() const;
     bool containsParameter(const QString& parameter) const;
+    /*
+     * Options of the scan bar that need root privileges,
+     * empty for root.
+     */
+    QStringList rootOptions() const;
 
 private:
-    bool removeUnsupportedOptions(QString& parameters) const;
-
     int m_userId;
     int m_savedProfileIndex;
     MainWindow* m_ui;
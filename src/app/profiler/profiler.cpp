@@ -26,124 +26,64 @@ Profiler::Profiler(ProfilerManager* parent)
 
 void Profiler::restoreValuesFromProfile(const QStringList parameters)
 {
-    for (int index = 0; index < parameters.size(); ++index) {
-        if (parameters[index].startsWith(QLatin1String("-")) || parameters[index].startsWith(QLatin1String("--"))) {
-            if (!parameters[index].startsWith(QLatin1String("-PA"))
-                    && !parameters[index].startsWith(QLatin1String("-PS"))
-                    && !parameters[index].startsWith(QLatin1String("-PU"))
-                    && !parameters[index].startsWith(QLatin1String("-PO"))
-                    && !parameters[index].startsWith(QLatin1String("-PY"))
-                    && !parameters[index].startsWith(QLatin1String("-d"))
-                    && !parameters[index].startsWith(QLatin1String("--script"))) {
-                bool isFounded = false;
-
-                // check combo options
-                QHash<QString, QPair<QComboBox*, int> >::const_iterator i = preLoadComboList.find(parameters[index]);
-
-                if (i != preLoadComboList.end()) {
-                    // value founded
-                    (*i).first->setCurrentIndex((*i).second);
-
-                    if (index < parameters.size() - 1) {
-                        // check if the next string value is an integer
-                        if (!parameters[index + 1].startsWith(QLatin1String("-")) && !parameters[index + 1].startsWith(QLatin1String("--"))) {
-                            // recover combo value
-                            QHash<QString, QLineEdit*>::const_iterator j = lineEditList.find(parameters[index]);
-
-                            if (j != lineEditList.end()) {
-                                (*j)->setText(parameters[index + 1]);
-                                if (!(*j)->isEnabled()) {
-                                    (*j)->setEnabled(true);
-                                }
-                                index++;
-                            }
-                        }
-                    }
-                    isFounded = true;
-                } // end combo restore value
-
-                if (!isFounded) {
-                    // check checkBox options
-                    QHash<QString, QPair<QCheckBox*, QString> >::const_iterator i = preLoadCheckBoxList.find(parameters[index]);
-
-                    if (i != preLoadCheckBoxList.end()) {
-                        (*i).first->setChecked(true);
-                    }
-
-                    if (index < parameters.size() - 1) {
-                        // check if the next string value is an integer
-                        if (!parameters[index + 1].startsWith(QLatin1String("-")) && !parameters[index + 1].startsWith(QLatin1String("--"))) {
-                            // check value for line edit
-                            QHash<QString, QLineEdit*>::const_iterator j = lineEditList.find(parameters[index]);
-
-                            if (j != lineEditList.end()) {
-                                (*j)->setText(parameters[index + 1]);
-                            }
-                            // check value for spin box
-                            QHash<QString, QSpinBox*>::const_iterator z = spinBoxList.find(parameters[index]);
-
-                            if (z != spinBoxList.end()) {
-                                int value = parameters[index + 1].toInt();
-                                (*z)->setValue(value);
-                            }
-                        }
-                    }
-                }
-            } else {
-                if (!parameters[index].startsWith(QLatin1String("--script"))) {
-                    // parameter with value on append
-                    QString token = parameters[index];
-                    QString option = parameters[index];
-
-                    option.remove(QRegExp("\\d+"));
-                    option.remove(',');
-                    token.remove(option);
-
-                    QHash<QString, QPair<QCheckBox*, QString> >::const_iterator i = preLoadCheckBoxList.find(option);
-
-                    if (i != preLoadCheckBoxList.end()) {
-                        (*i).first->setChecked(true);
-                    }
-
-                    if (!token.isEmpty()) {
-                        QHash<QString, QLineEdit*>::const_iterator j = lineEditList.find(option);
-
-                        if (j != lineEditList.end()) {
-                            (*j)->setText(token);
-                        } else {
-                            QHash<QString, QSpinBox*>::const_iterator j = spinBoxList.find(option);
-                            if (j != spinBoxList.end()) {
-                                (*j)->setValue(token.toInt());
-                            }
-                        }
-                    }
-                } else {
-                    // nse script value
-                    if (parameters[index].startsWith(QLatin1String("--script-args="))) {
-                        QString values = parameters[index];
-                        values.remove("--script-args=");
-                        m_ui->m_dialogUi->comboNsePar->lineEdit()->setText(values);
-                    } else if (parameters[index].startsWith(QLatin1String("--script="))) {
-                        QString values = parameters[index];
-                        values.remove("--script=");
-
-                        QStringList scripts = values.split(',', QString::SkipEmptyParts);
-                        for (const QString & script : scripts) {
-                            if (m_ui->m_nseManager->nseTreeActiveSingleScript(script)) {
-                                scripts.removeAt(script.indexOf(script));
-                            }
-                        }
-
-                        if (scripts.size()) {
-                            m_ui->m_dialogUi->comboNseInv->lineEdit()->setText(scripts.join(","));
-                        }
-                    }
+    for (const NmapOptions::Token& token : NmapOptions::tokenize(parameters)) {
+        if (!token.option) {
+            continue;
+        }
+
+        if (token.name == QLatin1String("--script-args")) {
+            // nse script value
+            m_ui->m_dialogUi->comboNsePar->lineEdit()->setText(token.value);
+            continue;
+        } else if (token.name == QLatin1String("--script")) {
+            QStringList scripts;
+            for (const QString & script : token.value.split(',', QString::SkipEmptyParts)) {
+                if (!m_ui->m_nseManager->nseTreeActiveSingleScript(script)) {
+                    scripts.append(script);
                 }
             }
-        } // end first if
-    } // end for
-}
 
+            if (scripts.size()) {
+                m_ui->m_dialogUi->comboNseInv->lineEdit()->setText(scripts.join(","));
+            }
+            continue;
+        }
+
+        // check combo options
+        QHash<QString, QPair<QComboBox*, int> >::const_iterator i = preLoadComboList.constFind(token.name);
+
+        if (i != preLoadComboList.constEnd()) {
+            (*i).first->setCurrentIndex((*i).second);
+        } else {
+            // check checkBox options
+            QHash<QString, QPair<QCheckBox*, QString> >::const_iterator j = preLoadCheckBoxList.constFind(token.name);
+
+            if (j != preLoadCheckBoxList.constEnd()) {
+                (*j).first->setChecked(true);
+            }
+        }
+
+        if (token.value.isEmpty()) {
+            continue;
+        }
+
+        // check value for line edit or spin box
+        QHash<QString, QLineEdit*>::const_iterator j = lineEditList.constFind(token.name);
+
+        if (j != lineEditList.constEnd()) {
+            (*j)->setText(token.value);
+            if (!(*j)->isEnabled()) {
+                (*j)->setEnabled(true);
+            }
+        } else {
+            QHash<QString, QSpinBox*>::const_iterator z = spinBoxList.constFind(token.name);
+
+            if (z != spinBoxList.constEnd()) {
+                (*z)->setValue(token.value.toInt());
+            }
+        }
+    }
+}
 
 void Profiler::loadDefaultHash()
 {
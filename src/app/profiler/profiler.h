@@ -25,6 +25,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QComboBox>
 #include <QCheckBox>
 
+#include "nmapoptions.h"
+
 class ProfilerManager;
 
 class Profiler : public QObject
@@ -98,6 +98,18 @@ void ProfilerManager::initObject()
             m_nseManager, &NseManager::requestNseHelp);
     connect(m_dialogUi->searchButtHelp, &QPushButton::clicked,
             m_nseManager, &NseManager::requestNseScriptHelp);
+    connect(m_dialogUi->nseSearchEdit, &QLineEdit::textChanged,
+            m_nseManager, &NseManager::searchScripts);
+    connect(m_dialogUi->nseCategoryFacet, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
+            m_nseManager, &NseManager::searchScripts);
+    connect(m_dialogUi->nseRuleFacet, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
+            m_nseManager, &NseManager::searchScripts);
+    connect(m_dialogUi->nseSearchTree, &QTreeWidget::itemSelectionChanged,
+            m_nseManager, &NseManager::showSearchedScript);
+    connect(m_dialogUi->nseSearchTree, &QTreeWidget::itemDoubleClicked,
+            m_nseManager, &NseManager::activeSearchedScript);
+    connect(m_dialogUi->nseSearchAddBut, &QPushButton::clicked,
+            m_nseManager, &NseManager::activeSearchedScript);
 
     loadDefaultComboValues();
     loadDefaultBaseProfile();
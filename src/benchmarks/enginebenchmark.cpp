@@ -0,0 +1,302 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "enginebenchmark.h"
+#include "scanparser.h"
+#include "scanresultwriter.h"
+#include "scanoutputbuffer.h"
+#include "progressparser.h"
+#include "logwriter.h"
+#include "logwriterxml.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QScopedPointer>
+#include <QtCore/QSettings>
+#include <QtCore/QTextStream>
+
+namespace
+{
+// the size of a QProcess read
+const int flowChunkSize = 4096;
+}
+
+void EngineBenchmark::initTestCase()
+{
+    QVERIFY(m_tempDir.isValid());
+
+    // the xml reader writes a debug line for every host
+    QLoggingCategory::setFilterRules(QLatin1String("default.debug=false"));
+
+    // the log writers read the log type, user settings are not touched
+    QSettings::setPath(QSettings::NativeFormat, QSettings::UserScope, m_tempDir.path());
+
+    QString dataDir = QString::fromLocal8Bit(qgetenv("NMAPSI4_BENCHMARK_DATA"));
+    if (dataDir.isEmpty()) {
+        dataDir = QLatin1String(BENCHMARK_DATA_DIR);
+    }
+
+    struct CorpusFile {
+        const char* name;
+        const char* parameters;
+    };
+
+    static const CorpusFile files[] = {
+        { "small", "-sV -O --traceroute 192.168.1.1" },
+        { "allports", "-sS -p- --stats-every 5s 10.0.0.12" },
+        { "nse", "-sV -O --script default,vulners,http-enum,dns-brute www.example.org" },
+        { "packettrace", "-sS --packet-trace 192.168.1.20" }
+    };
+
+    for (const CorpusFile& corpusFile : files) {
+        QFile file(dataDir + QLatin1Char('/') + QLatin1String(corpusFile.name) + QLatin1String(".nmap"));
+        QVERIFY2(file.open(QIODevice::ReadOnly), qPrintable(file.fileName()));
+
+        Corpus corpus;
+        corpus.parameters = QString::fromLatin1(corpusFile.parameters).split(' ');
+        corpus.output = file.readAll();
+        m_corpus.insert(QLatin1String(corpusFile.name), corpus);
+    }
+
+    Corpus sweep;
+    sweep.parameters = QString::fromLatin1("-sn 10.0.0.0/16").split(' ');
+    sweep.output = sweepOutput();
+    m_corpus.insert(QLatin1String("sweep"), sweep);
+}
+
+QByteArray EngineBenchmark::sweepOutput()
+{
+    QByteArray output("Starting Nmap 7.80 ( https://nmap.org ) at 2014-06-14 12:00 CEST\n");
+    output.reserve(8 * 1024 * 1024);
+
+    for (int address = 0; address < 65536; ++address) {
+        // one host of three is up
+        if (address % 3) {
+            continue;
+        }
+
+        const QByteArray host = "10.0." + QByteArray::number(address >> 8) + '.' + QByteArray::number(address & 0xff);
+        output += "Nmap scan report for " + host + "\nHost is up (0.00"
+                  + QByteArray::number(10 + address % 90) + "s latency).\n";
+
+        if (!(address % 1000)) {
+            output += "Stats: 0:01:" + QByteArray::number(10 + address / 1000 % 50)
+                      + " elapsed; " + QByteArray::number(address) + " hosts completed ("
+                      + QByteArray::number(address / 3) + " up), 256 undergoing Ping Scan\n"
+                      "Ping Scan Timing: About " + QByteArray::number(address * 100.0 / 65536, 'f', 2)
+                      + "% done; ETC: 12:04 (0:02:10 remaining)\n";
+        }
+    }
+
+    output += "Nmap done: 65536 IP addresses (21846 hosts up) scanned in 242.17 seconds\n";
+
+    return output;
+}
+
+void EngineBenchmark::addCorpusRows()
+{
+    QTest::addColumn<QString>("corpus");
+
+    QStringList names(m_corpus.keys());
+    names.sort();
+
+    for (const QString& name : names) {
+        QTest::newRow(qPrintable(name)) << name;
+    }
+}
+
+void EngineBenchmark::parse_data()
+{
+    addCorpusRows();
+}
+
+void EngineBenchmark::parse()
+{
+    QFETCH(QString, corpus);
+    const Corpus& data = m_corpus[corpus];
+
+    // the core of ParserManager::parserCore without the widgets
+    QBENCHMARK {
+        delete ScanParser::parse(data.parameters, data.output, QByteArray());
+    }
+}
+
+void EngineBenchmark::monitorFlow_data()
+{
+    addCorpusRows();
+}
+
+void EngineBenchmark::monitorFlow()
+{
+    QFETCH(QString, corpus);
+    const Corpus& data = m_corpus[corpus];
+
+    // Monitor::readFlowFromThread for every read of the process
+    QBENCHMARK {
+        ScanOutputBuffer buffer;
+        ProgressState state;
+
+        for (int from = 0; from < data.output.size(); from += flowChunkSize) {
+            const QByteArray lineData = data.output.mid(from, flowChunkSize);
+            buffer.append(lineData);
+
+            if (!ProgressParser::hasProgress(lineData)) {
+                continue;
+            }
+
+            QTextStream stream(lineData);
+            while (!stream.atEnd()) {
+                ProgressEvent event;
+                if (ProgressParser::parseLine(stream.readLine(), event)) {
+                    state.apply(event);
+                }
+            }
+        }
+
+        QVERIFY(buffer.size() == data.output.size());
+    }
+}
+
+void EngineBenchmark::progressPhases()
+{
+    // the stats and timing lines name the same phase in different ways
+    const QStringList lines = QStringList()
+        << "Stats: 0:00:10 elapsed; 0 hosts completed (1 up), 1 undergoing Service Scan"
+        << "Service scan Timing: About 50.00% done; ETC: 10:31 (0:00:05 remaining)"
+        << "Stats: 0:00:15 elapsed; 0 hosts completed (1 up), 1 undergoing Service Scan"
+        << "Service scan Timing: About 75.00% done; ETC: 10:31 (0:00:02 remaining)"
+        << "Completed Service scan at 10:31, 8.01s elapsed (3 services on 1 host)"
+        << "Stats: 0:00:20 elapsed; 0 hosts completed (1 up), 1 undergoing Script Scan"
+        << "NSE Timing: About 90.00% done; ETC: 10:32 (0:00:01 remaining)"
+        << "Completed NSE at 10:32, 1.00s elapsed";
+
+    ProgressState state;
+    double progress = 0.0;
+
+    for (const QString& line : lines) {
+        ProgressEvent event;
+        QVERIFY2(ProgressParser::parseLine(line, event), qPrintable(line));
+        state.apply(event);
+
+        QVERIFY(state.progress >= progress);
+        progress = state.progress;
+
+        if (line.startsWith(QLatin1String("Completed "))) {
+            QCOMPARE(state.percent, 100.0);
+        }
+    }
+
+    QCOMPARE(state.phaseCount, 2);
+    QVERIFY(!state.isPortPhase);
+}
+
+void EngineBenchmark::resultJson_data()
+{
+    addCorpusRows();
+}
+
+void EngineBenchmark::resultJson()
+{
+    QFETCH(QString, corpus);
+    const Corpus& data = m_corpus[corpus];
+    QScopedPointer<PObject> object(ScanParser::parse(data.parameters, data.output, QByteArray()));
+
+    QBENCHMARK {
+        QJsonDocument(ScanResultWriter::toJson(object.data(), true)).toJson(QJsonDocument::Compact);
+    }
+}
+
+void EngineBenchmark::logWriter_data()
+{
+    QTest::addColumn<QString>("corpus");
+    QTest::addColumn<int>("logType");
+
+    QStringList names(m_corpus.keys());
+    names.sort();
+
+    for (const QString& name : names) {
+        QTest::newRow(qPrintable(name + QLatin1String("/fancy"))) << name << int(LogWriter::FancyLog);
+        QTest::newRow(qPrintable(name + QLatin1String("/raw"))) << name << int(LogWriter::RawLog);
+        QTest::newRow(qPrintable(name + QLatin1String("/html"))) << name << int(LogWriter::HtmlLog);
+    }
+}
+
+void EngineBenchmark::logWriter()
+{
+    QFETCH(QString, corpus);
+    QFETCH(int, logType);
+    const Corpus& data = m_corpus[corpus];
+    QScopedPointer<PObject> object(ScanParser::parse(data.parameters, data.output, QByteArray()));
+
+    QSettings settings("nmapsi4", "nmapsi4");
+    settings.setValue("logType", logType);
+    settings.sync();
+
+    const QString path = m_tempDir.path() + QLatin1String("/log")
+                         + QLatin1String(logType == LogWriter::HtmlLog ? ".html" : ".log");
+    LogWriter writer;
+
+    QBENCHMARK {
+        writer.writeSingleLogFile(object.data(), path);
+    }
+}
+
+void EngineBenchmark::fillDiscoverList(QTreeWidget* widget) const
+{
+    const QByteArray& output = m_corpus[QLatin1String("sweep")].output;
+    const QByteArray reportLine("Nmap scan report for ");
+
+    for (int from = output.indexOf(reportLine); from != -1; from = output.indexOf(reportLine, from + 1)) {
+        const int start = from + reportLine.size();
+        QTreeWidgetItem* item = new QTreeWidgetItem(widget);
+        item->setText(0, QString::fromLatin1(output.mid(start, output.indexOf('\n', start) - start)));
+        item->setText(1, QLatin1String("Host is up"));
+    }
+}
+
+void EngineBenchmark::writeXmlDiscoverLog()
+{
+    // the discover list of the /16 sweep
+    QTreeWidget widget;
+    fillDiscoverList(&widget);
+
+    const QString fileName = m_tempDir.path() + QLatin1String("/discover.xml");
+    LogWriterXml writer;
+
+    QBENCHMARK {
+        QVERIFY(writer.writeXmlDiscoverLog(fileName, &widget));
+    }
+}
+
+void EngineBenchmark::readXmlDiscoverLog()
+{
+    QTreeWidget widget;
+    fillDiscoverList(&widget);
+
+    const QString fileName = m_tempDir.path() + QLatin1String("/discover.xml");
+    LogWriterXml writer;
+    QVERIFY(writer.writeXmlDiscoverLog(fileName, &widget));
+
+    QTreeWidget readWidget;
+
+    QBENCHMARK {
+        qDeleteAll(writer.readXmlDiscoverLog(fileName, &readWidget));
+    }
+}
+
+QTEST_MAIN(EngineBenchmark)
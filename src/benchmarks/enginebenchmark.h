@@ -0,0 +1,77 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ENGINEBENCHMARK_H
+#define ENGINEBENCHMARK_H
+
+#include <QtCore/QObject>
+#include <QtCore/QHash>
+#include <QtCore/QByteArray>
+#include <QtCore/QStringList>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QtTest>
+#include <QTreeWidget>
+
+class EngineBenchmark : public QObject
+{
+    /*!
+     * Replay recorded nmap outputs through the parser, the monitor
+     * progress, the JSON export and the log writers without nmap
+     * and without a network. The corpus is read from BENCHMARK_DATA_DIR
+     * or from the NMAPSI4_BENCHMARK_DATA environment variable.
+     */
+    Q_OBJECT
+
+private:
+    struct Corpus {
+        QStringList parameters;
+        QByteArray output;
+    };
+
+    QHash<QString, Corpus> m_corpus;
+    QTemporaryDir m_tempDir;
+
+    void addCorpusRows();
+    /*!
+     * -sn output of a /16, too big for the corpus files.
+     */
+    static QByteArray sweepOutput();
+    /*!
+     * Hosts of the sweep in a discover list.
+     */
+    void fillDiscoverList(QTreeWidget* widget) const;
+
+private slots:
+    void initTestCase();
+
+    void parse_data();
+    void parse();
+    void monitorFlow_data();
+    void monitorFlow();
+    /*!
+     * Stats and timing lines of the same phases, not a benchmark.
+     */
+    void progressPhases();
+    void resultJson_data();
+    void resultJson();
+    void logWriter_data();
+    void logWriter();
+    void writeXmlDiscoverLog();
+    void readXmlDiscoverLog();
+};
+
+#endif // ENGINEBENCHMARK_H
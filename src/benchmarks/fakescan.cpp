@@ -0,0 +1,310 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Stand-in of nmap, nping and dig for load tests, the program is chosen
+ * by the name, so a link named nping prints nping output.
+ * The output depends only on the target and the seed, the knobs are
+ * environment variables:
+ *
+ * NMAPSI4_FAKE_DURATION  ms of a scan (1000)
+ * NMAPSI4_FAKE_PORTS     open ports of a host (5)
+ * NMAPSI4_FAKE_STATS     progress lines of a scan (3)
+ * NMAPSI4_FAKE_NSE       script lines of a port (0)
+ * NMAPSI4_FAKE_PACKETS   packet trace lines of a scan (0)
+ * NMAPSI4_FAKE_DOWN      percent of hosts down (0)
+ * NMAPSI4_FAKE_SEED      seed of the results (0)
+ */
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QFileInfo>
+#include <QtCore/QStringList>
+#include <QtCore/QTextStream>
+#include <QtCore/QThread>
+#include <QtCore/QHostAddress>
+
+namespace {
+
+struct FakeService {
+    int port;
+    const char* name;
+    const char* version;
+};
+
+const FakeService services[] = {
+    { 21, "ftp", "vsftpd 3.0.3" },
+    { 22, "ssh", "OpenSSH 7.4 (protocol 2.0)" },
+    { 25, "smtp", "Postfix smtpd" },
+    { 53, "domain", "dnsmasq 2.80" },
+    { 80, "http", "Apache httpd 2.4.6 ((CentOS))" },
+    { 110, "pop3", "Dovecot pop3d" },
+    { 139, "netbios-ssn", "Samba smbd 3.X - 4.X (workgroup: WORKGROUP)" },
+    { 143, "imap", "Dovecot imapd" },
+    { 443, "ssl/http", "nginx 1.16.1" },
+    { 445, "microsoft-ds", "Samba smbd 4.9.5-Debian (workgroup: WORKGROUP)" },
+    { 993, "ssl/imap", "Dovecot imapd" },
+    { 3306, "mysql", "MySQL 5.7.29-0ubuntu0.18.04.1" },
+    { 5432, "postgresql", "PostgreSQL DB 9.6.0 or later" },
+    { 8080, "http-proxy", "Squid http proxy 4.6" }
+};
+
+const int servicesNumber = sizeof(services) / sizeof(FakeService);
+
+class FakeRandom
+{
+public:
+    explicit FakeRandom(uint seed) : m_state(seed | 1) { }
+
+    // xorshift, the same sequence on every platform
+    uint next() {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return m_state;
+    }
+
+    int bounded(int max) {
+        return max > 0 ? static_cast<int>(next() % static_cast<uint>(max)) : 0;
+    }
+
+private:
+    uint m_state;
+};
+
+int envValue(const char* name, int defaultValue)
+{
+    bool ok;
+    const int value = qgetenv(name).toInt(&ok);
+    return ok && value >= 0 ? value : defaultValue;
+}
+
+QTextStream& out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+void writeLine(const QString& line)
+{
+    // nmap writes a line at a time, the reader sees partial outputs
+    out() << line << '\n';
+    out().flush();
+}
+
+QString elapsed(int msecs)
+{
+    const int seconds = msecs / 1000;
+    return QString("0:%1:%2").arg(seconds / 60, 2, 10, QLatin1Char('0')).arg(seconds % 60, 2, 10, QLatin1Char('0'));
+}
+
+QString targetOf(const QStringList& arguments)
+{
+    for (int index = arguments.size() - 1; index > 0; --index) {
+        if (!arguments[index].startsWith('-') && !arguments[index].startsWith('+')) {
+            return arguments[index];
+        }
+    }
+
+    return QString("127.0.0.1");
+}
+
+QString addressOf(const QString& target, FakeRandom& random)
+{
+    QHostAddress address(target);
+
+    if (!address.isNull()) {
+        return address.toString();
+    }
+
+    return QString("10.%1.%2.%3").arg(random.bounded(256)).arg(random.bounded(256)).arg(1 + random.bounded(254));
+}
+
+void writePackets(const QString& address, int packets, int duration, FakeRandom& random)
+{
+    for (int index = 0; index < packets; ++index) {
+        const int port = services[random.bounded(servicesNumber)].port;
+        const QString time = QString::number((index * duration / qMax(1, packets)) / 1000.0, 'f', 4);
+        writeLine(QString("SENT (%1s) TCP 10.0.0.1:%2 > %3:%4 S ttl=%5 id=%6 iplen=44  seq=%7 win=1024 <mss 1460>")
+                  .arg(time).arg(40000 + index).arg(address).arg(port).arg(37 + random.bounded(22))
+                  .arg(random.bounded(65536)).arg(random.next()));
+        writeLine(QString("RCVD (%1s) TCP %2:%3 > 10.0.0.1:%4 %5 ttl=64 id=0 iplen=44  seq=%6 win=29200")
+                  .arg(time).arg(address).arg(port).arg(40000 + index)
+                  .arg(QString(random.bounded(2) ? "SA" : "RA")).arg(random.next()));
+    }
+}
+
+int fakeNmap(const QString& target, FakeRandom& random)
+{
+    const int duration = envValue("NMAPSI4_FAKE_DURATION", 1000) * (75 + random.bounded(51)) / 100;
+    const int portsNumber = qMin(envValue("NMAPSI4_FAKE_PORTS", 5), servicesNumber);
+    const int statsNumber = envValue("NMAPSI4_FAKE_STATS", 3);
+    const int nseLines = envValue("NMAPSI4_FAKE_NSE", 0);
+    const int packets = envValue("NMAPSI4_FAKE_PACKETS", 0);
+    const bool isDown = random.bounded(100) < envValue("NMAPSI4_FAKE_DOWN", 0);
+    const QString address = addressOf(target, random);
+    const QString seconds = QString::number(duration / 1000.0, 'f', 2);
+
+    writeLine("Starting Nmap 7.80 ( https://nmap.org ) at 2014-06-14 10:21 CEST");
+
+    const int step = duration / (statsNumber + 1);
+    for (int index = 1; index <= statsNumber; ++index) {
+        QThread::msleep(step);
+        const int percent = index * 100 / (statsNumber + 1);
+        writeLine(QString("Stats: %1 elapsed; 0 hosts completed (1 up), 1 undergoing SYN Stealth Scan")
+                  .arg(elapsed(index * step)));
+        writeLine(QString("SYN Stealth Scan Timing: About %1.00% done; ETC: 10:22 (%2 remaining)")
+                  .arg(percent).arg(elapsed(duration - index * step)));
+    }
+    QThread::msleep(duration - statsNumber * step);
+
+    if (isDown) {
+        writeLine("Note: Host seems down. If it is really up, but blocking our ping probes, try -Pn");
+        writeLine(QString("Nmap done: 1 IP address (0 hosts up) scanned in %1 seconds").arg(seconds));
+        return 0;
+    }
+
+    writePackets(address, packets, duration, random);
+
+    if (target == address) {
+        writeLine(QString("Nmap scan report for %1").arg(address));
+    } else {
+        writeLine(QString("Nmap scan report for %1 (%2)").arg(target, address));
+    }
+    writeLine(QString("Host is up (0.%1s latency).").arg(random.bounded(100000), 5, 10, QLatin1Char('0')));
+    writeLine(QString("Not shown: %1 closed ports").arg(1000 - portsNumber));
+    writeLine("PORT      STATE SERVICE      VERSION");
+
+    // a sorted subset of the services
+    const int first = random.bounded(servicesNumber - portsNumber + 1);
+    for (int index = first; index < first + portsNumber; ++index) {
+        const FakeService& service = services[index];
+        writeLine(QString("%1/tcp").arg(service.port).leftJustified(10)
+                  + QString("open  ") + QString(service.name).leftJustified(13) + service.version);
+
+        for (int line = 0; line < nseLines; ++line) {
+            const QString prefix = line == nseLines - 1 ? QString("|_") : QString("| ");
+            writeLine(prefix + QString("%1-info: line %2 of %3 %4").arg(service.name).arg(line + 1).arg(target).arg(random.next()));
+        }
+    }
+
+    writeLine("Service Info: OS: Linux; CPE: cpe:/o:linux:linux_kernel");
+    writeLine("");
+    writeLine("Service detection performed. Please report any incorrect results at https://nmap.org/submit/ .");
+    writeLine(QString("Nmap done: 1 IP address (1 host up) scanned in %1 seconds").arg(seconds));
+
+    return 0;
+}
+
+int fakeNping(const QString& target, FakeRandom& random)
+{
+    QStringList addresses;
+    const QPair<QHostAddress, int> subnet = QHostAddress::parseSubnet(target);
+
+    if (subnet.first.protocol() == QAbstractSocket::IPv4Protocol && subnet.second >= 16) {
+        const quint32 base = subnet.first.toIPv4Address();
+        const quint32 size = 1u << (32 - subnet.second);
+        for (quint32 index = size > 2 ? 1 : 0; index < (size > 2 ? size - 1 : size); ++index) {
+            addresses.append(QHostAddress(base + index).toString());
+        }
+    } else {
+        addresses.append(addressOf(target, random));
+    }
+
+    const int duration = envValue("NMAPSI4_FAKE_DURATION", 1000);
+    const int downPercent = envValue("NMAPSI4_FAKE_DOWN", 0);
+    const int step = duration / addresses.size();
+    int upNumber = 0;
+
+    writeLine("Starting Nping 0.7.80 ( https://nmap.org/nping ) at 2014-06-14 10:21 CEST");
+
+    for (int index = 0; index < addresses.size(); ++index) {
+        // the state of every address depends only on the address
+        FakeRandom hostRandom(qHash(addresses[index]) ^ static_cast<uint>(envValue("NMAPSI4_FAKE_SEED", 0)));
+        const QString time = QString::number(index * step / 1000.0, 'f', 4);
+
+        writeLine(QString("SENT (%1s) ICMP [10.0.0.1 > %2 Echo request (type=8/code=0) id=%3 seq=1] IP [ttl=64 id=%4 iplen=28 ]")
+                  .arg(time).arg(addresses[index]).arg(hostRandom.bounded(65536)).arg(hostRandom.bounded(65536)));
+        QThread::msleep(step);
+
+        if (hostRandom.bounded(100) >= downPercent) {
+            ++upNumber;
+            writeLine(QString("RCVD (%1s) ICMP [%2 > 10.0.0.1 Echo reply (type=0/code=0) id=%3 seq=1] IP [ttl=64 id=0 iplen=28 ]")
+                      .arg(QString::number((index * step + 1) / 1000.0, 'f', 4)).arg(addresses[index]).arg(hostRandom.bounded(65536)));
+        }
+    }
+
+    writeLine("");
+    writeLine(QString("Raw packets sent: %1 (%2B) | Rcvd: %3 (%4B) | Lost: %5 (%6%)")
+              .arg(addresses.size()).arg(addresses.size() * 28).arg(upNumber).arg(upNumber * 28)
+              .arg(addresses.size() - upNumber).arg((addresses.size() - upNumber) * 100 / addresses.size()));
+    writeLine(QString("Nping done: %1 IP addresses pinged in %2 seconds")
+              .arg(addresses.size()).arg(QString::number(duration / 1000.0, 'f', 2)));
+
+    return 0;
+}
+
+int fakeDig(const QString& target, const QStringList& arguments, FakeRandom& random)
+{
+    QThread::msleep(envValue("NMAPSI4_FAKE_DURATION", 1000) / 10);
+
+    const QString address = addressOf(target, random);
+
+    if (arguments.contains("+short")) {
+        writeLine(address);
+        return 0;
+    }
+
+    writeLine(QString("; <<>> DiG 9.11.5 <<>> %1").arg(target));
+    writeLine(";; global options: +cmd");
+    writeLine(";; Got answer:");
+    writeLine(QString(";; ->>HEADER<<- opcode: QUERY, status: NOERROR, id: %1").arg(random.bounded(65536)));
+    writeLine(";; flags: qr rd ra; QUERY: 1, ANSWER: 1, AUTHORITY: 0, ADDITIONAL: 1");
+    writeLine("");
+    writeLine(";; QUESTION SECTION:");
+    writeLine(QString(";%1.\t\t\tIN\tA").arg(target));
+    writeLine("");
+    writeLine(";; ANSWER SECTION:");
+    writeLine(QString("%1.\t\t%2\tIN\tA\t%3").arg(target).arg(60 + random.bounded(3600)).arg(address));
+    writeLine("");
+    writeLine(QString(";; Query time: %1 msec").arg(random.bounded(100)));
+    writeLine(";; SERVER: 127.0.0.53#53(127.0.0.53)");
+
+    return 0;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    const QStringList arguments = app.arguments();
+    const QString program = QFileInfo(arguments.first()).baseName();
+    const QString target = targetOf(arguments);
+
+    FakeRandom random(qHash(target) ^ static_cast<uint>(envValue("NMAPSI4_FAKE_SEED", 0)));
+
+    if (program.startsWith(QLatin1String("nping"))) {
+        return fakeNping(target, random);
+    }
+
+    if (program.startsWith(QLatin1String("dig"))) {
+        return fakeDig(target, arguments, random);
+    }
+
+    return fakeNmap(target, random);
+}
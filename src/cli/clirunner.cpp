@@ -0,0 +1,298 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "clirunner.h"
+#include "scanparser.h"
+#include "scanmetrics.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QSaveFile>
+
+CliRunner::CliRunner(QObject* parent)
+    : QObject(parent),
+      m_writer(0),
+      m_cveIndex(0),
+      m_controlServer(0),
+      m_errorStream(stderr),
+      m_fullLog(false),
+      m_quiet(false),
+      m_failedHosts(0),
+      m_finishedHosts(0)
+{
+    m_scheduler = new ScanScheduler(this);
+
+    connect(m_scheduler, &ScanScheduler::hostStarted,
+            this, &CliRunner::hostStarted);
+    connect(m_scheduler, &ScanScheduler::hostFinished,
+            this, &CliRunner::hostFinished);
+    connect(m_scheduler, &ScanScheduler::hostFailed,
+            this, &CliRunner::hostFailed);
+    connect(m_scheduler, &ScanScheduler::allFinished,
+            this, &CliRunner::profileFinished);
+}
+
+CliRunner::~CliRunner()
+{
+    delete m_writer;
+    delete m_cveIndex;
+}
+
+void CliRunner::setTargets(const QStringList& targets)
+{
+    m_targets = targets;
+}
+
+void CliRunner::addProfile(const QString& name, const QStringList& parameters)
+{
+    m_profiles.append(qMakePair(name, parameters));
+}
+
+void CliRunner::setProgramName(const QString& programName)
+{
+    m_scheduler->setProgramName(programName);
+}
+
+void CliRunner::setMaxParallelScan(int maxParallelScan)
+{
+    m_scheduler->setMaxParallelScan(maxParallelScan);
+}
+
+void CliRunner::setFullLog(bool fullLog)
+{
+    m_fullLog = fullLog;
+
+    if (m_writer) {
+        m_writer->setFullLog(fullLog);
+    }
+}
+
+void CliRunner::setQuiet(bool quiet)
+{
+    m_quiet = quiet;
+}
+
+bool CliRunner::setOutputFile(const QString& fileName)
+{
+    if (fileName == QLatin1String("-")) {
+        if (!m_outputFile.open(stdout, QIODevice::WriteOnly)) {
+            return false;
+        }
+    } else {
+        m_outputFile.setFileName(fileName);
+        if (!m_outputFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            return false;
+        }
+    }
+
+    delete m_writer;
+    m_writer = new ScanResultWriter(&m_outputFile);
+    m_writer->setFullLog(m_fullLog);
+
+    return true;
+}
+
+bool CliRunner::setOutputDirectory(const QString& path)
+{
+    QDir directory(path);
+
+    if (!directory.exists() && !directory.mkpath(".")) {
+        return false;
+    }
+
+    m_outputDirectory = directory.absolutePath();
+    return true;
+}
+
+bool CliRunner::loadCveIndex()
+{
+    delete m_cveIndex;
+    m_cveIndex = new CveIndex();
+
+    if (!m_cveIndex->load(CveIndex::defaultFileName()) || m_cveIndex->isEmpty()) {
+        delete m_cveIndex;
+        m_cveIndex = 0;
+        return false;
+    }
+
+    return true;
+}
+
+bool CliRunner::listen(quint16 port, int userId, QString& error)
+{
+    m_controlServer = new ControlServer(this);
+    m_controlServer->setUserId(userId);
+
+    if (!m_controlServer->listen(port)) {
+        error = m_controlServer->errorString();
+        return false;
+    }
+
+    connect(m_controlServer, &ControlServer::jobSubmitted,
+            this, &CliRunner::jobSubmitted);
+    connect(m_controlServer, &ControlServer::jobCanceled,
+            this, &CliRunner::jobCanceled);
+
+    message(QString("listening on 127.0.0.1:%1, token in %2").arg(m_controlServer->serverPort())
+            .arg(m_controlServer->tokenFileName()));
+    return true;
+}
+
+void CliRunner::start()
+{
+    m_elapsedTimer.start();
+    startNextProfile();
+}
+
+void CliRunner::startNextProfile()
+{
+    if (m_profiles.isEmpty()) {
+        m_outputFile.flush();
+        if (!m_controlServer) {
+            // throughput of the run, used by the load tests
+            const qint64 elapsed = qMax(m_elapsedTimer.elapsed(), qint64(1));
+            message(QString("%1 hosts in %2 s, %3 hosts/s, %4 kB resident memory")
+                    .arg(m_finishedHosts + m_failedHosts)
+                    .arg(elapsed / 1000.0, 0, 'f', 1)
+                    .arg(m_finishedHosts * 1000.0 / elapsed, 0, 'f', 2)
+                    .arg(ScanMetrics::residentMemory()));
+            emit finished(m_failedHosts ? 2 : 0);
+        }
+        return;
+    }
+
+    const QPair<QString, QStringList> profile = m_profiles.takeFirst();
+    message(QString("profile \"%1\": %2").arg(profile.first).arg(profile.second.join(" ")));
+
+    for (const QString& target : m_targets) {
+        m_scheduler->addHost(target, profile.second);
+    }
+
+    if (!m_scheduler->pendingHosts()) {
+        startNextProfile();
+    }
+}
+
+void CliRunner::writeHost(PObject* object)
+{
+    if (m_writer && !m_writer->write(object)) {
+        message(QString("write error: %1").arg(m_outputFile.errorString()));
+    }
+
+    if (m_outputDirectory.isEmpty()) {
+        return;
+    }
+
+    // ip ranges contain "/"
+    QString fileName(object->getHostName());
+    fileName.replace('/', '_');
+    fileName.replace(':', '_');
+
+    QSaveFile file(m_outputDirectory + QDir::separator() + fileName + QLatin1String(".json"));
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        message(QString("write error: %1").arg(file.fileName()));
+        return;
+    }
+
+    ScanResultWriter writer(&file);
+    writer.setFullLog(m_fullLog);
+
+    if (!writer.write(object) || !file.commit()) {
+        message(QString("write error: %1").arg(file.fileName()));
+    }
+}
+
+void CliRunner::message(const QString& text)
+{
+    if (m_quiet) {
+        return;
+    }
+
+    m_errorStream << "nmapsi4-cli: " << text << endl;
+}
+
+void CliRunner::hostStarted(const QString& hostName)
+{
+    message(QString("scanning %1").arg(hostName));
+
+    if (m_hostJobHash.contains(hostName)) {
+        m_controlServer->hostStarted(m_hostJobHash.value(hostName), hostName);
+    }
+}
+
+void CliRunner::hostFinished(PObject* object)
+{
+    m_finishedHosts++;
+    ScanParser::decodeScripts(object);
+
+    if (m_cveIndex) {
+        // closed ports are not useful
+        QStringList ports;
+        ports << object->getPortOpen() << object->getPortFiltered();
+        object->setCveMatches(m_cveIndex->correlate(ports, object->getHostInfo(), object->getNseScripts()));
+    }
+
+    writeHost(object);
+
+    if (m_hostJobHash.contains(object->getHostName())) {
+        m_controlServer->hostFinished(m_hostJobHash.take(object->getHostName()), object->getHostName(),
+                                      ScanResultWriter::toJson(object, m_fullLog));
+    }
+
+    message(QString("%1 done, %2 open ports").arg(object->getHostName()).arg(object->getPortOpen().size()));
+
+    delete object;
+}
+
+void CliRunner::hostFailed(const QString& hostName, const QString& error)
+{
+    m_failedHosts++;
+    // errors are always shown
+    m_errorStream << "nmapsi4-cli: " << hostName << " failed: " << error << endl;
+
+    if (m_hostJobHash.contains(hostName)) {
+        m_controlServer->hostFailed(m_hostJobHash.take(hostName), hostName, error);
+    }
+}
+
+void CliRunner::profileFinished()
+{
+    startNextProfile();
+}
+
+void CliRunner::jobSubmitted(int jobId, const QStringList& targets, const QStringList& parameters)
+{
+    for (const QString& target : targets) {
+        if (m_scheduler->addHost(target, parameters)) {
+            m_hostJobHash.insert(target, jobId);
+            m_controlServer->hostQueued(jobId, target);
+        } else {
+            m_controlServer->hostRejected(jobId, target, QLatin1String("already queued"));
+        }
+    }
+}
+
+void CliRunner::jobCanceled(int jobId)
+{
+    const QStringList hostList = m_hostJobHash.keys(jobId);
+
+    for (const QString& hostName : hostList) {
+        m_hostJobHash.remove(hostName);
+        m_scheduler->cancelHost(hostName);
+        m_controlServer->hostFailed(jobId, hostName, QLatin1String("canceled"));
+    }
+}
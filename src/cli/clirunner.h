@@ -0,0 +1,111 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CLIRUNNER_H
+#define CLIRUNNER_H
+
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QList>
+#include <QtCore/QPair>
+#include <QtCore/QFile>
+#include <QtCore/QTextStream>
+#include <QtCore/QElapsedTimer>
+
+#include "scanscheduler.h"
+#include "scanresultwriter.h"
+#include "cvedatabase.h"
+#include "controlserver.h"
+
+class CliRunner : public QObject
+{
+    /*!
+     * Scan the targets with every profile, one profile after
+     * the other, and write every host as soon as it is parsed.
+     */
+    Q_OBJECT
+
+public:
+    explicit CliRunner(QObject* parent = 0);
+    ~CliRunner();
+
+    void setTargets(const QStringList& targets);
+    /*!
+     * Add a profile as name and nmap parameters.
+     */
+    void addProfile(const QString& name, const QStringList& parameters);
+    void setProgramName(const QString& programName);
+    void setMaxParallelScan(int maxParallelScan);
+    void setFullLog(bool fullLog);
+    void setQuiet(bool quiet);
+    /*!
+     * Write all hosts in a JSON lines file, "-" is the standard output.
+     */
+    bool setOutputFile(const QString& fileName);
+    /*!
+     * Write a JSON file for every host in the directory.
+     */
+    bool setOutputDirectory(const QString& path);
+    /*!
+     * Correlate the hosts with the local CVE index.
+     */
+    bool loadCveIndex();
+    /*!
+     * Queue the jobs of the control server, the runner
+     * doesn't finish after the profiles.
+     */
+    bool listen(quint16 port, int userId, QString& error);
+
+public slots:
+    void start();
+
+signals:
+    void finished(int exitCode);
+
+private:
+    ScanScheduler* m_scheduler;
+    QStringList m_targets;
+    QList< QPair<QString, QStringList> > m_profiles;
+    QFile m_outputFile;
+    QString m_outputDirectory;
+    ScanResultWriter* m_writer;
+    CveIndex* m_cveIndex;
+    ControlServer* m_controlServer;
+    // hosts of the control server jobs
+    QHash<QString, int> m_hostJobHash;
+    QTextStream m_errorStream;
+    bool m_fullLog;
+    bool m_quiet;
+    int m_failedHosts;
+    int m_finishedHosts;
+    QElapsedTimer m_elapsedTimer;
+
+    void startNextProfile();
+    void writeHost(PObject* object);
+    void message(const QString& text);
+
+private slots:
+    void hostStarted(const QString& hostName);
+    void hostFinished(PObject* object);
+    void hostFailed(const QString& hostName, const QString& error);
+    void profileFinished();
+    void jobSubmitted(int jobId, const QStringList& targets, const QStringList& parameters);
+    void jobCanceled(int jobId);
+};
+
+#endif // CLIRUNNER_H
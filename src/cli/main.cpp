@@ -0,0 +1,207 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QSettings>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QFile>
+#include <QtCore/QTextStream>
+#include <QtCore/QMetaObject>
+#include <QtCore/QRegExp>
+
+#if !defined(Q_OS_WIN32)
+#include <unistd.h>
+#endif
+
+#include "config-nmapsi4.h"
+#include "clirunner.h"
+#include "scanprofiles.h"
+#include "programpaths.h"
+
+static int usageError(const QString& text)
+{
+    QTextStream errorStream(stderr);
+    errorStream << "nmapsi4-cli: " << text << endl;
+    return 1;
+}
+
+static bool readTargetFile(const QString& fileName, QStringList& targets)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    QTextStream stream(&file);
+
+    while (!stream.atEnd()) {
+        const QString line = stream.readLine().trimmed();
+        if (!line.isEmpty() && !line.startsWith('#')) {
+            targets.append(line.split(QRegExp("\\s+"), QString::SkipEmptyParts));
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("nmapsi4-cli");
+    QCoreApplication::setApplicationVersion(VERSION);
+
+    int userId = 0;
+#if !defined(Q_OS_WIN32)
+    userId = getuid();
+#endif
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Scan the targets with the nmapsi4 profiles and write JSON lines.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("targets", "Hosts, ip addresses or ranges to scan.", "[targets...]");
+
+    QCommandLineOption profileOption(QStringList() << "p" << "profile",
+                                     "Scan profile, repeat the option for more profiles.", "name");
+    QCommandLineOption parametersOption("parameters", "Custom nmap parameters instead of a profile.", "options");
+    QCommandLineOption inputOption(QStringList() << "i" << "input-file",
+                                   "Read the targets from a file, one or more for each line.", "file");
+    QCommandLineOption outputOption(QStringList() << "o" << "output",
+                                    "JSON lines file, \"-\" for the standard output.", "file", "-");
+    QCommandLineOption directoryOption("output-dir", "Write a JSON file for every host.", "directory");
+    QCommandLineOption parallelOption(QStringList() << "j" << "parallel", "Max parallel scans.", "number");
+    QCommandLineOption nmapOption("nmap", "Path of the nmap program.", "path", ProgramPaths::path("nmap"));
+    QCommandLineOption fullLogOption("full-log", "Add the nmap output to every host.");
+    QCommandLineOption cveOption("cve", "Match the services with the local CVE index.");
+    QCommandLineOption listOption("list-profiles", "Show the scan profiles and exit.");
+    QCommandLineOption quietOption(QStringList() << "q" << "quiet", "Show only the errors.");
+    QCommandLineOption listenOption("listen", "Run as a daemon, queue the scans of the loopback HTTP port.", "port");
+
+    parser.addOption(profileOption);
+    parser.addOption(parametersOption);
+    parser.addOption(inputOption);
+    parser.addOption(outputOption);
+    parser.addOption(directoryOption);
+    parser.addOption(parallelOption);
+    parser.addOption(nmapOption);
+    parser.addOption(fullLogOption);
+    parser.addOption(cveOption);
+    parser.addOption(listOption);
+    parser.addOption(quietOption);
+    parser.addOption(listenOption);
+    parser.process(app);
+
+    if (parser.isSet(listOption)) {
+        QList< QPair<QString, QString> > profiles(ScanProfiles::defaultProfiles(userId));
+        profiles.append(ScanProfiles::savedProfiles(userId));
+
+        QTextStream outputStream(stdout);
+        for (const QPair<QString, QString>& profile : profiles) {
+            outputStream << profile.first << '\t' << profile.second << endl;
+        }
+        return 0;
+    }
+
+    QStringList targets(parser.positionalArguments());
+
+    for (const QString& fileName : parser.values(inputOption)) {
+        if (!readTargetFile(fileName, targets)) {
+            return usageError(QString("target file not readable: %1").arg(fileName));
+        }
+    }
+
+    if (targets.isEmpty() && !parser.isSet(listenOption)) {
+        return usageError("no targets, see --help");
+    }
+
+    const QString programName = parser.value(nmapOption);
+
+    if (QStandardPaths::findExecutable(programName).isEmpty() && !QFile::exists(programName)) {
+        return usageError(QString("%1 not found").arg(programName));
+    }
+
+    CliRunner runner;
+    runner.setTargets(targets);
+    runner.setProgramName(programName);
+    runner.setQuiet(parser.isSet(quietOption));
+    runner.setFullLog(parser.isSet(fullLogOption));
+
+    QStringList profileNames(parser.values(profileOption));
+
+    if (parser.isSet(parametersOption)) {
+        runner.addProfile("custom", parser.value(parametersOption).split(' ', QString::SkipEmptyParts));
+    } else if (profileNames.isEmpty() && !targets.isEmpty()) {
+        profileNames.append(ScanProfiles::defaultProfiles(userId).first().first);
+    }
+
+    for (const QString& profileName : profileNames) {
+        QString parameters;
+        if (!ScanProfiles::parameters(profileName, userId, parameters)) {
+            return usageError(QString("unknown profile \"%1\", see --list-profiles").arg(profileName));
+        }
+        runner.addProfile(profileName, parameters.split(' ', QString::SkipEmptyParts));
+    }
+
+    QSettings settings("nmapsi4", "nmapsi4");
+    int maxParallelScan = settings.value("maxParallelScan", 5).toInt();
+
+    if (parser.isSet(parallelOption)) {
+        bool ok;
+        maxParallelScan = parser.value(parallelOption).toInt(&ok);
+        if (!ok || maxParallelScan < 1) {
+            return usageError("wrong parallel scans number");
+        }
+    }
+
+    runner.setMaxParallelScan(maxParallelScan);
+
+    // without --output-dir the hosts are written to the standard output
+    if ((parser.isSet(outputOption) || !parser.isSet(directoryOption))
+            && !runner.setOutputFile(parser.value(outputOption))) {
+        return usageError(QString("output file not writable: %1").arg(parser.value(outputOption)));
+    }
+
+    if (parser.isSet(directoryOption) && !runner.setOutputDirectory(parser.value(directoryOption))) {
+        return usageError(QString("output directory not writable: %1").arg(parser.value(directoryOption)));
+    }
+
+    if (parser.isSet(cveOption) && !runner.loadCveIndex()) {
+        return usageError("the CVE index is empty, import the NVD feeds from nmapsi4");
+    }
+
+    if (parser.isSet(listenOption)) {
+        bool ok;
+        const int port = parser.value(listenOption).toInt(&ok);
+        QString error;
+
+        if (!ok || port < 1 || port > 65535) {
+            return usageError("wrong listen port");
+        }
+
+        if (!runner.listen(port, userId, error)) {
+            return usageError(QString("listen error: %1").arg(error));
+        }
+    }
+
+    QObject::connect(&runner, &CliRunner::finished, &QCoreApplication::exit);
+    // the scans are started by the event loop
+    QMetaObject::invokeMethod(&runner, "start", Qt::QueuedConnection);
+
+    return app.exec();
+}
@@ -28,5 +28,6 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define DIG_NO_DEBUG
 //#define THREAD_NO_DEBUG
 #define LOOKUP_NO_DEBUG
+#define NSE_NO_DEBUG
 
 #endif
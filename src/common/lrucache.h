@@ -0,0 +1,240 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LRUCACHE_H
+#define LRUCACHE_H
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+
+/*
+ * Values in least recently used order with a limit.
+ * A hash finds the node of a value and the nodes are a double linked
+ * list, touch and eviction don't depend on the size.
+ */
+template <class T>
+class LruCache
+{
+public:
+    /*
+     * A negative capacity is unlimited.
+     */
+    explicit LruCache(int capacity = -1);
+    LruCache(const LruCache<T>& other);
+    ~LruCache();
+    LruCache<T>& operator=(const LruCache<T>& other);
+
+    /*
+     * Insert the value or move it to the front, the values over
+     * capacity are appended to evicted. Return true for a new value.
+     */
+    bool touch(const T& value, QList<T>* evicted = 0);
+    bool contains(const T& value) const;
+    bool remove(const T& value);
+    void setCapacity(int capacity, QList<T>* evicted = 0);
+    int capacity() const;
+    int size() const;
+    void clear();
+    /*
+     * Values from the most recent one.
+     */
+    QList<T> values() const;
+
+private:
+    struct Node {
+        T value;
+        Node* previous;
+        Node* next;
+    };
+
+    void unlink(Node* node);
+    void linkFront(Node* node);
+    void evict(QList<T>* evicted);
+
+    QHash<T, Node*> m_nodes;
+    Node* m_first;
+    Node* m_last;
+    int m_capacity;
+};
+
+template <class T>
+inline LruCache<T>::LruCache(int capacity)
+    : m_first(0), m_last(0), m_capacity(capacity)
+{
+}
+
+template <class T>
+inline LruCache<T>::LruCache(const LruCache<T>& other)
+    : m_first(0), m_last(0), m_capacity(other.m_capacity)
+{
+    *this = other;
+}
+
+template <class T>
+inline LruCache<T>::~LruCache()
+{
+    clear();
+}
+
+template <class T>
+inline LruCache<T>& LruCache<T>::operator=(const LruCache<T>& other)
+{
+    if (this == &other) {
+        return *this;
+    }
+
+    clear();
+    m_capacity = other.m_capacity;
+
+    // from the oldest value, the last touch is the most recent
+    for (Node* node = other.m_last; node; node = node->previous) {
+        touch(node->value);
+    }
+
+    return *this;
+}
+
+template <class T>
+inline bool LruCache<T>::touch(const T& value, QList<T>* evicted)
+{
+    typename QHash<T, Node*>::const_iterator i = m_nodes.constFind(value);
+
+    if (i != m_nodes.constEnd()) {
+        unlink(i.value());
+        linkFront(i.value());
+        return false;
+    }
+
+    Node* node = new Node;
+    node->value = value;
+    m_nodes.insert(value, node);
+    linkFront(node);
+    evict(evicted);
+
+    return true;
+}
+
+template <class T>
+inline bool LruCache<T>::contains(const T& value) const
+{
+    return m_nodes.contains(value);
+}
+
+template <class T>
+inline bool LruCache<T>::remove(const T& value)
+{
+    Node* node = m_nodes.take(value);
+
+    if (!node) {
+        return false;
+    }
+
+    unlink(node);
+    delete node;
+
+    return true;
+}
+
+template <class T>
+inline void LruCache<T>::setCapacity(int capacity, QList<T>* evicted)
+{
+    m_capacity = capacity;
+    evict(evicted);
+}
+
+template <class T>
+inline int LruCache<T>::capacity() const
+{
+    return m_capacity;
+}
+
+template <class T>
+inline int LruCache<T>::size() const
+{
+    return m_nodes.size();
+}
+
+template <class T>
+inline void LruCache<T>::clear()
+{
+    qDeleteAll(m_nodes);
+    m_nodes.clear();
+    m_first = 0;
+    m_last = 0;
+}
+
+template <class T>
+inline QList<T> LruCache<T>::values() const
+{
+    QList<T> valueList;
+    valueList.reserve(m_nodes.size());
+
+    for (Node* node = m_first; node; node = node->next) {
+        valueList.append(node->value);
+    }
+
+    return valueList;
+}
+
+template <class T>
+inline void LruCache<T>::unlink(Node* node)
+{
+    if (node->previous) {
+        node->previous->next = node->next;
+    } else {
+        m_first = node->next;
+    }
+
+    if (node->next) {
+        node->next->previous = node->previous;
+    } else {
+        m_last = node->previous;
+    }
+}
+
+template <class T>
+inline void LruCache<T>::linkFront(Node* node)
+{
+    node->previous = 0;
+    node->next = m_first;
+
+    if (m_first) {
+        m_first->previous = node;
+    } else {
+        m_last = node;
+    }
+
+    m_first = node;
+}
+
+template <class T>
+inline void LruCache<T>::evict(QList<T>* evicted)
+{
+    while (m_capacity >= 0 && m_nodes.size() > m_capacity && m_last) {
+        Node* node = m_last;
+        unlink(node);
+        m_nodes.remove(node->value);
+
+        if (evicted) {
+            evicted->append(node->value);
+        }
+
+        delete node;
+    }
+}
+
+#endif
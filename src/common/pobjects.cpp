@@ -77,6 +77,16 @@ const QHash< QString, QStringList > &PObject::getNseResult() const
     return m_nssResult;
 }
 
+const QList<NseScriptResult> &PObject::getNseScripts() const
+{
+    return m_nseScripts;
+}
+
+const QList<CveMatch> &PObject::getCveMatches() const
+{
+    return m_cveMatches;
+}
+
 const QStringList& PObject::getVulnDiscoverd() const
 {
     return m_vulnDiscoverd;
@@ -152,6 +162,16 @@ void PObject::setNseResult(const QHash< QString, QStringList > nseResult)
     m_nssResult = nseResult;
 }
 
+void PObject::setNseScripts(const QList<NseScriptResult> nseScripts)
+{
+    m_nseScripts = nseScripts;
+}
+
+void PObject::setCveMatches(const QList<CveMatch> cveMatches)
+{
+    m_cveMatches = cveMatches;
+}
+
 void PObject::setId(int id)
 {
     m_id = id;
@@ -21,8 +21,49 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QtCore/QString>
 #include <QtCore/QStringList>
 #include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QVariant>
 #include <QtCore/QMetaType>
 
+/*
+ * Output of a single nse script, fields are filled
+ * by the script decoder when one is available
+ */
+class NseScriptResult
+{
+
+public:
+    QString scriptName;
+    // port line or "Host script results:"
+    QString target;
+    QStringList lines;
+    QVariantMap fields;
+};
+
+Q_DECLARE_METATYPE(NseScriptResult);
+Q_DECLARE_METATYPE(QList<NseScriptResult>);
+
+/*
+ * A known vulnerability of a scanned product,
+ * port is empty for host values like the OS CPE
+ */
+class CveMatch
+{
+
+public:
+    CveMatch() : cvss(0), isPossible(false) {};
+
+    QString port;
+    QString cpe;
+    QString cveId;
+    double cvss;
+    // the version or the configuration isn't enough to confirm it
+    bool isPossible;
+};
+
+Q_DECLARE_METATYPE(CveMatch);
+Q_DECLARE_METATYPE(QList<CveMatch>);
+
 class PObject
 {
 
@@ -42,6 +83,8 @@ public:
     const QStringList &getErrorScan() const;
     const QStringList &getVulnDiscoverd() const;
     const QHash<QString, QStringList> &getNseResult() const;
+    const QList<NseScriptResult> &getNseScripts() const;
+    const QList<CveMatch> &getCveMatches() const;
     bool isValidObject();
     int getId();
 
@@ -55,6 +98,8 @@ public:
     void setFullScanLog(const QString logElem);
     void setErrorScan(const QString errorElem);
     void setNseResult(const QHash<QString, QStringList> nseResult);
+    void setNseScripts(const QList<NseScriptResult> nseScripts);
+    void setCveMatches(const QList<CveMatch> cveMatches);
     void setValidity(bool isValid);
     void setParameters(const QString parameters);
     void setId(int id);
@@ -72,6 +117,8 @@ private:
     QStringList m_fullLogScan;
     QStringList m_errorScan;
     QHash<QString, QStringList> m_nssResult;
+    QList<NseScriptResult> m_nseScripts;
+    QList<CveMatch> m_cveMatches;
     QStringList m_vulnDiscoverd;
     bool m_validFlag;
     int m_id;
@@ -17,9 +17,68 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "processthread.h"
 
+#include <QtCore/QDateTime>
+#include <QtCore/QFile>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+
+#if defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#if defined(Q_OS_UNIX)
+namespace
+{
+/*
+ * Usage of the reaped children at the last reap of a thread,
+ * the delta of the next reap is the usage of its process.
+ */
+struct ChildrenUsage {
+    ChildrenUsage() : isValid(false), cpuTime(0), peakMemory(0) {};
+
+    QMutex mutex;
+    bool isValid;
+    qint64 cpuTime;
+    qint64 peakMemory;
+};
+
+ChildrenUsage& childrenUsage()
+{
+    static ChildrenUsage usage;
+    return usage;
+}
+
+void readChildrenUsage(qint64& cpuTime, qint64& peakMemory)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_CHILDREN, &usage);
+
+    cpuTime = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000
+              + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000;
+#if defined(Q_OS_DARWIN)
+    // bytes on darwin
+    peakMemory = usage.ru_maxrss / 1024;
+#else
+    peakMemory = usage.ru_maxrss;
+#endif
+}
+}
+#endif
+
 ProcessThread::ProcessThread(const QString& programName, const QStringList& parameters)
-    : m_ParList(parameters), m_programName(programName)
+    : m_ParList(parameters), m_programName(programName), m_jobId(ScanOutput::nextJobId())
+{
+}
+
+const ProcessMetrics& ProcessThread::metrics() const
+{
+    return m_metrics;
+}
+
+int ProcessThread::jobId() const
 {
+    return m_jobId;
 }
 
 ProcessThread::~ProcessThread()
@@ -34,26 +93,52 @@ void ProcessThread::run()
 {
     m_process = new QProcess();
     qRegisterMetaType<QProcess::ExitStatus>("QProcess::ExitStatus");
+    qRegisterMetaType<ScanOutput>("ScanOutput");
 
     connect(m_process, static_cast<void (QProcess::*)(int,QProcess::ExitStatus)>(&QProcess::finished),
             this, &ProcessThread::readFinished);
     connect(m_process, &QProcess::readyReadStandardOutput,
             this, &ProcessThread::readyReadData);
+    // stdout is closed at exit, before the process is reaped
+    connect(m_process, &QProcess::readChannelFinished,
+            this, &ProcessThread::sampleProcess);
 
 #ifndef THREAD_NO_DEBUG
     qDebug() << "ProcessThread::Command:: " << m_ParList;
 #endif
 
+#if defined(Q_OS_UNIX)
+    {
+        ChildrenUsage& usage = childrenUsage();
+        QMutexLocker locker(&usage.mutex);
+
+        if (!usage.isValid) {
+            // children reaped before the first thread aren't counted
+            readChildrenUsage(usage.cpuTime, usage.peakMemory);
+            usage.isValid = true;
+        }
+    }
+#endif
+
+    m_metrics.startTime = QDateTime::currentMSecsSinceEpoch();
+    m_wallTimer.start();
     m_process->start(m_programName, m_ParList);
 
     exec();
-    // emit signal, scan is end
-    emit threadEnd(m_ParList, m_pout, m_perr);
-    emit dataIsReady(m_ParList, m_perr);
+
+    m_metrics.wallTime = m_wallTimer.elapsed();
+    m_metrics.outputBytes = m_pout.size();
+    m_metrics.errorBytes = m_perr.size();
+    // emit signal, scan is end, the receivers share the buffers
+    emit threadEnd(ScanOutput(m_jobId, m_ParList, m_pout, m_perr));
 }
 
-void ProcessThread::readFinished()
+void ProcessThread::readFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
+    m_metrics.exitCode = exitCode;
+    m_metrics.isCrashed = (exitStatus == QProcess::CrashExit);
+    readUsage();
+
     // set scan return buffer
     m_perr  = m_process->readAllStandardError(); // read error buffer
     m_process->close();
@@ -85,7 +170,69 @@ void ProcessThread::readyReadData()
     QByteArray realtimeByteArray(m_process->readAllStandardOutput());
     if (!realtimeByteArray.isEmpty()) {
         m_pout.append(realtimeByteArray);
+
+        // a few reads of procfs for every second of output
+        if (!m_sampleTimer.isValid() || m_sampleTimer.elapsed() >= 500) {
+            m_sampleTimer.start();
+            sampleProcess();
+        }
+
         // emit signal for data trasmission to parent
-        emit flowFromThread(m_ParList[m_ParList.size() - 1], realtimeByteArray);
+        emit flowFromThread(m_jobId, realtimeByteArray);
+    }
+}
+
+void ProcessThread::readUsage()
+{
+#if defined(Q_OS_UNIX)
+    // the process is reaped, its usage is in the children usage
+    ChildrenUsage& usage = childrenUsage();
+    QMutexLocker locker(&usage.mutex);
+
+    qint64 cpuTime;
+    qint64 peakMemory;
+    readChildrenUsage(cpuTime, peakMemory);
+
+    // procfs samples are a lower bound when two reaps are read together
+    m_metrics.cpuTime = qMax(m_metrics.cpuTime, cpuTime - usage.cpuTime);
+    usage.cpuTime = cpuTime;
+
+    // the children peak is the largest child, it grows only with this one
+    if (peakMemory > usage.peakMemory) {
+        m_metrics.peakMemory = qMax(m_metrics.peakMemory, peakMemory);
+        usage.peakMemory = peakMemory;
     }
+#endif
+}
+
+void ProcessThread::sampleProcess()
+{
+#if defined(Q_OS_LINUX)
+    const QString procPath = QLatin1String("/proc/") + QString::number(m_process->processId());
+    QFile statFile(procPath + QLatin1String("/stat"));
+
+    if (statFile.open(QIODevice::ReadOnly)) {
+        // the name can contain spaces, fields are read after it
+        const QByteArray stat = statFile.readAll();
+        const QList<QByteArray> fields = stat.mid(stat.lastIndexOf(')') + 2).split(' ');
+
+        if (fields.size() > 12) {
+            const qint64 ticks = fields[11].toLongLong() + fields[12].toLongLong();
+            m_metrics.cpuTime = ticks * 1000 / sysconf(_SC_CLK_TCK);
+        }
+    }
+
+    QFile statusFile(procPath + QLatin1String("/status"));
+
+    if (statusFile.open(QIODevice::ReadOnly)) {
+        while (!statusFile.atEnd()) {
+            const QByteArray line = statusFile.readLine();
+
+            if (line.startsWith("VmHWM:")) {
+                m_metrics.peakMemory = line.mid(6).simplified().split(' ').value(0).toLongLong();
+                break;
+            }
+        }
+    }
+#endif
 }
@@ -24,10 +24,32 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QtCore/QProcess>
 #include <QtCore/QMetaType>
 #include <QtCore/QPointer>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QDebug>
 
 //local include
 #include "debug.h"
+#include "scanoutput.h"
+
+struct ProcessMetrics {
+    ProcessMetrics()
+        : startTime(0), wallTime(0), cpuTime(-1), peakMemory(-1),
+          outputBytes(0), errorBytes(0), exitCode(-1), isCrashed(false) {};
+
+    // msecs since epoch
+    qint64 startTime;
+    // msecs
+    qint64 wallTime;
+    // user and system msecs, -1 on windows
+    qint64 cpuTime;
+    // peak resident set in kB, -1 on windows or when
+    // not readable from procfs or the children usage
+    qint64 peakMemory;
+    qint64 outputBytes;
+    qint64 errorBytes;
+    int exitCode;
+    bool isCrashed;
+};
 
 class ProcessThread : public QThread
 {
@@ -44,26 +66,53 @@ public:
      */
     ProcessThread(const QString& programName, const QStringList& parameters);
     ~ProcessThread();
+    /*!
+     * Resources of the process, complete after threadEnd.
+     */
+    const ProcessMetrics& metrics() const;
+    /*!
+     * Id of the process in the signals.
+     */
+    int jobId() const;
 signals:
     /*!
      * Return nmap QThread output with a Signal.
      */
-    void threadEnd(const QStringList parameters, QByteArray dataBuffer, QByteArray errorBuffer);
+    void threadEnd(const ScanOutput& output);
     /*!
      * Return nmap QThread stdout for ETC and remaining scan time.
      */
-    void flowFromThread(const QString parameters, QByteArray data);
-    void dataIsReady(const QStringList parameters, QByteArray errorBuffer);
+    void flowFromThread(int jobId, const QByteArray& data);
 
 private:
     QByteArray m_pout;
     QByteArray m_perr;
     QStringList m_ParList;
     QString m_programName;
+    int m_jobId;
     QPointer<QProcess> m_process;
+    ProcessMetrics m_metrics;
+    QElapsedTimer m_wallTimer;
+    QElapsedTimer m_sampleTimer;
+
+    /*!
+     * Read cpu time and peak memory of the reaped process from
+     * getrusage(RUSAGE_CHILDREN), as the delta from the last reap.
+     * The delta of two processes reaped before the first one reads
+     * it belongs to the first, procfs samples are used for the other.
+     * Peak memory is known only when the process is the largest
+     * child reaped so far.
+     */
+    void readUsage();
 
 private slots:
-    void readFinished();
+    /*!
+     * Read cpu time and peak memory of the running process from procfs,
+     * with the output and once more when stdout is closed. Only a lower
+     * bound, the final values are read by readUsage.
+     */
+    void sampleProcess();
+    void readFinished(int exitCode, QProcess::ExitStatus exitStatus);
     void stopProcess();
     void readyReadData();
 
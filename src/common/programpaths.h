@@ -0,0 +1,57 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROGRAMPATHS_H
+#define PROGRAMPATHS_H
+
+#include <QtCore/QString>
+#include <QtCore/QSettings>
+
+#if !defined(Q_OS_WIN32)
+#include <unistd.h>
+#endif
+
+class ProgramPaths
+{
+public:
+    static QString path(const QString& programName) {
+        /**
+         * Path of nmap, nping or dig from the settings, like a stand-in
+         * program for load tests. Without a path the program is
+         * searched in PATH.
+         * As root the settings are writable by every user, the
+         * paths are ignored.
+         **/
+
+#if !defined(Q_OS_WIN32)
+        if (!getuid() || !geteuid()) {
+            return programName;
+        }
+#endif
+
+        QSettings settings("nmapsi4", "nmapsi4");
+        const QString programPath = settings.value(programName + QLatin1String("Path")).toString().trimmed();
+
+        if (programPath.isEmpty()) {
+            return programName;
+        }
+
+        return programPath;
+    }
+};
+
+#endif // PROGRAMPATHS_H
@@ -0,0 +1,93 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "scanoutput.h"
+
+#include <QtCore/QAtomicInt>
+
+namespace
+{
+QAtomicInt jobCounter;
+
+const QStringList& emptyParameters()
+{
+    static const QStringList parameters;
+    return parameters;
+}
+
+const QString& emptyTarget()
+{
+    static const QString target;
+    return target;
+}
+
+const QByteArray& emptyOutput()
+{
+    static const QByteArray output;
+    return output;
+}
+}
+
+ScanOutput::ScanOutput()
+{
+}
+
+ScanOutput::ScanOutput(int jobId, const QStringList& parameters, const QByteArray& output, const QByteArray& errors)
+{
+    Data* data = new Data;
+    data->jobId = jobId;
+    data->parameters = parameters;
+    data->target = parameters.isEmpty() ? QString() : parameters.last();
+    data->output = output;
+    data->errors = errors;
+    d = QSharedPointer<const Data>(data);
+}
+
+bool ScanOutput::isNull() const
+{
+    return d.isNull();
+}
+
+int ScanOutput::jobId() const
+{
+    return d ? d->jobId : -1;
+}
+
+const QStringList& ScanOutput::parameters() const
+{
+    return d ? d->parameters : emptyParameters();
+}
+
+const QString& ScanOutput::target() const
+{
+    return d ? d->target : emptyTarget();
+}
+
+const QByteArray& ScanOutput::output() const
+{
+    return d ? d->output : emptyOutput();
+}
+
+const QByteArray& ScanOutput::errors() const
+{
+    return d ? d->errors : emptyOutput();
+}
+
+int ScanOutput::nextJobId()
+{
+    return jobCounter.fetchAndAddRelaxed(1) + 1;
+}
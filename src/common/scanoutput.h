@@ -0,0 +1,69 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCANOUTPUT_H
+#define SCANOUTPUT_H
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QByteArray>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QMetaType>
+
+/*
+ * Read only output of a finished process. Copies share the same data,
+ * so the output crosses the queued connections without a copy.
+ * The job id identifies the process, the host is not read again
+ * from the parameters.
+ */
+class ScanOutput
+{
+
+public:
+    ScanOutput();
+    ScanOutput(int jobId, const QStringList& parameters, const QByteArray& output, const QByteArray& errors);
+
+    bool isNull() const;
+    int jobId() const;
+    const QStringList& parameters() const;
+    /*
+     * Last parameter, the host of a scan
+     */
+    const QString& target() const;
+    const QByteArray& output() const;
+    const QByteArray& errors() const;
+
+    /*
+     * A new id for a process or a reused result
+     */
+    static int nextJobId();
+
+private:
+    struct Data {
+        int jobId;
+        QStringList parameters;
+        QString target;
+        QByteArray output;
+        QByteArray errors;
+    };
+
+    QSharedPointer<const Data> d;
+};
+
+Q_DECLARE_METATYPE(ScanOutput)
+
+#endif // SCANOUTPUT_H
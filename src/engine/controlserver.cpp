@@ -0,0 +1,734 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "controlserver.h"
+#include "scanprofiles.h"
+#include "nmapoptions.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonArray>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QRegExp>
+#include <QtCore/QDebug>
+#include <QtNetwork/QHostAddress>
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+#include <QtCore/QRandomGenerator>
+#endif
+
+namespace
+{
+QByteArray randomBytes(int size)
+{
+    QByteArray bytes(size, 0);
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+    QRandomGenerator::system()->fillRange(reinterpret_cast<quint32*>(bytes.data()), size / 4);
+    return bytes;
+#else
+    QFile random("/dev/urandom");
+
+    if (!random.open(QIODevice::ReadOnly | QIODevice::Unbuffered) || random.read(bytes.data(), size) != size) {
+        return QByteArray();
+    }
+
+    return bytes;
+#endif
+}
+}
+
+ControlServer::ControlServer(QObject* parent)
+    : QObject(parent), m_jobCounter(0), m_userId(0), m_metrics(0)
+{
+    m_server = new QTcpServer(this);
+
+    connect(m_server, &QTcpServer::newConnection,
+            this, &ControlServer::newConnection);
+}
+
+ControlServer::~ControlServer()
+{
+    // sockets are children of the server
+    if (!m_tokenFileName.isEmpty()) {
+        QFile::remove(m_tokenFileName);
+    }
+}
+
+QString ControlServer::defaultTokenFileName(quint16 port)
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericConfigLocation)
+           + QLatin1String("/nmapsi4/control-") + QString::number(port) + QLatin1String(".token");
+}
+
+bool ControlServer::listen(quint16 port)
+{
+    m_errorString.clear();
+
+    // only local programs can queue scans, the token file of a server
+    // already on the port is kept
+    if (!m_server->listen(QHostAddress::LocalHost, port)) {
+        m_errorString = m_server->errorString();
+        return false;
+    }
+
+    // requests are refused until the token is set
+    if (!writeToken(defaultTokenFileName(m_server->serverPort()))) {
+        m_server->close();
+        return false;
+    }
+
+    return true;
+}
+
+bool ControlServer::writeToken(const QString& fileName)
+{
+    const QByteArray bytes = randomBytes(32);
+
+    if (bytes.isEmpty()) {
+        m_errorString = QLatin1String("no random source for the token");
+        return false;
+    }
+
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+    QSaveFile file(fileName);
+
+    // owner only before the token is written
+    if (!file.open(QIODevice::WriteOnly)
+            || !file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner)) {
+        m_errorString = file.errorString();
+        return false;
+    }
+
+    const QByteArray token = bytes.toHex();
+    file.write(QByteArray(token + '\n'));
+
+    if (!file.commit()) {
+        m_errorString = file.errorString();
+        return false;
+    }
+
+    m_token = token;
+    m_tokenFileName = fileName;
+    return true;
+}
+
+QString ControlServer::tokenFileName() const
+{
+    return m_tokenFileName;
+}
+
+quint16 ControlServer::serverPort() const
+{
+    return m_server->serverPort();
+}
+
+QString ControlServer::errorString() const
+{
+    return m_errorString;
+}
+
+void ControlServer::setUserId(int userId)
+{
+    m_userId = userId;
+}
+
+void ControlServer::setMetrics(const ScanMetrics* metrics)
+{
+    m_metrics = metrics;
+}
+
+void ControlServer::hostQueued(int jobId, const QString& hostName)
+{
+    QJsonObject event;
+    event.insert("event", QLatin1String("queued"));
+    event.insert("job", jobId);
+    event.insert("host", hostName);
+    sendEvent(event);
+}
+
+void ControlServer::hostRejected(int jobId, const QString& hostName, const QString& reason)
+{
+    if (m_jobs.contains(jobId)) {
+        m_jobs[jobId].rejected++;
+    }
+
+    QJsonObject event;
+    event.insert("event", QLatin1String("rejected"));
+    event.insert("job", jobId);
+    event.insert("host", hostName);
+    event.insert("error", reason);
+    sendEvent(event);
+
+    updateJob(jobId);
+}
+
+void ControlServer::hostStarted(int jobId, const QString& hostName)
+{
+    QJsonObject event;
+    event.insert("event", QLatin1String("started"));
+    event.insert("job", jobId);
+    event.insert("host", hostName);
+    sendEvent(event);
+}
+
+void ControlServer::hostFinished(int jobId, const QString& hostName, const QJsonObject& result)
+{
+    if (m_jobs.contains(jobId)) {
+        m_jobs[jobId].finished++;
+    }
+
+    QJsonObject event;
+    event.insert("event", QLatin1String("finished"));
+    event.insert("job", jobId);
+    event.insert("host", hostName);
+    event.insert("result", result);
+    sendEvent(event);
+
+    updateJob(jobId);
+}
+
+void ControlServer::hostFailed(int jobId, const QString& hostName, const QString& error)
+{
+    if (m_jobs.contains(jobId)) {
+        m_jobs[jobId].failed++;
+    }
+
+    QJsonObject event;
+    event.insert("event", QLatin1String("failed"));
+    event.insert("job", jobId);
+    event.insert("host", hostName);
+    event.insert("error", error);
+    sendEvent(event);
+
+    updateJob(jobId);
+}
+
+void ControlServer::updateJob(int jobId)
+{
+    if (!m_jobs.contains(jobId)) {
+        return;
+    }
+
+    const Job& job = m_jobs[jobId];
+
+    if (job.finished + job.failed + job.rejected == job.total) {
+        QJsonObject event(jobToJson(jobId));
+        event.insert("event", QLatin1String("job"));
+        sendEvent(event);
+    }
+}
+
+QJsonObject ControlServer::jobToJson(int jobId) const
+{
+    const Job job = m_jobs.value(jobId);
+    QJsonObject jobObject;
+
+    jobObject.insert("job", jobId);
+    jobObject.insert("total", job.total);
+    jobObject.insert("finished", job.finished);
+    jobObject.insert("failed", job.failed);
+    jobObject.insert("rejected", job.rejected);
+
+    if (job.finished + job.failed + job.rejected == job.total) {
+        jobObject.insert("state", QLatin1String("done"));
+    } else if (job.isCanceled) {
+        jobObject.insert("state", QLatin1String("canceled"));
+    } else {
+        jobObject.insert("state", QLatin1String("running"));
+    }
+
+    return jobObject;
+}
+
+void ControlServer::newConnection()
+{
+    while (m_server->hasPendingConnections()) {
+        QTcpSocket* socket = m_server->nextPendingConnection();
+        m_requestBuffers.insert(socket, QByteArray());
+
+        connect(socket, &QTcpSocket::readyRead,
+                this, &ControlServer::readClient);
+        connect(socket, &QTcpSocket::disconnected,
+                this, &ControlServer::clientDisconnected);
+    }
+}
+
+void ControlServer::clientDisconnected()
+{
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+
+    m_requestBuffers.remove(socket);
+    m_eventClients.remove(socket);
+    socket->deleteLater();
+}
+
+void ControlServer::readClient()
+{
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+
+    if (m_eventClients.contains(socket)) {
+        if (m_eventClients.value(socket)) {
+            readWebSocketFrames(socket);
+        } else {
+            socket->readAll();
+        }
+        return;
+    }
+
+    if (!m_requestBuffers.contains(socket)) {
+        // the response is sent, the socket is closing
+        socket->readAll();
+        return;
+    }
+
+    QByteArray& buffer = m_requestBuffers[socket];
+    buffer.append(socket->readAll());
+
+    Request request;
+    bool isComplete;
+
+    if (!readRequest(buffer, request, isComplete)) {
+        m_requestBuffers.remove(socket);
+        QJsonObject error;
+        error.insert("error", QLatin1String("bad request"));
+        sendResponse(socket, 400, error);
+        return;
+    }
+
+    if (isComplete) {
+        m_requestBuffers.remove(socket);
+        handleRequest(socket, request);
+    }
+}
+
+bool ControlServer::readRequest(QByteArray& buffer, Request& request, bool& isComplete) const
+{
+    isComplete = false;
+    const int headerEnd = buffer.indexOf("\r\n\r\n");
+
+    if (headerEnd == -1) {
+        return buffer.size() <= 64 * 1024;
+    }
+
+    const QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+    const QList<QByteArray> requestLine = lines[0].trimmed().split(' ');
+
+    if (requestLine.size() != 3) {
+        return false;
+    }
+
+    request.method = QString::fromLatin1(requestLine[0]);
+    request.path = QString::fromLatin1(requestLine[1]).section('?', 0, 0);
+
+    for (int index = 1; index < lines.size(); ++index) {
+        const int separator = lines[index].indexOf(':');
+        if (separator > 0) {
+            request.headers.insert(lines[index].left(separator).trimmed().toLower(),
+                                   lines[index].mid(separator + 1).trimmed());
+        }
+    }
+
+    bool ok = true;
+    const int contentLength = request.headers.value("content-length", "0").toInt(&ok);
+
+    if (!ok || contentLength < 0 || contentLength > maxRequestSize) {
+        return false;
+    }
+
+    if (buffer.size() < headerEnd + 4 + contentLength) {
+        return true;
+    }
+
+    request.body = buffer.mid(headerEnd + 4, contentLength);
+    isComplete = true;
+
+    return true;
+}
+
+bool ControlServer::isLocalRequest(const Request& request) const
+{
+    // browsers always send Origin on cross-site requests and WebSocket handshakes,
+    // a rebound DNS name shows up in Host
+    if (request.headers.contains("origin")) {
+        return false;
+    }
+
+    const QByteArray host = request.headers.value("host").toLower();
+    const QByteArray port = QByteArray::number(m_server->serverPort());
+
+    return host == QByteArray("127.0.0.1:" + port) || host == QByteArray("localhost:" + port);
+}
+
+bool ControlServer::isAuthorized(const Request& request) const
+{
+    const QByteArray expected = QByteArray("Bearer " + m_token);
+    const QByteArray authorization = request.headers.value("authorization");
+
+    if (m_token.isEmpty() || authorization.size() != expected.size()) {
+        return false;
+    }
+
+    // same time for every wrong token
+    char difference = 0;
+    for (int index = 0; index < expected.size(); ++index) {
+        difference |= authorization[index] ^ expected[index];
+    }
+
+    return !difference;
+}
+
+void ControlServer::handleRequest(QTcpSocket* socket, const Request& request)
+{
+    if (!isLocalRequest(request)) {
+        QJsonObject error;
+        error.insert("error", QLatin1String("forbidden"));
+        sendResponse(socket, 403, error);
+        return;
+    }
+
+    if (!isAuthorized(request)) {
+        QJsonObject error;
+        error.insert("error", QLatin1String("missing or wrong token"));
+        sendResponse(socket, 401, error);
+        return;
+    }
+
+    if (request.path == QLatin1String("/jobs")) {
+        if (request.method == QLatin1String("POST")) {
+            submitJob(socket, request);
+            return;
+        }
+
+        if (request.method == QLatin1String("GET")) {
+            QJsonArray jobs;
+            for (QMap<int, Job>::const_iterator i = m_jobs.constBegin(); i != m_jobs.constEnd(); ++i) {
+                jobs.append(jobToJson(i.key()));
+            }
+
+            QJsonObject body;
+            body.insert("jobs", jobs);
+            sendResponse(socket, 200, body);
+            return;
+        }
+    }
+
+    if (request.path.startsWith(QLatin1String("/jobs/"))) {
+        bool ok;
+        const int jobId = request.path.mid(6).toInt(&ok);
+
+        if (ok && m_jobs.contains(jobId) && request.method == QLatin1String("GET")) {
+            sendResponse(socket, 200, jobToJson(jobId));
+            return;
+        }
+
+        if (ok && m_jobs.contains(jobId) && request.method == QLatin1String("DELETE")) {
+            m_jobs[jobId].isCanceled = true;
+            sendResponse(socket, 200, jobToJson(jobId));
+            emit jobCanceled(jobId);
+            return;
+        }
+    }
+
+    if (request.path == QLatin1String("/events") && request.method == QLatin1String("GET")) {
+        startEvents(socket, request);
+        return;
+    }
+
+    if (m_metrics && request.path == QLatin1String("/metrics") && request.method == QLatin1String("GET")) {
+        sendContent(socket, 200, "text/plain; version=0.0.4", m_metrics->toPrometheus());
+        return;
+    }
+
+    if (m_metrics && request.path == QLatin1String("/metrics.json") && request.method == QLatin1String("GET")) {
+        sendResponse(socket, 200, m_metrics->toJson());
+        return;
+    }
+
+    QJsonObject error;
+    error.insert("error", QLatin1String("not found"));
+    sendResponse(socket, 404, error);
+}
+
+void ControlServer::submitJob(QTcpSocket* socket, const Request& request)
+{
+    QJsonObject error;
+
+    // a form post of a web page can't send JSON without a preflight
+    if (request.headers.value("content-type").split(';').first().trimmed().toLower() != "application/json") {
+        error.insert("error", QLatin1String("content type is not application/json"));
+        sendResponse(socket, 415, error);
+        return;
+    }
+
+    QJsonParseError parseError;
+    const QJsonObject submission = QJsonDocument::fromJson(request.body, &parseError).object();
+
+    if (parseError.error != QJsonParseError::NoError) {
+        error.insert("error", parseError.errorString());
+        sendResponse(socket, 400, error);
+        return;
+    }
+
+    QStringList targets;
+    const QJsonValue targetValue = submission.value("targets");
+
+    if (targetValue.isArray()) {
+        for (const QJsonValue& target : targetValue.toArray()) {
+            if (!target.toString().trimmed().isEmpty()) {
+                targets.append(target.toString().trimmed());
+            }
+        }
+    } else {
+        // a list of hosts separated by spaces or lines
+        targets = targetValue.toString().split(QRegExp("\\s+"), QString::SkipEmptyParts);
+    }
+
+    if (targets.isEmpty()) {
+        error.insert("error", QLatin1String("no targets"));
+        sendResponse(socket, 400, error);
+        return;
+    }
+
+    QString parameters;
+
+    if (submission.contains("parameters")) {
+        parameters = submission.value("parameters").toString();
+
+        QString parameterError;
+        if (!NmapOptions::checkRemoteParameters(parameters.split(' ', QString::SkipEmptyParts), parameterError)) {
+            error.insert("error", parameterError);
+            sendResponse(socket, 400, error);
+            return;
+        }
+    } else {
+        QString profile(submission.value("profile").toString());
+
+        if (profile.isEmpty()) {
+            profile = ScanProfiles::defaultProfiles(m_userId).first().first;
+        }
+
+        if (!ScanProfiles::parameters(profile, m_userId, parameters)) {
+            error.insert("error", QLatin1String("unknown profile: ") + profile);
+            sendResponse(socket, 400, error);
+            return;
+        }
+    }
+
+    // keep the state of the last jobs
+    QMap<int, Job>::iterator i = m_jobs.begin();
+    while (m_jobs.size() >= 1000 && i != m_jobs.end()) {
+        if (i.value().finished + i.value().failed + i.value().rejected == i.value().total) {
+            i = m_jobs.erase(i);
+        } else {
+            ++i;
+        }
+    }
+
+    const int jobId = ++m_jobCounter;
+    Job job;
+    job.total = targets.size();
+    m_jobs.insert(jobId, job);
+
+    QJsonObject body;
+    body.insert("job", jobId);
+    body.insert("targets", targets.size());
+    sendResponse(socket, 202, body);
+
+    emit jobSubmitted(jobId, targets, parameters.split(' ', QString::SkipEmptyParts));
+}
+
+void ControlServer::startEvents(QTcpSocket* socket, const Request& request)
+{
+    const QByteArray key = request.headers.value("sec-websocket-key");
+
+    if (request.headers.value("upgrade").toLower() == "websocket" && !key.isEmpty()) {
+        const QByteArray accept = QCryptographicHash::hash(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11",
+                                  QCryptographicHash::Sha1).toBase64();
+
+        const QByteArray response = "HTTP/1.1 101 Switching Protocols\r\n"
+                                    "Upgrade: websocket\r\n"
+                                    "Connection: Upgrade\r\n"
+                                    "Sec-WebSocket-Accept: " + accept + "\r\n\r\n";
+        socket->write(response);
+        m_eventClients.insert(socket, true);
+    } else {
+        // plain JSON lines until the client closes the connection
+        socket->write("HTTP/1.1 200 OK\r\n"
+                      "Content-Type: application/x-ndjson\r\n"
+                      "Cache-Control: no-cache\r\n"
+                      "Connection: close\r\n\r\n");
+        m_eventClients.insert(socket, false);
+    }
+}
+
+void ControlServer::readWebSocketFrames(QTcpSocket* socket)
+{
+    QByteArray& buffer = m_requestBuffers[socket];
+    buffer.append(socket->readAll());
+
+    while (buffer.size() >= 2) {
+        const quint8 opcode = quint8(buffer[0]) & 0x0F;
+        const bool isMasked = quint8(buffer[1]) & 0x80;
+        quint64 length = quint8(buffer[1]) & 0x7F;
+        int headerSize = 2;
+
+        if (length == 126) {
+            if (buffer.size() < 4) {
+                return;
+            }
+            length = (quint8(buffer[2]) << 8) | quint8(buffer[3]);
+            headerSize = 4;
+        } else if (length == 127) {
+            if (buffer.size() < 10) {
+                return;
+            }
+            length = 0;
+            for (int index = 2; index < 10; ++index) {
+                length = (length << 8) | quint8(buffer[index]);
+            }
+            headerSize = 10;
+        }
+
+        if (length > quint64(maxRequestSize)) {
+            socket->abort();
+            return;
+        }
+
+        const int maskSize = isMasked ? 4 : 0;
+
+        if (quint64(buffer.size()) < headerSize + maskSize + length) {
+            return;
+        }
+
+        QByteArray payload = buffer.mid(headerSize + maskSize, int(length));
+
+        if (isMasked) {
+            const QByteArray mask = buffer.mid(headerSize, 4);
+            for (int index = 0; index < payload.size(); ++index) {
+                payload[index] = payload[index] ^ mask[index % 4];
+            }
+        }
+
+        buffer.remove(0, headerSize + maskSize + int(length));
+
+        if (opcode == 0x8) {
+            // close
+            socket->write(webSocketFrame(0x8, payload.left(2)));
+            socket->disconnectFromHost();
+            return;
+        }
+
+        if (opcode == 0x9) {
+            // ping
+            socket->write(webSocketFrame(0xA, payload));
+        }
+    }
+}
+
+void ControlServer::sendResponse(QTcpSocket* socket, int status, const QJsonObject& body)
+{
+    const QByteArray content = QJsonDocument(body).toJson(QJsonDocument::Compact) + '\n';
+    sendContent(socket, status, "application/json", content);
+}
+
+void ControlServer::sendContent(QTcpSocket* socket, int status, const QByteArray& contentType, const QByteArray& content)
+{
+    const QByteArray response = "HTTP/1.1 " + QByteArray::number(status) + ' ' + statusText(status) + "\r\n"
+                                "Content-Type: " + contentType + "\r\n"
+                                "Content-Length: " + QByteArray::number(content.size()) + "\r\n"
+                                "Connection: close\r\n\r\n" + content;
+
+    socket->write(response);
+    socket->disconnectFromHost();
+}
+
+void ControlServer::sendEvent(const QJsonObject& event)
+{
+    if (m_eventClients.isEmpty()) {
+        return;
+    }
+
+    const QByteArray line = QJsonDocument(event).toJson(QJsonDocument::Compact);
+    const QByteArray frame = webSocketFrame(0x1, line);
+
+    QList<QTcpSocket*> slowClients;
+
+    QHash<QTcpSocket*, bool>::const_iterator i;
+    for (i = m_eventClients.constBegin(); i != m_eventClients.constEnd(); ++i) {
+        if (i.key()->bytesToWrite() > maxEventBacklog) {
+            slowClients.append(i.key());
+        } else if (i.value()) {
+            i.key()->write(frame);
+        } else {
+            i.key()->write(QByteArray(line + '\n'));
+        }
+    }
+
+    // abort() can remove the client from the hash
+    for (QTcpSocket* socket : slowClients) {
+        qWarning("ControlServer:: event client too slow, disconnected");
+        m_eventClients.remove(socket);
+        socket->abort();
+    }
+}
+
+QByteArray ControlServer::webSocketFrame(quint8 opcode, const QByteArray& payload)
+{
+    QByteArray frame;
+    frame.append(char(0x80 | opcode));
+
+    if (payload.size() < 126) {
+        frame.append(char(payload.size()));
+    } else if (payload.size() < 65536) {
+        frame.append(char(126));
+        frame.append(char((payload.size() >> 8) & 0xFF));
+        frame.append(char(payload.size() & 0xFF));
+    } else {
+        frame.append(char(127));
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            frame.append(char((quint64(payload.size()) >> shift) & 0xFF));
+        }
+    }
+
+    frame.append(payload);
+    return frame;
+}
+
+QByteArray ControlServer::statusText(int status)
+{
+    switch (status) {
+    case 200:
+        return "OK";
+    case 202:
+        return "Accepted";
+    case 400:
+        return "Bad Request";
+    case 401:
+        return "Unauthorized";
+    case 403:
+        return "Forbidden";
+    case 415:
+        return "Unsupported Media Type";
+    default:
+        return "Not Found";
+    }
+}
@@ -0,0 +1,145 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CONTROLSERVER_H
+#define CONTROLSERVER_H
+
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QHash>
+#include <QtCore/QMap>
+#include <QtCore/QByteArray>
+#include <QtCore/QJsonObject>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QTcpSocket>
+
+#include "scanmetrics.h"
+
+class ControlServer : public QObject
+{
+    /*!
+     * Loopback HTTP server to queue scans from other programs.
+     *
+     * POST /jobs           {"targets": [...], "profile": name} or {"targets", "parameters"}
+     * GET /jobs            state of every job
+     * GET /jobs/<id>       state of a job
+     * DELETE /jobs/<id>    cancel the hosts of a job
+     * GET /events          progress and results as JSON lines, over
+     *                      WebSocket or over a plain HTTP response
+     * GET /metrics         scan metrics as Prometheus text
+     * GET /metrics.json    scan metrics as JSON
+     *
+     * The scans are run by the owner: it reads jobSubmitted and
+     * reports every host with the host methods.
+     *
+     * Every request needs "Authorization: Bearer <token>", the token is
+     * written at listen() in a file readable only by the user. Requests
+     * with an Origin header or with a Host other than the loopback
+     * port are refused, the web pages of a browser can't reach the server.
+     */
+    Q_OBJECT
+
+public:
+    explicit ControlServer(QObject* parent = 0);
+    ~ControlServer();
+
+    bool listen(quint16 port);
+    quint16 serverPort() const;
+    QString errorString() const;
+    /*!
+     * File of the token, valid after listen().
+     */
+    QString tokenFileName() const;
+    static QString defaultTokenFileName(quint16 port);
+    /*!
+     * User of the profile parameters, see ScanProfiles.
+     */
+    void setUserId(int userId);
+    /*!
+     * Metrics of the owner, null without metrics.
+     */
+    void setMetrics(const ScanMetrics* metrics);
+
+    void hostQueued(int jobId, const QString& hostName);
+    void hostRejected(int jobId, const QString& hostName, const QString& reason);
+    void hostStarted(int jobId, const QString& hostName);
+    void hostFinished(int jobId, const QString& hostName, const QJsonObject& result);
+    void hostFailed(int jobId, const QString& hostName, const QString& error);
+
+    static const int maxRequestSize = 16 * 1024 * 1024;
+    // a slower event client is disconnected
+    static const int maxEventBacklog = 8 * 1024 * 1024;
+
+signals:
+    void jobSubmitted(int jobId, const QStringList& targets, const QStringList& parameters);
+    void jobCanceled(int jobId);
+
+private:
+    struct Job {
+        Job() : total(0), finished(0), failed(0), rejected(0), isCanceled(false) {};
+
+        int total;
+        int finished;
+        int failed;
+        int rejected;
+        bool isCanceled;
+    };
+
+    struct Request {
+        QString method;
+        QString path;
+        QHash<QByteArray, QByteArray> headers;
+        QByteArray body;
+    };
+
+    QTcpServer* m_server;
+    QHash<QTcpSocket*, QByteArray> m_requestBuffers;
+    // event clients, true for WebSocket clients
+    QHash<QTcpSocket*, bool> m_eventClients;
+    QMap<int, Job> m_jobs;
+    int m_jobCounter;
+    int m_userId;
+    const ScanMetrics* m_metrics;
+    QByteArray m_token;
+    QString m_tokenFileName;
+    QString m_errorString;
+
+    bool writeToken(const QString& fileName);
+    bool readRequest(QByteArray& buffer, Request& request, bool& isComplete) const;
+    bool isLocalRequest(const Request& request) const;
+    bool isAuthorized(const Request& request) const;
+    void handleRequest(QTcpSocket* socket, const Request& request);
+    void submitJob(QTcpSocket* socket, const Request& request);
+    void startEvents(QTcpSocket* socket, const Request& request);
+    void readWebSocketFrames(QTcpSocket* socket);
+    void sendResponse(QTcpSocket* socket, int status, const QJsonObject& body);
+    void sendContent(QTcpSocket* socket, int status, const QByteArray& contentType, const QByteArray& content);
+    void sendEvent(const QJsonObject& event);
+    void updateJob(int jobId);
+    QJsonObject jobToJson(int jobId) const;
+
+    static QByteArray webSocketFrame(quint8 opcode, const QByteArray& payload);
+    static QByteArray statusText(int status);
+
+private slots:
+    void newConnection();
+    void readClient();
+    void clientDisconnected();
+};
+
+#endif // CONTROLSERVER_H
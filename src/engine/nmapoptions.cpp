@@ -0,0 +1,321 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "nmapoptions.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QRegExp>
+
+namespace
+{
+const NmapOptions::Option optionTable[] = {
+    // target specification
+    { "-iL", NmapOptions::RequiredArgument, NmapOptions::FileOption },
+    { "-iR", NmapOptions::RequiredArgument, NmapOptions::NoFlag },
+    { "--exclude", NmapOptions::RequiredArgument, NmapOptions::NoFlag },
+    { "--excludefile", NmapOptions::RequiredArgument, NmapOptions::FileOption },
+    // host discovery
+    { "-sL", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    { "-sP", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    { "-sn", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    { "-Pn", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    { "-PS", NmapOptions::AttachedArgument, NmapOptions::NoFlag },
+    { "-PA", NmapOptions::AttachedArgument, NmapOptions::NoFlag },
+    { "-PU", NmapOptions::AttachedArgument, NmapOptions::RootOption },
+    { "-PY", NmapOptions::AttachedArgument, NmapOptions::RootOption },
+    { "-PO", NmapOptions::AttachedArgument, NmapOptions::RootOption },
+    { "-PE", NmapOptions::NoArgument, NmapOptions::RootOption },
+    { "-PP", NmapOptions::NoArgument, NmapOptions::RootOption },
+    { "-PM", NmapOptions::NoArgument, NmapOptions::RootOption },
+    { "-n", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    { "-R", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    { "--dns-servers", NmapOptions::RequiredArgument, NmapOptions::NoFlag },
+    { "--system-dns", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    { "--traceroute", NmapOptions::NoArgument, NmapOptions::RootOption },
+    // scan techniques
+    { "-sS", NmapOptions::NoArgument, NmapOptions::RootOption },
+    { "-sT", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    { "-sA", NmapOptions::NoArgument, NmapOptions::RootOption },
+    { "-sW", NmapOptions::NoArgument, NmapOptions::RootOption },
+    { "-sM", NmapOptions::NoArgument, NmapOptions::RootOption },
+    { "-sU", NmapOptions::NoArgument, NmapOptions::RootOption },
+    { "-sN", NmapOptions::NoArgument, NmapOptions::RootOption },
+    { "-sF", NmapOptions::NoArgument, NmapOptions::RootOption },
+    { "-sX", NmapOptions::NoArgument, NmapOptions::RootOption },
+    { "-sY", NmapOptions::NoArgument, NmapOptions::RootOption },
+    { "-sZ", NmapOptions::NoArgument, NmapOptions::RootOption },
+    { "-sO", NmapOptions::NoArgument, NmapOptions::RootOption },
+    { "-sI", NmapOptions::RequiredArgument, NmapOptions::RootOption },
+    { "-b", NmapOptions::RequiredArgument, NmapOptions::NoFlag },
+    // ports
+    { "-p-", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    { "-p", NmapOptions::RequiredArgument, NmapOptions::NoFlag },
+    { "-F", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    { "-r", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    { "--top-ports", NmapOptions::RequiredArgument, NmapOptions::NoFlag },
+    // services, os and scripts
+    { "-sV", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    { "--version-intensity", NmapOptions::RequiredArgument, NmapOptions::NoFlag },
+    { "-sC", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    { "--script", NmapOptions::RequiredArgument, NmapOptions::NoFlag },
+    { "--script-args", NmapOptions::RequiredArgument, NmapOptions::NoFlag },
+    { "--script-args-file", NmapOptions::RequiredArgument, NmapOptions::FileOption },
+    { "-O", NmapOptions::NoArgument, NmapOptions::RootOption },
+    { "-A", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    // timing
+    { "-T0", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    { "-T1", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    { "-T2", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    { "-T3", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    { "-T4", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    { "-T5", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    { "-T", NmapOptions::RequiredArgument, NmapOptions::NoFlag },
+    { "--min-parallelism", NmapOptions::RequiredArgument, NmapOptions::NoFlag },
+    { "--max-parallelism", NmapOptions::RequiredArgument, NmapOptions::NoFlag },
+    { "--min-rtt-timeout", NmapOptions::RequiredArgument, NmapOptions::NoFlag },
+    { "--max-rtt-timeout", NmapOptions::RequiredArgument, NmapOptions::NoFlag },
+    { "--initial-rtt-timeout", NmapOptions::RequiredArgument, NmapOptions::NoFlag },
+    { "--max-retries", NmapOptions::RequiredArgument, NmapOptions::NoFlag },
+    { "--host-timeout", NmapOptions::RequiredArgument, NmapOptions::NoFlag },
+    { "--scan-delay", NmapOptions::RequiredArgument, NmapOptions::NoFlag },
+    { "--max-scan-delay", NmapOptions::RequiredArgument, NmapOptions::NoFlag },
+    { "--min-rate", NmapOptions::RequiredArgument, NmapOptions::NoFlag },
+    { "--max-rate", NmapOptions::RequiredArgument, NmapOptions::NoFlag },
+    // evasion and spoofing
+    { "-f", NmapOptions::NoArgument, NmapOptions::RootOption },
+    { "--mtu", NmapOptions::RequiredArgument, NmapOptions::RootOption },
+    { "-D", NmapOptions::RequiredArgument, NmapOptions::RootOption },
+    { "-S", NmapOptions::RequiredArgument, NmapOptions::RootOption },
+    { "-e", NmapOptions::RequiredArgument, NmapOptions::NoFlag },
+    { "-g", NmapOptions::RequiredArgument, NmapOptions::RootOption },
+    { "--source-port", NmapOptions::RequiredArgument, NmapOptions::RootOption },
+    { "--data-length", NmapOptions::RequiredArgument, NmapOptions::NoFlag },
+    { "--ttl", NmapOptions::RequiredArgument, NmapOptions::RootOption },
+    { "--spoof-mac", NmapOptions::RequiredArgument, NmapOptions::RootOption },
+    { "--badsum", NmapOptions::NoArgument, NmapOptions::RootOption },
+    // output
+    { "-oN", NmapOptions::RequiredArgument, NmapOptions::FileOption },
+    { "-oX", NmapOptions::RequiredArgument, NmapOptions::UnsupportedOption | NmapOptions::FileOption },
+    { "-oS", NmapOptions::RequiredArgument, NmapOptions::UnsupportedOption | NmapOptions::FileOption },
+    { "-oG", NmapOptions::RequiredArgument, NmapOptions::UnsupportedOption | NmapOptions::FileOption },
+    { "-oA", NmapOptions::RequiredArgument, NmapOptions::UnsupportedOption | NmapOptions::FileOption },
+    { "-v", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    { "-vv", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    { "-d", NmapOptions::AttachedArgument, NmapOptions::NoFlag },
+    { "--reason", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    { "--open", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    { "--packet-trace", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    { "--stats-every", NmapOptions::RequiredArgument, NmapOptions::NoFlag },
+    // misc
+    { "-6", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    { "--datadir", NmapOptions::RequiredArgument, NmapOptions::FileOption },
+    { "--resume", NmapOptions::RequiredArgument, NmapOptions::FileOption },
+    { "--send-eth", NmapOptions::NoArgument, NmapOptions::RootOption },
+    { "--send-ip", NmapOptions::NoArgument, NmapOptions::RootOption },
+    { "--privileged", NmapOptions::NoArgument, NmapOptions::NoFlag },
+    { "--unprivileged", NmapOptions::NoArgument, NmapOptions::NoFlag }
+};
+
+const int optionTableSize = sizeof(optionTable) / sizeof(optionTable[0]);
+
+QHash<QString, const NmapOptions::Option*> buildOptionIndex()
+{
+    QHash<QString, const NmapOptions::Option*> index;
+    index.reserve(optionTableSize);
+
+    for (int i = 0; i < optionTableSize; ++i) {
+        index.insert(QLatin1String(optionTable[i].name), &optionTable[i]);
+    }
+
+    return index;
+}
+
+const QHash<QString, const NmapOptions::Option*>& optionIndex()
+{
+    // built once at the first call
+    static const QHash<QString, const NmapOptions::Option*> index = buildOptionIndex();
+    return index;
+}
+}
+
+const NmapOptions::Option* NmapOptions::find(const QString& name)
+{
+    return optionIndex().value(name, 0);
+}
+
+QList<NmapOptions::Token> NmapOptions::tokenize(const QStringList& parameters)
+{
+    QList<Token> tokens;
+    tokens.reserve(parameters.size());
+
+    for (int index = 0; index < parameters.size(); ++index) {
+        const QString& parameter = parameters[index];
+
+        if (parameter.isEmpty()) {
+            continue;
+        }
+
+        Token token;
+        token.option = 0;
+        token.name = parameter;
+        token.format = SeparateValue;
+
+        if (parameter.size() > 1 && parameter.startsWith(QLatin1Char('-'))) {
+            token.option = find(parameter);
+
+            if (!token.option && parameter.startsWith(QLatin1String("--"))) {
+                // --name=value
+                const int separator = parameter.indexOf(QLatin1Char('='));
+                if (separator != -1) {
+                    token.option = find(parameter.left(separator));
+                    if (token.option) {
+                        token.name = parameter.left(separator);
+                        token.value = parameter.mid(separator + 1);
+                        token.format = EqualsValue;
+                    }
+                }
+            } else if (!token.option) {
+                // value attached to a short option: -PS22,80, -p80, -d2
+                for (int size = qMin(3, parameter.size() - 1); size >= 2 && !token.option; --size) {
+                    const Option* option = find(parameter.left(size));
+                    if (option && option->argument != NoArgument) {
+                        token.option = option;
+                        token.name = parameter.left(size);
+                        token.value = parameter.mid(size);
+                        token.format = AttachedValue;
+                    }
+                }
+            } else if (token.option->argument == RequiredArgument && index + 1 < parameters.size()) {
+                token.value = parameters[++index];
+            }
+        }
+
+        tokens.append(token);
+    }
+
+    return tokens;
+}
+
+QStringList NmapOptions::parameters(const QList<Token>& tokens)
+{
+    QStringList parameterList;
+
+    for (const Token& token : tokens) {
+        if (!token.option || token.value.isEmpty()) {
+            parameterList.append(token.name);
+        } else if (token.format == EqualsValue) {
+            parameterList.append(QString(token.name + QLatin1Char('=') + token.value));
+        } else if (token.format == AttachedValue) {
+            parameterList.append(QString(token.name + token.value));
+        } else {
+            parameterList.append(token.name);
+            parameterList.append(token.value);
+        }
+    }
+
+    return parameterList;
+}
+
+bool NmapOptions::contains(const QStringList& parameters, const QString& optionName)
+{
+    for (const Token& token : tokenize(parameters)) {
+        if (token.option && token.name == optionName) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+QStringList NmapOptions::rootOptions(const QStringList& parameters)
+{
+    QStringList options;
+
+    for (const Token& token : tokenize(parameters)) {
+        if (token.option && (token.option->flags & RootOption) && !options.contains(token.name)) {
+            options.append(token.name);
+        }
+    }
+
+    return options;
+}
+
+bool NmapOptions::removeUnsupportedOptions(QStringList& parameters)
+{
+    QList<Token> tokens(tokenize(parameters));
+    bool isChanged = false;
+
+    for (int index = tokens.size() - 1; index >= 0; --index) {
+        if (tokens[index].option && (tokens[index].option->flags & UnsupportedOption)) {
+            tokens.removeAt(index);
+            isChanged = true;
+        }
+    }
+
+    if (isChanged) {
+        parameters = NmapOptions::parameters(tokens);
+    }
+
+    return isChanged;
+}
+
+QStringList NmapOptions::fileOptions(const QStringList& parameters)
+{
+    // names, categories and expressions, everything else can be a file or a directory
+    const QRegExp scriptNames("[A-Za-z0-9_*(), -]+");
+    QStringList options;
+
+    for (const Token& token : tokenize(parameters)) {
+        if (!token.option) {
+            continue;
+        }
+
+        bool isFile = token.option->flags & FileOption;
+
+        if (token.name == QLatin1String("--script")) {
+            isFile = !scriptNames.exactMatch(token.value);
+        } else if (token.name == QLatin1String("--script-args")) {
+            isFile = token.value.contains(QLatin1Char('/')) || token.value.contains(QLatin1Char('\\'));
+        }
+
+        if (isFile && !options.contains(token.name)) {
+            options.append(token.name);
+        }
+    }
+
+    return options;
+}
+
+bool NmapOptions::checkRemoteParameters(const QStringList& parameters, QString& error)
+{
+    // targets come only from the target list
+    for (const Token& token : tokenize(parameters)) {
+        if (!token.option) {
+            error = QLatin1String("unknown option: ") + token.name;
+            return false;
+        }
+    }
+
+    const QStringList options = fileOptions(parameters);
+
+    if (!options.isEmpty()) {
+        error = QLatin1String("options with local files are not allowed: ") + options.join(' ');
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,106 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef NMAPOPTIONS_H
+#define NMAPOPTIONS_H
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QList>
+
+class NmapOptions
+{
+    /*!
+     * Grammar of the nmap options: argument and privileges of every
+     * option, from a static table indexed once by name.
+     */
+
+public:
+    enum ArgumentType {
+        // -sS, --traceroute
+        NoArgument,
+        // -p 80, -p80, --script=default or --script default
+        RequiredArgument,
+        // -PS, -PS22,80 or -d2, only attached
+        AttachedArgument
+    };
+
+    enum OptionFlag {
+        NoFlag = 0x0,
+        // raw packets, nmap quits or skips it without root privileges
+        RootOption = 0x1,
+        // the output is read from stdout, file formats are removed
+        UnsupportedOption = 0x2,
+        // reads or writes local files
+        FileOption = 0x4
+    };
+
+    struct Option {
+        const char* name;
+        ArgumentType argument;
+        int flags;
+    };
+
+    enum ValueFormat {
+        // -p 80
+        SeparateValue,
+        // -p80
+        AttachedValue,
+        // --script=default
+        EqualsValue
+    };
+
+    struct Token {
+        // null for targets and unknown options
+        const Option* option;
+        QString name;
+        QString value;
+        ValueFormat format;
+    };
+
+    /*!
+     * Split a command line in options with their values in one pass.
+     */
+    static QList<Token> tokenize(const QStringList& parameters);
+    /*!
+     * Command line of the tokens, values keep their format.
+     */
+    static QStringList parameters(const QList<Token>& tokens);
+    static const Option* find(const QString& name);
+    static bool contains(const QStringList& parameters, const QString& optionName);
+    /*!
+     * Options that need root privileges.
+     */
+    static QStringList rootOptions(const QStringList& parameters);
+    /*!
+     * Remove the unsupported options with their values,
+     * return true if parameters are changed.
+     */
+    static bool removeUnsupportedOptions(QStringList& parameters);
+    /*!
+     * Options that read or write local files, with --script
+     * and --script-args when their values name a path.
+     */
+    static QStringList fileOptions(const QStringList& parameters);
+    /*!
+     * Check the parameters of other programs (D-Bus, control server):
+     * only known options, none with local files.
+     */
+    static bool checkRemoteParameters(const QStringList& parameters, QString& error);
+};
+
+#endif // NMAPOPTIONS_H
@@ -0,0 +1,227 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "scanjournal.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonArray>
+#include <QtCore/QDebug>
+
+ScanJournal::ScanJournal()
+    : m_sequence(0), m_lines(0)
+{
+}
+
+ScanJournal::~ScanJournal()
+{
+    // every line is already flushed
+}
+
+QString ScanJournal::defaultFileName()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+           + QLatin1String("/nmapsi4/scans.journal");
+}
+
+bool ScanJournal::open(const QString& fileName)
+{
+    m_file.close();
+    m_file.setFileName(fileName);
+    m_pendingJobs.clear();
+    m_jobIndex.clear();
+
+    readJournal();
+    // the old events are rewritten as queued jobs
+    compact();
+
+    return m_file.isOpen();
+}
+
+void ScanJournal::readJournal()
+{
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    while (!m_file.atEnd()) {
+        const QByteArray line = m_file.readLine().trimmed();
+        QJsonParseError error;
+        const QJsonObject event = QJsonDocument::fromJson(line, &error).object();
+
+        if (error.error != QJsonParseError::NoError) {
+            // the last line of a crash can be cut
+            continue;
+        }
+
+        const QString host = event.value(QLatin1String("host")).toString();
+        const QString type = event.value(QLatin1String("event")).toString();
+
+        if (host.isEmpty()) {
+            continue;
+        }
+
+        if (type == QLatin1String("queued")) {
+            Job job;
+            job.host = host;
+            job.isStarted = false;
+
+            for (const QJsonValue& parameter : event.value(QLatin1String("parameters")).toArray()) {
+                job.parameters.append(parameter.toString());
+            }
+
+            m_pendingJobs.remove(m_jobIndex.value(host, -1));
+            m_pendingJobs.insert(m_sequence, job);
+            m_jobIndex.insert(host, m_sequence);
+            ++m_sequence;
+        } else if (type == QLatin1String("started") && m_jobIndex.contains(host)) {
+            m_pendingJobs[m_jobIndex.value(host)].isStarted = true;
+        } else if (type == QLatin1String("finished")) {
+            m_pendingJobs.remove(m_jobIndex.value(host, -1));
+            m_jobIndex.remove(host);
+        }
+    }
+
+    m_file.close();
+}
+
+QList<ScanJournal::Job> ScanJournal::pendingJobs() const
+{
+    return m_pendingJobs.values();
+}
+
+int ScanJournal::pendingNumber() const
+{
+    return m_pendingJobs.size();
+}
+
+void ScanJournal::queued(const QString& host, const QStringList& parameters)
+{
+    Job job;
+    job.host = host;
+    job.parameters = parameters;
+    job.isStarted = false;
+
+    m_pendingJobs.remove(m_jobIndex.value(host, -1));
+    m_pendingJobs.insert(m_sequence, job);
+    m_jobIndex.insert(host, m_sequence);
+    ++m_sequence;
+
+    QJsonObject event;
+    event.insert(QLatin1String("event"), QLatin1String("queued"));
+    event.insert(QLatin1String("host"), host);
+    event.insert(QLatin1String("parameters"), QJsonArray::fromStringList(parameters));
+    writeLine(event);
+}
+
+void ScanJournal::started(const QString& host)
+{
+    if (!m_jobIndex.contains(host)) {
+        return;
+    }
+
+    m_pendingJobs[m_jobIndex.value(host)].isStarted = true;
+
+    QJsonObject event;
+    event.insert(QLatin1String("event"), QLatin1String("started"));
+    event.insert(QLatin1String("host"), host);
+    writeLine(event);
+}
+
+void ScanJournal::finished(const QString& host)
+{
+    if (!m_jobIndex.contains(host)) {
+        return;
+    }
+
+    m_pendingJobs.remove(m_jobIndex.take(host));
+
+    QJsonObject event;
+    event.insert(QLatin1String("event"), QLatin1String("finished"));
+    event.insert(QLatin1String("host"), host);
+    writeLine(event);
+
+    if (m_lines > 2 * m_pendingJobs.size() + 1024) {
+        compact();
+    }
+}
+
+void ScanJournal::clear()
+{
+    m_pendingJobs.clear();
+    m_jobIndex.clear();
+
+    if (m_file.isOpen()) {
+        m_file.resize(0);
+    }
+
+    m_lines = 0;
+}
+
+void ScanJournal::writeLine(const QJsonObject& event)
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+
+    m_file.write(QJsonDocument(event).toJson(QJsonDocument::Compact) + '\n');
+    // a crash loses only the unwritten events of the os
+    m_file.flush();
+    ++m_lines;
+}
+
+void ScanJournal::compact()
+{
+    const QString fileName = m_file.fileName();
+    m_file.close();
+
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+    QSaveFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "ScanJournal:: journal not writable " << fileName;
+        return;
+    }
+
+    for (const Job& job : m_pendingJobs) {
+        QJsonObject event;
+        event.insert(QLatin1String("event"), QLatin1String("queued"));
+        event.insert(QLatin1String("host"), job.host);
+        event.insert(QLatin1String("parameters"), QJsonArray::fromStringList(job.parameters));
+        file.write(QJsonDocument(event).toJson(QJsonDocument::Compact) + '\n');
+
+        if (job.isStarted) {
+            QJsonObject startEvent;
+            startEvent.insert(QLatin1String("event"), QLatin1String("started"));
+            startEvent.insert(QLatin1String("host"), job.host);
+            file.write(QJsonDocument(startEvent).toJson(QJsonDocument::Compact) + '\n');
+        }
+    }
+
+    if (!file.commit()) {
+        qWarning() << "ScanJournal:: journal not saved " << fileName;
+    }
+
+    m_lines = m_pendingJobs.size();
+
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "ScanJournal:: journal not writable " << fileName;
+    }
+}
@@ -0,0 +1,83 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCANJOURNAL_H
+#define SCANJOURNAL_H
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QFile>
+#include <QtCore/QJsonObject>
+#include <QtCore/QHash>
+#include <QtCore/QMap>
+#include <QtCore/QList>
+
+class ScanJournal
+{
+    /*!
+     * Queued, started and finished hosts of the monitor as JSON lines,
+     * one line is written and flushed for every change. Hosts without
+     * a finished line are the jobs of an interrupted run, they are
+     * queued again on the next start.
+     */
+
+public:
+    struct Job {
+        QString host;
+        // without the host
+        QStringList parameters;
+        bool isStarted;
+    };
+
+    ScanJournal();
+    ~ScanJournal();
+
+    static QString defaultFileName();
+    /*!
+     * Read the pending jobs of the journal and open it for the new events.
+     */
+    bool open(const QString& fileName = defaultFileName());
+    /*!
+     * Pending jobs in the order of the queue.
+     */
+    QList<Job> pendingJobs() const;
+    int pendingNumber() const;
+
+    void queued(const QString& host, const QStringList& parameters);
+    void started(const QString& host);
+    void finished(const QString& host);
+    /*!
+     * Forget all jobs, the journal file is truncated.
+     */
+    void clear();
+
+private:
+    void readJournal();
+    void writeLine(const QJsonObject& event);
+    /*!
+     * Write only the pending jobs, a long run doesn't grow the file.
+     */
+    void compact();
+
+    QFile m_file;
+    QMap<qint64, Job> m_pendingJobs;
+    QHash<QString, qint64> m_jobIndex;
+    qint64 m_sequence;
+    int m_lines;
+};
+
+#endif // SCANJOURNAL_H
@@ -0,0 +1,327 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "scanmetrics.h"
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QFile>
+
+namespace
+{
+QByteArray labelValue(const QString& value)
+{
+    QByteArray label(value.toUtf8());
+    label.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+    return label;
+}
+
+QByteArray seconds(qint64 msecs)
+{
+    return QByteArray::number(msecs / 1000.0, 'f', 3);
+}
+
+void writeHeader(QByteArray& text, const char* name, const char* type, const char* help)
+{
+    text += QByteArray("# HELP ") + name + ' ' + help + "\n# TYPE " + name + ' ' + type + '\n';
+}
+}
+
+double ScanMetrics::BatchMetrics::hostsPerSecond() const
+{
+    return wallTime > 0 ? hosts * 1000.0 / wallTime : 0.0;
+}
+
+ScanMetrics::ScanMetrics()
+    : m_renderCount(0), m_renderTime(0), m_maxRenderTime(0)
+{
+}
+
+ScanMetrics::~ScanMetrics()
+{
+}
+
+void ScanMetrics::addJob(const JobMetrics& job)
+{
+    m_jobs.prepend(job);
+
+    if (m_jobs.size() > maxJobs) {
+        m_jobs.removeLast();
+    }
+
+    ProfileMetrics& profile = m_profiles[job.profile];
+    profile.jobs++;
+    profile.wallTime += job.process.wallTime;
+    profile.outputBytes += job.process.outputBytes;
+    profile.parseTime += job.parseTime;
+
+    if (job.process.exitCode != 0 || job.process.isCrashed) {
+        profile.failedJobs++;
+    }
+
+    if (job.process.cpuTime > 0) {
+        profile.cpuTime += job.process.cpuTime;
+    }
+
+    profile.peakMemory = qMax(profile.peakMemory, job.process.peakMemory);
+}
+
+void ScanMetrics::addRenderTime(qint64 msecs)
+{
+    m_renderCount++;
+    m_renderTime += msecs;
+    m_maxRenderTime = qMax(m_maxRenderTime, msecs);
+}
+
+void ScanMetrics::startBatch()
+{
+    m_batch = BatchMetrics();
+    m_batch.startMemory = residentMemory();
+    m_batchTimer.start();
+}
+
+void ScanMetrics::addDispatchTime(qint64 msecs)
+{
+    m_batch.hosts++;
+    m_batch.dispatchTime += msecs;
+    m_batch.maxDispatchTime = qMax(m_batch.maxDispatchTime, msecs);
+}
+
+void ScanMetrics::addUpdateTime(qint64 msecs)
+{
+    m_batch.updateCount++;
+    m_batch.updateTime += msecs;
+    m_batch.maxUpdateTime = qMax(m_batch.maxUpdateTime, msecs);
+}
+
+void ScanMetrics::finishBatch()
+{
+    if (!m_batchTimer.isValid()) {
+        return;
+    }
+
+    m_batch.wallTime = m_batchTimer.elapsed();
+    m_batch.endMemory = residentMemory();
+    m_lastBatch = m_batch;
+    m_batchTimer.invalidate();
+}
+
+bool ScanMetrics::isBatchRunning() const
+{
+    return m_batchTimer.isValid();
+}
+
+const ScanMetrics::BatchMetrics& ScanMetrics::lastBatch() const
+{
+    return m_lastBatch;
+}
+
+void ScanMetrics::clear()
+{
+    m_jobs.clear();
+    m_profiles.clear();
+    m_renderCount = 0;
+    m_renderTime = 0;
+    m_maxRenderTime = 0;
+    m_lastBatch = BatchMetrics();
+}
+
+const QList<ScanMetrics::JobMetrics>& ScanMetrics::jobs() const
+{
+    return m_jobs;
+}
+
+const QHash<QString, ScanMetrics::ProfileMetrics>& ScanMetrics::profiles() const
+{
+    return m_profiles;
+}
+
+int ScanMetrics::renderCount() const
+{
+    return m_renderCount;
+}
+
+qint64 ScanMetrics::renderTime() const
+{
+    return m_renderTime;
+}
+
+qint64 ScanMetrics::maxRenderTime() const
+{
+    return m_maxRenderTime;
+}
+
+QByteArray ScanMetrics::toPrometheus() const
+{
+    QByteArray text;
+    QHash<QString, ProfileMetrics>::const_iterator i;
+
+    writeHeader(text, "nmapsi4_scans_total", "counter", "Finished scans by profile.");
+    for (i = m_profiles.constBegin(); i != m_profiles.constEnd(); ++i) {
+        text += "nmapsi4_scans_total{profile=\"" + labelValue(i.key()) + "\"} "
+                + QByteArray::number(i.value().jobs) + '\n';
+    }
+
+    writeHeader(text, "nmapsi4_scans_failed_total", "counter", "Scans with an error exit code or a crash.");
+    for (i = m_profiles.constBegin(); i != m_profiles.constEnd(); ++i) {
+        text += "nmapsi4_scans_failed_total{profile=\"" + labelValue(i.key()) + "\"} "
+                + QByteArray::number(i.value().failedJobs) + '\n';
+    }
+
+    writeHeader(text, "nmapsi4_scan_wall_seconds_total", "counter", "Wall time of the nmap processes.");
+    for (i = m_profiles.constBegin(); i != m_profiles.constEnd(); ++i) {
+        text += "nmapsi4_scan_wall_seconds_total{profile=\"" + labelValue(i.key()) + "\"} "
+                + seconds(i.value().wallTime) + '\n';
+    }
+
+    writeHeader(text, "nmapsi4_scan_cpu_seconds_total", "counter", "User and system time of the nmap processes.");
+    for (i = m_profiles.constBegin(); i != m_profiles.constEnd(); ++i) {
+        text += "nmapsi4_scan_cpu_seconds_total{profile=\"" + labelValue(i.key()) + "\"} "
+                + seconds(i.value().cpuTime) + '\n';
+    }
+
+    writeHeader(text, "nmapsi4_scan_peak_memory_bytes", "gauge", "Max peak resident memory of an nmap process.");
+    for (i = m_profiles.constBegin(); i != m_profiles.constEnd(); ++i) {
+        text += "nmapsi4_scan_peak_memory_bytes{profile=\"" + labelValue(i.key()) + "\"} "
+                + QByteArray::number(qMax(qint64(0), i.value().peakMemory) * 1024) + '\n';
+    }
+
+    writeHeader(text, "nmapsi4_scan_output_bytes_total", "counter", "Standard output of the nmap processes.");
+    for (i = m_profiles.constBegin(); i != m_profiles.constEnd(); ++i) {
+        text += "nmapsi4_scan_output_bytes_total{profile=\"" + labelValue(i.key()) + "\"} "
+                + QByteArray::number(i.value().outputBytes) + '\n';
+    }
+
+    writeHeader(text, "nmapsi4_parse_seconds_total", "counter", "Time to parse the scan output.");
+    for (i = m_profiles.constBegin(); i != m_profiles.constEnd(); ++i) {
+        text += "nmapsi4_parse_seconds_total{profile=\"" + labelValue(i.key()) + "\"} "
+                + seconds(i.value().parseTime) + '\n';
+    }
+
+    writeHeader(text, "nmapsi4_render_seconds", "summary", "Time to show a host in the result view.");
+    text += "nmapsi4_render_seconds_sum " + seconds(m_renderTime) + '\n';
+    text += "nmapsi4_render_seconds_count " + QByteArray::number(m_renderCount) + '\n';
+
+    writeHeader(text, "nmapsi4_render_max_seconds", "gauge", "Slowest time to show a host.");
+    text += "nmapsi4_render_max_seconds " + seconds(m_maxRenderTime) + '\n';
+
+    writeHeader(text, "nmapsi4_batch_hosts", "gauge", "Hosts of the last finished batch.");
+    text += "nmapsi4_batch_hosts " + QByteArray::number(m_lastBatch.hosts) + '\n';
+
+    writeHeader(text, "nmapsi4_batch_wall_seconds", "gauge", "Wall time of the last finished batch.");
+    text += "nmapsi4_batch_wall_seconds " + seconds(m_lastBatch.wallTime) + '\n';
+
+    writeHeader(text, "nmapsi4_batch_hosts_per_second", "gauge", "Throughput of the last finished batch.");
+    text += "nmapsi4_batch_hosts_per_second " + QByteArray::number(m_lastBatch.hostsPerSecond(), 'f', 3) + '\n';
+
+    writeHeader(text, "nmapsi4_batch_dispatch_seconds", "summary", "Time from the queue to the start of a scan.");
+    text += "nmapsi4_batch_dispatch_seconds_sum " + seconds(m_lastBatch.dispatchTime) + '\n';
+    text += "nmapsi4_batch_dispatch_seconds_count " + QByteArray::number(m_lastBatch.hosts) + '\n';
+
+    writeHeader(text, "nmapsi4_batch_update_seconds", "summary", "Time to refresh the monitor view.");
+    text += "nmapsi4_batch_update_seconds_sum " + seconds(m_lastBatch.updateTime) + '\n';
+    text += "nmapsi4_batch_update_seconds_count " + QByteArray::number(m_lastBatch.updateCount) + '\n';
+
+    if (m_lastBatch.startMemory != -1 && m_lastBatch.endMemory != -1) {
+        writeHeader(text, "nmapsi4_batch_memory_growth_bytes", "gauge", "Resident memory growth of the last finished batch.");
+        text += "nmapsi4_batch_memory_growth_bytes "
+                + QByteArray::number((m_lastBatch.endMemory - m_lastBatch.startMemory) * 1024) + '\n';
+    }
+
+    return text;
+}
+
+QJsonObject ScanMetrics::toJson() const
+{
+    QJsonArray profiles;
+
+    QHash<QString, ProfileMetrics>::const_iterator i;
+    for (i = m_profiles.constBegin(); i != m_profiles.constEnd(); ++i) {
+        QJsonObject profile;
+        profile.insert("profile", i.key());
+        profile.insert("jobs", i.value().jobs);
+        profile.insert("failedJobs", i.value().failedJobs);
+        profile.insert("wallTime", i.value().wallTime);
+        profile.insert("cpuTime", i.value().cpuTime);
+        profile.insert("peakMemory", i.value().peakMemory);
+        profile.insert("outputBytes", i.value().outputBytes);
+        profile.insert("parseTime", i.value().parseTime);
+        profiles.append(profile);
+    }
+
+    QJsonArray jobs;
+
+    for (const JobMetrics& job : m_jobs) {
+        QJsonObject jobObject;
+        jobObject.insert("host", job.host);
+        jobObject.insert("profile", job.profile);
+        jobObject.insert("startTime", job.process.startTime);
+        jobObject.insert("wallTime", job.process.wallTime);
+        jobObject.insert("cpuTime", job.process.cpuTime);
+        jobObject.insert("peakMemory", job.process.peakMemory);
+        jobObject.insert("outputBytes", job.process.outputBytes);
+        jobObject.insert("errorBytes", job.process.errorBytes);
+        jobObject.insert("exitCode", job.process.exitCode);
+        jobObject.insert("crashed", job.process.isCrashed);
+        jobObject.insert("parseTime", job.parseTime);
+        jobs.append(jobObject);
+    }
+
+    QJsonObject render;
+    render.insert("count", m_renderCount);
+    render.insert("time", m_renderTime);
+    render.insert("maxTime", m_maxRenderTime);
+
+    QJsonObject batch;
+    batch.insert("hosts", m_lastBatch.hosts);
+    batch.insert("wallTime", m_lastBatch.wallTime);
+    batch.insert("hostsPerSecond", m_lastBatch.hostsPerSecond());
+    batch.insert("dispatchTime", m_lastBatch.dispatchTime);
+    batch.insert("maxDispatchTime", m_lastBatch.maxDispatchTime);
+    batch.insert("updateCount", m_lastBatch.updateCount);
+    batch.insert("updateTime", m_lastBatch.updateTime);
+    batch.insert("maxUpdateTime", m_lastBatch.maxUpdateTime);
+    batch.insert("startMemory", m_lastBatch.startMemory);
+    batch.insert("endMemory", m_lastBatch.endMemory);
+
+    // times in msecs, memory in kB
+    QJsonObject metrics;
+    metrics.insert("profiles", profiles);
+    metrics.insert("jobs", jobs);
+    metrics.insert("render", render);
+    metrics.insert("batch", batch);
+
+    return metrics;
+}
+
+qint64 ScanMetrics::residentMemory()
+{
+#if defined(Q_OS_LINUX)
+    QFile statusFile(QLatin1String("/proc/self/status"));
+
+    if (statusFile.open(QIODevice::ReadOnly)) {
+        while (!statusFile.atEnd()) {
+            const QByteArray line = statusFile.readLine();
+
+            if (line.startsWith("VmRSS:")) {
+                return line.mid(6).simplified().split(' ').value(0).toLongLong();
+            }
+        }
+    }
+#endif
+
+    return -1;
+}
@@ -0,0 +1,136 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCANMETRICS_H
+#define SCANMETRICS_H
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QJsonObject>
+#include <QtCore/QElapsedTimer>
+
+#include "processthread.h"
+
+class ScanMetrics
+{
+    /*!
+     * Resources of the finished scans by host and by profile: process
+     * metrics of nmap, parse time and the render time of the results.
+     * Exported as Prometheus text and JSON.
+     */
+
+public:
+    struct JobMetrics {
+        QString host;
+        // parameters without target and timing options
+        QString profile;
+        ProcessMetrics process;
+        // msecs
+        qint64 parseTime;
+    };
+
+    struct ProfileMetrics {
+        ProfileMetrics()
+            : jobs(0), failedJobs(0), wallTime(0), cpuTime(0), peakMemory(0),
+              outputBytes(0), parseTime(0) {};
+
+        int jobs;
+        int failedJobs;
+        qint64 wallTime;
+        qint64 cpuTime;
+        // max of the jobs
+        qint64 peakMemory;
+        qint64 outputBytes;
+        qint64 parseTime;
+    };
+
+    struct BatchMetrics {
+        BatchMetrics()
+            : hosts(0), wallTime(0), dispatchTime(0), maxDispatchTime(0), updateCount(0),
+              updateTime(0), maxUpdateTime(0), startMemory(-1), endMemory(-1) {};
+
+        double hostsPerSecond() const;
+
+        int hosts;
+        qint64 wallTime;
+        // from the queue to the start of the scan
+        qint64 dispatchTime;
+        qint64 maxDispatchTime;
+        // refresh of the monitor view
+        int updateCount;
+        qint64 updateTime;
+        qint64 maxUpdateTime;
+        // resident memory of nmapsi4 in kB, -1 if unknown
+        qint64 startMemory;
+        qint64 endMemory;
+    };
+
+    ScanMetrics();
+    ~ScanMetrics();
+
+    void addJob(const JobMetrics& job);
+    /*!
+     * Time to show a parsed host in the result view.
+     */
+    void addRenderTime(qint64 msecs);
+    /*!
+     * A batch goes from the first queued host to the end of the queue,
+     * the last finished batch is kept for the load tests.
+     */
+    void startBatch();
+    void addDispatchTime(qint64 msecs);
+    void addUpdateTime(qint64 msecs);
+    void finishBatch();
+    bool isBatchRunning() const;
+    const BatchMetrics& lastBatch() const;
+    void clear();
+
+    /*!
+     * Recent jobs, the first one is the most recent.
+     */
+    const QList<JobMetrics>& jobs() const;
+    const QHash<QString, ProfileMetrics>& profiles() const;
+    int renderCount() const;
+    qint64 renderTime() const;
+    qint64 maxRenderTime() const;
+
+    QByteArray toPrometheus() const;
+    QJsonObject toJson() const;
+
+    /*!
+     * Resident memory of this process in kB, -1 if unknown.
+     */
+    static qint64 residentMemory();
+
+    // recent jobs for the host details
+    static const int maxJobs = 1000;
+
+private:
+    QList<JobMetrics> m_jobs;
+    QHash<QString, ProfileMetrics> m_profiles;
+    int m_renderCount;
+    qint64 m_renderTime;
+    qint64 m_maxRenderTime;
+    BatchMetrics m_batch;
+    BatchMetrics m_lastBatch;
+    QElapsedTimer m_batchTimer;
+};
+
+#endif // SCANMETRICS_H
@@ -0,0 +1,188 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "scanparser.h"
+#include "nseresultparser.h"
+#include "regularexpression.h"
+
+#include <QtCore/QTextStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QRegExp>
+
+bool ScanParser::isHostInfoLine(const QString& line)
+{
+    static const char* const infoStrings[] = {
+        "MAC", "Running", "OS details:", "Aggressive OS guesses:",
+        "OS CPE:", "Device type:", "Uptime:", "Uptime guess:", "TCP Sequence Prediction:",
+        "IPID Sequence Generation:", "IP ID Sequence Generation:", "Service Info:",
+        "Initiating Ping ", "Completed Ping ", "Network Distance:", "Note:",
+        "Nmap done:", "Hosts"
+    };
+
+    for (const char* infoString : infoStrings) {
+        if (line.startsWith(QLatin1String(infoString))) {
+            return true;
+        }
+    }
+
+    return line.startsWith(QLatin1String("Host"))
+           && !line.contains("Host script results:")
+           && !line.contains("Probes");
+}
+
+PObject* ScanParser::parse(const QStringList& parList, const QByteArray& output, const QByteArray& errors)
+{
+    PObject *parserObjectElem = new PObject();
+    QString hostName(parList[parList.size() - 1]);
+    parserObjectElem->setHostName(hostName);
+
+    QRegExp portRx(matchPorts);
+    QRegExp tracerouteRx(matchTraceroute);
+
+    QByteArray outputBuffer(output);
+    QTextStream stream(&outputBuffer);
+    QString tmpBufferLine;
+    QString bufferInfo;
+    // nse output of every port, and of every script
+    QString nseTarget;
+    QHash<QString, QStringList> nseResult;
+    QList<NseScriptResult> nseScripts;
+
+    while (!stream.atEnd()) {
+        tmpBufferLine = stream.readLine();
+
+        if (portRx.indexIn(tmpBufferLine) != -1) {
+            if (tmpBufferLine.contains("open") || tmpBufferLine.contains("filtered")
+                    || tmpBufferLine.contains("unfiltered")) {
+
+                if (tmpBufferLine.contains("open")) {
+                    parserObjectElem->setPortOpen(tmpBufferLine);
+                } else {
+                    parserObjectElem->setPortFiltered(tmpBufferLine);
+                }
+
+            } else {
+                parserObjectElem->setPortClose(tmpBufferLine);
+            }
+
+            // following nse lines are about this port
+            nseTarget = tmpBufferLine;
+        }
+
+        if (tmpBufferLine.startsWith(QLatin1String("Host script results:"))) {
+            nseTarget = tmpBufferLine;
+        }
+
+        // check for specific info
+        if (isHostInfoLine(tmpBufferLine)) {
+            bufferInfo.append(tmpBufferLine);
+            bufferInfo.append("\n");
+        }
+
+        // check for nse subtree service
+        if (tmpBufferLine.startsWith(QLatin1String("|")) && !nseTarget.isEmpty()) {
+            int indent;
+            const QString& nseLine = NseResultParser::cleanLine(tmpBufferLine, indent);
+
+            if (!nseLine.isEmpty()) {
+                nseResult[nseTarget].append(nseLine);
+            }
+
+            QString scriptName;
+            QString scriptValue;
+
+            if (NseResultParser::isScriptHeader(nseLine, indent, scriptName, scriptValue)) {
+                NseScriptResult script;
+                script.scriptName = scriptName;
+                script.target = nseTarget;
+                if (!scriptValue.isEmpty()) {
+                    script.lines.append(scriptValue);
+                }
+                nseScripts.append(script);
+            } else if (!nseScripts.isEmpty() && !nseLine.isEmpty()) {
+                nseScripts.last().lines.append(nseLine);
+            }
+
+            // Save nse vulnerabilies url discovered
+            if ((nseLine.startsWith(QLatin1String("http://"))
+                    || nseLine.startsWith(QLatin1String("https://")))
+                    && !nseLine.contains(hostName)
+                    && !nseLine.contains("localhost")) {
+                parserObjectElem->setVulnDiscoverd(nseLine);
+            }
+        }
+
+        // collect trace route information
+        if ((tracerouteRx.indexIn(tmpBufferLine) != -1) && (!tmpBufferLine.contains("/"))) {
+            if (!tmpBufferLine.isEmpty() && !tmpBufferLine.contains("guessing hop")) {
+                parserObjectElem->setTraceRouteInfo(tmpBufferLine);
+            }
+        }
+
+    } // End first While
+
+    parserObjectElem->setScanDate(QDateTime::currentDateTime().toString("M/d/yyyy - hh:mm:ss"));
+
+    QTextStream bufferInfoStream(&bufferInfo); // Host info
+
+    while (!bufferInfoStream.atEnd()) {
+        parserObjectElem->setHostInfo(bufferInfoStream.readLine());
+    }
+
+    // set validity of parser object
+    if (!bufferInfo.isEmpty()) {
+        parserObjectElem->setValidity(true);
+    } else {
+        parserObjectElem->setValidity(false);
+    }
+
+    // save nse result with QHash
+    parserObjectElem->setNseResult(nseResult);
+    parserObjectElem->setNseScripts(nseScripts);
+
+    QTextStream bufferLogStream(&outputBuffer);
+    QString bufferLogStream_line;
+
+    // check for full log scan
+    while (!bufferLogStream.atEnd()) {
+        bufferLogStream_line = bufferLogStream.readLine();
+        if (!bufferLogStream_line.isEmpty()) {
+            parserObjectElem->setFullScanLog(bufferLogStream_line);
+        }
+    }
+
+    QByteArray errorBuffer(errors);
+    QTextStream bufferErrorStream(&errorBuffer);
+
+    // check for scan error
+    while (!bufferErrorStream.atEnd()) {
+        parserObjectElem->setErrorScan(bufferErrorStream.readLine());
+    }
+
+    return parserObjectElem;
+}
+
+void ScanParser::decodeScripts(PObject* object)
+{
+    QList<NseScriptResult> scripts(object->getNseScripts());
+
+    for (NseScriptResult& script : scripts) {
+        NseResultParser::decode(script);
+    }
+
+    object->setNseScripts(scripts);
+}
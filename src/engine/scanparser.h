@@ -0,0 +1,49 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCANPARSER_H
+#define SCANPARSER_H
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QByteArray>
+
+#include "pobjects.h"
+
+class ScanParser
+{
+    /*!
+     * Parse the nmap output of a host without widgets,
+     * used by the gui parser and by the command line.
+     */
+
+public:
+    /*!
+     * Return a new object of the host, the last parameter is the host name.
+     */
+    static PObject* parse(const QStringList& parList, const QByteArray& output, const QByteArray& errors);
+    /*!
+     * Decode the nse scripts of the object with the registered decoders.
+     */
+    static void decodeScripts(PObject* object);
+    /*!
+     * Return true for the lines saved as host info.
+     */
+    static bool isHostInfoLine(const QString& line);
+};
+
+#endif // SCANPARSER_H
@@ -0,0 +1,153 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "scanprofiles.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QSettings>
+#include <QtCore/QStringList>
+
+QList< QPair<QString, QString> > ScanProfiles::defaultProfiles(int userId)
+{
+    // preload StringList with default static Scan profile
+    QPair<QString, QString> profileModel;
+    QList< QPair<QString, QString> > listProfileModel;
+
+    if (!userId) {
+        profileModel.first = QCoreApplication::translate("ProfileHandler", "Default");
+        profileModel.second = "-sS -sV -O -T4 -v --traceroute";
+        listProfileModel.push_back(profileModel);
+
+        profileModel.first = QCoreApplication::translate("ProfileHandler", "Default, force ipv6");
+        profileModel.second = "-sS -sV -O -T4 -v -6 --traceroute";
+        listProfileModel.push_back(profileModel);
+
+        profileModel.first = QCoreApplication::translate("ProfileHandler", "Default, Aggressive");
+        profileModel.second = "-A -sS -sV -O -T4 -v --traceroute";
+        listProfileModel.push_back(profileModel);
+
+        profileModel.first = QCoreApplication::translate("ProfileHandler", "Default, base nse script");
+        profileModel.second = "--script=default,safe -sS -sV -O -T4 -v --traceroute";
+        listProfileModel.push_back(profileModel);
+
+        profileModel.first = QCoreApplication::translate("ProfileHandler", "Default, base nse script, force ipv6");
+        profileModel.second = "--script=default,safe -sS -sV -O -T4 -v -6 --traceroute";
+        listProfileModel.push_back(profileModel);
+
+        profileModel.first = QCoreApplication::translate("ProfileHandler", "Quick Scan");
+        profileModel.second = "-T4 --traceroute";
+        listProfileModel.push_back(profileModel);
+
+        profileModel.first = QCoreApplication::translate("ProfileHandler", "Intense Scan");
+        profileModel.second = "-T4 -A -v -PE -PS22,25,80 -PA21,23,80,3389 --traceroute";
+        listProfileModel.push_back(profileModel);
+
+        profileModel.first = QCoreApplication::translate("ProfileHandler", "Intense Scan, no ping");
+        profileModel.second = "-T4 -A -v -Pn --traceroute";
+        listProfileModel.push_back(profileModel);
+
+        profileModel.first = QCoreApplication::translate("ProfileHandler", "Intense Scan, all TCP ports");
+        profileModel.second = "-T4 -A -v -PE -PS22,25,80 -PA21,23,80,3389 --traceroute";
+        listProfileModel.push_back(profileModel);
+
+        profileModel.first = QCoreApplication::translate("ProfileHandler", "Intense scan plus UDP");
+        profileModel.second = "-sS -sU -T4 -v --traceroute";
+        listProfileModel.push_back(profileModel);
+
+        profileModel.first = QCoreApplication::translate("ProfileHandler", "Slow comprehensive scan");
+        profileModel.second = "-sS -sU -T4 -v -PE -PP -PS80,443 -PA3389 -PU40125 -PY -g 53 --traceroute";
+        listProfileModel.push_back(profileModel);
+    } else {
+        // for user mode
+        profileModel.first = QCoreApplication::translate("ProfileHandler", "Default");
+        profileModel.second = "-sT -sV -T4 -v";
+        listProfileModel.push_back(profileModel);
+
+        profileModel.first = QCoreApplication::translate("ProfileHandler", "Default, force ipv6");
+        profileModel.second = "-sT -sV -T4 -v -6";
+        listProfileModel.push_back(profileModel);
+
+        profileModel.first = QCoreApplication::translate("ProfileHandler", "Default, Aggressive");
+        profileModel.second = "-A -sT -sV -T4 -v";
+        listProfileModel.push_back(profileModel);
+
+        profileModel.first = QCoreApplication::translate("ProfileHandler", "Default, base nse script");
+        profileModel.second = "--script=default,safe -sT -sV -T4 -v";
+        listProfileModel.push_back(profileModel);
+
+        profileModel.first = QCoreApplication::translate("ProfileHandler", "Default, base nse script, force ipv6");
+        profileModel.second = "--script=default,safe -sT -sV -T4 -v -6";
+        listProfileModel.push_back(profileModel);
+
+        profileModel.first = QCoreApplication::translate("ProfileHandler", "Quick Scan");
+        profileModel.second = "-T4";
+        listProfileModel.push_back(profileModel);
+
+        profileModel.first = QCoreApplication::translate("ProfileHandler", "Intense Scan");
+        profileModel.second = "-T4 -A -v -PS22,25,80 -PA21,23,80,3389";
+        listProfileModel.push_back(profileModel);
+
+        profileModel.first = QCoreApplication::translate("ProfileHandler", "Intense Scan, no ping");
+        profileModel.second = "-T4 -A -v -Pn";
+        listProfileModel.push_back(profileModel);
+
+        profileModel.first = QCoreApplication::translate("ProfileHandler", "Intense Scan, all TCP ports");
+        profileModel.second = "-T4 -A -PS22,25,80 -PA21,23,80,3389 -v";
+        listProfileModel.push_back(profileModel);
+    }
+
+    return listProfileModel;
+}
+
+QList< QPair<QString, QString> > ScanProfiles::savedProfiles(int userId)
+{
+    QSettings settings("nmapsi4", "nmapsi4_bookmark");
+    QStringList parameterList;
+    QStringList nameList;
+
+    // same keys of the profiler bookmarks
+    if (!userId) {
+        parameterList = settings.value("nmapsi4/urlListPar", QStringList()).toStringList();
+        nameList = settings.value("nmapsi4/urlListTimePar", QStringList()).toStringList();
+    } else {
+        parameterList = settings.value("nmapsi4/urlListParUser", QStringList()).toStringList();
+        nameList = settings.value("nmapsi4/urlListTimeParUser", QStringList()).toStringList();
+    }
+
+    QList< QPair<QString, QString> > listProfileModel;
+
+    for (int index = 0; index < parameterList.size() && index < nameList.size(); ++index) {
+        listProfileModel.append(qMakePair(nameList[index], parameterList[index]));
+    }
+
+    return listProfileModel;
+}
+
+bool ScanProfiles::parameters(const QString& profileName, int userId, QString& parameters)
+{
+    QList< QPair<QString, QString> > listProfileModel(defaultProfiles(userId));
+    listProfileModel.append(savedProfiles(userId));
+
+    for (const QPair<QString, QString>& profile : listProfileModel) {
+        if (!profile.first.compare(profileName, Qt::CaseInsensitive)) {
+            parameters = profile.second;
+            return true;
+        }
+    }
+
+    return false;
+}
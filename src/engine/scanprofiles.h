@@ -0,0 +1,48 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCANPROFILES_H
+#define SCANPROFILES_H
+
+#include <QtCore/QString>
+#include <QtCore/QList>
+#include <QtCore/QPair>
+
+class ScanProfiles
+{
+    /*!
+     * Scan profiles as (name, nmap parameters) pairs, read without widgets.
+     */
+
+public:
+    /*!
+     * Built-in profiles, users without root privileges
+     * (userId != 0) get the connect scan profiles.
+     */
+    static QList< QPair<QString, QString> > defaultProfiles(int userId);
+    /*!
+     * Profiles saved by the profiler in the bookmark settings.
+     */
+    static QList< QPair<QString, QString> > savedProfiles(int userId);
+    /*!
+     * Parameters of a default or saved profile, the name is case insensitive.
+     * Return false when the profile is not found.
+     */
+    static bool parameters(const QString& profileName, int userId, QString& parameters);
+};
+
+#endif // SCANPROFILES_H
@@ -0,0 +1,326 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "scanresultcache.h"
+#include "nmapoptions.h"
+#include "targetimporter.h"
+
+#include <QtCore/QDateTime>
+#include <QtNetwork/QHostAddress>
+
+#include <algorithm>
+
+namespace
+{
+bool isIgnoredOption(const QString& name)
+{
+    // timing and monitor options don't change the result
+    return name.startsWith(QLatin1String("-T")) || name == QLatin1String("--min-rate")
+           || name == QLatin1String("--max-rate") || name == QLatin1String("--max-retries")
+           || name == QLatin1String("--host-timeout") || name == QLatin1String("--stats-every")
+           || name.endsWith(QLatin1String("-parallelism")) || name.endsWith(QLatin1String("-rtt-timeout"))
+           || name.endsWith(QLatin1String("scan-delay"));
+}
+
+int readPortLine(const QByteArray& line)
+{
+    // 22/tcp   open  ssh
+    int index = 0;
+    int port = 0;
+
+    while (index < line.size() && index < 6 && line[index] >= '0' && line[index] <= '9') {
+        port = port * 10 + (line[index] - '0');
+        ++index;
+    }
+
+    return (index && index < line.size() && line[index] == '/') ? port : -1;
+}
+}
+
+ScanResultCache::ScanResultCache(int freshnessSeconds)
+    : m_recentHosts(maxHosts), m_freshness(freshnessSeconds)
+{
+}
+
+ScanResultCache::~ScanResultCache()
+{
+}
+
+void ScanResultCache::setFreshness(int seconds)
+{
+    m_freshness = seconds;
+
+    if (!m_freshness) {
+        clear();
+    }
+}
+
+int ScanResultCache::freshness() const
+{
+    return m_freshness;
+}
+
+void ScanResultCache::clear()
+{
+    m_entries.clear();
+    m_recentHosts.clear();
+}
+
+QString ScanResultCache::normalizedTarget(const QString& host)
+{
+    quint32 address;
+
+    if (TargetParser::readIpv4(host, address)) {
+        return TargetParser::ipv4ToString(address);
+    }
+
+    QHostAddress ipv6Address(host);
+
+    if (ipv6Address.protocol() == QAbstractSocket::IPv6Protocol) {
+        return ipv6Address.toString();
+    }
+
+    return host.toLower();
+}
+
+bool ScanResultCache::readPorts(const QString& portList, PortRanges& ports)
+{
+    PortRanges ranges;
+
+    for (const QString& range : portList.split(QLatin1Char(','), QString::SkipEmptyParts)) {
+        // protocol prefixes and service names are compared as options
+        const int separator = range.indexOf(QLatin1Char('-'));
+        bool firstOk = true;
+        bool lastOk = true;
+        int first;
+        int last;
+
+        if (separator == -1) {
+            first = last = range.toInt(&firstOk);
+        } else {
+            first = separator ? range.left(separator).toInt(&firstOk) : 1;
+            last = (separator < range.size() - 1) ? range.mid(separator + 1).toInt(&lastOk) : 65535;
+        }
+
+        if (!firstOk || !lastOk || first < 0 || last > 65535 || first > last) {
+            return false;
+        }
+
+        ranges.append(qMakePair(first, last));
+    }
+
+    // more -p options are merged
+    ranges += ports;
+    std::sort(ranges.begin(), ranges.end());
+
+    PortRanges mergedPorts;
+    for (const QPair<int, int>& range : ranges) {
+        if (!mergedPorts.isEmpty() && range.first <= mergedPorts.last().second + 1) {
+            mergedPorts.last().second = qMax(mergedPorts.last().second, range.second);
+        } else {
+            mergedPorts.append(range);
+        }
+    }
+
+    ports = mergedPorts;
+    return !ports.isEmpty();
+}
+
+QString ScanResultCache::canonicalOptions(const QStringList& parameters, PortRanges& ports)
+{
+    QStringList options;
+
+    for (const NmapOptions::Token& token : NmapOptions::tokenize(parameters)) {
+        if (!token.option) {
+            // targets are left out, unknown options are kept
+            if (TargetParser::classify(token.name) == TargetParser::InvalidTarget) {
+                options.append(token.name);
+            }
+            continue;
+        }
+
+        if (isIgnoredOption(token.name)) {
+            continue;
+        }
+
+        if (token.name == QLatin1String("-p-")) {
+            ports = PortRanges() << qMakePair(1, 65535);
+        } else if (token.name == QLatin1String("-p") && readPorts(token.value, ports)) {
+            continue;
+        } else if (token.value.isEmpty()) {
+            options.append(token.name);
+        } else {
+            options.append(token.name + QLatin1Char('=') + token.value);
+        }
+    }
+
+    options.sort();
+    return options.join(QLatin1Char(' '));
+}
+
+bool ScanResultCache::containsPort(const PortRanges& ports, int port)
+{
+    PortRanges::const_iterator range = std::upper_bound(ports.constBegin(), ports.constEnd(),
+                                       qMakePair(port, 65536));
+
+    if (range == ports.constBegin()) {
+        return false;
+    }
+
+    --range;
+    return port <= range->second;
+}
+
+bool ScanResultCache::containsPorts(const PortRanges& ports, const PortRanges& subset)
+{
+    for (const QPair<int, int>& range : subset) {
+        PortRanges::const_iterator i = std::upper_bound(ports.constBegin(), ports.constEnd(),
+                                       qMakePair(range.first, 65536));
+
+        // ranges are merged, a subset range is inside a single range
+        if (i == ports.constBegin() || (i - 1)->second < range.second) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+QByteArray ScanResultCache::filterPorts(const QByteArray& output, const PortRanges& ports)
+{
+    QByteArray filteredOutput;
+    filteredOutput.reserve(output.size());
+
+    bool skipScripts = false;
+    bool hostScripts = false;
+    int from = 0;
+
+    while (from < output.size()) {
+        int to = output.indexOf('\n', from);
+        to = (to == -1) ? output.size() : to + 1;
+
+        const QByteArray line = QByteArray::fromRawData(output.constData() + from, to - from);
+        from = to;
+
+        if (line.startsWith("Host script results:")) {
+            hostScripts = true;
+        }
+
+        if (!hostScripts) {
+            const int port = readPortLine(line);
+
+            if (port != -1) {
+                skipScripts = !containsPort(ports, port);
+            } else if (!line.startsWith('|')) {
+                skipScripts = false;
+            }
+
+            // the number of filtered ports is not right any more
+            if (skipScripts || line.startsWith("Not shown:")) {
+                continue;
+            }
+        }
+
+        filteredOutput.append(line);
+    }
+
+    return filteredOutput;
+}
+
+void ScanResultCache::insert(const QString& host, const QStringList& parameters,
+                             const QByteArray& output, const QByteArray& errors)
+{
+    if (!m_freshness) {
+        return;
+    }
+
+    const QString target = normalizedTarget(host);
+
+    Entry entry;
+    entry.options = canonicalOptions(parameters, entry.ports);
+    entry.result.output = output;
+    entry.result.errors = errors;
+    entry.result.time = QDateTime::currentMSecsSinceEpoch();
+
+    QList<QString> evictedHosts;
+    m_recentHosts.touch(target, &evictedHosts);
+
+    for (const QString& evictedHost : evictedHosts) {
+        m_entries.remove(evictedHost);
+    }
+
+    QList<Entry>& hostEntries = m_entries[target];
+
+    // a new scan with the same options replaces the old one
+    for (int index = hostEntries.size() - 1; index >= 0; --index) {
+        if (hostEntries[index].options == entry.options && hostEntries[index].ports == entry.ports) {
+            hostEntries.removeAt(index);
+        }
+    }
+
+    hostEntries.prepend(entry);
+
+    if (hostEntries.size() > maxResultsForHost) {
+        hostEntries.removeLast();
+    }
+}
+
+bool ScanResultCache::find(const QString& host, const QStringList& parameters, Result& result)
+{
+    if (!m_freshness) {
+        return false;
+    }
+
+    const QString target = normalizedTarget(host);
+    QHash<QString, QList<Entry> >::iterator i = m_entries.find(target);
+
+    if (i == m_entries.end()) {
+        return false;
+    }
+
+    PortRanges ports;
+    const QString options = canonicalOptions(parameters, ports);
+    const qint64 oldestTime = QDateTime::currentMSecsSinceEpoch() - m_freshness * qint64(1000);
+    QList<Entry>& hostEntries = i.value();
+
+    for (int index = hostEntries.size() - 1; index >= 0; --index) {
+        if (hostEntries[index].result.time < oldestTime) {
+            hostEntries.removeAt(index);
+        }
+    }
+
+    // from the most recent scan
+    for (const Entry& entry : hostEntries) {
+        if (entry.options != options) {
+            continue;
+        }
+
+        if (entry.ports == ports) {
+            result = entry.result;
+            return true;
+        }
+
+        // default ports are compared only with the default ports
+        if (!ports.isEmpty() && !entry.ports.isEmpty() && containsPorts(entry.ports, ports)) {
+            result = entry.result;
+            result.output = filterPorts(entry.result.output, ports);
+            return true;
+        }
+    }
+
+    return false;
+}
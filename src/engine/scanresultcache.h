@@ -0,0 +1,97 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCANRESULTCACHE_H
+#define SCANRESULTCACHE_H
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QVector>
+#include <QtCore/QPair>
+
+#include "lrucache.h"
+
+class ScanResultCache
+{
+    /*!
+     * Output of the recent scans by target and parameters. A scan of
+     * the same target with the same options in the freshness window
+     * reuses the output, a scan of a subset of the ports reuses the
+     * output of an earlier scan of more ports with the other lines.
+     */
+
+public:
+    struct Result {
+        QByteArray output;
+        QByteArray errors;
+        // msecs since epoch
+        qint64 time;
+    };
+
+    explicit ScanResultCache(int freshnessSeconds = 300);
+    ~ScanResultCache();
+
+    void setFreshness(int seconds);
+    int freshness() const;
+    /*!
+     * Store the output of a finished scan, parameters can end with the target.
+     */
+    void insert(const QString& host, const QStringList& parameters, const QByteArray& output, const QByteArray& errors);
+    /*!
+     * Return true with a fresh result for the host and parameters.
+     */
+    bool find(const QString& host, const QStringList& parameters, Result& result);
+    void clear();
+
+    static QString normalizedTarget(const QString& host);
+
+    // hosts and results for every host
+    static const int maxHosts = 256;
+    static const int maxResultsForHost = 8;
+
+private:
+    // sorted and merged port ranges, empty for the default ports
+    typedef QVector< QPair<int, int> > PortRanges;
+
+    struct Entry {
+        QString options;
+        PortRanges ports;
+        Result result;
+    };
+
+    /*!
+     * Sorted options without targets, timing and monitor options.
+     * The -p ranges are returned apart when they can be compared.
+     */
+    static QString canonicalOptions(const QStringList& parameters, PortRanges& ports);
+    static bool readPorts(const QString& portList, PortRanges& ports);
+    static bool containsPort(const PortRanges& ports, int port);
+    static bool containsPorts(const PortRanges& ports, const PortRanges& subset);
+    /*!
+     * Output without the port lines out of ports.
+     */
+    static QByteArray filterPorts(const QByteArray& output, const PortRanges& ports);
+
+    QHash<QString, QList<Entry> > m_entries;
+    LruCache<QString> m_recentHosts;
+    int m_freshness;
+};
+
+#endif // SCANRESULTCACHE_H
@@ -0,0 +1,110 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "scanresultwriter.h"
+
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonArray>
+
+ScanResultWriter::ScanResultWriter(QIODevice* device)
+    : m_device(device), m_fullLog(false)
+{
+}
+
+void ScanResultWriter::setFullLog(bool fullLog)
+{
+    m_fullLog = fullLog;
+}
+
+bool ScanResultWriter::write(PObject* object)
+{
+    QByteArray line(QJsonDocument(toJson(object, m_fullLog)).toJson(QJsonDocument::Compact));
+    line.append('\n');
+
+    return m_device->write(line) == line.size();
+}
+
+QJsonObject ScanResultWriter::toJson(PObject* object, bool fullLog)
+{
+    QJsonObject host;
+    host.insert("host", object->getHostName());
+    host.insert("id", object->getId());
+    host.insert("parameters", object->getParameters());
+    host.insert("date", object->scanDate());
+    host.insert("up", object->getHostInfo().filter("Host is up").size() > 0);
+
+    QJsonArray ports;
+    for (const QString& port : object->getPortOpen()) {
+        ports.append(portToJson(port));
+    }
+    for (const QString& port : object->getPortFiltered()) {
+        ports.append(portToJson(port));
+    }
+    for (const QString& port : object->getPortClose()) {
+        ports.append(portToJson(port));
+    }
+    host.insert("ports", ports);
+
+    host.insert("info", QJsonArray::fromStringList(object->getHostInfo()));
+    host.insert("traceroute", QJsonArray::fromStringList(object->getTraceRouteInfo()));
+
+    QJsonArray scripts;
+    for (const NseScriptResult& script : object->getNseScripts()) {
+        QJsonObject scriptObject;
+        scriptObject.insert("name", script.scriptName);
+        scriptObject.insert("target", script.target);
+        scriptObject.insert("output", QJsonArray::fromStringList(script.lines));
+        if (!script.fields.isEmpty()) {
+            scriptObject.insert("fields", QJsonObject::fromVariantMap(script.fields));
+        }
+        scripts.append(scriptObject);
+    }
+    host.insert("scripts", scripts);
+
+    QJsonArray vulnerabilities;
+    for (const CveMatch& match : object->getCveMatches()) {
+        QJsonObject matchObject;
+        matchObject.insert("cve", match.cveId);
+        matchObject.insert("cvss", match.cvss);
+        matchObject.insert("cpe", match.cpe);
+        matchObject.insert("port", match.port);
+        matchObject.insert("possible", match.isPossible);
+        vulnerabilities.append(matchObject);
+    }
+    host.insert("vulnerabilities", vulnerabilities);
+
+    host.insert("errors", QJsonArray::fromStringList(object->getErrorScan()));
+
+    if (fullLog) {
+        host.insert("log", QJsonArray::fromStringList(object->getFullScanLog()));
+    }
+
+    return host;
+}
+
+QJsonObject ScanResultWriter::portToJson(const QString& portLine)
+{
+    const QStringList details = portLine.split(' ', QString::SkipEmptyParts);
+    QJsonObject port;
+
+    port.insert("port", details.value(0));
+    port.insert("state", details.value(1));
+    port.insert("service", details.value(2));
+    port.insert("version", QStringList(details.mid(3)).join(" "));
+
+    return port;
+}
@@ -0,0 +1,54 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCANRESULTWRITER_H
+#define SCANRESULTWRITER_H
+
+#include <QtCore/QIODevice>
+#include <QtCore/QJsonObject>
+
+#include "pobjects.h"
+
+class ScanResultWriter
+{
+    /*!
+     * Write the parsed hosts as JSON lines,
+     * a compact object for every host.
+     */
+
+public:
+    explicit ScanResultWriter(QIODevice* device);
+    ~ScanResultWriter() {};
+
+    /*!
+     * Add the full nmap output to every host.
+     */
+    void setFullLog(bool fullLog);
+    bool write(PObject* object);
+
+    static QJsonObject toJson(PObject* object, bool fullLog);
+    /*!
+     * Split a nmap port line: "22/tcp open ssh OpenSSH 7.4"
+     */
+    static QJsonObject portToJson(const QString& portLine);
+
+private:
+    QIODevice* m_device;
+    bool m_fullLog;
+};
+
+#endif // SCANRESULTWRITER_H
@@ -0,0 +1,150 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "scanscheduler.h"
+#include "scanparser.h"
+#include "memorytools.h"
+#include "programpaths.h"
+
+ScanScheduler::ScanScheduler(QObject* parent)
+    : QObject(parent), m_programName(ProgramPaths::path("nmap")), m_maxParallelScan(5), m_idCounter(0)
+{
+}
+
+ScanScheduler::~ScanScheduler()
+{
+    stopAll();
+}
+
+bool ScanScheduler::addHost(const QString& hostName, const QStringList& parameters)
+{
+    if (m_hostIdHash.contains(hostName)) {
+        return false;
+    }
+
+    m_hostIdHash.insert(hostName, m_idCounter++);
+    m_queue.append(qMakePair(hostName, parameters));
+    startNextScans();
+
+    return true;
+}
+
+void ScanScheduler::setMaxParallelScan(int maxParallelScan)
+{
+    m_maxParallelScan = qMax(maxParallelScan, 1);
+    startNextScans();
+}
+
+void ScanScheduler::setProgramName(const QString& programName)
+{
+    m_programName = programName;
+}
+
+int ScanScheduler::pendingHosts() const
+{
+    return m_queue.size() + m_scanThreadHash.size();
+}
+
+bool ScanScheduler::cancelHost(const QString& hostName)
+{
+    if (!m_hostIdHash.remove(hostName)) {
+        return false;
+    }
+
+    ProcessThread* thread = m_scanThreadHash.take(hostName);
+
+    if (thread) {
+        // threadEnd is ignored without the thread in the hash
+        thread->quit();
+        thread->wait();
+        delete thread;
+    } else {
+        for (int index = 0; index < m_queue.size(); ++index) {
+            if (m_queue[index].first == hostName) {
+                m_queue.removeAt(index);
+                break;
+            }
+        }
+    }
+
+    startNextScans();
+
+    if (!pendingHosts()) {
+        emit allFinished();
+    }
+
+    return true;
+}
+
+void ScanScheduler::stopAll()
+{
+    m_queue.clear();
+    m_hostIdHash.clear();
+    memory::freemap<QString, ProcessThread*>::itemDeleteAllWithWait(m_scanThreadHash);
+}
+
+void ScanScheduler::startNextScans()
+{
+    while (m_scanThreadHash.size() < m_maxParallelScan && !m_queue.isEmpty()) {
+        const QPair<QString, QStringList> scan = m_queue.takeFirst();
+        QStringList parameters(scan.second);
+        parameters.append(scan.first);
+
+        ProcessThread* thread = new ProcessThread(m_programName, parameters);
+        m_scanThreadHash.insert(scan.first, thread);
+
+        connect(thread, &ProcessThread::threadEnd,
+                this, &ScanScheduler::scanFinished);
+
+        thread->start();
+        emit hostStarted(scan.first);
+    }
+}
+
+void ScanScheduler::scanFinished(const ScanOutput& output)
+{
+    const QString& hostName = output.target();
+    ProcessThread* thread = m_scanThreadHash.value(hostName);
+
+    if (!thread || thread->jobId() != output.jobId()) {
+        // stopped scan
+        return;
+    }
+
+    m_scanThreadHash.remove(hostName);
+
+    thread->wait();
+    thread->deleteLater();
+
+    const int id = m_hostIdHash.take(hostName);
+
+    if (!output.output().size() && output.errors().size()) {
+        // nmap is not started or the parameters are wrong
+        emit hostFailed(hostName, QString::fromLocal8Bit(output.errors()).trimmed());
+    } else {
+        PObject* object = ScanParser::parse(output.parameters(), output.output(), output.errors());
+        object->setParameters(output.parameters().join(" "));
+        object->setId(id);
+        emit hostFinished(object);
+    }
+
+    startNextScans();
+
+    if (!pendingHosts()) {
+        emit allFinished();
+    }
+}
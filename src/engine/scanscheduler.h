@@ -0,0 +1,84 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCANSCHEDULER_H
+#define SCANSCHEDULER_H
+
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QList>
+#include <QtCore/QHash>
+#include <QtCore/QPair>
+#include <QtCore/QPointer>
+
+#include "processthread.h"
+#include "pobjects.h"
+
+class ScanScheduler : public QObject
+{
+    /*!
+     * Queue of host scans without widgets, at most maxParallelScan
+     * nmap processes run together. Every finished host is parsed and
+     * returned with hostFinished, the receiver takes the object.
+     */
+    Q_OBJECT
+
+public:
+    explicit ScanScheduler(QObject* parent = 0);
+    ~ScanScheduler();
+
+    /*!
+     * Add a host to the queue, false when the host is already queued.
+     */
+    bool addHost(const QString& hostName, const QStringList& parameters);
+    void setMaxParallelScan(int maxParallelScan);
+    void setProgramName(const QString& programName);
+    /*!
+     * Number of queued and running hosts.
+     */
+    int pendingHosts() const;
+    /*!
+     * Remove a queued host or stop its scan, false when the host is unknown.
+     */
+    bool cancelHost(const QString& hostName);
+    /*!
+     * Stop the running scans and clear the queue.
+     */
+    void stopAll();
+
+signals:
+    void hostStarted(const QString& hostName);
+    void hostFinished(PObject* object);
+    void hostFailed(const QString& hostName, const QString& error);
+    void allFinished();
+
+private:
+    QList< QPair<QString, QStringList> > m_queue;
+    QHash<QString, ProcessThread*> m_scanThreadHash;
+    QHash<QString, int> m_hostIdHash;
+    QString m_programName;
+    int m_maxParallelScan;
+    int m_idCounter;
+
+    void startNextScans();
+
+private slots:
+    void scanFinished(const ScanOutput& output);
+};
+
+#endif // SCANSCHEDULER_H
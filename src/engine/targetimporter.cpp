@@ -0,0 +1,552 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "targetimporter.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QDebug>
+#include <QtNetwork/QHostAddress>
+
+#include <algorithm>
+
+namespace
+{
+// interruption is checked every block of lines
+const int linesBlockSize = 4096;
+
+bool readNumber(const QString& text, int from, int to, int maxValue, int& value)
+{
+    // at most 3 digits, enough for octets and prefix lengths
+    if (from >= to || to - from > 3) {
+        return false;
+    }
+
+    value = 0;
+    for (int index = from; index < to; ++index) {
+        const ushort digit = text.at(index).unicode();
+        if (digit < '0' || digit > '9') {
+            return false;
+        }
+        value = value * 10 + (digit - '0');
+    }
+
+    return value <= maxValue;
+}
+}
+
+TargetParser::TargetType TargetParser::classify(const QString& token)
+{
+    if (token.isEmpty()) {
+        return InvalidTarget;
+    }
+
+    quint32 first;
+    quint32 last;
+
+    if (token.contains(QLatin1Char(':'))) {
+        QHostAddress address(token);
+        return address.protocol() == QAbstractSocket::IPv6Protocol ? Ipv6Target : InvalidTarget;
+    } else if (readIpv4(token, first)) {
+        return Ipv4Target;
+    } else if (readIpv4Range(token, first, last)) {
+        return Ipv4RangeTarget;
+    } else if (isHostname(token)) {
+        return HostnameTarget;
+    }
+
+    return InvalidTarget;
+}
+
+bool TargetParser::readIpv4(const QString& text, quint32& address)
+{
+    address = 0;
+    int from = 0;
+
+    for (int octet = 0; octet < 4; ++octet) {
+        int to = (octet < 3) ? text.indexOf(QLatin1Char('.'), from) : text.size();
+        int value;
+
+        if (to == -1 || !readNumber(text, from, to, 255, value)) {
+            return false;
+        }
+
+        address = (address << 8) | static_cast<quint32>(value);
+        from = to + 1;
+    }
+
+    return true;
+}
+
+bool TargetParser::readIpv4Range(const QString& text, quint32& first, quint32& last)
+{
+    int separator = text.indexOf(QLatin1Char('/'));
+
+    if (separator != -1) {
+        // cidr block: a.b.c.d/nn
+        int bits;
+        if (!readIpv4(text.left(separator), first)
+                || !readNumber(text, separator + 1, text.size(), 32, bits)) {
+            return false;
+        }
+
+        const quint32 mask = bits ? (0xFFFFFFFFu << (32 - bits)) : 0;
+        first &= mask;
+        last = first | ~mask;
+        return true;
+    }
+
+    separator = text.indexOf(QLatin1Char('-'));
+
+    if (separator == -1 || !readIpv4(text.left(separator), first)) {
+        return false;
+    }
+
+    const QString end = text.mid(separator + 1);
+
+    if (end.contains(QLatin1Char('.'))) {
+        // a.b.c.d-e.f.g.h
+        if (!readIpv4(end, last)) {
+            return false;
+        }
+    } else {
+        // a.b.c.d-e, range of the last octet
+        int value;
+        if (!readNumber(end, 0, end.size(), 255, value)) {
+            return false;
+        }
+        last = (first & 0xFFFFFF00u) | static_cast<quint32>(value);
+    }
+
+    return last >= first;
+}
+
+bool TargetParser::isHostname(const QString& text)
+{
+    if (text.isEmpty() || text.size() > 253) {
+        return false;
+    }
+
+    int labelSize = 0;
+    bool numericLabel = true;
+
+    for (int index = 0; index < text.size(); ++index) {
+        const ushort c = text.at(index).unicode();
+
+        if (c == '.') {
+            if (!labelSize || text.at(index - 1) == QLatin1Char('-')) {
+                return false;
+            }
+            labelSize = 0;
+            numericLabel = true;
+            continue;
+        }
+
+        const bool isDigit = (c >= '0' && c <= '9');
+        const bool isLetter = ((c | 0x20) >= 'a' && (c | 0x20) <= 'z');
+
+        if (!isDigit && !isLetter && c != '-') {
+            return false;
+        }
+
+        if (c == '-' && !labelSize) {
+            return false;
+        }
+
+        numericLabel = numericLabel && isDigit;
+
+        if (++labelSize > 63) {
+            return false;
+        }
+    }
+
+    // the top level label is never numeric (rfc 1123)
+    return labelSize && !numericLabel && !text.endsWith(QLatin1Char('-'));
+}
+
+QString TargetParser::ipv4ToString(quint32 address)
+{
+    return QString::number(address >> 24) + QLatin1Char('.')
+           + QString::number((address >> 16) & 0xFF) + QLatin1Char('.')
+           + QString::number((address >> 8) & 0xFF) + QLatin1Char('.')
+           + QString::number(address & 0xFF);
+}
+
+QString TargetParser::clearTarget(const QString& token)
+{
+    QString target(token);
+    const int scheme = target.indexOf(QLatin1String("://"));
+
+    if (scheme == -1) {
+        if (target.endsWith(QLatin1Char('/'))) {
+            target.chop(1);
+        }
+        return target;
+    }
+
+    // an url: only the host is the target
+    target.remove(0, scheme + 3);
+    const int path = target.indexOf(QLatin1Char('/'));
+    if (path != -1) {
+        target.truncate(path);
+    }
+
+    if (target.startsWith(QLatin1Char('['))) {
+        const int close = target.indexOf(QLatin1Char(']'));
+        return close == -1 ? QString() : target.mid(1, close - 1);
+    }
+
+    const int port = target.indexOf(QLatin1Char(':'));
+    if (port != -1) {
+        target.truncate(port);
+    }
+
+    return target;
+}
+
+TargetImporter::TargetImporter(const QString& fileName, QObject* parent)
+    : QThread(parent),
+      m_fileName(fileName),
+      m_nextTarget(0),
+      m_duplicates(0),
+      m_invalid(0),
+      m_excluded(0),
+      m_isTruncated(false)
+{
+}
+
+TargetImporter::~TargetImporter()
+{
+}
+
+void TargetImporter::run()
+{
+    QFile file(m_fileName);
+
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        emit importFailed(tr("File not readable: ") + m_fileName);
+        return;
+    }
+
+    int lines = 0;
+
+    while (!file.atEnd() && !m_isTruncated) {
+        if (!(++lines % linesBlockSize) && isInterruptionRequested()) {
+            m_targets.clear();
+            return;
+        }
+
+        readLine(QString::fromUtf8(file.readLine()));
+    }
+
+    if (m_isTruncated) {
+        qWarning() << "TargetImporter:: too many targets, list truncated to" << maxTargets;
+    }
+
+    file.close();
+
+    // exclusions are merged for the binary search
+    std::sort(m_excludedRanges.begin(), m_excludedRanges.end());
+    QVector< QPair<quint32, quint32> > mergedRanges;
+
+    for (const QPair<quint32, quint32>& range : m_excludedRanges) {
+        if (!mergedRanges.isEmpty() && range.first <= mergedRanges.last().second
+                + (mergedRanges.last().second < 0xFFFFFFFFu ? 1u : 0u)) {
+            mergedRanges.last().second = qMax(mergedRanges.last().second, range.second);
+        } else {
+            mergedRanges.append(range);
+        }
+    }
+
+    m_excludedRanges = mergedRanges;
+
+    removeExcluded();
+
+    if (isInterruptionRequested()) {
+        m_targets.clear();
+        return;
+    }
+
+    // only the targets are kept until they are queued
+    m_ipv4Set.clear();
+    m_nameSet.clear();
+    m_excludedRanges.clear();
+    m_excludedNames.clear();
+
+    emit importFinished(m_targets.size(), m_duplicates, m_invalid, m_excluded, m_isTruncated);
+}
+
+void TargetImporter::readLine(const QString& line)
+{
+    int end = line.indexOf(QLatin1Char('#'));
+    if (end == -1) {
+        end = line.size();
+    }
+
+    int from = -1;
+
+    for (int index = 0; index <= end; ++index) {
+        const bool isSeparator = (index == end) || line.at(index).isSpace()
+                                 || line.at(index) == QLatin1Char(',');
+
+        if (isSeparator) {
+            if (from != -1) {
+                readToken(line.mid(from, index - from));
+                from = -1;
+            }
+        } else if (from == -1) {
+            from = index;
+        }
+    }
+}
+
+void TargetImporter::readToken(QString token)
+{
+    const bool isExclusion = token.startsWith(QLatin1Char('!'));
+
+    if (isExclusion) {
+        token.remove(0, 1);
+    }
+
+    token = TargetParser::clearTarget(token);
+
+    quint32 first;
+    quint32 last;
+
+    switch (TargetParser::classify(token)) {
+    case TargetParser::Ipv4Target:
+        TargetParser::readIpv4(token, first);
+        if (isExclusion) {
+            m_excludedRanges.append(qMakePair(first, first));
+        } else {
+            addIpv4(first);
+        }
+        break;
+    case TargetParser::Ipv4RangeTarget:
+        TargetParser::readIpv4Range(token, first, last);
+        if (isExclusion) {
+            m_excludedRanges.append(qMakePair(first, last));
+        } else if (static_cast<quint64>(last) - first < maxRangeSize) {
+            for (quint64 address = first; address <= last && !m_isTruncated; ++address) {
+                addIpv4(static_cast<quint32>(address));
+            }
+        } else {
+            // nmap expands it, the exclusions are added later
+            addName(token, first, last);
+        }
+        break;
+    case TargetParser::Ipv6Target:
+        token = QHostAddress(token).toString();
+        if (isExclusion) {
+            m_excludedNames.insert(token);
+        } else {
+            addName(token);
+        }
+        break;
+    case TargetParser::HostnameTarget:
+        token = token.toLower();
+        if (isExclusion) {
+            m_excludedNames.insert(token);
+        } else {
+            addName(token);
+        }
+        break;
+    default:
+        ++m_invalid;
+        break;
+    }
+}
+
+void TargetImporter::addIpv4(quint32 address)
+{
+    if (m_ipv4Set.contains(address)) {
+        ++m_duplicates;
+        return;
+    }
+
+    Target target;
+    target.address = address;
+    target.last = 0;
+
+    if (addTarget(target)) {
+        m_ipv4Set.insert(address);
+    }
+}
+
+void TargetImporter::addName(const QString& name, quint32 first, quint32 last)
+{
+    if (m_nameSet.contains(name)) {
+        ++m_duplicates;
+        return;
+    }
+
+    Target target;
+    target.address = first;
+    target.last = last;
+    target.name = name;
+
+    if (addTarget(target)) {
+        m_nameSet.insert(name);
+    }
+}
+
+bool TargetImporter::addTarget(const Target& target)
+{
+    if (m_targets.size() >= maxTargets) {
+        m_isTruncated = true;
+        return false;
+    }
+
+    m_targets.append(target);
+    return true;
+}
+
+bool TargetImporter::isExcluded(quint32 address) const
+{
+    // first range starting after the address, the previous one can contain it
+    QVector< QPair<quint32, quint32> >::const_iterator range =
+        std::upper_bound(m_excludedRanges.constBegin(), m_excludedRanges.constEnd(),
+                         qMakePair(address, 0xFFFFFFFFu));
+
+    if (range == m_excludedRanges.constBegin()) {
+        return false;
+    }
+
+    --range;
+    return address <= range->second;
+}
+
+QStringList TargetImporter::excludedBlocks(quint32 first, quint32 last) const
+{
+    QStringList blocks;
+    QVector< QPair<quint32, quint32> >::const_iterator range =
+        std::upper_bound(m_excludedRanges.constBegin(), m_excludedRanges.constEnd(),
+                         qMakePair(first, 0xFFFFFFFFu));
+
+    if (range != m_excludedRanges.constBegin() && (range - 1)->second >= first) {
+        --range;
+    }
+
+    for (; range != m_excludedRanges.constEnd() && range->first <= last; ++range) {
+        quint64 from = qMax(range->first, first);
+        const quint64 to = qMin(range->second, last);
+
+        while (from <= to) {
+            // largest aligned block from the address inside the range
+            int prefix = 32;
+            while (prefix > 0) {
+                const quint64 size = Q_UINT64_C(1) << (33 - prefix);
+                if ((from & (size - 1)) || from + size - 1 > to) {
+                    break;
+                }
+                --prefix;
+            }
+
+            blocks.append(QString(TargetParser::ipv4ToString(static_cast<quint32>(from))
+                                  + QLatin1Char('/') + QString::number(prefix)));
+            from += Q_UINT64_C(1) << (32 - prefix);
+        }
+    }
+
+    return blocks;
+}
+
+void TargetImporter::removeExcluded()
+{
+    int kept = 0;
+
+    for (int index = 0; index < m_targets.size(); ++index) {
+        if (!(index % linesBlockSize) && isInterruptionRequested()) {
+            return;
+        }
+
+        const Target target = m_targets.at(index);
+        bool excluded;
+
+        if (target.name.isEmpty()) {
+            excluded = isExcluded(target.address);
+        } else if (target.last) {
+            // merged exclusions, one of them can contain all the range
+            QVector< QPair<quint32, quint32> >::const_iterator range =
+                std::upper_bound(m_excludedRanges.constBegin(), m_excludedRanges.constEnd(),
+                                 qMakePair(target.address, 0xFFFFFFFFu));
+            excluded = range != m_excludedRanges.constBegin() && (range - 1)->second >= target.last;
+
+            if (!excluded) {
+                const QStringList blocks = excludedBlocks(target.address, target.last);
+
+                if (blocks.size() > maxExcludedBlocks) {
+                    // too long for the command line
+                    qWarning() << "TargetImporter:: too many exclusions in" << target.name;
+                    ++m_invalid;
+                    continue;
+                }
+
+                if (!blocks.isEmpty()) {
+                    m_rangeExclusions.insert(target.name, blocks.join(QLatin1Char(',')));
+                }
+            }
+        } else {
+            excluded = m_excludedNames.contains(target.name);
+        }
+
+        if (excluded) {
+            ++m_excluded;
+        } else {
+            m_targets[kept++] = target;
+        }
+    }
+
+    m_targets.resize(kept);
+    m_targets.squeeze();
+}
+
+QStringList TargetImporter::takeTargets(int size, QString& exclude)
+{
+    QStringList targets;
+    exclude.clear();
+
+    while (m_nextTarget < m_targets.size() && targets.size() < size) {
+        const Target& target = m_targets.at(m_nextTarget);
+
+        if (target.last && m_rangeExclusions.contains(target.name)) {
+            // the parameters of the block are the same for every target
+            if (targets.isEmpty()) {
+                exclude = m_rangeExclusions.value(target.name);
+                targets.append(target.name);
+                ++m_nextTarget;
+            }
+            break;
+        }
+
+        targets.append(target.name.isEmpty() ? TargetParser::ipv4ToString(target.address) : target.name);
+        ++m_nextTarget;
+    }
+
+    if (m_nextTarget == m_targets.size()) {
+        m_targets.clear();
+        m_targets.squeeze();
+        m_rangeExclusions.clear();
+        m_nextTarget = 0;
+    }
+
+    return targets;
+}
+
+bool TargetImporter::hasTargets() const
+{
+    return m_nextTarget < m_targets.size();
+}
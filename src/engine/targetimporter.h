@@ -0,0 +1,135 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TARGETIMPORTER_H
+#define TARGETIMPORTER_H
+
+#include <QtCore/QThread>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+#include <QtCore/QPair>
+#include <QtCore/QSet>
+#include <QtCore/QHash>
+
+class TargetParser
+{
+    /*!
+     * Classify scan targets without regular expressions.
+     */
+
+public:
+    enum TargetType {
+        InvalidTarget,
+        Ipv4Target,
+        Ipv4RangeTarget,
+        Ipv6Target,
+        HostnameTarget
+    };
+
+    /*!
+     * Type of "a.b.c.d", "a.b.c.d/nn", "a.b.c.d-e", "a.b.c.d-e.f.g.h",
+     * an ipv6 address or a hostname.
+     */
+    static TargetType classify(const QString& token);
+    static bool readIpv4(const QString& text, quint32& address);
+    /*!
+     * First and last address of a CIDR block or of a range.
+     */
+    static bool readIpv4Range(const QString& text, quint32& first, quint32& last);
+    static bool isHostname(const QString& text);
+    static QString ipv4ToString(quint32 address);
+    /*!
+     * Remove the url scheme and the path: "http://host/" -> "host"
+     */
+    static QString clearTarget(const QString& token);
+};
+
+class TargetImporter : public QThread
+{
+    /*!
+     * Read a target list on a thread. Targets are separated by spaces,
+     * commas or lines, "#" starts a comment and targets starting with
+     * "!" are excluded. Ranges are expanded, the unique targets are
+     * taken in blocks with takeTargets() after the thread is finished,
+     * the monitor is fed only when it needs more hosts.
+     */
+    Q_OBJECT
+
+public:
+    explicit TargetImporter(const QString& fileName, QObject* parent = 0);
+    ~TargetImporter();
+
+    static const int blockSize = 1024;
+    // larger ranges are passed to nmap as a single target
+    static const quint32 maxRangeSize = 65536;
+    static const int maxTargets = 1048576;
+    // CIDR blocks of --exclude for a range, a range with more is invalid
+    static const int maxExcludedBlocks = 4096;
+
+    /*!
+     * Next targets, at most size. A range passed to nmap with its
+     * exclusions is taken alone, exclude is the value of --exclude.
+     * Only after finished().
+     */
+    QStringList takeTargets(int size, QString& exclude);
+    bool hasTargets() const;
+
+signals:
+    void importFinished(int targets, int duplicates, int invalid, int excluded, bool isTruncated);
+    void importFailed(const QString error);
+
+private:
+    struct Target {
+        // ipv4 targets are kept as numbers, the name is empty
+        quint32 address;
+        // last address of a range passed to nmap
+        quint32 last;
+        QString name;
+    };
+
+    QString m_fileName;
+    QVector<Target> m_targets;
+    QSet<quint32> m_ipv4Set;
+    QSet<QString> m_nameSet;
+    QVector< QPair<quint32, quint32> > m_excludedRanges;
+    QSet<QString> m_excludedNames;
+    // --exclude value of the ranges passed to nmap
+    QHash<QString, QString> m_rangeExclusions;
+    int m_nextTarget;
+    int m_duplicates;
+    int m_invalid;
+    int m_excluded;
+    bool m_isTruncated;
+
+    void readLine(const QString& line);
+    void readToken(QString token);
+    void addIpv4(quint32 address);
+    void addName(const QString& name, quint32 first = 0, quint32 last = 0);
+    bool addTarget(const Target& target);
+    bool isExcluded(quint32 address) const;
+    /*!
+     * Excluded parts of a range as CIDR blocks, empty if nothing is excluded.
+     */
+    QStringList excludedBlocks(quint32 first, quint32 last) const;
+    void removeExcluded();
+
+protected:
+    void run();
+};
+
+#endif // TARGETIMPORTER_H
@@ -0,0 +1,401 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "timingadvisor.h"
+#include "nmapoptions.h"
+#include "targetimporter.h"
+
+#include <QtCore/QSettings>
+#include <QtCore/QCryptographicHash>
+#include <QtNetwork/QHostAddress>
+
+#include <cmath>
+#include <cctype>
+
+namespace
+{
+// weight of a new sample in the moving averages
+const double sampleWeight = 0.3;
+// below this latency and drop rate a segment is a lan
+const double lanLatency = 0.005;
+const double lanDropRate = 0.01;
+// above this latency or drop rate a segment is slow
+const double slowLatency = 0.1;
+const double slowDropRate = 0.05;
+const int minHostTimeout = 900;
+
+double readNumber(const QByteArray& line, int from)
+{
+    int to = from;
+    while (to < line.size() && (isdigit(static_cast<unsigned char>(line[to])) || line[to] == '.')) {
+        ++to;
+    }
+
+    return line.mid(from, to - from).toDouble();
+}
+
+// seconds of a nmap time: 900, 900s, 500ms, 15m or 1h, -1 if not valid
+double timeSeconds(const QString& value)
+{
+    QString number(value.trimmed().toLower());
+    double unit = 1.0;
+
+    if (number.endsWith(QLatin1String("ms"))) {
+        unit = 0.001;
+        number.chop(2);
+    } else if (number.endsWith(QLatin1Char('s'))) {
+        number.chop(1);
+    } else if (number.endsWith(QLatin1Char('m'))) {
+        unit = 60.0;
+        number.chop(1);
+    } else if (number.endsWith(QLatin1Char('h'))) {
+        unit = 3600.0;
+        number.chop(1);
+    }
+
+    bool isNumber;
+    const double seconds = number.toDouble(&isNumber);
+
+    return (isNumber && seconds >= 0) ? seconds * unit : -1;
+}
+
+// level of a -T template, -1 for other options
+int templateLevel(const NmapOptions::Token& token)
+{
+    static const char* const names[] = {
+        "paranoid", "sneaky", "polite", "normal", "aggressive", "insane"
+    };
+
+    if (!token.name.startsWith(QLatin1String("-T"))) {
+        return -1;
+    }
+
+    const QString value(token.name.size() > 2 ? token.name.mid(2) : token.value.toLower());
+    bool isNumber;
+    const int level = value.toInt(&isNumber);
+
+    if (isNumber) {
+        return level;
+    }
+
+    for (int index = 0; index < 6; ++index) {
+        if (value == QLatin1String(names[index])) {
+            return index;
+        }
+    }
+
+    return -1;
+}
+
+// second level labels of the country code domains: example.co.uk
+bool isSecondLevelSuffix(const QString& label)
+{
+    return label == QLatin1String("co") || label == QLatin1String("com")
+           || label == QLatin1String("net") || label == QLatin1String("org")
+           || label == QLatin1String("gov") || label == QLatin1String("edu")
+           || label == QLatin1String("ac") || label == QLatin1String("ne")
+           || label == QLatin1String("or");
+}
+
+bool isTimingOption(const QString& name)
+{
+    return name.startsWith(QLatin1String("-T")) || name == QLatin1String("--min-rate")
+           || name == QLatin1String("--max-retries") || name == QLatin1String("--host-timeout")
+           || name == QLatin1String("--stats-every");
+}
+}
+
+TimingAdvisor::TimingAdvisor()
+{
+}
+
+TimingAdvisor::~TimingAdvisor()
+{
+    save();
+}
+
+TimingAdvisor::TimingSample TimingAdvisor::readSample(const QByteArray& output, double measuredDuration)
+{
+    TimingSample sample;
+    sample.latency = -1.0;
+    sample.dropRate = 0.0;
+    sample.duration = measuredDuration;
+    sample.timedOut = false;
+
+    double droppedProbes = 0;
+    double sentProbes = 0;
+    int cappedPorts = 0;
+    int from = 0;
+
+    while (from < output.size()) {
+        int to = output.indexOf('\n', from);
+        if (to == -1) {
+            to = output.size();
+        }
+
+        const QByteArray line = QByteArray::fromRawData(output.constData() + from, to - from);
+        from = to + 1;
+
+        int index;
+
+        if (line.startsWith("Host is up (")) {
+            // Host is up (0.00041s latency).
+            sample.latency = readNumber(line, 12);
+        } else if (line.startsWith("Nmap done:") && (index = line.indexOf(" scanned in ")) != -1) {
+            sample.duration = readNumber(line, index + 12);
+        } else if ((index = line.indexOf(" due to ")) != -1 && line.contains("dropped probes")) {
+            // Increasing send delay ... due to 11 out of 34 dropped probes since last increase.
+            droppedProbes += readNumber(line, index + 8);
+            const int total = line.indexOf(" out of ", index);
+            if (total != -1) {
+                sentProbes += readNumber(line, total + 8);
+            }
+        } else if (line.contains("retransmission cap hit")) {
+            ++cappedPorts;
+        } else if (line.contains("due to host timeout")) {
+            sample.timedOut = true;
+        }
+    }
+
+    if (sentProbes > 0) {
+        sample.dropRate = droppedProbes / sentProbes;
+    }
+
+    if (cappedPorts) {
+        // probes lost after all retries
+        sample.dropRate = qMax(sample.dropRate, slowDropRate);
+    }
+
+    return sample;
+}
+
+QString TimingAdvisor::segment(const QString& host)
+{
+    quint32 address;
+
+    if (TargetParser::readIpv4(host, address)) {
+        return TargetParser::ipv4ToString(address & 0xFFFFFF00u) + QLatin1String("/24");
+    }
+
+    QHostAddress ipv6Address(host);
+
+    if (ipv6Address.protocol() == QAbstractSocket::IPv6Protocol) {
+        Q_IPV6ADDR bytes = ipv6Address.toIPv6Address();
+        for (int index = 8; index < 16; ++index) {
+            bytes[index] = 0;
+        }
+        return QHostAddress(bytes).toString() + QLatin1String("/64");
+    }
+
+    // hosts of a registrable domain share the network, a shorter name is a single host
+    const QStringList labels = host.toLower().split(QLatin1Char('.'), QString::SkipEmptyParts);
+    int domainLabels = 2;
+
+    if (labels.size() >= 3 && labels.last().size() == 2 && isSecondLevelSuffix(labels[labels.size() - 2])) {
+        domainLabels = 3;
+    }
+
+    if (labels.size() <= domainLabels) {
+        return host.toLower();
+    }
+
+    return QStringList(labels.mid(labels.size() - domainLabels)).join(QLatin1Char('.'));
+}
+
+QString TimingAdvisor::profileKey(const QStringList& parameters)
+{
+    QList<NmapOptions::Token> tokens;
+
+    for (const NmapOptions::Token& token : NmapOptions::tokenize(parameters)) {
+        if (token.option && !isTimingOption(token.name)) {
+            tokens.append(token);
+        }
+    }
+
+    return NmapOptions::parameters(tokens).join(" ");
+}
+
+QString TimingAdvisor::recordKey(const QString& host, const QStringList& parameters)
+{
+    // settings keys can't have slashes, profiles are hashed
+    const QByteArray profileHash = QCryptographicHash::hash(profileKey(parameters).toUtf8(),
+                                   QCryptographicHash::Md5).toHex().left(12);
+    QString segmentKey(segment(host));
+    segmentKey.replace(QLatin1Char('/'), QLatin1Char('_'));
+
+    return QString::fromLatin1(profileHash) + QLatin1Char('/') + segmentKey;
+}
+
+TimingAdvisor::TimingRecord TimingAdvisor::record(const QString& host, const QStringList& parameters)
+{
+    const QString key = recordKey(host, parameters);
+    QHash<QString, TimingRecord>::const_iterator i = m_records.constFind(key);
+
+    if (i != m_records.constEnd()) {
+        return i.value();
+    }
+
+    QSettings settings("nmapsi4", "nmapsi4_timing");
+    settings.beginGroup(key);
+
+    TimingRecord timing;
+    timing.scans = settings.value("scans", 0).toInt();
+    timing.latency = settings.value("latency", -1.0).toDouble();
+    timing.dropRate = settings.value("dropRate", 0.0).toDouble();
+    timing.duration = settings.value("duration", 0.0).toDouble();
+    timing.maxDuration = settings.value("maxDuration", 0.0).toDouble();
+    timing.timeouts = settings.value("timeouts", 0).toInt();
+
+    m_records.insert(key, timing);
+    return timing;
+}
+
+void TimingAdvisor::addSample(const QString& host, const QStringList& parameters, const TimingSample& sample)
+{
+    TimingRecord timing = record(host, parameters);
+
+    if (!timing.scans) {
+        timing.latency = sample.latency;
+        timing.dropRate = sample.dropRate;
+        timing.duration = sample.duration;
+    } else {
+        if (sample.latency >= 0) {
+            timing.latency = (timing.latency < 0) ? sample.latency
+                             : timing.latency + sampleWeight * (sample.latency - timing.latency);
+        }
+        timing.dropRate += sampleWeight * (sample.dropRate - timing.dropRate);
+        timing.duration += sampleWeight * (sample.duration - timing.duration);
+    }
+
+    timing.maxDuration = qMax(timing.maxDuration, sample.duration);
+    // a scan without timeouts forgets the old ones
+    timing.timeouts = sample.timedOut ? timing.timeouts + 1 : qMax(0, timing.timeouts - 1);
+    timing.scans++;
+
+    const QString key = recordKey(host, parameters);
+    m_records.insert(key, timing);
+    m_changedKeys.insert(key);
+}
+
+void TimingAdvisor::save()
+{
+    if (m_changedKeys.isEmpty()) {
+        return;
+    }
+
+    QSettings settings("nmapsi4", "nmapsi4_timing");
+
+    for (const QString& key : m_changedKeys) {
+        const TimingRecord& timing = m_records[key];
+
+        settings.beginGroup(key);
+        settings.setValue("scans", timing.scans);
+        settings.setValue("latency", timing.latency);
+        settings.setValue("dropRate", timing.dropRate);
+        settings.setValue("duration", timing.duration);
+        settings.setValue("maxDuration", timing.maxDuration);
+        settings.setValue("timeouts", timing.timeouts);
+        settings.endGroup();
+    }
+
+    m_changedKeys.clear();
+}
+
+QStringList TimingAdvisor::suggestedOptions(const TimingRecord& record)
+{
+    QStringList options;
+
+    if (record.scans < minScans) {
+        return options;
+    }
+
+    if (record.timeouts || record.latency > slowLatency || record.dropRate > slowDropRate) {
+        // slow or lossy wan: normal template and time enough for the host
+        const int hostTimeout = qMax(minHostTimeout, static_cast<int>(std::ceil(record.maxDuration * 2)));
+        options << "-T3" << "--host-timeout" << QString(QString::number(hostTimeout) + QLatin1Char('s'));
+    } else if (record.latency >= 0 && record.latency < lanLatency && record.dropRate < lanDropRate) {
+        // lan without losses
+        options << "-T4" << "--min-rate" << "1000" << "--max-retries" << "2";
+    }
+
+    return options;
+}
+
+QStringList TimingAdvisor::tune(const QString& host, const QStringList& parameters)
+{
+    const QStringList options = suggestedOptions(record(host, parameters));
+
+    if (options.isEmpty()) {
+        return parameters;
+    }
+
+    QList<NmapOptions::Token> tokens(NmapOptions::tokenize(parameters));
+    const QList<NmapOptions::Token> suggestedTokens(NmapOptions::tokenize(options));
+
+    int profileLevel = -1;
+    for (const NmapOptions::Token& token : tokens) {
+        if (token.option && templateLevel(token) != -1) {
+            profileLevel = templateLevel(token);
+        }
+    }
+
+    for (const NmapOptions::Token& suggestedToken : suggestedTokens) {
+        const int suggestedLevel = templateLevel(suggestedToken);
+
+        if (suggestedLevel != -1 && suggestedLevel <= profileLevel) {
+            // the template of the user is never lowered
+            continue;
+        }
+
+        if (suggestedToken.name == QLatin1String("--host-timeout")) {
+            // a shorter timeout of the profile is raised, a profile
+            // without timeout (or with 0) keeps waiting for the host
+            const double suggestedTimeout = timeSeconds(suggestedToken.value);
+
+            for (NmapOptions::Token& token : tokens) {
+                const double timeout = token.option && token.name == suggestedToken.name
+                                       ? timeSeconds(token.value) : -1;
+
+                if (timeout > 0 && timeout < suggestedTimeout) {
+                    token.value = suggestedToken.value;
+                }
+            }
+            continue;
+        }
+
+        bool isSet = false;
+
+        for (int index = tokens.size() - 1; index >= 0; --index) {
+            if (!tokens[index].option) {
+                continue;
+            }
+
+            if (suggestedLevel != -1 && tokens[index].name.startsWith(QLatin1String("-T"))) {
+                // a slower template of the profile is replaced
+                tokens.removeAt(index);
+            } else if (tokens[index].name == suggestedToken.name) {
+                isSet = true;
+            }
+        }
+
+        if (!isSet) {
+            tokens.append(suggestedToken);
+        }
+    }
+
+    return NmapOptions::parameters(tokens);
+}
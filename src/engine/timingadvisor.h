@@ -0,0 +1,103 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TIMINGADVISOR_H
+#define TIMINGADVISOR_H
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QSet>
+
+class TimingAdvisor
+{
+    /*!
+     * Timing of past scans for every profile and network segment,
+     * saved in the nmapsi4_timing settings. The next scans of a slow
+     * segment get a longer host timeout if the profile has a shorter
+     * one, a fast segment gets a minimum rate and fewer retries.
+     */
+
+public:
+    struct TimingSample {
+        // seconds, negative when the host is down
+        double latency;
+        // dropped probes / sent probes
+        double dropRate;
+        double duration;
+        bool timedOut;
+    };
+
+    struct TimingRecord {
+        int scans;
+        // moving averages of the samples
+        double latency;
+        double dropRate;
+        double duration;
+        double maxDuration;
+        int timeouts;
+    };
+
+    TimingAdvisor();
+    ~TimingAdvisor();
+
+    /*!
+     * Timing of a finished scan from the nmap output,
+     * measuredDuration is used without the "Nmap done" line.
+     */
+    static TimingSample readSample(const QByteArray& output, double measuredDuration);
+    /*!
+     * /24 for ipv4, /64 for ipv6, the registrable domain for names,
+     * the name itself without a parent domain.
+     */
+    static QString segment(const QString& host);
+    /*!
+     * Parameters of the profile without targets and timing options.
+     */
+    static QString profileKey(const QStringList& parameters);
+    /*!
+     * Timing options for the record, empty without enough scans.
+     */
+    static QStringList suggestedOptions(const TimingRecord& record);
+
+    void addSample(const QString& host, const QStringList& parameters, const TimingSample& sample);
+    /*!
+     * Write the changed records in the settings, the samples are
+     * kept in memory during a batch.
+     */
+    void save();
+    TimingRecord record(const QString& host, const QStringList& parameters);
+    /*!
+     * Replace a slower -T template with the suggested one, raise a
+     * shorter host timeout and add the other suggested options not
+     * set by the profile.
+     */
+    QStringList tune(const QString& host, const QStringList& parameters);
+
+    // scans of a segment before a suggestion
+    static const int minScans = 2;
+
+private:
+    static QString recordKey(const QString& host, const QStringList& parameters);
+
+    // records read from the settings on demand
+    QHash<QString, TimingRecord> m_records;
+    QSet<QString> m_changedKeys;
+};
+
+#endif // TIMINGADVISOR_H
@@ -0,0 +1,1033 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "cvedatabase.h"
+#include "resultindex.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QMetaObject>
+#include <QtCore/QRegExp>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QDebug>
+
+#include <algorithm>
+#include <limits>
+#include <cctype>
+
+namespace
+{
+// "CVE1", change the version when CveEntry changes
+const quint32 indexMagic = 0x43564531;
+const qint32 indexVersion = 2;
+
+/*
+ * nmap product names and their cpe "vendor:product" keys
+ */
+QHash<QString, QStringList> createAliases()
+{
+    QHash<QString, QStringList> aliases;
+    aliases.insert("apache httpd", QStringList("apache:http_server"));
+    aliases.insert("apache tomcat", QStringList("apache:tomcat"));
+    aliases.insert("apache tomcat/coyote jsp engine", QStringList("apache:tomcat"));
+    aliases.insert("microsoft iis httpd", QStringList("microsoft:internet_information_services"));
+    aliases.insert("isc bind", QStringList("isc:bind"));
+    aliases.insert("openssh", QStringList("openbsd:openssh"));
+    aliases.insert("nginx", QStringList() << "f5:nginx" << "nginx:nginx");
+    aliases.insert("lighttpd", QStringList("lighttpd:lighttpd"));
+    aliases.insert("postfix smtpd", QStringList("postfix:postfix"));
+    aliases.insert("exim smtpd", QStringList("exim:exim"));
+    aliases.insert("dovecot imapd", QStringList("dovecot:dovecot"));
+    aliases.insert("dovecot pop3d", QStringList("dovecot:dovecot"));
+    aliases.insert("samba smbd", QStringList("samba:samba"));
+    aliases.insert("vsftpd", QStringList("beasts:vsftpd"));
+    aliases.insert("proftpd", QStringList("proftpd:proftpd"));
+    aliases.insert("mysql", QStringList() << "oracle:mysql" << "mysql:mysql");
+    aliases.insert("openssl", QStringList("openssl:openssl"));
+    aliases.insert("php", QStringList("php:php"));
+
+    return aliases;
+}
+
+QStringList productAliases(const QString& product)
+{
+    // read from the correlation threads
+    static const QHash<QString, QStringList> aliases = createAliases();
+    return aliases.value(product);
+}
+
+/*
+ * Position after the '[' of the item array of a NVD feed, -1 if not found.
+ * Only the top level keys of the document are read.
+ */
+qint64 findItemArray(const char* data, qint64 size, bool& isApiFeed)
+{
+    int depth = 0;
+    qint64 keyStart = -1;
+    QByteArray lastKey;
+
+    for (qint64 pos = 0; pos < size; ++pos) {
+        const char c = data[pos];
+
+        if (c == '"') {
+            const qint64 start = pos + 1;
+            for (++pos; pos < size && data[pos] != '"'; ++pos) {
+                if (data[pos] == '\\') {
+                    ++pos;
+                }
+            }
+            keyStart = (depth == 1) ? start : -1;
+            if (keyStart != -1) {
+                lastKey = QByteArray(data + start, static_cast<int>(pos - start));
+            }
+        } else if (c == '{' || c == '[') {
+            if (c == '[' && depth == 1 && keyStart != -1
+                    && (lastKey == "CVE_Items" || lastKey == "vulnerabilities")) {
+                isApiFeed = (lastKey == "vulnerabilities");
+                return pos + 1;
+            }
+            ++depth;
+            keyStart = -1;
+        } else if (c == '}' || c == ']') {
+            --depth;
+            keyStart = -1;
+        } else if (c == ',') {
+            keyStart = -1;
+        }
+    }
+
+    return -1;
+}
+
+/*
+ * End of the json value starting at pos, -1 when the document is truncated
+ */
+qint64 valueEnd(const char* data, qint64 size, qint64 pos)
+{
+    int depth = 0;
+
+    for (; pos < size; ++pos) {
+        const char c = data[pos];
+
+        if (c == '"') {
+            for (++pos; pos < size && data[pos] != '"'; ++pos) {
+                if (data[pos] == '\\') {
+                    ++pos;
+                }
+            }
+        } else if (c == '{' || c == '[') {
+            ++depth;
+        } else if (c == '}' || c == ']') {
+            if (!--depth) {
+                return pos + 1;
+            }
+        }
+    }
+
+    return -1;
+}
+
+/*
+ * Leading numeric part of a version: "7.4p1" and "7.4-1ubuntu" are "7.4"
+ */
+QString normalizeVersion(const QString& version)
+{
+    int size = 0;
+
+    while (size < version.size() && (version.at(size).isDigit() || version.at(size) == QLatin1Char('.'))) {
+        ++size;
+    }
+
+    while (size > 0 && version.at(size - 1) == QLatin1Char('.')) {
+        --size;
+    }
+
+    return size ? version.left(size) : version;
+}
+
+/*
+ * Compare a version with a bound cut to the size of the version,
+ * isPrefix is set when "3" is equal to "3.2.1" only as a prefix
+ */
+int compareBound(const QString& version, const QString& bound, bool& isPrefix)
+{
+    const QString value = normalizeVersion(bound);
+    const int size = version.count(QLatin1Char('.')) + 1;
+
+    if (value.count(QLatin1Char('.')) + 1 <= size) {
+        return ResultIndex::compareVersion(version, value);
+    }
+
+    const int result = ResultIndex::compareVersion(version, value.section(QLatin1Char('.'), 0, size - 1));
+    if (!result) {
+        isPrefix = true;
+    }
+
+    return result;
+}
+
+bool higherCvss(const CveMatch& first, const CveMatch& second)
+{
+    return first.cvss > second.cvss;
+}
+}
+
+QDataStream& operator<<(QDataStream& stream, const CveEntry& entry)
+{
+    stream << entry.cveId << entry.cvss << entry.version
+           << entry.versionStart << entry.versionEnd << entry.flags << entry.requires;
+    return stream;
+}
+
+QDataStream& operator>>(QDataStream& stream, CveEntry& entry)
+{
+    stream >> entry.cveId >> entry.cvss >> entry.version
+           >> entry.versionStart >> entry.versionEnd >> entry.flags >> entry.requires;
+    return stream;
+}
+
+CveIndex::CveIndex()
+{
+}
+
+QString CveIndex::defaultFileName()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+           + QLatin1String("/nmapsi4/cve.db");
+}
+
+bool CveIndex::isEmpty() const
+{
+    return m_products.isEmpty();
+}
+
+int CveIndex::cveNumber() const
+{
+    return m_cveIds.size();
+}
+
+bool CveIndex::load(const QString& fileName)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    quint32 magic;
+    qint32 version;
+    stream >> magic >> version;
+
+    if (magic != indexMagic) {
+        return false;
+    }
+
+    if (version != indexVersion) {
+        qWarning() << "CveIndex:: old index format, import the feeds again " << fileName;
+        return false;
+    }
+
+    stream >> m_products;
+
+    if (stream.status() != QDataStream::Ok) {
+        qWarning() << "CveIndex:: corrupted index " << fileName;
+        m_products.clear();
+        return false;
+    }
+
+    buildLookup();
+
+    return true;
+}
+
+bool CveIndex::save(const QString& fileName) const
+{
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+    QSaveFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "CveIndex:: index not writable " << fileName;
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    stream << indexMagic << indexVersion << m_products;
+
+    if (!file.commit()) {
+        qWarning() << "CveIndex:: index not saved " << fileName;
+        return false;
+    }
+
+    return true;
+}
+
+void CveIndex::buildLookup()
+{
+    m_productNames.clear();
+    m_cveIds.clear();
+
+    QHash<QString, QVector<CveEntry> >::const_iterator i;
+    for (i = m_products.constBegin(); i != m_products.constEnd(); ++i) {
+        m_productNames[i.key().mid(i.key().indexOf(QLatin1Char(':')) + 1)].append(i.key());
+
+        for (const CveEntry& entry : i.value()) {
+            m_cveIds.insert(entry.cveId);
+        }
+    }
+}
+
+bool CveIndex::importFeed(const QString& fileName, QString& error)
+{
+    if (fileName.endsWith(QLatin1String(".gz")) || fileName.endsWith(QLatin1String(".zip"))) {
+        error = QObject::tr("Compressed feeds are not supported, extract %1 first").arg(fileName);
+        return false;
+    }
+
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = QObject::tr("Cannot open %1").arg(fileName);
+        return false;
+    }
+
+    const qint64 size = file.size();
+    uchar* map = size ? file.map(0, size) : 0;
+
+    if (!map) {
+        error = QObject::tr("Cannot read %1").arg(fileName);
+        return false;
+    }
+
+    /*
+     * A year feed is bigger than the QJsonDocument limit, the item
+     * array is split here and every CVE is parsed alone.
+     */
+    const char* data = reinterpret_cast<const char*>(map);
+    bool isApiFeed = false;
+    qint64 pos = findItemArray(data, size, isApiFeed);
+
+    if (pos == -1) {
+        file.unmap(map);
+        error = QObject::tr("%1 is not a NVD CVE feed").arg(fileName);
+        return false;
+    }
+
+    QHash<QString, QVector<CveEntry> > entries;
+    QSet<QString> feedIds;
+    int itemNumber = 0;
+
+    while (true) {
+        while (pos < size && (data[pos] == ',' || isspace(static_cast<unsigned char>(data[pos])))) {
+            ++pos;
+        }
+
+        if (pos < size && data[pos] == ']') {
+            break;
+        }
+
+        const qint64 end = (pos < size && data[pos] == '{') ? valueEnd(data, size, pos) : -1;
+
+        if (end == -1 || end - pos > std::numeric_limits<int>::max()) {
+            file.unmap(map);
+            error = QObject::tr("%1: malformed or truncated feed after %2 CVEs").arg(fileName).arg(itemNumber);
+            return false;
+        }
+
+        QJsonParseError parseError;
+        const QJsonDocument item = QJsonDocument::fromJson(
+            QByteArray::fromRawData(data + pos, static_cast<int>(end - pos)), &parseError);
+
+        if (!item.isObject()) {
+            file.unmap(map);
+            error = QObject::tr("%1: %2 at byte %3").arg(fileName, parseError.errorString())
+                    .arg(pos + parseError.offset);
+            return false;
+        }
+
+        if (isApiFeed) {
+            readApiItem(item.object(), entries, feedIds);
+        } else {
+            readFeedItem(item.object(), entries, feedIds);
+        }
+
+        ++itemNumber;
+        pos = end;
+
+        if (QThread::currentThread()->isInterruptionRequested()) {
+            file.unmap(map);
+            return false;
+        }
+    }
+
+    file.unmap(map);
+    file.close();
+
+    if (feedIds.isEmpty()) {
+        error = QObject::tr("%1 doesn't contain CVEs").arg(fileName);
+        return false;
+    }
+
+    // a new feed of the same year replaces the old values
+    if (!m_cveIds.isEmpty()) {
+        QHash<QString, QVector<CveEntry> >::iterator i = m_products.begin();
+        while (i != m_products.end()) {
+            QVector<CveEntry>& productEntries = i.value();
+            productEntries.erase(std::remove_if(productEntries.begin(), productEntries.end(),
+                                                [&feedIds](const CveEntry& entry) {
+                                                    return feedIds.contains(entry.cveId);
+                                                }), productEntries.end());
+            if (productEntries.isEmpty()) {
+                i = m_products.erase(i);
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    QHash<QString, QVector<CveEntry> >::const_iterator i;
+    for (i = entries.constBegin(); i != entries.constEnd(); ++i) {
+        m_products[i.key()] += i.value();
+    }
+
+    buildLookup();
+
+    return true;
+}
+
+void CveIndex::readFeedItem(const QJsonObject& item, QHash<QString, QVector<CveEntry> >& entries,
+                            QSet<QString>& feedIds) const
+{
+    // NVD 1.1 feed
+    const QString cveId = item.value(QLatin1String("cve")).toObject()
+                          .value(QLatin1String("CVE_data_meta")).toObject()
+                          .value(QLatin1String("ID")).toString();
+
+    if (cveId.isEmpty()) {
+        return;
+    }
+
+    const QJsonObject impact = item.value(QLatin1String("impact")).toObject();
+    double cvss = impact.value(QLatin1String("baseMetricV3")).toObject()
+                  .value(QLatin1String("cvssV3")).toObject()
+                  .value(QLatin1String("baseScore")).toDouble(-1);
+    if (cvss < 0) {
+        cvss = impact.value(QLatin1String("baseMetricV2")).toObject()
+               .value(QLatin1String("cvssV2")).toObject()
+               .value(QLatin1String("baseScore")).toDouble(0);
+    }
+
+    feedIds.insert(cveId);
+    readNodes(item.value(QLatin1String("configurations")).toObject()
+              .value(QLatin1String("nodes")).toArray(), false, QStringList(), cveId, cvss, entries);
+}
+
+void CveIndex::readApiItem(const QJsonObject& item, QHash<QString, QVector<CveEntry> >& entries,
+                           QSet<QString>& feedIds) const
+{
+    // NVD 2.0 api
+    const char* metrics[] = { "cvssMetricV31", "cvssMetricV30", "cvssMetricV2" };
+    const QJsonObject cve = item.value(QLatin1String("cve")).toObject();
+    const QString cveId = cve.value(QLatin1String("id")).toString();
+
+    if (cveId.isEmpty()) {
+        return;
+    }
+
+    const QJsonObject metricObject = cve.value(QLatin1String("metrics")).toObject();
+    double cvss = 0;
+    for (const char* metric : metrics) {
+        const QJsonArray metricList = metricObject.value(QLatin1String(metric)).toArray();
+        if (!metricList.isEmpty()) {
+            cvss = metricList.first().toObject().value(QLatin1String("cvssData")).toObject()
+                   .value(QLatin1String("baseScore")).toDouble(0);
+            break;
+        }
+    }
+
+    feedIds.insert(cveId);
+    for (const QJsonValue& configurationValue : cve.value(QLatin1String("configurations")).toArray()) {
+        const QJsonObject configuration = configurationValue.toObject();
+        readNodes(configuration.value(QLatin1String("nodes")).toArray(),
+                  configuration.value(QLatin1String("operator")).toString() == QLatin1String("AND"),
+                  QStringList(), cveId, cvss, entries);
+    }
+}
+
+void CveIndex::readNodes(const QJsonArray& nodes, bool isAnd, const QStringList& requires,
+                         const QString& cveId, float cvss, QHash<QString, QVector<CveEntry> >& entries) const
+{
+    QStringList keyList;
+    if (isAnd) {
+        for (const QJsonValue& nodeValue : nodes) {
+            keyList.append(nodeKeys(nodeValue.toObject()).join(QLatin1Char('|')));
+        }
+    }
+
+    for (int index = 0; index < nodes.size(); ++index) {
+        QStringList nodeRequires(requires);
+
+        for (int keyIndex = 0; keyIndex < keyList.size(); ++keyIndex) {
+            if (keyIndex != index && !keyList[keyIndex].isEmpty()) {
+                nodeRequires.append(keyList[keyIndex]);
+            }
+        }
+
+        readNode(nodes[index].toObject(), nodeRequires, cveId, cvss, entries);
+    }
+}
+
+void CveIndex::readNode(const QJsonObject& node, const QStringList& requires, const QString& cveId,
+                        float cvss, QHash<QString, QVector<CveEntry> >& entries) const
+{
+    // "application on a platform" is an AND of the two products
+    const bool isAnd = (node.value(QLatin1String("operator")).toString() == QLatin1String("AND"));
+    const QJsonArray matchList = nodeMatches(node);
+    const QJsonArray children = node.value(QLatin1String("children")).toArray();
+
+    QStringList matchKeys;
+    QStringList childKeys;
+    if (isAnd) {
+        for (const QJsonValue& matchValue : matchList) {
+            matchKeys.append(matchKey(matchValue.toObject()));
+        }
+        for (const QJsonValue& child : children) {
+            childKeys.append(nodeKeys(child.toObject()).join(QLatin1Char('|')));
+        }
+    }
+
+    for (int index = 0; index < matchList.size(); ++index) {
+        const QJsonObject match = matchList[index].toObject();
+
+        if (!match.value(QLatin1String("vulnerable")).toBool(true)) {
+            continue;
+        }
+
+        QString cpe = match.value(QLatin1String("cpe23Uri")).toString();
+        if (cpe.isEmpty()) {
+            cpe = match.value(QLatin1String("criteria")).toString();
+        }
+
+        QString vendor;
+        QString product;
+        QString version;
+        if (!readCpe(cpe, vendor, product, version)) {
+            continue;
+        }
+
+        CveEntry entry;
+        entry.cveId = cveId;
+        entry.cvss = cvss;
+        entry.version = version.isEmpty() ? QString(QLatin1Char('*')) : version;
+        entry.requires = requires;
+
+        for (int keyIndex = 0; keyIndex < matchKeys.size(); ++keyIndex) {
+            if (keyIndex != index && !matchKeys[keyIndex].isEmpty()) {
+                entry.requires.append(matchKeys[keyIndex]);
+            }
+        }
+
+        for (const QString& key : childKeys) {
+            if (!key.isEmpty()) {
+                entry.requires.append(key);
+            }
+        }
+
+        if (match.contains(QLatin1String("versionStartIncluding"))) {
+            entry.versionStart = match.value(QLatin1String("versionStartIncluding")).toString();
+            entry.flags |= CveEntry::StartIncluding;
+        } else {
+            entry.versionStart = match.value(QLatin1String("versionStartExcluding")).toString();
+        }
+
+        if (match.contains(QLatin1String("versionEndIncluding"))) {
+            entry.versionEnd = match.value(QLatin1String("versionEndIncluding")).toString();
+            entry.flags |= CveEntry::EndIncluding;
+        } else {
+            entry.versionEnd = match.value(QLatin1String("versionEndExcluding")).toString();
+        }
+
+        entries[vendor + QLatin1Char(':') + product].append(entry);
+    }
+
+    QStringList childRequires(requires);
+    for (const QString& key : matchKeys) {
+        if (!key.isEmpty()) {
+            childRequires.append(key);
+        }
+    }
+
+    readNodes(children, isAnd, childRequires, cveId, cvss, entries);
+}
+
+QJsonArray CveIndex::nodeMatches(const QJsonObject& node)
+{
+    // "cpe_match" in 1.1 feeds, "cpeMatch" in 2.0
+    const QJsonArray matchList = node.value(QLatin1String("cpe_match")).toArray();
+    return matchList.isEmpty() ? node.value(QLatin1String("cpeMatch")).toArray() : matchList;
+}
+
+QString CveIndex::matchKey(const QJsonObject& match)
+{
+    QString cpe = match.value(QLatin1String("cpe23Uri")).toString();
+    if (cpe.isEmpty()) {
+        cpe = match.value(QLatin1String("criteria")).toString();
+    }
+
+    QString vendor;
+    QString product;
+    QString version;
+    if (!readCpe(cpe, vendor, product, version)) {
+        return QString();
+    }
+
+    return vendor + QLatin1Char(':') + product;
+}
+
+QStringList CveIndex::nodeKeys(const QJsonObject& node)
+{
+    // vulnerable or not, a platform of the configuration is required too
+    QStringList keys;
+
+    for (const QJsonValue& matchValue : nodeMatches(node)) {
+        const QString key = matchKey(matchValue.toObject());
+        if (!key.isEmpty() && !keys.contains(key)) {
+            keys.append(key);
+        }
+    }
+
+    for (const QJsonValue& child : node.value(QLatin1String("children")).toArray()) {
+        for (const QString& key : nodeKeys(child.toObject())) {
+            if (!keys.contains(key)) {
+                keys.append(key);
+            }
+        }
+    }
+
+    return keys;
+}
+
+bool CveIndex::readCpe(const QString& cpe, QString& vendor, QString& product, QString& version)
+{
+    // cpe:2.3:a:openbsd:openssh:7.4:*:*:*:*:*:*:* or cpe:/a:openbsd:openssh:7.4
+    QStringList values;
+
+    if (cpe.startsWith(QLatin1String("cpe:2.3:"))) {
+        values = cpe.mid(8).split(QLatin1Char(':'));
+    } else if (cpe.startsWith(QLatin1String("cpe:/"))) {
+        values = cpe.mid(5).split(QLatin1Char(':'));
+    } else {
+        return false;
+    }
+
+    if (values.size() < 3) {
+        return false;
+    }
+
+    vendor = values[1].toLower();
+    product = values[2].toLower();
+    version = values.value(3);
+
+    if (version == QLatin1String("-")) {
+        // not applicable
+        version.clear();
+    }
+
+    return !vendor.isEmpty() && !product.isEmpty();
+}
+
+bool CveIndex::versionMatches(const CveEntry& entry, const QString& version, bool& isPossible)
+{
+    // distro and patch suffixes are not in the cpe values: 7.4p1 is 7.4
+    const QString hostVersion = normalizeVersion(version);
+    bool isPrefix = false;
+
+    if (entry.version != QLatin1String("*")) {
+        const bool isMatch = !compareBound(hostVersion, entry.version, isPrefix);
+        isPossible = isPrefix;
+        return isMatch;
+    }
+
+    if (!entry.versionStart.isEmpty()) {
+        bool isStartPrefix = false;
+        const int result = compareBound(hostVersion, entry.versionStart, isStartPrefix);
+        if (result < 0 || (!result && !isStartPrefix && !(entry.flags & CveEntry::StartIncluding))) {
+            return false;
+        }
+        isPrefix = isStartPrefix;
+    }
+
+    if (!entry.versionEnd.isEmpty()) {
+        bool isEndPrefix = false;
+        const int result = compareBound(hostVersion, entry.versionEnd, isEndPrefix);
+        if (result > 0 || (!result && !isEndPrefix && !(entry.flags & CveEntry::EndIncluding))) {
+            return false;
+        }
+        isPrefix = isPrefix || isEndPrefix;
+    }
+
+    isPossible = isPrefix;
+    return true;
+}
+
+QList<CveMatch> CveIndex::matchProduct(const ProductLookup& lookup, const QSet<QString>* hostKeys) const
+{
+    QList<CveMatch> matches;
+
+    for (const CveEntry& entry : m_products.value(lookup.key)) {
+        bool isPossible = false;
+        if (!versionMatches(entry, lookup.version, isPossible)) {
+            continue;
+        }
+
+        if (!entry.requires.isEmpty()) {
+            if (!hostKeys) {
+                isPossible = true;
+            } else {
+                // one product of every other part of the configuration
+                bool isFound = true;
+                for (int index = 0; isFound && index < entry.requires.size(); ++index) {
+                    isFound = false;
+                    for (const QString& key : entry.requires[index].split(QLatin1Char('|'))) {
+                        if (hostKeys->contains(key)) {
+                            isFound = true;
+                            break;
+                        }
+                    }
+                }
+                if (!isFound) {
+                    continue;
+                }
+            }
+        }
+
+        CveMatch match;
+        match.port = lookup.port;
+        match.cpe = lookup.cpe;
+        match.cveId = entry.cveId;
+        match.cvss = entry.cvss;
+        match.isPossible = isPossible;
+        matches.append(match);
+    }
+
+    return matches;
+}
+
+bool CveIndex::cpeLookup(const QString& cpe, const QString& port, ProductLookup& lookup)
+{
+    QString vendor;
+    QString product;
+
+    if (!readCpe(cpe, vendor, product, lookup.version)) {
+        return false;
+    }
+
+    lookup.key = vendor + QLatin1Char(':') + product;
+    lookup.cpe = cpe;
+    lookup.port = port;
+
+    // without a version every cve of the product is a match
+    return !lookup.version.isEmpty();
+}
+
+QList<CveMatch> CveIndex::matchCpe(const QString& cpe, const QString& port) const
+{
+    ProductLookup lookup;
+
+    if (!cpeLookup(cpe, port, lookup)) {
+        return QList<CveMatch>();
+    }
+
+    return matchProduct(lookup, 0);
+}
+
+bool CveIndex::readService(const QString& description, QString& product, QString& version)
+{
+    // product words are followed by the version: "Apache httpd 2.4.6 ((CentOS))"
+    const QStringList words = description.split(QLatin1Char(' '), QString::SkipEmptyParts);
+    int versionIndex = 0;
+
+    while (versionIndex < words.size() && !words[versionIndex].at(0).isDigit()) {
+        ++versionIndex;
+    }
+
+    if (!versionIndex || versionIndex == words.size()) {
+        return false;
+    }
+
+    version = words[versionIndex];
+    product = QStringList(words.mid(0, versionIndex)).join(QLatin1Char(' ')).toLower();
+
+    return true;
+}
+
+QStringList CveIndex::productKeys(const QString& product)
+{
+    const QStringList aliases = productAliases(product);
+
+    if (!aliases.isEmpty()) {
+        return aliases;
+    }
+
+    // "microsoft ftpd" -> "microsoft:ftpd", "vsftpd" -> "vsftpd:vsftpd"
+    const int space = product.indexOf(QLatin1Char(' '));
+    const QString name = QString(space == -1 ? product : product.mid(space + 1))
+                         .replace(QLatin1Char(' '), QLatin1Char('_'));
+
+    return QStringList(QString(space == -1 ? product : product.left(space)) + QLatin1Char(':') + name);
+}
+
+QList<CveIndex::ProductLookup> CveIndex::serviceLookups(const QString& description,
+                                                       const QString& port) const
+{
+    QString productText;
+    QString version;
+
+    if (!readService(description, productText, version)) {
+        return QList<ProductLookup>();
+    }
+
+    QStringList keys = productKeys(productText);
+
+    if (!m_products.contains(keys.first())) {
+        // a product name of a single vendor is not ambiguous
+        const QString name = QString(productText).replace(QLatin1Char(' '), QLatin1Char('_'));
+        const QStringList vendorKeys = m_productNames.value(name);
+        if (vendorKeys.size() == 1) {
+            keys.append(vendorKeys.first());
+        }
+    }
+
+    QList<ProductLookup> lookups;
+    for (const QString& key : keys) {
+        if (m_products.contains(key)) {
+            ProductLookup lookup;
+            lookup.key = key;
+            lookup.version = version;
+            lookup.cpe = QLatin1String("cpe:/a:") + key + QLatin1Char(':') + version;
+            lookup.port = port;
+            lookups.append(lookup);
+        }
+    }
+
+    return lookups;
+}
+
+QList<CveMatch> CveIndex::matchService(const QString& description, const QString& port) const
+{
+    QList<CveMatch> matches;
+
+    for (const ProductLookup& lookup : serviceLookups(description, port)) {
+        matches += matchProduct(lookup, 0);
+    }
+
+    return matches;
+}
+
+QList<CveMatch> CveIndex::correlate(const QStringList& ports, const QStringList& hostInfo,
+                                    const QList<NseScriptResult>& scripts) const
+{
+    QList<ProductLookup> lookups;
+    // products of the host for the AND configurations
+    QSet<QString> hostKeys;
+
+    // 22/tcp open ssh OpenSSH 7.4 (protocol 2.0)
+    for (const QString& line : ports) {
+        const QStringList values = line.split(QLatin1Char(' '), QString::SkipEmptyParts);
+        if (values.size() > 3) {
+            lookups += serviceLookups(QStringList(values.mid(3)).join(QLatin1Char(' ')), values[0]);
+        }
+    }
+
+    // OS CPE: cpe:/o:linux:linux_kernel:3 cpe:/o:linux:linux_kernel:4
+    for (const QString& line : hostInfo) {
+        for (const QString& token : line.split(QRegExp("[\\s,;]+"), QString::SkipEmptyParts)) {
+            if (!token.startsWith(QLatin1String("cpe:/"))) {
+                continue;
+            }
+            ProductLookup lookup;
+            if (cpeLookup(token, QString(), lookup)) {
+                lookups.append(lookup);
+            } else if (!lookup.key.isEmpty()) {
+                // a platform without version is a product of the host too
+                hostKeys.insert(lookup.key);
+            }
+        }
+    }
+
+    // cpe values of vulners and the version scripts
+    for (const NseScriptResult& script : scripts) {
+        QString port;
+        if (!script.target.startsWith(QLatin1String("Host script results:"))) {
+            port = script.target.left(script.target.indexOf(QLatin1Char(' ')));
+        }
+
+        for (const QString& line : script.lines) {
+            QString token = line.trimmed();
+            if (!token.startsWith(QLatin1String("cpe:/"))) {
+                continue;
+            }
+            if (token.endsWith(QLatin1Char(':'))) {
+                token.chop(1);
+            }
+            ProductLookup lookup;
+            if (cpeLookup(token, port, lookup)) {
+                lookups.append(lookup);
+            } else if (!lookup.key.isEmpty()) {
+                hostKeys.insert(lookup.key);
+            }
+        }
+    }
+
+    for (const ProductLookup& lookup : lookups) {
+        hostKeys.insert(lookup.key);
+    }
+
+    QList<CveMatch> matches;
+    for (const ProductLookup& lookup : lookups) {
+        matches += matchProduct(lookup, &hostKeys);
+    }
+
+    // a cve is reported once for every port, a confirmed match first
+    QHash<QString, int> values;
+    QList<CveMatch> uniqueMatches;
+    for (const CveMatch& match : matches) {
+        const QString key = match.port + QLatin1Char(' ') + match.cveId;
+        QHash<QString, int>::const_iterator i = values.constFind(key);
+        if (i == values.constEnd()) {
+            values.insert(key, uniqueMatches.size());
+            uniqueMatches.append(match);
+        } else if (uniqueMatches[i.value()].isPossible && !match.isPossible) {
+            uniqueMatches[i.value()] = match;
+        }
+    }
+
+    std::stable_sort(uniqueMatches.begin(), uniqueMatches.end(), higherCvss);
+
+    return uniqueMatches;
+}
+
+CveDatabase::CveDatabase(QObject* parent)
+    : QThread(parent), m_indexFileName(CveIndex::defaultFileName())
+{
+}
+
+CveDatabase::~CveDatabase()
+{
+    requestInterruption();
+    wait();
+}
+
+bool CveDatabase::importFeeds(const QStringList& fileNames)
+{
+    if (isRunning()) {
+        return false;
+    }
+
+    m_feeds = fileNames;
+    start();
+
+    return true;
+}
+
+QSharedPointer<const CveIndex> CveDatabase::index() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_index;
+}
+
+void CveDatabase::run()
+{
+    const QStringList feeds = m_feeds;
+    m_feeds.clear();
+
+    QSharedPointer<CveIndex> newIndex(new CveIndex());
+    const QSharedPointer<const CveIndex> currentIndex = index();
+
+    if (currentIndex) {
+        *newIndex = *currentIndex;
+    } else {
+        newIndex->load(m_indexFileName);
+    }
+
+    QStringList errors;
+    bool isImported = false;
+
+    for (const QString& fileName : feeds) {
+        if (isInterruptionRequested()) {
+            return;
+        }
+
+        QString error;
+        if (newIndex->importFeed(fileName, error)) {
+            isImported = true;
+        } else if (!error.isEmpty()) {
+            errors.append(error);
+        }
+    }
+
+    if (isInterruptionRequested()) {
+        return;
+    }
+
+    if (isImported) {
+        newIndex->save(m_indexFileName);
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_index = newIndex;
+    }
+
+    if (!errors.isEmpty()) {
+        emit importFailed(errors.join(QLatin1Char('\n')));
+    }
+
+    if (!newIndex->isEmpty()) {
+        emit databaseReady(newIndex->cveNumber());
+    }
+}
+
+CveCorrelateTask::CveCorrelateTask(QObject* receiver, const char* member, int serial,
+                                   QSharedPointer<const CveIndex> index, PObject* object)
+    : m_receiver(receiver), m_member(member), m_serial(serial), m_index(index),
+      m_hostInfo(object->getHostInfo()), m_scripts(object->getNseScripts())
+{
+    // closed ports are not useful
+    m_ports << object->getPortOpen() << object->getPortFiltered();
+}
+
+void CveCorrelateTask::run()
+{
+    const QList<CveMatch> matches = m_index->correlate(m_ports, m_hostInfo, m_scripts);
+
+    if (m_receiver) {
+        QMetaObject::invokeMethod(m_receiver, m_member, Qt::QueuedConnection,
+                                  Q_ARG(int, m_serial),
+                                  Q_ARG(QList<CveMatch>, matches));
+    }
+}
@@ -0,0 +1,221 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CVEDATABASE_H
+#define CVEDATABASE_H
+
+#include <QtCore/QThread>
+#include <QtCore/QRunnable>
+#include <QtCore/QPointer>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QHash>
+#include <QtCore/QSet>
+#include <QtCore/QVector>
+#include <QtCore/QDataStream>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonObject>
+
+#include "pobjects.h"
+
+/*!
+ * Affected versions of a product for a single CVE,
+ * version is "*" when the range bounds are used.
+ */
+class CveEntry
+{
+
+public:
+    enum BoundFlags {
+        StartIncluding = 0x01,
+        EndIncluding = 0x02
+    };
+
+    CveEntry() : cvss(0), flags(0) {};
+
+    QString cveId;
+    float cvss;
+    QString version;
+    QString versionStart;
+    QString versionEnd;
+    quint8 flags;
+    // other products of an AND configuration, every value is
+    // a "vendor:product|vendor:product" list of alternatives
+    QStringList requires;
+};
+
+QDataStream& operator<<(QDataStream& stream, const CveEntry& entry);
+QDataStream& operator>>(QDataStream& stream, CveEntry& entry);
+
+class CveIndex
+{
+    /*!
+     * Offline CPE -> CVE index imported from the NVD JSON feeds.
+     * The index is immutable once loaded, lookups are thread safe.
+     */
+
+public:
+    CveIndex();
+    ~CveIndex() {};
+
+    bool load(const QString& fileName);
+    bool save(const QString& fileName) const;
+    /*!
+     * Merge a NVD JSON feed (1.1 "CVE_Items" or 2.0 "vulnerabilities"),
+     * CVEs already present are replaced. The CVEs are parsed one by
+     * one, a malformed or empty feed is an error and nothing is merged.
+     */
+    bool importFeed(const QString& fileName, QString& error);
+    bool isEmpty() const;
+    int cveNumber() const;
+    /*!
+     * Match a "cpe:/a:vendor:product:version" or cpe 2.3 value,
+     * CVEs of an AND configuration are possible matches.
+     */
+    QList<CveMatch> matchCpe(const QString& cpe, const QString& port) const;
+    /*!
+     * Match a nmap service description: "OpenSSH 7.4 (protocol 2.0)"
+     */
+    QList<CveMatch> matchService(const QString& description, const QString& port) const;
+    /*!
+     * Match ports, OS CPE lines and vulners CPEs of a host,
+     * the list is sorted by CVSS. CVEs of an AND configuration
+     * match only when the host has every product of it.
+     */
+    QList<CveMatch> correlate(const QStringList& ports, const QStringList& hostInfo,
+                              const QList<NseScriptResult>& scripts) const;
+
+    /*!
+     * Split a service description in the lower case product and the version.
+     */
+    static bool readService(const QString& description, QString& product, QString& version);
+    /*!
+     * Return the cpe "vendor:product" keys of a nmap product:
+     * "apache httpd" -> "apache:http_server", the first word is the
+     * vendor of the products without an alias.
+     */
+    static QStringList productKeys(const QString& product);
+    static QString defaultFileName();
+
+private:
+    struct ProductLookup {
+        // "vendor:product"
+        QString key;
+        QString version;
+        QString cpe;
+        QString port;
+    };
+
+    // "vendor:product" and the affected versions
+    QHash<QString, QVector<CveEntry> > m_products;
+    // "product" and its "vendor:product" keys, only for unknown vendors
+    QHash<QString, QStringList> m_productNames;
+    QSet<QString> m_cveIds;
+
+    void buildLookup();
+    void readFeedItem(const QJsonObject& item, QHash<QString, QVector<CveEntry> >& entries,
+                      QSet<QString>& feedIds) const;
+    void readApiItem(const QJsonObject& item, QHash<QString, QVector<CveEntry> >& entries,
+                     QSet<QString>& feedIds) const;
+    /*
+     * Read the nodes of a configuration, with isAnd every node
+     * requires the products of the other nodes
+     */
+    void readNodes(const QJsonArray& nodes, bool isAnd, const QStringList& requires,
+                   const QString& cveId, float cvss, QHash<QString, QVector<CveEntry> >& entries) const;
+    void readNode(const QJsonObject& node, const QStringList& requires, const QString& cveId,
+                  float cvss, QHash<QString, QVector<CveEntry> >& entries) const;
+    QList<ProductLookup> serviceLookups(const QString& description, const QString& port) const;
+    /*
+     * Without hostKeys the CVEs of an AND configuration are possible matches
+     */
+    QList<CveMatch> matchProduct(const ProductLookup& lookup, const QSet<QString>* hostKeys) const;
+
+    static bool readCpe(const QString& cpe, QString& vendor, QString& product, QString& version);
+    static bool cpeLookup(const QString& cpe, const QString& port, ProductLookup& lookup);
+    /*
+     * "vendor:product" keys of a node and its children
+     */
+    static QStringList nodeKeys(const QJsonObject& node);
+    static QJsonArray nodeMatches(const QJsonObject& node);
+    static QString matchKey(const QJsonObject& match);
+    /*
+     * isPossible is set when the version is shorter than the
+     * compared value: "3" of linux_kernel matches 3.2 and 3.18
+     */
+    static bool versionMatches(const CveEntry& entry, const QString& version, bool& isPossible);
+};
+
+class CveDatabase : public QThread
+{
+    /*!
+     * Load the local CVE index and import new feeds on a thread,
+     * the index is replaced only when the import is completed.
+     */
+    Q_OBJECT
+
+public:
+    explicit CveDatabase(QObject* parent = 0);
+    ~CveDatabase();
+
+    /*!
+     * Import the feed files, false when an import is running.
+     */
+    bool importFeeds(const QStringList& fileNames);
+    QSharedPointer<const CveIndex> index() const;
+
+signals:
+    void databaseReady(int cveNumber);
+    void importFailed(const QString& error);
+
+private:
+    mutable QMutex m_mutex;
+    QSharedPointer<const CveIndex> m_index;
+    QStringList m_feeds;
+    QString m_indexFileName;
+
+protected:
+    void run();
+};
+
+class CveCorrelateTask : public QRunnable
+{
+    /*!
+     * Correlate the values of a host on the thread pool, the result is
+     * returned with a queued call of member(int serial, QList<CveMatch>).
+     */
+
+public:
+    CveCorrelateTask(QObject* receiver, const char* member, int serial,
+                     QSharedPointer<const CveIndex> index, PObject* object);
+    ~CveCorrelateTask() {};
+
+    void run();
+
+private:
+    QPointer<QObject> m_receiver;
+    const char* m_member;
+    int m_serial;
+    QSharedPointer<const CveIndex> m_index;
+    QStringList m_ports;
+    QStringList m_hostInfo;
+    QList<NseScriptResult> m_scripts;
+};
+
+#endif // CVEDATABASE_H
@@ -17,6 +17,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "digmanager.h"
 #include "memorytools.h"
+#include "programpaths.h"
 
 DigManager::DigManager(QObject* parent)
     : QObject(parent), m_elemObjUtil(0)
@@ -42,7 +43,7 @@ void DigManager::digRequest(const QString hostname, PObjectLookup* objElem, DigR
     m_hostNameLocal = hostname;
     m_elemObjUtil = objElem;
 
-    QPointer<ProcessThread> m_th = new ProcessThread("dig", command);
+    QPointer<ProcessThread> m_th = new ProcessThread(ProgramPaths::path("dig"), command);
     m_threadList.push_back(m_th);
 
     if (type == Verbose) {
@@ -56,20 +57,18 @@ void DigManager::digRequest(const QString hostname, PObjectLookup* objElem, DigR
     m_th->start();
 }
 
-void DigManager::longDigAnswer(const QStringList hostname, QByteArray bufferData, QByteArray bufferError)
+void DigManager::longDigAnswer(const ScanOutput& output)
 {
-    Q_UNUSED(hostname);
-
     /*
      * TODO: remove this check with QT5 QStandardPaths::findExecutable.
      *
      */
-    if (!bufferData.size() && bufferError.size()) {
+    if (!output.output().size() && output.errors().size()) {
         qWarning() << "Error: Dig is not installed.";
         return;
     }
 
-    QString buff1(bufferData);
+    QString buff1(output.output());
     QTextStream stream1(&buff1);
     QString line;
 
@@ -83,26 +82,20 @@ void DigManager::longDigAnswer(const QStringList hostname, QByteArray bufferData
             m_elemObjUtil->setInfoLookup(line);
         }
     }
-
-    // clear thread
-    bufferData.clear();
-    bufferError.clear();
 }
 
-void DigManager::shortDigAnswer(const QStringList hostname, QByteArray bufferData, QByteArray bufferError)
+void DigManager::shortDigAnswer(const ScanOutput& output)
 {
-    Q_UNUSED(hostname);
-
     /*
      * TODO: remove this check with QT5 QStandardPaths::findExecutable.
      *
      */
-    if (!bufferData.size() && bufferError.size()) {
+    if (!output.output().size() && output.errors().size()) {
         qWarning() << "Error: Dig is not installed.";
         return;
     }
 
-    QString buff1(bufferData);
+    QString buff1(output.output());
     QTextStream stream1(&buff1);
     QString line;
 
@@ -112,8 +105,4 @@ void DigManager::shortDigAnswer(const QStringList hostname, QByteArray bufferDat
         line = stream1.readLine();
         m_elemObjUtil->setInfoLookup(line);
     }
-
-    // clear thread
-    bufferData.clear();
-    bufferError.clear();
 }
@@ -60,8 +60,8 @@ private slots:
     /*!
      * Set dig result on parser Object utils (objElem)
      */
-    void longDigAnswer(const QStringList hostname, QByteArray bufferData, QByteArray bufferError);
-    void shortDigAnswer(const QStringList hostname, QByteArray bufferData, QByteArray bufferError);
+    void longDigAnswer(const ScanOutput& output);
+    void shortDigAnswer(const ScanOutput& output);
 
 signals:
     /*!
@@ -17,6 +17,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "discover.h"
 #include "memorytools.h"
+#include "programpaths.h"
 #include "discovermanager.h"
 
 Discover::Discover(int uid)
@@ -106,7 +107,7 @@ void Discover::fromList(const QString networkIp, DiscoverManager *parent, QStrin
         // acquire one element from thread counter
         m_threadLimit--;
 
-        QPointer<ProcessThread> pingTh = new ProcessThread("nping", parameters);
+        QPointer<ProcessThread> pingTh = new ProcessThread(ProgramPaths::path("nping"), parameters);
         m_threadList.push_back(pingTh);
 
         connect(pingTh, &ProcessThread::threadEnd,
@@ -133,9 +134,8 @@ void Discover::fromList(const QString networkIp, DiscoverManager *parent, QStrin
     }
 }
 
-void Discover::fromListReturn(const QStringList ipAddr, QByteArray ipBuffer, QByteArray bufferError)
+void Discover::fromListReturn(const ScanOutput& output)
 {
-    Q_UNUSED(bufferError);
     /*
      * Signal return, send data to discoverCalls
      */
@@ -143,18 +143,18 @@ void Discover::fromListReturn(const QStringList ipAddr, QByteArray ipBuffer, QBy
     // increment thread limit, new ip discover is possible
     m_threadLimit++;
 
-    QString buffString(ipBuffer);
+    QString buffString(output.output());
     QTextStream buffStream(&buffString);
     QString buffLine;
 
     while (!buffStream.atEnd()) {
         buffLine = buffStream.readLine();
         if (buffLine.startsWith(QLatin1String("RCVD")) || buffLine.startsWith(QLatin1String("RECV"))) {
-            emit fromListFinisched(ipAddr, true, ipBuffer);
+            emit fromListFinisched(output.parameters(), true, output.output());
             return;
         }
     }
-    emit fromListFinisched(ipAddr, false, ipBuffer);
+    emit fromListFinisched(output.parameters(), false, output.output());
 }
 
 void Discover::repeatScanner()
@@ -202,7 +202,8 @@ void Discover::fromCIDR(const QString networkCIDR, QStringList parameters, Disco
 
     parameters.append(networkCIDR);
 
-    QPointer<ProcessThread> thread = new ProcessThread("nping", parameters);
+    QPointer<ProcessThread> thread = new ProcessThread(ProgramPaths::path("nping"), parameters);
+    m_cidrJobHash.insert(thread->jobId(), networkCIDR);
 
     connect(thread, &ProcessThread::flowFromThread,
             this, &Discover::currentCIDRValue);
@@ -221,9 +222,10 @@ void Discover::stopDiscoverFromCIDR()
     memory::freelist<ProcessThread*>::itemDeleteAllWithWait(m_threadList);
 }
 
-void Discover::currentCIDRValue(const QString parameters, QByteArray data)
+void Discover::currentCIDRValue(int jobId, const QByteArray& data)
 {
-    QTextStream currentValues(&data);
+    const QString& cidr = m_cidrJobHash.value(jobId);
+    QTextStream currentValues(data);
     QString currentLine;
 
     while (!currentValues.atEnd()) {
@@ -232,12 +234,13 @@ void Discover::currentCIDRValue(const QString parameters, QByteArray data)
         if (currentLine.startsWith(QLatin1String("RCVD"))
                 || currentLine.startsWith(QLatin1String("RECV"))
                 || currentLine.startsWith(QLatin1String("SENT"))) {
-            emit cidrCurrentValue(parameters, currentLine);
+            emit cidrCurrentValue(cidr, currentLine);
         }
     }
 }
 
-void Discover::endCIDR(const QStringList ipAddr, QByteArray ipBuffer, QByteArray bufferError)
+void Discover::endCIDR(const ScanOutput& output)
 {
-    emit cidrFinisced(ipAddr, ipBuffer, bufferError);
+    m_cidrJobHash.remove(output.jobId());
+    emit cidrFinisced(output.parameters(), output.output(), output.errors());
 }
@@ -19,6 +19,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define MAINDISCOVER_H
 
 #include <QtCore/QList>
+#include <QtCore/QHash>
 #include <QtCore/QDebug>
 #include <QtCore/QStringList>
 #include <QtCore/QPointer>
@@ -80,6 +81,8 @@ private:
     QStringList m_ipSospended;
     QStringList m_parameters;
     QList<ProcessThread*> m_threadList;
+    // network of the nping jobs
+    QHash<int, QString> m_cidrJobHash;
     DiscoverManager* m_parent;
     QTimer* m_timer;
 
@@ -87,12 +90,12 @@ private slots:
     /*!
      * Emit signal with nping QThread ByteArray output
      */
-    void fromListReturn(const QStringList ipAddr, QByteArray ipBuffer, QByteArray BufferError);
+    void fromListReturn(const ScanOutput& output);
     void repeatScanner();
     void stopDiscoverFromList();
     void stopDiscoverFromCIDR();
-    void currentCIDRValue(const QString parameters, QByteArray data);
-    void endCIDR(const QStringList ipAddr, QByteArray ipBuffer, QByteArray bufferError);
+    void currentCIDRValue(int jobId, const QByteArray& data);
+    void endCIDR(const ScanOutput& output);
 
 signals:
     /*!
@@ -0,0 +1,203 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bookmarkstore.h"
+
+#include <QtCore/QSettings>
+
+BookmarkStore::BookmarkStore(QObject* parent)
+    : QObject(parent)
+{
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(flushDelay);
+
+    connect(&m_flushTimer, &QTimer::timeout,
+            this, &BookmarkStore::flush);
+}
+
+BookmarkStore::~BookmarkStore()
+{
+    flush();
+}
+
+BookmarkStore::List& BookmarkStore::list(const QString& key)
+{
+    QHash<QString, List>::iterator i = m_lists.find(key);
+
+    if (i != m_lists.end()) {
+        return i.value();
+    }
+
+    QSettings settings("nmapsi4", "nmapsi4_bookmark");
+    List newList;
+    newList.values = settings.value(key, QStringList()).toStringList();
+
+    // NOTE: backward compatibility (to remove with 0.6.x)
+    if (newList.values.size() == 1 && newList.values[0].contains("NULL")) {
+        newList.values.clear();
+    }
+
+    for (const QString& value : newList.values) {
+        ++newList.counts[value];
+    }
+
+    return m_lists.insert(key, newList).value();
+}
+
+LruCache<QString>& BookmarkStore::cache(const QString& key)
+{
+    QHash<QString, LruCache<QString> >::iterator i = m_caches.find(key);
+
+    if (i != m_caches.end()) {
+        return i.value();
+    }
+
+    QSettings settings("nmapsi4", "nmapsi4_bookmark");
+    const QStringList values = settings.value(key, QStringList()).toStringList();
+    LruCache<QString>& newCache = m_caches[key];
+
+    // the file starts with the most recent value
+    for (int index = values.size() - 1; index >= 0; --index) {
+        // NOTE: backward compatibility (to remove with 0.6.x)
+        if (!values[index].contains("NULL")) {
+            newCache.touch(values[index]);
+        }
+    }
+
+    return newCache;
+}
+
+void BookmarkStore::setChanged(const QString& key)
+{
+    m_changedKeys.insert(key);
+
+    if (!m_flushTimer.isActive()) {
+        m_flushTimer.start();
+    }
+}
+
+const QStringList& BookmarkStore::values(const QString& key)
+{
+    return list(key).values;
+}
+
+bool BookmarkStore::contains(const QString& key, const QString& value)
+{
+    return list(key).counts.contains(value);
+}
+
+int BookmarkStore::indexOf(const QString& key, const QString& value)
+{
+    const List& valueList = list(key);
+
+    if (!valueList.counts.contains(value)) {
+        return -1;
+    }
+
+    return valueList.values.indexOf(value);
+}
+
+void BookmarkStore::prepend(const QString& key, const QString& value)
+{
+    List& valueList = list(key);
+
+    valueList.values.prepend(value);
+    ++valueList.counts[value];
+    setChanged(key);
+}
+
+void BookmarkStore::replace(const QString& key, int index, const QString& value)
+{
+    List& valueList = list(key);
+
+    if (index < 0 || index >= valueList.values.size()) {
+        return;
+    }
+
+    const QString oldValue = valueList.values[index];
+
+    if (!--valueList.counts[oldValue]) {
+        valueList.counts.remove(oldValue);
+    }
+
+    valueList.values[index] = value;
+    ++valueList.counts[value];
+    setChanged(key);
+}
+
+void BookmarkStore::removeAt(const QString& key, int index)
+{
+    List& valueList = list(key);
+
+    if (index < 0 || index >= valueList.values.size()) {
+        return;
+    }
+
+    const QString value = valueList.values.takeAt(index);
+
+    if (!--valueList.counts[value]) {
+        valueList.counts.remove(value);
+    }
+
+    setChanged(key);
+}
+
+void BookmarkStore::removeLast(const QString& key)
+{
+    removeAt(key, list(key).values.size() - 1);
+}
+
+bool BookmarkStore::touchCacheValue(const QString& key, const QString& value, int capacity, QStringList* evicted)
+{
+    LruCache<QString>& valueCache = cache(key);
+
+    if (valueCache.capacity() != capacity) {
+        valueCache.setCapacity(capacity, evicted);
+    }
+
+    const bool isNew = valueCache.touch(value, evicted);
+    setChanged(key);
+
+    return isNew;
+}
+
+QStringList BookmarkStore::cacheValues(const QString& key)
+{
+    return cache(key).values();
+}
+
+void BookmarkStore::flush()
+{
+    m_flushTimer.stop();
+
+    if (m_changedKeys.isEmpty()) {
+        return;
+    }
+
+    QSettings settings("nmapsi4", "nmapsi4_bookmark");
+
+    for (const QString& key : m_changedKeys) {
+        if (m_caches.contains(key)) {
+            settings.setValue(key, QStringList(m_caches[key].values()));
+        } else {
+            settings.setValue(key, m_lists[key].values);
+        }
+    }
+
+    m_changedKeys.clear();
+    settings.sync();
+}
@@ -0,0 +1,83 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOOKMARKSTORE_H
+#define BOOKMARKSTORE_H
+
+#include <QtCore/QObject>
+#include <QtCore/QHash>
+#include <QtCore/QSet>
+#include <QtCore/QStringList>
+#include <QtCore/QTimer>
+
+#include "lrucache.h"
+
+class BookmarkStore : public QObject
+{
+    /*!
+     * Lists of the bookmark file, read once and kept in memory.
+     * The changed lists are written together after a short delay,
+     * with flush() or when the store is deleted.
+     */
+    Q_OBJECT
+
+public:
+    explicit BookmarkStore(QObject* parent = 0);
+    ~BookmarkStore();
+
+    const QStringList& values(const QString& key);
+    bool contains(const QString& key, const QString& value);
+    int indexOf(const QString& key, const QString& value);
+    void prepend(const QString& key, const QString& value);
+    void replace(const QString& key, int index, const QString& value);
+    void removeAt(const QString& key, int index);
+    void removeLast(const QString& key);
+    /*!
+     * Recently used lists, like the host cache of the completer.
+     * Touch the value with the cache limit and return true for a new
+     * value, the values over the limit are appended to evicted.
+     */
+    bool touchCacheValue(const QString& key, const QString& value, int capacity, QStringList* evicted = 0);
+    QStringList cacheValues(const QString& key);
+
+    // delay of the batched writes in ms
+    static const int flushDelay = 2000;
+
+public slots:
+    /*!
+     * Write the changed lists to the bookmark file.
+     */
+    void flush();
+
+private:
+    struct List {
+        QStringList values;
+        // occurrences of every value
+        QHash<QString, int> counts;
+    };
+
+    List& list(const QString& key);
+    LruCache<QString>& cache(const QString& key);
+    void setChanged(const QString& key);
+
+    QHash<QString, List> m_lists;
+    QHash<QString, LruCache<QString> > m_caches;
+    QSet<QString> m_changedKeys;
+    QTimer m_flushTimer;
+};
+
+#endif
@@ -17,7 +17,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "history.h"
 
-History::History(QTreeWidget* treeWidget, const QString firstConfigTag, const QString secondConfigTag, int cacheSize)
+History::History(BookmarkStore* store, QTreeWidget* treeWidget, const QString firstConfigTag, const QString secondConfigTag, int cacheSize)
+    : m_store(store)
 {
     Q_ASSERT(treeWidget->columnCount() == 2 || treeWidget->columnCount() == 3);
 
@@ -27,61 +28,18 @@ History::History(QTreeWidget* treeWidget, const QString firstConfigTag, const QS
     m_cacheSize = cacheSize;
 }
 
-History::History(const QString firstConfigTag, const QString secondConfigTag, int cacheSize)
-    : m_treeWidget(0)
+History::History(BookmarkStore* store, const QString firstConfigTag, const QString secondConfigTag, int cacheSize)
+    : m_store(store), m_treeWidget(0)
 {
     m_firstConfigTag = firstConfigTag;
     m_secondConfigTag = secondConfigTag;
     m_cacheSize = cacheSize;
 }
 
-History::History(const QString configTag, int cacheSize)
-    : m_treeWidget(0)
-{
-    m_firstConfigTag = configTag;
-    m_cacheSize = cacheSize;
-}
-
 History::~History()
 {
 }
 
-const QStringList History::readBaseHistoryList()
-{
-    QSettings settings("nmapsi4", "nmapsi4_bookmark");
-
-    QVariant value = settings.value(m_firstConfigTag, QStringList());
-
-    if (value.isValid()) {
-        QStringList list = value.toStringList();
-        // NOTE: backward compatibility (to remove with 0.6.x)
-        if (list.size() == 1 && list[0].contains("NULL")) {
-            list.clear();
-        }
-        return list;
-    }
-
-    return QStringList();
-}
-
-const QStringList History::readOptionalHistoryList()
-{
-    QSettings settings("nmapsi4", "nmapsi4_bookmark");
-
-    QVariant value = settings.value(m_secondConfigTag, QStringList());
-
-    if (value.isValid()) {
-        QStringList list = value.toStringList();
-        // NOTE: backward compatibility (to remove with 0.6.x)
-        if (list.size() == 1 && list[0].contains("NULL")) {
-            list.clear();
-        }
-        return list;
-    }
-
-    return QStringList();
-}
-
 void History::addItemHistory(const QString item)
 {
     addItemToHistory(item, QString());
@@ -94,22 +52,16 @@ void History::addItemHistory(const QString item, const QString value)
 
 bool History::isProfileInHistory(const QString profileName)
 {
-    return readOptionalHistoryList().contains(profileName);
+    return m_store->contains(m_secondConfigTag, profileName);
 }
 
 void History::updateProfile(const QString parameters, const QString profileName)
 {
-    QSettings settings("nmapsi4", "nmapsi4_bookmark");
-
-    QStringList baseList = readBaseHistoryList();
-    QStringList optionalList = readOptionalHistoryList();
+    const int index = m_store->indexOf(m_secondConfigTag, profileName);
 
-    if (optionalList.contains(profileName)) {
-        int index = optionalList.indexOf(profileName);
-        baseList.removeAt(index);
-        optionalList.removeAt(index);
-        settings.setValue(m_firstConfigTag, baseList);
-        settings.setValue(m_secondConfigTag, optionalList);
+    if (index != -1) {
+        m_store->removeAt(m_firstConfigTag, index);
+        m_store->removeAt(m_secondConfigTag, index);
     }
 
     addItemHistory(parameters, profileName);
@@ -117,26 +69,18 @@ void History::updateProfile(const QString parameters, const QString profileName)
 
 void History::deleteItemBookmark(const QString item)
 {
-    QSettings settings("nmapsi4", "nmapsi4_bookmark");
-    QStringList baseList = readBaseHistoryList();
-    QStringList optionalList = readOptionalHistoryList();
-
-    for (int index = 0; index < baseList.size(); index++) {
-        if (baseList[index].contains(item)) {
-            int index = baseList.indexOf(item);
-            baseList.removeAt(index);
-            optionalList.removeAt(index);
-            settings.setValue(m_firstConfigTag, baseList);
-            settings.setValue(m_secondConfigTag, optionalList);
-            break;
-        }
+    const int index = m_store->indexOf(m_firstConfigTag, item);
+
+    if (index != -1) {
+        m_store->removeAt(m_firstConfigTag, index);
+        m_store->removeAt(m_secondConfigTag, index);
     }
 }
 
 QList<QTreeWidgetItem*> History::updateBookMarks()
 {
-    QStringList baseList = readBaseHistoryList();
-    QStringList optionalList = readOptionalHistoryList();
+    const QStringList& baseList = m_store->values(m_firstConfigTag);
+    const QStringList& optionalList = m_store->values(m_secondConfigTag);
 
     QList<QTreeWidgetItem*> ItemListHistory;
 
@@ -144,15 +88,15 @@ QList<QTreeWidgetItem*> History::updateBookMarks()
     m_treeWidget->setIconSize(QSize(22, 22));
 
     if (!baseList.isEmpty() && !optionalList.isEmpty()) {
-        short index = 0;
+        int index = 0;
         for (const QString & item : baseList) {
             QTreeWidgetItem* historyItem = new QTreeWidgetItem(m_treeWidget);
             historyItem->setIcon(0, QIcon(QString::fromUtf8(":/images/images/bookmark.png")));
             ItemListHistory.push_front(historyItem);
             historyItem->setText(0, item);
             historyItem->setToolTip(0, item);
-            historyItem->setText(1, optionalList[index]);
-            historyItem->setToolTip(1, optionalList[index]);
+            historyItem->setText(1, optionalList.value(index));
+            historyItem->setToolTip(1, optionalList.value(index));
             index++;
         }
     }
@@ -160,56 +104,30 @@ QList<QTreeWidgetItem*> History::updateBookMarks()
     return ItemListHistory;
 }
 
-QStringList History::getHostCache()
-{
-    return readBaseHistoryList();
-}
-
 void History::addItemToHistory(const QString item, const QString timeStamp)
 {
     Q_ASSERT(!item.isEmpty());
 
-    QSettings settings("nmapsi4", "nmapsi4_bookmark");
-
-    QStringList baseList = readBaseHistoryList();
-    QStringList optionalList;
-
-    if (!timeStamp.isEmpty()) {
-        optionalList = readOptionalHistoryList();
-    }
-
-    if (baseList.isEmpty()) {
-        baseList.append(item);
-        settings.setValue(m_firstConfigTag, baseList);
+    if (m_store->contains(m_firstConfigTag, item)) {
         if (!timeStamp.isEmpty()) {
-            optionalList.append(timeStamp);
-            settings.setValue(m_secondConfigTag, optionalList);
+            // append time
+            m_store->replace(m_secondConfigTag, m_store->indexOf(m_firstConfigTag, item), timeStamp);
         }
-    } else if ((baseList.size() == m_cacheSize) && (m_cacheSize != -1) && (!baseList.contains(item))) {
+        return;
+    }
+
+    if ((m_store->values(m_firstConfigTag).size() == m_cacheSize) && (m_cacheSize != -1)) {
         // new value with m_cacheSize limit
-        baseList.removeLast();
-        baseList.push_front(item);
-        settings.setValue(m_firstConfigTag, baseList);
+        m_store->removeLast(m_firstConfigTag);
 
         if (!timeStamp.isEmpty()) {
-            optionalList.removeLast();
-            optionalList.push_front(timeStamp);
-            settings.setValue(m_secondConfigTag, optionalList);
+            m_store->removeLast(m_secondConfigTag);
         }
-    } else if (!baseList.contains(item)) {
-        // new value with not m_cacheSize limit
-        baseList.push_front(item);
-        settings.setValue(m_firstConfigTag, baseList);
+    }
 
-        if (!timeStamp.isEmpty()) {
-            optionalList.push_front(timeStamp);
-            settings.setValue(m_secondConfigTag, optionalList);
-        }
-    } else if (!timeStamp.isEmpty()) {
-        // append time
-        int index = baseList.indexOf(item);
-        optionalList[index].clear();
-        optionalList[index].append(timeStamp);
-        settings.setValue(m_secondConfigTag, optionalList);
+    m_store->prepend(m_firstConfigTag, item);
+
+    if (!timeStamp.isEmpty()) {
+        m_store->prepend(m_secondConfigTag, timeStamp);
     }
 }
@@ -26,18 +26,17 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QTreeWidgetItem>
 
 #include "memorytools.h"
+#include "bookmarkstore.h"
 
 #define HISTORY_NO_DEBUG
 
 class History
 {
 public:
-    History(QTreeWidget* treeWidget, const QString firstConfigTag, const QString secondConfigTag, int cacheSize);
-    History(const QString firstConfigTag, const QString secondConfigTag, int cacheSize);
-    explicit History(const QString configTag, int cacheSize = 0);
+    History(BookmarkStore* store, QTreeWidget* treeWidget, const QString firstConfigTag, const QString secondConfigTag, int cacheSize);
+    History(BookmarkStore* store, const QString firstConfigTag, const QString secondConfigTag, int cacheSize);
     ~History();
     QList<QTreeWidgetItem*> updateBookMarks();
-    QStringList getHostCache();
     void addItemHistory(const QString item);
     void addItemHistory(const QString item, const QString value);
     void deleteItemBookmark(const QString item);
@@ -45,10 +44,9 @@ public:
     bool isProfileInHistory(const QString profileName);
 
 private:
-    const QStringList readBaseHistoryList();
-    const QStringList readOptionalHistoryList();
     void addItemToHistory(const QString item, const QString timeStamp);
 
+    BookmarkStore* m_store;
     QTreeWidget* m_treeWidget;
     QString m_firstConfigTag;
     QString m_secondConfigTag;
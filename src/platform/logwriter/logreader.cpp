@@ -0,0 +1,690 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "logreader.h"
+#include "scanparser.h"
+
+#include <cstring>
+
+namespace
+{
+// mapped window size, files bigger than this are read in more steps
+const qint64 mapWindowSize = 128 * 1024 * 1024;
+// records are returned to the gui thread in blocks
+const int recordsBlockSize = 256;
+// limit for a single host read back from an archive
+const qint64 maxRecordSize = 64 * 1024 * 1024;
+}
+
+LogReader::LogReader(const QStringList& pathList)
+    : m_pathList(pathList),
+      m_format(LogRecord::NormalFormat),
+      m_insideRecord(false)
+{
+    qRegisterMetaType<LogRecord>("LogRecord");
+    qRegisterMetaType< QList<LogRecord> >("QList<LogRecord>");
+}
+
+LogReader::~LogReader()
+{
+}
+
+void LogReader::run()
+{
+    for (const QString& path : m_pathList) {
+        if (isInterruptionRequested()) {
+            break;
+        }
+
+        QFileInfo info(path);
+        if (info.isDir()) {
+            QDirIterator it(path, QDir::Files | QDir::Readable, QDirIterator::Subdirectories);
+            while (it.hasNext() && !isInterruptionRequested()) {
+                readFile(it.next());
+            }
+        } else {
+            readFile(path);
+        }
+    }
+
+    flushRecords();
+}
+
+void LogReader::readFile(const QString& fileName)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "LogReader:: file not readable " << fileName;
+        return;
+    }
+
+    if (!detectFormat(file)) {
+#ifndef SAVELOG_NO_DEBUG
+        qDebug() << "DEBUG::LogReader:: unknown log format " << fileName;
+#endif
+        return;
+    }
+
+    m_fileName = fileName;
+    m_parameters.clear();
+    m_scanDate = QFileInfo(file).lastModified().toString("M/d/yyyy - hh:mm:ss");
+    m_insideRecord = false;
+    m_recordKey.clear();
+
+    const qint64 fileSize = file.size();
+    qint64 base = 0;
+
+    /*
+     * Map the file with a fixed window, only complete lines are read
+     * from every window and the last partial line starts the next one.
+     */
+    while (base < fileSize && !isInterruptionRequested()) {
+        const qint64 windowSize = qMin(mapWindowSize, fileSize - base);
+        uchar* window = file.map(base, windowSize);
+
+        if (!window) {
+            qWarning() << "LogReader:: file not mappable " << fileName;
+            break;
+        }
+
+        const char* data = reinterpret_cast<const char*>(window);
+        const bool lastWindow = (base + windowSize == fileSize);
+        qint64 pos = 0;
+
+        while (pos < windowSize) {
+            const void* newLine = std::memchr(data + pos, '\n', windowSize - pos);
+            qint64 end;
+
+            if (newLine) {
+                end = static_cast<const char*>(newLine) - data;
+            } else if (lastWindow || !pos) {
+                // last line of file or a line bigger than the window
+                end = windowSize;
+            } else {
+                break;
+            }
+
+            const qint64 lineSize = (end > pos && data[end - 1] == '\r') ? end - pos - 1 : end - pos;
+            readLine(QByteArray::fromRawData(data + pos, static_cast<int>(lineSize)), base + pos, base + end + 1);
+            pos = end + 1;
+        }
+
+        file.unmap(window);
+        base += qMin(pos, windowSize);
+    }
+
+    closeRecord(fileSize);
+    file.close();
+}
+
+bool LogReader::detectFormat(QFile& file)
+{
+    const QByteArray head = file.peek(4096);
+
+    if (head.contains("<?xml") || head.contains("<nmaprun")) {
+        m_format = LogRecord::XmlFormat;
+        return true;
+    }
+
+    if (head.startsWith("Host: ") || head.contains("\nHost: ")
+            || (head.startsWith("# Nmap") && head.contains(" -oG "))) {
+        m_format = LogRecord::GrepableFormat;
+        return true;
+    }
+
+    if (head.startsWith("# Nmap") || head.contains("Nmap scan report for")
+            || head.startsWith("Starting Nmap")) {
+        m_format = LogRecord::NormalFormat;
+        return true;
+    }
+
+    return false;
+}
+
+void LogReader::readLine(const QByteArray& line, qint64 offset, qint64 nextOffset)
+{
+    switch (m_format) {
+    case LogRecord::NormalFormat:
+        if (line.startsWith("# Nmap ") && line.contains(" scan initiated ")) {
+            closeRecord(offset);
+            readHeader(line, m_parameters, m_scanDate);
+        } else if (line.startsWith("Nmap scan report for ")) {
+            closeRecord(offset);
+            QByteArray host(line.mid(21).trimmed());
+            const int space = host.indexOf(' ');
+            if (space != -1) {
+                host.truncate(space);
+            }
+            openRecord(QString::fromUtf8(host), offset);
+        } else if (line.startsWith("# Nmap done") || line.startsWith("Nmap done")) {
+            closeRecord(offset);
+        }
+        break;
+    case LogRecord::GrepableFormat:
+        if (line.startsWith("# Nmap ") && line.contains(" scan initiated ")) {
+            closeRecord(offset);
+            readHeader(line, m_parameters, m_scanDate);
+        } else if (line.startsWith("Host: ")) {
+            const int tab = line.indexOf('\t');
+            const QByteArray key(line.mid(6, tab == -1 ? -1 : tab - 6).trimmed());
+
+            if (!m_insideRecord || key != m_recordKey) {
+                closeRecord(offset);
+                // Host: address (name)
+                const int open = key.indexOf('(');
+                QByteArray host(key.mid(open + 1, key.lastIndexOf(')') - open - 1).trimmed());
+                if (open == -1 || host.isEmpty()) {
+                    host = key.left(open == -1 ? key.size() : open).trimmed();
+                }
+                openRecord(QString::fromUtf8(host), offset);
+                m_recordKey = key;
+            }
+        } else if (line.startsWith("#")) {
+            closeRecord(offset);
+        }
+        break;
+    case LogRecord::XmlFormat: {
+        const QByteArray trimmedLine(line.trimmed());
+        if (trimmedLine.startsWith("<nmaprun ")) {
+            m_parameters = xmlAttribute(trimmedLine, "args");
+            const QString& date = xmlAttribute(trimmedLine, "startstr");
+            if (!date.isEmpty()) {
+                m_scanDate = date;
+            }
+        } else if (trimmedLine.startsWith("<host ") || trimmedLine.startsWith("<host>")) {
+            closeRecord(offset);
+            openRecord(QString(), offset);
+        } else if (m_insideRecord && trimmedLine.startsWith("<address ")) {
+            if (m_current.hostName.isEmpty() && xmlAttribute(trimmedLine, "addrtype") != QLatin1String("mac")) {
+                m_current.hostName = xmlAttribute(trimmedLine, "addr");
+            }
+        } else if (m_insideRecord && trimmedLine.startsWith("<hostname ") && m_recordKey.isEmpty()) {
+            // the first hostname wins on the address
+            m_current.hostName = xmlAttribute(trimmedLine, "name");
+            m_recordKey = "hostname";
+        } else if (trimmedLine.startsWith("</host>")) {
+            closeRecord(nextOffset);
+        }
+        break;
+    }
+    }
+}
+
+void LogReader::openRecord(const QString& hostName, qint64 offset)
+{
+    m_current = LogRecord();
+    m_current.fileName = m_fileName;
+    m_current.hostName = hostName;
+    m_current.parameters = m_parameters;
+    m_current.scanDate = m_scanDate;
+    m_current.format = m_format;
+    m_current.offset = offset;
+    m_recordKey.clear();
+    m_insideRecord = true;
+}
+
+void LogReader::closeRecord(qint64 offset)
+{
+    if (!m_insideRecord) {
+        return;
+    }
+
+    m_insideRecord = false;
+    m_current.length = offset - m_current.offset;
+
+    if (m_current.hostName.isEmpty() || m_current.length <= 0) {
+        return;
+    }
+
+    m_records.append(m_current);
+
+    if (m_records.size() >= recordsBlockSize) {
+        flushRecords();
+    }
+}
+
+void LogReader::flushRecords()
+{
+    if (m_records.isEmpty()) {
+        return;
+    }
+
+    emit recordsReady(m_records);
+    m_records.clear();
+}
+
+void LogReader::readHeader(const QByteArray& line, QString& parameters, QString& scanDate)
+{
+    // # Nmap 6.40 scan initiated Mon Jan  6 10:00:00 2014 as: nmap -sS -oN log 192.168.1.1
+    const int initiatedPos = line.indexOf(" scan initiated ");
+    const int asPos = line.indexOf(" as: ");
+
+    if (initiatedPos != -1 && asPos > initiatedPos) {
+        scanDate = QString::fromUtf8(line.mid(initiatedPos + 16, asPos - initiatedPos - 16).simplified());
+    }
+
+    if (asPos != -1) {
+        parameters = QString::fromUtf8(line.mid(asPos + 5).trimmed());
+    }
+}
+
+QString LogReader::xmlAttribute(const QByteArray& line, const char* name)
+{
+    const QByteArray pattern(QByteArray(" ") + name + "=\"");
+    const int start = line.indexOf(pattern);
+
+    if (start == -1) {
+        return QString();
+    }
+
+    const int valueStart = start + pattern.size();
+    const int valueEnd = line.indexOf('"', valueStart);
+
+    if (valueEnd == -1) {
+        return QString();
+    }
+
+    QString value(QString::fromUtf8(line.mid(valueStart, valueEnd - valueStart)));
+    value.replace(QLatin1String("&quot;"), QLatin1String("\""));
+    value.replace(QLatin1String("&apos;"), QLatin1String("'"));
+    value.replace(QLatin1String("&lt;"), QLatin1String("<"));
+    value.replace(QLatin1String("&gt;"), QLatin1String(">"));
+    value.replace(QLatin1String("&amp;"), QLatin1String("&"));
+
+    return value;
+}
+
+QByteArray LogReader::readRecord(const LogRecord& record)
+{
+    QFile file(record.fileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "LogReader:: file not readable " << record.fileName;
+        return QByteArray();
+    }
+
+    if (record.length > maxRecordSize) {
+        // a truncated output would be a partial host
+        qWarning() << "LogReader:: record too large " << record.hostName << record.length;
+        return QByteArray();
+    }
+
+    const qint64 length = record.length;
+    uchar* map = file.map(record.offset, length);
+
+    if (!map) {
+        qWarning() << "LogReader:: file not mappable " << record.fileName;
+        return QByteArray();
+    }
+
+    const QByteArray data(reinterpret_cast<const char*>(map), static_cast<int>(length));
+    file.unmap(map);
+    file.close();
+
+    switch (record.format) {
+    case LogRecord::GrepableFormat:
+        return grepableToNormal(data);
+    case LogRecord::XmlFormat:
+        return xmlToNormal(data);
+    case LogRecord::NormalFormat:
+        break;
+    }
+
+    return data;
+}
+
+QByteArray LogReader::grepableToNormal(const QByteArray& data)
+{
+    QByteArray result;
+    bool isHeaderDone = false;
+
+    for (const QByteArray& line : data.split('\n')) {
+        if (!line.startsWith("Host: ")) {
+            continue;
+        }
+
+        const QList<QByteArray> fields = line.trimmed().split('\t');
+
+        if (!isHeaderDone) {
+            // Host: address (name)
+            const QByteArray key(fields[0].mid(6).trimmed());
+            const int open = key.indexOf('(');
+            const QByteArray address(key.left(open == -1 ? key.size() : open).trimmed());
+            const QByteArray name(open == -1 ? QByteArray() : key.mid(open + 1, key.lastIndexOf(')') - open - 1));
+
+            if (name.isEmpty()) {
+                result += "Nmap scan report for " + address + '\n';
+            } else {
+                result += "Nmap scan report for " + name + " (" + address + ")\n";
+            }
+            isHeaderDone = true;
+        }
+
+        for (int index = 1; index < fields.size(); ++index) {
+            const QByteArray& field = fields[index];
+
+            if (field.startsWith("Status: ")) {
+                if (field.mid(8).startsWith("Up")) {
+                    result += "Host is up.\n";
+                } else {
+                    result += "Note: Host seems down.\n";
+                }
+            } else if (field.startsWith("Ports: ")) {
+                // 22/open/tcp//ssh//OpenSSH 5.3 (protocol 2.0)/
+                for (const QByteArray& port : field.mid(7).split(',')) {
+                    const QList<QByteArray> values = port.trimmed().split('/');
+                    if (values.size() < 5) {
+                        continue;
+                    }
+
+                    QByteArray portLine(values[0] + '/' + values[2] + ' ' + values[1] + ' ' + values[4]);
+                    if (values.size() > 6 && !values[6].isEmpty()) {
+                        QByteArray version(values[6]);
+                        portLine += ' ' + version.replace('|', '/');
+                    }
+                    result += portLine + '\n';
+                }
+            } else if (field.startsWith("Ignored State: ")) {
+                // Ignored State: closed (997)
+                const QByteArray state(field.mid(15));
+                const int open = state.indexOf('(');
+                result += "Not shown: " + state.mid(open + 1, state.indexOf(')') - open - 1)
+                          + ' ' + state.left(open).trimmed() + " ports\n";
+            } else if (field.startsWith("OS: ")) {
+                result += "OS details: " + field.mid(4) + '\n';
+            }
+        }
+    }
+
+    return result;
+}
+
+namespace
+{
+void appendScriptOutput(QStringList& lines, const QString& id, const QString& output)
+{
+    QStringList outputLines;
+    for (const QString& line : output.split('\n', QString::SkipEmptyParts)) {
+        if (!line.trimmed().isEmpty()) {
+            outputLines.append(line);
+        }
+    }
+
+    if (outputLines.size() <= 1) {
+        lines.append("|_" + id + ": " + outputLines.value(0).trimmed());
+        return;
+    }
+
+    lines.append("| " + id + ": ");
+    for (int index = 0; index < outputLines.size(); ++index) {
+        if (index == outputLines.size() - 1) {
+            lines.append("|_" + outputLines[index]);
+        } else {
+            lines.append("| " + outputLines[index]);
+        }
+    }
+}
+}
+
+QByteArray LogReader::xmlToNormal(const QByteArray& data)
+{
+    QXmlStreamReader xml(data);
+
+    QString address;
+    QString hostName;
+    QString status;
+    QString macLine;
+    QString portLine;
+    QString osDetails;
+    QString osCpe;
+    QString uptime;
+    QString distance;
+    QStringList portLines;
+    QStringList portScripts;
+    QStringList hostScripts;
+    QStringList traceLines;
+    bool isInsidePort = false;
+    bool isInsideHostScript = false;
+    bool isInsideOsClass = false;
+    int osMatchCount = 0;
+
+    while (!xml.atEnd()) {
+        xml.readNext();
+
+        if (xml.isEndElement()) {
+            if (xml.name() == QLatin1String("port")) {
+                portLines.append(portLine);
+                portLines.append(portScripts);
+                portScripts.clear();
+                isInsidePort = false;
+            } else if (xml.name() == QLatin1String("hostscript")) {
+                isInsideHostScript = false;
+            } else if (xml.name() == QLatin1String("osclass")) {
+                isInsideOsClass = false;
+            }
+            continue;
+        }
+
+        if (!xml.isStartElement()) {
+            continue;
+        }
+
+        const QXmlStreamAttributes attributes = xml.attributes();
+        const QStringRef name = xml.name();
+
+        if (name == QLatin1String("status")) {
+            status = attributes.value("state").toString();
+        } else if (name == QLatin1String("address")) {
+            if (attributes.value("addrtype") == QLatin1String("mac")) {
+                macLine = "MAC Address: " + attributes.value("addr").toString();
+                if (!attributes.value("vendor").isEmpty()) {
+                    macLine += " (" + attributes.value("vendor").toString() + ')';
+                }
+            } else if (address.isEmpty()) {
+                address = attributes.value("addr").toString();
+            }
+        } else if (name == QLatin1String("hostname")) {
+            if (hostName.isEmpty()) {
+                hostName = attributes.value("name").toString();
+            }
+        } else if (name == QLatin1String("port")) {
+            isInsidePort = true;
+            portLine = attributes.value("portid").toString() + '/' + attributes.value("protocol").toString();
+        } else if (name == QLatin1String("state") && isInsidePort) {
+            portLine += ' ' + attributes.value("state").toString();
+        } else if (name == QLatin1String("service") && isInsidePort) {
+            portLine += ' ' + attributes.value("name").toString();
+            QString version(attributes.value("product").toString());
+            if (!attributes.value("version").isEmpty()) {
+                version += ' ' + attributes.value("version").toString();
+            }
+            if (!attributes.value("extrainfo").isEmpty()) {
+                version += " (" + attributes.value("extrainfo").toString() + ')';
+            }
+            if (!version.trimmed().isEmpty()) {
+                portLine += ' ' + version.trimmed();
+            }
+        } else if (name == QLatin1String("hostscript")) {
+            isInsideHostScript = true;
+        } else if (name == QLatin1String("script")) {
+            const QString id(attributes.value("id").toString());
+            const QString output(attributes.value("output").toString());
+            if (isInsidePort) {
+                appendScriptOutput(portScripts, id, output);
+            } else if (isInsideHostScript) {
+                appendScriptOutput(hostScripts, id, output);
+            }
+        } else if (name == QLatin1String("osmatch")) {
+            const QString match(attributes.value("name").toString());
+            const QString accuracy(attributes.value("accuracy").toString());
+            if (!osMatchCount && accuracy == QLatin1String("100")) {
+                osDetails = "OS details: " + match;
+            } else if (!osMatchCount) {
+                osDetails = "Aggressive OS guesses: " + match + " (" + accuracy + "%)";
+            } else if (osDetails.startsWith(QLatin1String("Aggressive"))) {
+                osDetails += ", " + match + " (" + accuracy + "%)";
+            } else {
+                osDetails += ", " + match;
+            }
+            osMatchCount++;
+        } else if (name == QLatin1String("osclass")) {
+            isInsideOsClass = true;
+        } else if (name == QLatin1String("cpe") && isInsideOsClass) {
+            const QString cpe(xml.readElementText());
+            if (osCpe.isEmpty()) {
+                osCpe = "OS CPE: " + cpe;
+            } else if (!osCpe.contains(cpe)) {
+                osCpe += ' ' + cpe;
+            }
+        } else if (name == QLatin1String("uptime")) {
+            const double days = attributes.value("seconds").toString().toDouble() / 86400.0;
+            uptime = "Uptime guess: " + QString::number(days, 'f', 3) + " days (since "
+                     + attributes.value("lastboot").toString() + ')';
+        } else if (name == QLatin1String("distance")) {
+            distance = "Network Distance: " + attributes.value("value").toString() + " hops";
+        } else if (name == QLatin1String("hop")) {
+            QString hopAddress(attributes.value("ipaddr").toString());
+            if (!attributes.value("host").isEmpty()) {
+                hopAddress = attributes.value("host").toString() + " (" + hopAddress + ')';
+            }
+            traceLines.append(attributes.value("ttl").toString() + "   "
+                              + QString::number(attributes.value("rtt").toString().toDouble(), 'f', 2)
+                              + " ms " + hopAddress);
+        }
+    }
+
+    if (xml.hasError() && xml.error() != QXmlStreamReader::PrematureEndOfDocumentError) {
+        qWarning() << "LogReader:: xml error " << xml.errorString();
+    }
+
+    QStringList lines;
+    if (hostName.isEmpty()) {
+        lines.append("Nmap scan report for " + address);
+    } else {
+        lines.append("Nmap scan report for " + hostName + " (" + address + ')');
+    }
+
+    if (status == QLatin1String("up")) {
+        lines.append("Host is up.");
+    } else {
+        lines.append("Note: Host seems down.");
+    }
+
+    if (!portLines.isEmpty()) {
+        lines.append("PORT STATE SERVICE VERSION");
+        lines.append(portLines);
+    }
+
+    if (!macLine.isEmpty()) {
+        lines.append(macLine);
+    }
+
+    if (!osCpe.isEmpty()) {
+        lines.append(osCpe);
+    }
+
+    if (!osDetails.isEmpty()) {
+        lines.append(osDetails);
+    }
+
+    if (!uptime.isEmpty()) {
+        lines.append(uptime);
+    }
+
+    if (!distance.isEmpty()) {
+        lines.append(distance);
+    }
+
+    if (!hostScripts.isEmpty()) {
+        lines.append("");
+        lines.append("Host script results:");
+        lines.append(hostScripts);
+    }
+
+    if (!traceLines.isEmpty()) {
+        lines.append("");
+        lines.append("TRACEROUTE");
+        lines.append("HOP RTT ADDRESS");
+        lines.append(traceLines);
+    }
+
+    return lines.join('\n').toUtf8() + '\n';
+}
+
+PObject* LogReader::parseRecord(const LogRecord& record)
+{
+    QStringList parList = record.parameters.split(' ', QString::SkipEmptyParts);
+    parList.append(record.hostName);
+
+    QByteArray output;
+    QByteArray errors;
+
+    if (record.length > maxRecordSize) {
+        errors = QByteArray("nmapsi4: the host output of the log is larger than ")
+                 + QByteArray::number(maxRecordSize / (1024 * 1024)) + " MB, not loaded\n";
+    } else {
+        output = readRecord(record);
+    }
+
+    PObject* object = ScanParser::parse(parList, output, errors);
+    object->setParameters(record.parameters);
+    object->setScanDate(record.scanDate);
+
+    return object;
+}
+
+LogRecordParseTask::LogRecordParseTask(QObject* receiver, const char* member, int serial, const LogRecord& record)
+    : m_receiver(receiver), m_member(member), m_serial(serial), m_record(record)
+{
+}
+
+void LogRecordParseTask::run()
+{
+    PObject* object = LogReader::parseRecord(m_record);
+
+    if (!m_receiver || !QMetaObject::invokeMethod(m_receiver, m_member, Qt::QueuedConnection,
+            Q_ARG(int, m_serial),
+            Q_ARG(PObject*, object))) {
+        delete object;
+    }
+}
+
+LogRecordIndexTask::LogRecordIndexTask(QObject* receiver, const char* member, int generation,
+                                       int firstId, const QList<LogRecord>& records)
+    : m_receiver(receiver), m_member(member), m_generation(generation),
+      m_firstId(firstId), m_records(records)
+{
+}
+
+void LogRecordIndexTask::run()
+{
+    QList<IndexFields> fieldsList;
+
+    for (int index = 0; index < m_records.size() && m_receiver; ++index) {
+        IndexFields fields;
+        fields.id = m_firstId + index;
+        ResultIndex::readFields(LogReader::readRecord(m_records[index]), fields);
+        fieldsList.append(fields);
+    }
+
+    if (m_receiver) {
+        QMetaObject::invokeMethod(m_receiver, m_member, Qt::QueuedConnection,
+                                  Q_ARG(int, m_generation),
+                                  Q_ARG(QList<IndexFields>, fieldsList));
+    }
+}
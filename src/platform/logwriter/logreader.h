@@ -0,0 +1,167 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LOGREADER_H
+#define LOGREADER_H
+
+#include <QtCore/QThread>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QDateTime>
+#include <QtCore/QDirIterator>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
+#include <QtCore/QMetaType>
+#include <QtCore/QRunnable>
+#include <QtCore/QPointer>
+#include <QtCore/QXmlStreamReader>
+#include <QtCore/QDebug>
+
+#include "pobjects.h"
+#include "resultindex.h"
+
+/*!
+ * Position of a single host inside an nmap log file.
+ * The host output is read back from the file only when requested.
+ */
+class LogRecord
+{
+
+public:
+    enum LogFormat {
+        NormalFormat,
+        XmlFormat,
+        GrepableFormat
+    };
+
+    LogRecord() : offset(0), length(0), format(NormalFormat) {};
+
+    QString fileName;
+    QString hostName;
+    QString parameters;
+    QString scanDate;
+    qint64 offset;
+    qint64 length;
+    LogFormat format;
+};
+
+Q_DECLARE_METATYPE(LogRecord)
+Q_DECLARE_METATYPE(QList<LogRecord>)
+
+class LogReader : public QThread
+{
+    /*!
+     * Read nmap -oN/-oX/-oG files (or directories of them) with a
+     * memory mapped view and return the host records with a signal.
+     */
+    Q_OBJECT
+
+public:
+    explicit LogReader(const QStringList& pathList);
+    ~LogReader();
+
+    /*!
+     * Read the host output from the log file and return it
+     * with the nmap normal output format, empty for a record
+     * larger than 64 MB.
+     */
+    static QByteArray readRecord(const LogRecord& record);
+    /*!
+     * Read and parse a host without widgets, the caller owns the object.
+     * A record too large has only an error.
+     */
+    static PObject* parseRecord(const LogRecord& record);
+
+signals:
+    /*!
+     * Return a block of host records found in the log files.
+     */
+    void recordsReady(const QList<LogRecord> records);
+
+private:
+    QStringList m_pathList;
+    QList<LogRecord> m_records;
+    LogRecord m_current;
+    QString m_fileName;
+    QString m_parameters;
+    QString m_scanDate;
+    QByteArray m_recordKey;
+    LogRecord::LogFormat m_format;
+    bool m_insideRecord;
+
+    void readFile(const QString& fileName);
+    void readLine(const QByteArray& line, qint64 offset, qint64 nextOffset);
+    void openRecord(const QString& hostName, qint64 offset);
+    void closeRecord(qint64 offset);
+    void flushRecords();
+    bool detectFormat(QFile& file);
+
+    static void readHeader(const QByteArray& line, QString& parameters, QString& scanDate);
+    static QString xmlAttribute(const QByteArray& line, const char* name);
+    static QByteArray grepableToNormal(const QByteArray& data);
+    static QByteArray xmlToNormal(const QByteArray& data);
+
+protected:
+    void run();
+};
+
+class LogRecordParseTask : public QRunnable
+{
+    /*!
+     * Parse an imported host on the thread pool, the object is
+     * returned with a queued call of member(int serial, PObject*).
+     */
+
+public:
+    LogRecordParseTask(QObject* receiver, const char* member, int serial, const LogRecord& record);
+    ~LogRecordParseTask() {};
+
+    void run();
+
+private:
+    QPointer<QObject> m_receiver;
+    const char* m_member;
+    int m_serial;
+    LogRecord m_record;
+};
+
+class LogRecordIndexTask : public QRunnable
+{
+    /*!
+     * Read the indexed fields of a block of imported hosts on the thread
+     * pool, ids start from firstId. The fields are returned with a queued
+     * call of member(int generation, QList<IndexFields>).
+     */
+
+public:
+    LogRecordIndexTask(QObject* receiver, const char* member, int generation,
+                       int firstId, const QList<LogRecord>& records);
+    ~LogRecordIndexTask() {};
+
+    void run();
+
+private:
+    QPointer<QObject> m_receiver;
+    const char* m_member;
+    int m_generation;
+    int m_firstId;
+    QList<LogRecord> m_records;
+};
+
+#endif // LOGREADER_H
@@ -17,6 +17,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "monitor.h"
 #include "mainwindow.h"
+#include "programpaths.h"
+#include "nmapoptions.h"
+#include "scanmetricsdialog.h"
+
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonArray>
 
 #if !defined(Q_OS_WIN32) && !defined(Q_OS_MAC)
 #include "nmapsi4adaptor.h"
@@ -28,7 +34,9 @@ MonitorWidget::MonitorWidget(QWidget* parent): QWidget(parent)
 }
 
 Monitor::Monitor(MainWindow* parent)
-    : QObject(parent), m_ui(parent), m_idCounter(0)
+    : QObject(parent), m_ui(parent), m_completedHostsCount(0), m_aggregatePercent(0),
+      m_completedDuration(0), m_completedPorts(0.0), m_idCounter(0), m_controlServer(0),
+      m_tuneTiming(false)
 {
 #if !defined(Q_OS_WIN32) && !defined(Q_OS_MAC)
     new Nmapsi4Adaptor(this);
@@ -49,26 +57,42 @@ Monitor::Monitor(MainWindow* parent)
     m_monitorWidget = new MonitorWidget(m_ui);
     m_monitorWidget->scanMonitor->setColumnWidth(0, 300);
     m_monitorWidget->scanMonitor->setColumnWidth(1, 350);
+    m_monitorWidget->scanMonitor->setColumnWidth(2, 250);
     m_monitorWidget->scanMonitor->setIconSize(QSize(22, 22));
     m_monitorWidget->scanMonitor->header()->setSectionResizeMode(QHeaderView::Interactive);
 
     updateMaxParallelScan();
+    updateControlServer();
+    updateTimingTuning();
+    updateResultCache();
+
+    // pending jobs of the last run are kept until resumed or discarded
+    m_journal.open();
 
     m_isHostcached = false;
     m_timer = new QTimer(this);
 
+    // coalesce monitor updates, 5 frames per second are enough
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(200);
+    connect(m_refreshTimer, &QTimer::timeout,
+            this, &Monitor::refreshMonitor);
+
     connect(m_monitorWidget->monitorStopCurrentScanButt, &QPushButton::clicked,
             this, &Monitor::stopSelectedScan);
     connect(m_monitorWidget->monitorDetailsScanButt, &QPushButton::clicked,
             this, &Monitor::showSelectedScanDetails);
     connect(m_monitorWidget->monitorStopAllScanButt, &QPushButton::clicked,
             this, &Monitor::stopAllScan);
+    connect(m_monitorWidget->monitorMetricsButt, &QPushButton::clicked,
+            this, &Monitor::showScanMetrics);
     connect(m_monitorWidget->scanMonitor, &QTreeWidget::itemSelectionChanged,
             this, &Monitor::monitorRuntimeEvent);
 }
 
 Monitor::~Monitor()
 {
+    memory::freemap<QString, ScanOutputBuffer*>::itemDeleteAll(m_scanHashListRealtime);
     memory::freemap<QString, ProcessThread*>::itemDeleteAllWithWait(m_scanThreadHashList);
     memory::freelist<LookupManager*>::itemDeleteAllWithWait(m_internealLookupList);
     memory::freelist<DigManager*>::itemDeleteAll(m_digLookupPointersList);
@@ -82,19 +106,12 @@ Monitor::~Monitor()
 
 bool Monitor::isHostOnMonitor(const QString hostname)
 {
-    QList<QTreeWidgetItem*>::const_iterator i;
-    for (i = m_monitorTreeWidgetItemsList.constBegin(); i != m_monitorTreeWidgetItemsList.constEnd(); ++i) {
-        if ((*i)->text(0) == hostname) {
-            return true;
-        }
-    }
-
-    return false;
+    return m_monitorTreeWidgetItemsHash.contains(hostname);
 }
 
 int Monitor::monitorHostNumber()
 {
-    return m_monitorTreeWidgetItemsList.size();
+    return m_monitorTreeWidgetItemsHash.size();
 }
 
 void Monitor::addMonitorHost(const QString hostName, const QStringList parameters, LookupType option)
@@ -106,12 +123,26 @@ void Monitor::addMonitorHost(const QString hostName, const QStringList parameter
     hostThread->setIcon(2, QIcon::fromTheme("media-playback-start",
                                             QIcon(":/images/images/media-playback-start.png")));
     hostThread->setText(2, "Scanning");
-    m_monitorTreeWidgetItemsList.push_front(hostThread);
-    // start indeterminate progress bar
-    m_monitorWidget->scanProgressBar->setMaximum(0);
+    m_monitorTreeWidgetItemsHash.insert(hostName, hostThread);
+
+    m_monitorWidget->scanProgressBar->setMaximum(100);
+
+    if (!m_batchTimer.isValid()) {
+        m_batchTimer.start();
+        m_metrics.startBatch();
+        m_nmapPath = ProgramPaths::path("nmap");
+    }
+
+    m_hostQueueHash.insert(hostName, m_batchTimer.elapsed());
+
+    if (!m_refreshTimer->isActive()) {
+        m_refreshTimer->start();
+    }
 
     emit monitorUpdated(monitorHostNumber());
 
+    m_journal.queued(hostName, parameters);
+
     // Start Scan for host
     m_hostIdList.insert(hostName, m_idCounter);
     ++m_idCounter;
@@ -182,16 +213,72 @@ void Monitor::cacheRepeat()
 
 void Monitor::startScan(const QString hostname, QStringList parameters)
 {
+    m_journal.started(hostname);
+
+    if (m_hostQueueHash.contains(hostname)) {
+        m_metrics.addDispatchTime(m_batchTimer.elapsed() - m_hostQueueHash.take(hostname));
+    }
+
+    ScanResultCache::Result result;
+
+    if (m_resultCache.find(hostname, parameters, result)) {
+        if (m_hostJobHash.contains(hostname)) {
+            m_controlServer->hostStarted(m_hostJobHash.value(hostname), hostname);
+        }
+
+        // without a start time the ETA doesn't count the reused hosts
+        m_reusedResultHash.insert(hostname, qMakePair(parameters, result));
+        QMetaObject::invokeMethod(this, "reuseScanResult", Qt::QueuedConnection,
+                                  Q_ARG(QString, hostname));
+        return;
+    }
+
+    if (m_tuneTiming) {
+        // timing options from the past scans of the segment
+        parameters = m_timingAdvisor.tune(hostname, parameters);
+
+        QTreeWidgetItem* item = m_monitorTreeWidgetItemsHash.value(hostname);
+        if (item) {
+            item->setText(1, parameters.join(" "));
+        }
+    }
+
+    bool isStatsEveryPresent = false;
+    for (const QString& parameter : parameters) {
+        if (parameter.startsWith(QLatin1String("--stats-every"))) {
+            isStatsEveryPresent = true;
+            break;
+        }
+    }
+
+    if (!isStatsEveryPresent) {
+        // periodic timing lines for the monitor progress
+        parameters << "--stats-every" << "5s";
+        m_statsEveryHostsSet.insert(hostname);
+    }
+
     parameters.append(hostname); // add hostname
+    m_hostStartHash.insert(hostname, m_batchTimer.elapsed());
+
+    if (m_hostJobHash.contains(hostname)) {
+        m_controlServer->hostStarted(m_hostJobHash.value(hostname), hostname);
+    }
+
+    // queued hosts don't have a progress bar, thousands of widgets are slow
+    QProgressBar* hostProgressBar = new QProgressBar();
+    hostProgressBar->setRange(0, 100);
+    hostProgressBar->setValue(0);
+    m_monitorWidget->scanMonitor->setItemWidget(m_monitorTreeWidgetItemsHash.value(hostname), 3, hostProgressBar);
 
     // start scan Thread
-    QPointer<ProcessThread> thread = new ProcessThread("nmap", parameters);
+    QPointer<ProcessThread> thread = new ProcessThread(m_nmapPath, parameters);
     m_scanThreadHashList.insert(hostname, thread);
+    m_jobHostHash.insert(thread->jobId(), hostname);
     // read current data scan from the thread
     connect(thread, &ProcessThread::flowFromThread,
             this, &Monitor::readFlowFromThread);
     // read scan data return
-    connect(thread, &ProcessThread::dataIsReady,
+    connect(thread, &ProcessThread::threadEnd,
             this, &Monitor::scanFinisced);
     // start scan
     thread->start();
@@ -233,24 +320,111 @@ void Monitor::startLookup(const QString hostname, LookupType option)
     }
 }
 
-void Monitor::scanFinisced(const QStringList parameters, QByteArray errorBuffer)
+void Monitor::scanFinisced(const ScanOutput& output)
 {
-    QString hostName(parameters[parameters.size() - 1]);
+    if (!m_jobHostHash.contains(output.jobId())) {
+        return;
+    }
+
+    // canceled jobs send their partial output too
+    const QString hostName = m_jobHostHash.take(output.jobId());
+    QStringList parserParameters(output.parameters());
+
+    if (m_statsEveryHostsSet.remove(hostName)) {
+        // don't show the monitor option in the scan parameters
+        const int index = parserParameters.indexOf("--stats-every");
+        if (index != -1 && index + 1 < parserParameters.size()) {
+            parserParameters.removeAt(index + 1);
+            parserParameters.removeAt(index);
+        }
+    }
+
+    qint64 scanDuration = -1;
+
+    if (m_hostStartHash.contains(hostName)) {
+        scanDuration = m_batchTimer.elapsed() - m_hostStartHash.take(hostName);
+        m_completedHostsCount++;
+        m_completedDuration += scanDuration;
+        m_completedPorts += m_hostProgressHash.value(hostName).scannedPorts();
+    }
 
     /*
      * Remove host scan finisced from the monitor list.
      */
     delMonitorHost(hostName);
+    m_journal.finished(hostName);
 
     m_parallelThreadLimitValue++;
 
     /*
      * Start Scan parser
      */
-    m_ui->m_parser->startParser(parameters,
-                                m_scanHashListRealtime.value(hostName).first,
-                                errorBuffer,
+    PObject* object = m_ui->m_parser->startParser(parserParameters,
+                                output.output(),
+                                output.errors(),
                                 m_hostIdList.value(hostName));
+
+    if (object && scanDuration != -1) {
+        m_resultCache.insert(hostName, parserParameters, output.output(), output.errors());
+
+        const TimingAdvisor::TimingSample sample = TimingAdvisor::readSample(output.output(), scanDuration / 1000.0);
+        // down hosts don't say anything about the segment
+        if (sample.latency >= 0 || sample.timedOut) {
+            m_timingAdvisor.addSample(hostName, parserParameters, sample);
+        }
+    }
+
+    ProcessThread* thread = takeMonitorElem(hostName);
+
+    // reused results don't have a process
+    if (thread && scanDuration != -1) {
+        ScanMetrics::JobMetrics job;
+        job.host = hostName;
+        job.profile = TimingAdvisor::profileKey(parserParameters);
+        job.process = thread->metrics();
+        job.parseTime = object ? m_ui->m_parser->lastParseTime() : 0;
+        m_metrics.addJob(job);
+    }
+
+    // the thread and the output of a finished host are not kept until the batch end,
+    // threadEnd is sent at the end of run()
+    if (thread) {
+        thread->wait();
+        delete thread;
+    }
+
+    if (hostName != m_detailsHostName) {
+        delete m_scanHashListRealtime.take(hostName);
+    }
+
+    // without the dbus adaptor nobody reads the JSON
+    if (object && receivers(SIGNAL(hostCompleted(QString,QString))) > 0) {
+        const QJsonDocument result(ScanResultWriter::toJson(object, false));
+        emit hostCompleted(hostName, QString::fromUtf8(result.toJson(QJsonDocument::Compact)));
+    }
+
+    if (m_hostJobHash.contains(hostName)) {
+        if (object) {
+            m_controlServer->hostFinished(m_hostJobHash.take(hostName), hostName, ScanResultWriter::toJson(object, false));
+        } else {
+            m_controlServer->hostFailed(m_hostJobHash.take(hostName), hostName, QString::fromLocal8Bit(output.errors()).trimmed());
+        }
+    }
+
+    if (!monitorHostNumber()) {
+        // all scans are completed
+        m_monitorWidget->scanProgressBar->setMaximum(100);
+        m_monitorWidget->monitorStopAllScanButt->setEnabled(false);
+        m_monitorWidget->monitorStopCurrentScanButt->setEnabled(false);
+        m_monitorWidget->monitorDetailsScanButt->setEnabled(false);
+        m_ui->m_mainTabWidget->setTabIcon(m_ui->m_mainTabWidget->indexOf(m_monitorWidget),
+                                QIcon(QString::fromUtf8(":/images/images/utilities-system-monitor.png")));
+        Notify::clearButtonNotify(m_ui->m_collections->m_collectionsButton.value("scan-sez"));
+        m_metrics.finishBatch();
+        clearHostMonitor();
+        m_journal.clear();
+        emit queueFinished();
+    }
 }
 
 void Monitor::lookupFinisced(QHostInfo info, int state, const QString hostname)
@@ -274,13 +448,10 @@ void Monitor::lookupFinisced(QHostInfo info, int state, const QString hostname)
 
 void Monitor::delMonitorHost(const QString hostName)
 {
-    for (int i = 0; i < m_monitorTreeWidgetItemsList.size(); i++) {
-        if (m_monitorTreeWidgetItemsList[i]->text(0) == hostName) {
-            // remove host from monitor and list.
-            delete m_monitorTreeWidgetItemsList.takeAt(i);
-            break;
-        }
-    }
+    // remove host from monitor and hash.
+    delete m_monitorTreeWidgetItemsHash.take(hostName);
+    m_hostProgressHash.remove(hostName);
+    m_dirtyHostsSet.remove(hostName);
 
     emit monitorUpdated(monitorHostNumber());
 }
@@ -289,19 +460,18 @@ void Monitor::updateMonitorHost(const QString hostName, int valueIndex, const QS
 {
     Q_ASSERT(valueIndex < m_monitorWidget->scanMonitor->columnCount());
 
-    QList<QTreeWidgetItem*>::const_iterator i;
-    for (i = m_monitorTreeWidgetItemsList.constBegin(); i != m_monitorTreeWidgetItemsList.constEnd(); ++i) {
-        if ((*i)->text(0) == hostName) {
-            (*i)->setText(valueIndex, newData);
-        }
+    QTreeWidgetItem* item = m_monitorTreeWidgetItemsHash.value(hostName);
 
-        break;
+    if (item && item->text(valueIndex) != newData) {
+        item->setText(valueIndex, newData);
     }
 }
 
 void Monitor::clearHostMonitor()
 {
     memory::freemap<QString, ProcessThread*>::itemDeleteAllWithWait(m_scanThreadHashList);
+    // threadEnd of the deleted threads is still queued, scanFinisced drops it
+    m_jobHostHash.clear();
     memory::freelist<LookupManager*>::itemDeleteAllWithWait(m_internealLookupList);
     memory::freelist<DigManager*>::itemDeleteAll(m_digLookupPointersList);
 
@@ -311,18 +481,156 @@ void Monitor::clearHostMonitor()
 
     m_firstScanCacheList.clear();
     m_secondScanCacheList.clear();
+    m_reusedResultHash.clear();
 
     m_isHostcached = false;
     updateMaxParallelScan();
 
-    memory::freelist<QTreeWidgetItem*>::itemDeleteAll(m_monitorTreeWidgetItemsList);
+    memory::freemap<QString, QTreeWidgetItem*>::itemDeleteAll(m_monitorTreeWidgetItemsHash);
+    m_hostProgressHash.clear();
+    m_dirtyHostsSet.clear();
+    m_statsEveryHostsSet.clear();
+    m_hostStartHash.clear();
+    m_hostQueueHash.clear();
+    m_refreshTimer->stop();
     m_hostIdList.clear();
+
+    // a new scan batch starts from zero
+    m_timingAdvisor.save();
+    m_batchTimer.invalidate();
+    m_completedHostsCount = 0;
+    m_aggregatePercent = 0;
+    m_completedDuration = 0;
+    m_completedPorts = 0.0;
 }
 
 void Monitor::updateMaxParallelScan()
 {
     QSettings settings("nmapsi4", "nmapsi4");
     m_parallelThreadLimitValue = settings.value("maxParallelScan", 5).toInt();
+    m_maxParallelScan = m_parallelThreadLimitValue;
+}
+
+void Monitor::updateTimingTuning()
+{
+    QSettings settings("nmapsi4", "nmapsi4");
+    m_tuneTiming = settings.value("tuneTiming", false).toBool();
+}
+
+void Monitor::updateResultCache()
+{
+    QSettings settings("nmapsi4", "nmapsi4");
+    m_resultCache.setFreshness(settings.value("resultCacheMinutes", 5).toInt() * 60);
+}
+
+int Monitor::interruptedHostsNumber() const
+{
+    return m_journal.pendingNumber();
+}
+
+void Monitor::resumeInterruptedHosts()
+{
+    const QList<ScanJournal::Job> jobs = m_journal.pendingJobs();
+    // the hosts are journaled again by the queue
+    m_journal.clear();
+
+    // consecutive hosts with the same parameters are queued together
+    QStringList hosts;
+    QStringList parameters;
+
+    for (const ScanJournal::Job& job : jobs) {
+        if (!hosts.isEmpty() && job.parameters != parameters) {
+            enqueueHosts(hosts, parameters.join(" "));
+            hosts.clear();
+        }
+
+        hosts.append(job.host);
+        parameters = job.parameters;
+    }
+
+    if (!hosts.isEmpty()) {
+        enqueueHosts(hosts, parameters.join(" "));
+    }
+}
+
+void Monitor::discardInterruptedHosts()
+{
+    if (!monitorHostNumber()) {
+        m_journal.clear();
+    }
+}
+
+ScanMetrics& Monitor::metrics()
+{
+    return m_metrics;
+}
+
+void Monitor::updateControlServer()
+{
+    QSettings settings("nmapsi4", "nmapsi4");
+    const int port = settings.value("controlServerPort", 0).toInt();
+
+    if (m_controlServer && m_controlServer->serverPort() == port) {
+        return;
+    }
+
+    // jobs of the old server are not reported
+    delete m_controlServer;
+    m_controlServer = 0;
+    m_hostJobHash.clear();
+
+    if (!port) {
+        return;
+    }
+
+    m_controlServer = new ControlServer(this);
+    m_controlServer->setUserId(m_ui->userId());
+    m_controlServer->setMetrics(&m_metrics);
+
+    if (!m_controlServer->listen(port)) {
+        qWarning("Monitor:: control server error: %s", qPrintable(m_controlServer->errorString()));
+        delete m_controlServer;
+        m_controlServer = 0;
+        return;
+    }
+
+    connect(m_controlServer, &ControlServer::jobSubmitted,
+            this, &Monitor::controlJobSubmitted);
+    connect(m_controlServer, &ControlServer::jobCanceled,
+            this, &Monitor::controlJobCanceled);
+}
+
+void Monitor::controlJobSubmitted(int jobId, const QStringList& targets, const QStringList& parameters)
+{
+    // the parameters are checked by the server
+    const QStringList acceptedHosts = queueTargets(targets, parameters.join(" "));
+    const QSet<QString> acceptedSet = acceptedHosts.toSet();
+
+    for (const QString& target : targets) {
+        const QString hostName = HostTools::clearHost(target.trimmed());
+
+        if (acceptedSet.contains(hostName) && !m_hostJobHash.contains(hostName)) {
+            m_hostJobHash.insert(hostName, jobId);
+            m_controlServer->hostQueued(jobId, hostName);
+        } else {
+            m_controlServer->hostRejected(jobId, target, QLatin1String("invalid or already scanning"));
+        }
+    }
+}
+
+void Monitor::controlJobCanceled(int jobId)
+{
+    const QStringList hostList = m_hostJobHash.keys(jobId);
+
+    for (const QString& hostName : hostList) {
+        // a running host sends its partial result
+        if (!m_scanThreadHashList.contains(hostName)) {
+            m_hostJobHash.remove(hostName);
+            m_controlServer->hostFailed(jobId, hostName, QLatin1String("canceled"));
+        }
+
+        cancelHost(hostName);
+    }
 }
 
 void Monitor::monitorRuntimeEvent()
@@ -338,7 +646,13 @@ void Monitor::monitorRuntimeEvent()
 
 void Monitor::clearHostMonitorDetails()
 {
-    m_scanHashListRealtime.clear();
+    // the open details dialog reads its buffer
+    ScanOutputBuffer* detailsBuffer = m_scanHashListRealtime.take(m_detailsHostName);
+    memory::freemap<QString, ScanOutputBuffer*>::itemDeleteAll(m_scanHashListRealtime);
+
+    if (detailsBuffer) {
+        m_scanHashListRealtime.insert(m_detailsHostName, detailsBuffer);
+    }
 }
 
 ProcessThread* Monitor::takeMonitorElem(const QString hostName)
@@ -353,9 +667,18 @@ void Monitor::stopSelectedScan()
         return;
     }
 
-    const QString& hostname = m_monitorWidget->scanMonitor->selectedItems()[0]->text(0);
+    cancelHost(m_monitorWidget->scanMonitor->selectedItems()[0]->text(0));
+}
+
+bool Monitor::cancelHost(const QString& hostName)
+{
+    if (!isHostOnMonitor(hostName)) {
+        return false;
+    }
 
-    ProcessThread *ptrTmp = takeMonitorElem(hostname);
+    ProcessThread *ptrTmp = takeMonitorElem(hostName);
+    // a canceled host is not resumed
+    m_journal.finished(hostName);
 
     qDebug() << "Monitor:: pointer not in list:: " << ptrTmp;
 
@@ -365,10 +688,19 @@ void Monitor::stopSelectedScan()
         delete ptrTmp;
 
         // Remove Qhash entry for stopped scan
-        m_scanHashListRealtime.take(hostname);
+        delete m_scanHashListRealtime.take(hostName);
+        m_hostStartHash.remove(hostName);
+        m_statsEveryHostsSet.remove(hostName);
     } else {
+        if (m_reusedResultHash.remove(hostName)) {
+            // the slot of the scan is free again
+            m_parallelThreadLimitValue++;
+        }
+
+        m_hostQueueHash.remove(hostName);
+
         for (int i = 0; i < m_firstScanCacheList.size(); ++i) {
-            if (m_firstScanCacheList[i].first == hostname) {
+            if (m_firstScanCacheList[i].first == hostName) {
                 // Remove stopped host from cache
                 m_firstScanCacheList.removeAt(i);
                 m_secondScanCacheList.removeAt(i);
@@ -377,13 +709,144 @@ void Monitor::stopSelectedScan()
         }
 
         // delete QTreeWidgetItem for removed host
-        delMonitorHost(hostname);
+        delMonitorHost(hostName);
+    }
+
+    return true;
+}
+
+void Monitor::cancelAll()
+{
+    stopAllScan();
+}
+
+QStringList Monitor::enqueueTargets(const QStringList& targets, const QString& profile)
+{
+    QString parameters;
+
+    if (!ScanProfiles::parameters(profile, m_ui->userId(), parameters)) {
+        qWarning("Monitor:: unknown profile %s", qPrintable(profile));
+        return QStringList();
+    }
+
+    return queueTargets(targets, parameters);
+}
+
+QStringList Monitor::enqueueTargetsWithParameters(const QStringList& targets, const QString& parameters)
+{
+    QString error;
+
+    // nmap can run as root, other programs don't read or write files with it
+    if (!NmapOptions::checkRemoteParameters(parameters.split(' ', QString::SkipEmptyParts), error)) {
+        qWarning("Monitor:: parameters refused, %s", qPrintable(error));
+        return QStringList();
+    }
+
+    return queueTargets(targets, parameters);
+}
+
+QStringList Monitor::queueTargets(const QStringList& targets, const QString& parameters)
+{
+    QStringList hosts;
+
+    for (const QString& target : targets) {
+        const QString hostName = HostTools::clearHost(target.trimmed());
+
+        // same checks of the scan bar
+        if (!hostName.isEmpty() && (!HostTools::isDns(hostName) || HostTools::isValidDns(hostName))) {
+            hosts.append(hostName);
+        }
     }
+
+    return enqueueHosts(hosts, parameters);
+}
+
+QStringList Monitor::enqueueHosts(const QStringList& hosts, const QString& parameters)
+{
+    QStringList acceptedHosts;
+    const QStringList parameterList = parameters.split(' ', QString::SkipEmptyParts);
+
+    for (const QString& hostName : hosts) {
+        if (isHostOnMonitor(hostName)) {
+            continue;
+        }
+
+        QStringList hostParameters(parameterList);
+        quint32 address;
+
+        // ipv6 addresses are the only targets with a colon
+        if (hostName.contains(QLatin1Char(':')) && !hostParameters.contains("-6")) {
+            hostParameters << "-6";
+        } else if (TargetParser::readIpv4(hostName, address)) {
+            hostParameters.removeAll("-6");
+        }
+
+        addMonitorHost(hostName, hostParameters, static_cast<LookupType>(m_ui->lookupType()));
+        acceptedHosts.append(hostName);
+    }
+
+    if (!acceptedHosts.isEmpty()) {
+        m_monitorWidget->monitorStopAllScanButt->setEnabled(true);
+        m_ui->m_collections->disableSaveActions();
+        Notify::startButtonNotify(m_ui->m_collections->m_collectionsButton.value("scan-sez"));
+    }
+
+    return acceptedHosts;
+}
+
+QString Monitor::queueState()
+{
+    QJsonArray runningHosts;
+
+    // started hosts, the reused results don't have a thread
+    QHash<QString, qint64>::const_iterator i;
+    for (i = m_hostStartHash.constBegin(); i != m_hostStartHash.constEnd(); ++i) {
+        const ProgressState& state = m_hostProgressHash.value(i.key());
+        QTreeWidgetItem* item = m_monitorTreeWidgetItemsHash.value(i.key());
+
+        QJsonObject host;
+        host.insert("host", i.key());
+        host.insert("parameters", item ? item->text(1) : QString());
+        host.insert("phase", state.phase);
+        host.insert("percent", state.progress);
+        host.insert("phases", state.phaseCount);
+        host.insert("remaining", state.remainingSeconds);
+        runningHosts.append(host);
+    }
+
+    QJsonArray queuedHosts;
+
+    for (const QPair<QString, QStringList>& scan : m_firstScanCacheList) {
+        queuedHosts.append(scan.first);
+    }
+
+    QJsonObject queue;
+    queue.insert("running", runningHosts);
+    queue.insert("queued", queuedHosts);
+    queue.insert("completed", m_completedHostsCount);
+    queue.insert("progress", m_aggregatePercent);
+
+    return QString::fromUtf8(QJsonDocument(queue).toJson(QJsonDocument::Compact));
 }
 
 void Monitor::stopAllScan()
 {
+    // the output of the stopped scans is dropped, the server jobs are told here
+    if (m_controlServer) {
+        QHash<QString, int>::const_iterator i;
+        for (i = m_hostJobHash.constBegin(); i != m_hostJobHash.constEnd(); ++i) {
+            m_controlServer->hostFailed(i.value(), i.key(), QLatin1String("canceled"));
+        }
+    }
+
+    m_hostJobHash.clear();
+
+    // a stopped batch is still reported in the metrics
+    m_metrics.finishBatch();
+    m_journal.clear();
     clearHostMonitor();
+
+    emit queueStopped();
 }
 
 void Monitor::showSelectedScanDetails()
@@ -391,64 +854,195 @@ void Monitor::showSelectedScanDetails()
     if (m_monitorWidget->scanMonitor->selectedItems().isEmpty()) {
         return;
     }
+    const QString& hostname = m_monitorWidget->scanMonitor->selectedItems()[0]->text(0);
+    ScanOutputBuffer*& buffer = m_scanHashListRealtime[hostname];
+
+    if (!buffer) {
+        // waiting host, the details follow the scan when it starts
+        buffer = new ScanOutputBuffer(this);
+    }
+
     // start details UI
-    MonitorDetails* details = new MonitorDetails(
-        m_scanHashListRealtime.operator[](m_monitorWidget->scanMonitor->selectedItems()[0]->text(0)).second,
-        m_monitorWidget->scanMonitor->selectedItems()[0]->text(0), m_ui);
+    MonitorDetails* details = new MonitorDetails(buffer, hostname, m_ui);
+    m_detailsHostName = hostname;
 
     details->exec();
 
     if (details) {
         delete details;
     }
+
+    m_detailsHostName.clear();
+
+    if (!isHostOnMonitor(hostname)) {
+        // finished while the dialog was open
+        delete m_scanHashListRealtime.take(hostname);
+    }
+}
+
+void Monitor::showScanMetrics()
+{
+    QPointer<ScanMetricsDialog> dialog = new ScanMetricsDialog(m_metrics, m_ui);
+
+    dialog->exec();
+
+    if (dialog) {
+        delete dialog;
+    }
 }
 
-void Monitor::readFlowFromThread(const QString hostname, QByteArray lineData)
+void Monitor::reuseScanResult(const QString& hostName)
+{
+    if (!m_reusedResultHash.contains(hostName)) {
+        // canceled before the event loop
+        return;
+    }
+
+    const QPair<QStringList, ScanResultCache::Result> reusedResult = m_reusedResultHash.take(hostName);
+
+    QStringList parameters(reusedResult.first);
+    parameters.append(hostName);
+
+    // a job without a process, the cached buffers are shared
+    const ScanOutput output(ScanOutput::nextJobId(), parameters, reusedResult.second.output, reusedResult.second.errors);
+    m_jobHostHash.insert(output.jobId(), hostName);
+    scanFinisced(output);
+}
+
+void Monitor::readFlowFromThread(int jobId, const QByteArray& lineData)
 {
     /*
      * read data line form thread
      */
-    QHash<QString, QPair<QByteArray,QStringList> >::const_iterator i = m_scanHashListRealtime.find(hostname);
+    const QString hostname = m_jobHostHash.value(jobId);
+
+    if (hostname.isEmpty()) {
+        return;
+    }
+
+    ScanOutputBuffer*& buffer = m_scanHashListRealtime[hostname];
+
+    if (!buffer) {
+        buffer = new ScanOutputBuffer(this);
+    }
+
+    buffer->append(lineData);
+    updateHostProgress(hostname, lineData);
+}
+
+void Monitor::updateHostProgress(const QString& hostName, const QByteArray& lineData)
+{
+    // most of the output is not a progress line, skip it with a few searches
+    if (!ProgressParser::hasProgress(lineData)) {
+        return;
+    }
+
+    ProgressState state = m_hostProgressHash.value(hostName);
+    bool isUpdated = false;
+
     QTextStream stream(lineData);
+    while (!stream.atEnd()) {
+        ProgressEvent event;
+        if (ProgressParser::parseLine(stream.readLine(), event)) {
+            state.apply(event);
+            isUpdated = true;
+        }
+    }
+
+    if (!isUpdated) {
+        return;
+    }
 
-    if (i == m_scanHashListRealtime.constEnd()) {
-        QPair<QByteArray, QStringList> dataElement;
-        dataElement.first.append(lineData);
+    m_hostProgressHash.insert(hostName, state);
+    m_dirtyHostsSet.insert(hostName);
+}
 
-        while (!stream.atEnd()) {
-            QString currentLine(stream.readLine());
-            findRemainingTime(currentLine,hostname);
-            dataElement.second.append(currentLine);
+void Monitor::refreshMonitor()
+{
+    QElapsedTimer updateTimer;
+    updateTimer.start();
+
+    for (const QString& hostName : m_dirtyHostsSet) {
+        QTreeWidgetItem* item = m_monitorTreeWidgetItemsHash.value(hostName);
+
+        if (!item) {
+            continue;
         }
 
-        m_scanHashListRealtime.insert(hostname, dataElement);
-    } else {
-        // append scan flow values
-        while (i != m_scanHashListRealtime.constEnd() && i.key() == hostname) {
+        const ProgressState& state = m_hostProgressHash.value(hostName);
+        QString text(state.phase);
 
-            QPair<QByteArray, QStringList> dataElement = i.value();
-            dataElement.first.append(lineData);
+        if (state.remainingSeconds > 0) {
+            text += " - " + ProgressParser::formatDuration(state.remainingSeconds) + ' ' + tr("remaining");
+        }
 
-            while (!stream.atEnd()) {
-                QString currentLine(stream.readLine());
-                findRemainingTime(currentLine,hostname);
-                dataElement.second.append(currentLine);
-            }
+        updateMonitorHost(hostName, 2, text);
 
-            m_scanHashListRealtime.insert(i.key(), dataElement);
-            ++i;
+        QProgressBar* hostProgressBar = qobject_cast<QProgressBar*>(m_monitorWidget->scanMonitor->itemWidget(item, 3));
+        if (hostProgressBar) {
+            hostProgressBar->setValue(qRound(state.progress));
         }
     }
+
+    m_dirtyHostsSet.clear();
+    updateAggregateProgress();
+    m_metrics.addUpdateTime(updateTimer.elapsed());
+
+    if (!monitorHostNumber()) {
+        m_refreshTimer->stop();
+    }
 }
 
-void Monitor::findRemainingTime(const QString& textLine, const QString& hostName)
+void Monitor::updateAggregateProgress()
 {
-    if (textLine.contains("remaining") || textLine.contains("ETC")) {
-        QString cleanLine = textLine.mid(textLine.indexOf("("), textLine.indexOf(")"));
-        cleanLine = cleanLine.remove('(');
-        cleanLine = cleanLine.remove(')');
-        cleanLine.remove('\n');
-        // insert new information into monitor
-        updateMonitorHost(hostName, 2, cleanLine);
+    if (!m_batchTimer.isValid()) {
+        return;
     }
+
+    const qint64 batchElapsed = m_batchTimer.elapsed();
+    const int averageDuration = m_completedHostsCount ? (m_completedDuration / 1000) / m_completedHostsCount : -1;
+
+    double runningPercent = 0.0;
+    double runningPorts = 0.0;
+    int runningRemaining = 0;
+    int maxRemaining = 0;
+
+    QHash<QString, qint64>::const_iterator i;
+    for (i = m_hostStartHash.constBegin(); i != m_hostStartHash.constEnd(); ++i) {
+        const ProgressState& state = m_hostProgressHash.value(i.key());
+        runningPercent += state.progress;
+        runningPorts += state.scannedPorts();
+
+        int remaining = state.remainingSeconds;
+        if (remaining < 0) {
+            const int hostElapsed = (batchElapsed - i.value()) / 1000;
+            remaining = averageDuration > 0 ? qMax(averageDuration - hostElapsed, 0) : 0;
+        }
+
+        runningRemaining += remaining;
+        maxRemaining = qMax(maxRemaining, remaining);
+    }
+
+    const int totalHosts = m_completedHostsCount + monitorHostNumber();
+    if (totalHosts) {
+        m_aggregatePercent = qRound((m_completedHostsCount * 100 + runningPercent) / totalHosts);
+        m_monitorWidget->scanProgressBar->setValue(m_aggregatePercent);
+    }
+
+    const double elapsedSeconds = qMax(batchElapsed / 1000.0, 1.0);
+    const double portsPerSecond = (m_completedPorts + runningPorts) / elapsedSeconds;
+    const double hostsPerMinute = m_completedHostsCount / (elapsedSeconds / 60.0);
+
+    QString eta("--");
+    const int queuedHosts = m_firstScanCacheList.size();
+    if (!queuedHosts || averageDuration > 0) {
+        const int parallelScan = qMax(m_maxParallelScan, 1);
+        const int seconds = qMax(maxRemaining, (runningRemaining + queuedHosts * qMax(averageDuration, 0)) / parallelScan);
+        eta = ProgressParser::formatDuration(seconds);
+    }
+
+    m_monitorWidget->scanThroughputLabel->setText(tr("%1 ports/s - %2 hosts/min - ETA %3")
+            .arg(portsPerSecond, 0, 'f', 0)
+            .arg(hostsPerMinute, 0, 'f', 1)
+            .arg(eta));
 }
@@ -22,9 +22,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 // Qt include
 #include <QTreeWidget>
+#include <QProgressBar>
 #include <QtCore/QObject>
 #include <QtCore/QList>
 #include <QtCore/QHash>
+#include <QtCore/QSet>
+#include <QtCore/QTimer>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QPair>
 #include <QtCore/QWeakPointer>
 #include <QtCore/QSettings>
@@ -40,6 +44,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "monitorhostscandetails.h"
 #include "lookupmanager.h"
 #include "digmanager.h"
+#include "progressparser.h"
+#include "scanoutputbuffer.h"
+#include "scanprofiles.h"
+#include "scanresultwriter.h"
+#include "controlserver.h"
+#include "targetimporter.h"
+#include "timingadvisor.h"
+#include "scanresultcache.h"
+#include "scanjournal.h"
+#include "scanmetrics.h"
 
 class MainWindow;
 
@@ -71,6 +85,15 @@ public:
      * Add host in the monitor and start scan.
      */
     void addMonitorHost(const QString hostName, const QStringList parameters, LookupType option);
+    /*
+     * Queue hosts already validated, like the blocks of a target list.
+     * Return the hosts not yet in the monitor.
+     */
+    QStringList enqueueHosts(const QStringList& hosts, const QString& parameters);
+    /*
+     * Queue the valid targets, the parameters are trusted
+     */
+    QStringList queueTargets(const QStringList& targets, const QString& parameters);
     /*
      * Return true if host is present in the monitor, otherwise return false.
      */
@@ -91,6 +114,31 @@ public:
      * Load max parallel scan option from config file
      */
     void updateMaxParallelScan();
+    /*
+     * Start or stop the control server with the port of the config file
+     */
+    void updateControlServer();
+    /*
+     * Load the timing tuning option from config file
+     */
+    void updateTimingTuning();
+    /*
+     * Load the freshness of the reused scan results from config file
+     */
+    void updateResultCache();
+    /*
+     * Hosts of the scans not completed by the last run
+     */
+    int interruptedHostsNumber() const;
+    /*
+     * Queue again the interrupted hosts with their parameters
+     */
+    void resumeInterruptedHosts();
+    void discardInterruptedHosts();
+    /*
+     * Resources of the finished scans
+     */
+    ScanMetrics& metrics();
 
     MonitorWidget* m_monitorWidget;
 
@@ -110,31 +158,95 @@ private:
      * Cache for parallel host thread
      */
     void cacheScan(const QString& hostname, const QStringList& parameters, LookupType option, QTreeWidgetItem *item);
-    void findRemainingTime(const QString& textLine, const QString& hostName);
+    /*
+     * Read progress from the new scan output, the monitor row is
+     * updated later by refreshMonitor().
+     */
+    void updateHostProgress(const QString& hostName, const QByteArray& lineData);
+    /*
+     * Update global progress bar, throughput and ETA for running and queued hosts
+     */
+    void updateAggregateProgress();
 
-    QList<QTreeWidgetItem*> m_monitorTreeWidgetItemsList;
+    QHash<QString, QTreeWidgetItem*> m_monitorTreeWidgetItemsHash;
+    QHash<QString, ProgressState> m_hostProgressHash;
+    QSet<QString> m_dirtyHostsSet;
+    QSet<QString> m_statsEveryHostsSet;
+    QHash<QString, qint64> m_hostStartHash;
+    // batch time of the queued hosts, for the dispatch latency
+    QHash<QString, qint64> m_hostQueueHash;
+    QElapsedTimer m_batchTimer;
+    // nmap path of the running batch, read once from the settings
+    QString m_nmapPath;
     QList<LookupManager*> m_internealLookupList;
     QList<DigManager*> m_digLookupPointersList;
     QList< QPair<QString, QStringList> > m_firstScanCacheList;
     QList< QPair<LookupType, QTreeWidgetItem*> > m_secondScanCacheList;
     QHash<QString, ProcessThread*> m_scanThreadHashList;
-    QHash<QString, QPair<QByteArray,QStringList> > m_scanHashListRealtime;
+    // host of the scan jobs, until the output is read
+    QHash<int, QString> m_jobHostHash;
+    QHash<QString, ScanOutputBuffer*> m_scanHashListRealtime;
+    // host of the open details dialog, its output is kept after the scan
+    QString m_detailsHostName;
     QHash<QString, int> m_hostIdList;
     MainWindow* m_ui;
     int m_parallelThreadLimitValue;
+    int m_maxParallelScan;
+    int m_completedHostsCount;
+    int m_aggregatePercent;
+    qint64 m_completedDuration;
+    double m_completedPorts;
     int m_idCounter;
     bool m_isHostcached;
     QTimer* m_timer;
+    QTimer* m_refreshTimer;
+    ControlServer* m_controlServer;
+    TimingAdvisor m_timingAdvisor;
+    bool m_tuneTiming;
+    ScanResultCache m_resultCache;
+    // hosts with a reused result, the parser starts from the event loop
+    QHash<QString, QPair<QStringList, ScanResultCache::Result> > m_reusedResultHash;
+    ScanJournal m_journal;
+    ScanMetrics m_metrics;
+    // hosts of the control server jobs
+    QHash<QString, int> m_hostJobHash;
 
 signals:
     /*
      * Exported with dbus
      */
     Q_SCRIPTABLE void monitorUpdated(int hostNumber);
+    /*
+     * A host scan is parsed, result is the host as compact JSON
+     */
+    Q_SCRIPTABLE void hostCompleted(const QString& hostName, const QString& result);
+    Q_SCRIPTABLE void queueFinished();
+    /*
+     * All the scans are stopped by the user
+     */
+    void queueStopped();
+
+public slots:
+    /*
+     * Exported with dbus, queue the targets with the parameters of
+     * a default or saved profile. Return the accepted hosts.
+     */
+    QStringList enqueueTargets(const QStringList& targets, const QString& profile);
+    /*
+     * Exported with dbus, the parameters can't have unknown options
+     * or options with local files.
+     */
+    QStringList enqueueTargetsWithParameters(const QStringList& targets, const QString& parameters);
+    /*
+     * Running and queued hosts with their progress as compact JSON
+     */
+    QString queueState();
+    bool cancelHost(const QString& hostName);
+    void cancelAll();
 
 private slots:
-    void readFlowFromThread(const QString hostname, QByteArray lineData);
-    void scanFinisced(const QStringList parameters, QByteArray errorBuffer);
+    void readFlowFromThread(int jobId, const QByteArray& lineData);
+    void scanFinisced(const ScanOutput& output);
     void lookupFinisced(QHostInfo info, int state, const QString hostname);
     void cacheRepeat();
     /*
@@ -143,7 +255,18 @@ private slots:
     void stopSelectedScan();
     void stopAllScan();
     void showSelectedScanDetails();
+    void showScanMetrics();
     void monitorRuntimeEvent();
+    /*
+     * Write the changed host progress into the monitor with a fixed rate
+     */
+    void refreshMonitor();
+    void controlJobSubmitted(int jobId, const QStringList& targets, const QStringList& parameters);
+    void controlJobCanceled(int jobId);
+    /*
+     * Parse a reused result like the output of a finished scan
+     */
+    void reuseScanResult(const QString& hostName);
 };
 
 #endif
@@ -17,62 +17,209 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "monitorhostscandetails.h"
 
-MonitorDetails::MonitorDetails(QStringList& processFlow, const QString hostname, QWidget* parent)
-    : QDialog(parent), m_scanLines(processFlow)
+namespace
 {
-    setupUi(this);
-    monitorEditHostname->setText(hostname);
-    m_itemsSize = processFlow.size();
-    m_timer = new QTimer(this);
-    connect(monitorCloseButt, &QPushButton::clicked, this, &MonitorDetails::close);
-    connect(monitorReloadButt, &QPushButton::clicked, this, &MonitorDetails::reloadFlow);
-    connect(m_timer, &QTimer::timeout, this, &MonitorDetails::reloadFlow);
-    loadFlow();
+// lines kept in the view
+const int maxViewLines = 2000;
+// lines loaded for every seek back request
+const int olderLinesStep = 500;
 }
 
-MonitorDetails::~MonitorDetails()
+MonitorDetailsModel::MonitorDetailsModel(ScanOutputBuffer* buffer, int capacity, QObject* parent)
+    : QAbstractListModel(parent), m_buffer(buffer), m_lines(capacity)
+{
+}
+
+MonitorDetailsModel::~MonitorDetailsModel()
+{
+}
+
+int MonitorDetailsModel::rowCount(const QModelIndex& parent) const
 {
-    memory::freelist<QListWidgetItem*>::itemDeleteAll(m_itemsList);
-    m_timer->stop();
-    delete m_timer;
+    if (parent.isValid()) {
+        return 0;
+    }
+
+    return m_lines.count();
 }
 
-void MonitorDetails::loadFlow()
+QVariant MonitorDetailsModel::data(const QModelIndex& index, int role) const
 {
-    for (const QString & token : m_scanLines) {
-        QListWidgetItem *item_ = new QListWidgetItem(detailsListW);
-        m_itemsList.push_back(item_);
+    if (!index.isValid() || index.row() >= m_lines.count()) {
+        return QVariant();
+    }
+
+    const QString& token = m_lines.at(m_lines.firstIndex() + index.row());
+
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::ToolTipRole:
+        return token;
+    case Qt::ForegroundRole:
         if (token.contains("open")) {
-            item_->setForeground(QBrush(QColor(0, 0, 255, 127)));
+            return QBrush(QColor(0, 0, 255, 127));
         } else if (token.contains("closed")) {
-            item_->setForeground(QBrush(QColor(255, 0, 0, 127)));
+            return QBrush(QColor(255, 0, 0, 127));
         } else if (token.contains("filtered") || token.contains("unfiltered")) {
-            item_->setForeground(QBrush(QColor(255, 134, 12, 127)));
+            return QBrush(QColor(255, 134, 12, 127));
         }
+        break;
+    default:
+        break;
+    }
+
+    return QVariant();
+}
+
+bool MonitorDetailsModel::isTailLoaded() const
+{
+    if (!m_buffer) {
+        return true;
+    }
+
+    return m_lines.isEmpty() ? !m_buffer->lineCount() : m_lines.lastIndex() == m_buffer->lineCount() - 1;
+}
+
+void MonitorDetailsModel::loadTail()
+{
+    if (!m_buffer) {
+        return;
+    }
+
+    beginResetModel();
+    m_lines.clear();
+
+    const int lineCount = m_buffer->lineCount();
+    const int firstLine = qMax(m_buffer->firstLine(), lineCount - m_lines.capacity());
 
-        item_->setText(token);
+    for (int index = firstLine; index < lineCount; ++index) {
+        if (m_lines.isEmpty()) {
+            m_lines.insert(index, m_buffer->line(index));
+        } else {
+            m_lines.append(m_buffer->line(index));
+        }
     }
 
-    // Start QTimer for automatic reload
-    m_timer->start(4000);
+    endResetModel();
 }
 
-void MonitorDetails::reloadFlow()
+void MonitorDetailsModel::loadOlder(int count)
 {
-    if (m_itemsSize < m_scanLines.size()) {
-        for (int i = m_itemsSize; i < m_scanLines.size(); ++i) {
-            QListWidgetItem *item_ = new QListWidgetItem(detailsListW);
-            m_itemsList.push_back(item_);
-            if (m_scanLines[i].contains("open")) {
-                item_->setForeground(QBrush(QColor(0, 0, 255, 127)));
-            } else if (m_scanLines[i].contains("closed")) {
-                item_->setForeground(QBrush(QColor(255, 0, 0, 127)));
-            } else if (m_scanLines[i].contains("filtered") || m_scanLines[i].contains("unfiltered")) {
-                item_->setForeground(QBrush(QColor(255, 134, 12, 127)));
-            }
-
-            item_->setText(m_scanLines[i]);
+    // the oldest lines are dropped by the buffer too
+    if (!m_buffer || m_lines.isEmpty() || m_lines.firstIndex() <= m_buffer->firstLine()) {
+        return;
+    }
+
+    const int firstLine = qMax(m_buffer->firstLine(), m_lines.firstIndex() - count);
+    const int newLines = m_lines.firstIndex() - firstLine;
+    const int overflow = qMax(0, m_lines.count() + newLines - m_lines.capacity());
+
+    // the window is full, drop lines from the bottom
+    if (overflow) {
+        beginRemoveRows(QModelIndex(), m_lines.count() - overflow, m_lines.count() - 1);
+        for (int index = 0; index < overflow; ++index) {
+            m_lines.removeLast();
         }
-        m_itemsSize = m_scanLines.size();
+        endRemoveRows();
+    }
+
+    beginInsertRows(QModelIndex(), 0, newLines - 1);
+    for (int index = m_lines.firstIndex() - 1; index >= firstLine; --index) {
+        m_lines.prepend(m_buffer->line(index));
+    }
+    endInsertRows();
+}
+
+bool MonitorDetailsModel::appendLines(int firstLine, int count)
+{
+    if (!m_buffer || (!m_lines.isEmpty() && m_lines.lastIndex() + 1 != firstLine)) {
+        return false;
+    }
+
+    if (m_lines.isEmpty()) {
+        loadTail();
+        return true;
     }
+
+    const int newLines = qMin(count, m_lines.capacity());
+    const int startLine = firstLine + count - newLines;
+
+    if (startLine != firstLine) {
+        // more new lines than the window, restart from the tail
+        loadTail();
+        return true;
+    }
+
+    const int overflow = qMax(0, m_lines.count() + newLines - m_lines.capacity());
+
+    // the window is full, drop lines from the top
+    if (overflow) {
+        beginRemoveRows(QModelIndex(), 0, overflow - 1);
+        for (int index = 0; index < overflow; ++index) {
+            m_lines.removeFirst();
+        }
+        endRemoveRows();
+    }
+
+    beginInsertRows(QModelIndex(), m_lines.count(), m_lines.count() + newLines - 1);
+    for (int index = firstLine; index < firstLine + newLines; ++index) {
+        m_lines.append(m_buffer->line(index));
+    }
+    endInsertRows();
+
+    return true;
+}
+
+MonitorDetails::MonitorDetails(ScanOutputBuffer* buffer, const QString hostname, QWidget* parent)
+    : QDialog(parent)
+{
+    setupUi(this);
+    monitorEditHostname->setText(hostname);
+
+    m_model = new MonitorDetailsModel(buffer, maxViewLines, this);
+    detailsListW->setModel(m_model);
+    m_model->loadTail();
+    detailsListW->scrollToBottom();
+
+    connect(monitorCloseButt, &QPushButton::clicked, this, &MonitorDetails::close);
+    connect(monitorReloadButt, &QPushButton::clicked, this, &MonitorDetails::loadOlderLines);
+    connect(monitorFollowCheck, &QCheckBox::toggled, this, &MonitorDetails::followOutput);
+    connect(buffer, &ScanOutputBuffer::linesAppended, this, &MonitorDetails::readNewLines);
+}
+
+MonitorDetails::~MonitorDetails()
+{
+}
+
+void MonitorDetails::readNewLines(int firstLine, int count)
+{
+    if (!monitorFollowCheck->isChecked()) {
+        return;
+    }
+
+    if (m_model->appendLines(firstLine, count)) {
+        detailsListW->scrollToBottom();
+    }
+}
+
+void MonitorDetails::loadOlderLines()
+{
+    // stop the tail, the older lines are shown until follow is checked again
+    monitorFollowCheck->setChecked(false);
+
+    m_model->loadOlder(olderLinesStep);
+    detailsListW->scrollToTop();
+}
+
+void MonitorDetails::followOutput(bool follow)
+{
+    if (!follow) {
+        return;
+    }
+
+    if (!m_model->isTailLoaded()) {
+        m_model->loadTail();
+    }
+
+    detailsListW->scrollToBottom();
 }
@@ -19,39 +19,68 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define MONITORHOSTSCANDETAILS_H
 
 #include <QDialog>
-#include <QtCore/QList>
+#include <QBrush>
+#include <QtCore/QAbstractListModel>
+#include <QtCore/QContiguousCache>
 #include <QtCore/QStringList>
 #include <QtCore/QObject>
-#include <QtCore/QTimer>
+#include <QtCore/QPointer>
 
 // local include
 #include "ui_monitorhostscandetails.h"
-#include "memorytools.h"
+#include "scanoutputbuffer.h"
 
-class MonitorDetails : public QDialog, private Ui::monitorDetails
+/*!
+ * List model with a bounded window of scan output lines,
+ * the cache index is the line number into the output buffer.
+ */
+class MonitorDetailsModel : public QAbstractListModel
 {
     Q_OBJECT
 
 public:
-    MonitorDetails(QStringList& processFlow, const QString hostname, QWidget* parent);
-    ~MonitorDetails();
+    MonitorDetailsModel(ScanOutputBuffer* buffer, int capacity, QObject* parent);
+    ~MonitorDetailsModel();
 
-private:
+    int rowCount(const QModelIndex& parent = QModelIndex()) const;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+
+    /*
+     * Fill the window with the last lines of the buffer
+     */
+    void loadTail();
+    /*
+     * Load older lines at the top of the window
+     */
+    void loadOlder(int count);
     /*
-     * Load scan realtime line to QListWidget
+     * Append new lines if they follow the window
      */
-    void loadFlow();
+    bool appendLines(int firstLine, int count);
+    bool isTailLoaded() const;
 
-    QStringList& m_scanLines;
-    QList<QListWidgetItem*> m_itemsList;
-    int m_itemsSize;
-    QTimer* m_timer;
+private:
+    QPointer<ScanOutputBuffer> m_buffer;
+    QContiguousCache<QString> m_lines;
+};
+
+class MonitorDetails : public QDialog, private Ui::monitorDetails
+{
+    Q_OBJECT
+
+public:
+    MonitorDetails(ScanOutputBuffer* buffer, const QString hostname, QWidget* parent);
+    ~MonitorDetails();
+
+private:
+    MonitorDetailsModel* m_model;
 
 private slots:
     /*
-     * Reload scan realtime line, append to QListWidget
-     * only the new line.
+     * Push the new scan lines, only when the view follows the output
      */
-    void reloadFlow();
+    void readNewLines(int firstLine, int count);
+    void loadOlderLines();
+    void followOutput(bool follow);
 };
 #endif
@@ -0,0 +1,281 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "progressparser.h"
+
+#include <QtCore/QStringList>
+#include <QtCore/QtGlobal>
+
+void ProgressState::apply(const ProgressEvent& event)
+{
+    switch (event.type) {
+    case ProgressEvent::TimingEvent:
+        if (!ProgressParser::isSamePhase(event.phase, phase)) {
+            startPhase(event.phase);
+        }
+        percent = event.percent;
+        etc = event.etc;
+        remainingSeconds = event.remainingSeconds;
+        updateProgress();
+        break;
+    case ProgressEvent::StatsEvent:
+        elapsedSeconds = event.elapsedSeconds;
+        if (event.hostsCompleted != -1) {
+            hostsCompleted = event.hostsCompleted;
+        }
+        if (!event.phase.isEmpty() && !ProgressParser::isSamePhase(event.phase, phase)) {
+            // a new phase is started, the timing line comes later
+            startPhase(event.phase);
+            remainingSeconds = -1;
+            etc.clear();
+        }
+        break;
+    case ProgressEvent::ScanningEvent:
+        totalPorts = event.totalPorts;
+        break;
+    case ProgressEvent::CompletedEvent:
+        if (ProgressParser::isPortScanPhase(event.phase) && event.totalPorts > 0) {
+            completedPorts += event.totalPorts;
+        }
+        if (ProgressParser::isSamePhase(event.phase, phase)) {
+            percent = 100.0;
+            remainingSeconds = 0;
+            isPortPhase = false;
+            updateProgress();
+        }
+        break;
+    }
+}
+
+void ProgressState::startPhase(const QString& name)
+{
+    phase = name;
+    isPortPhase = ProgressParser::isPortScanPhase(phase);
+    percent = 0.0;
+    phaseCount++;
+
+    // the number of phases is not known, 100 is reached only at the end
+    phaseBase = progress;
+    phaseSpan = (100.0 - phaseBase) * (isPortPhase ? 0.8 : 0.3);
+}
+
+void ProgressState::updateProgress()
+{
+    progress = qMax(progress, phaseBase + phaseSpan * qBound(0.0, percent, 100.0) / 100.0);
+}
+
+double ProgressState::scannedPorts() const
+{
+    if (isPortPhase && totalPorts > 0) {
+        return completedPorts + (percent / 100.0) * totalPorts;
+    }
+
+    return completedPorts;
+}
+
+bool ProgressParser::hasProgress(const QByteArray& data)
+{
+    // "Scanning " and "Completed " are common words of the nse output,
+    // they are progress lines only at the line start
+    return data.contains("% done") || data.contains("Stats: ")
+           || data.startsWith("Scanning ") || data.contains("\nScanning ")
+           || data.startsWith("Completed ") || data.contains("\nCompleted ");
+}
+
+bool ProgressParser::parseLine(const QString& line, ProgressEvent& event)
+{
+    if (line.startsWith(QLatin1String("Stats: "))) {
+        return parseStats(line, event);
+    }
+
+    if (line.startsWith(QLatin1String("Scanning "))) {
+        return parseScanning(line, event);
+    }
+
+    if (line.startsWith(QLatin1String("Completed "))) {
+        return parseCompleted(line, event);
+    }
+
+    return parseTiming(line, event);
+}
+
+bool ProgressParser::parseTiming(const QString& line, ProgressEvent& event)
+{
+    const int aboutPos = line.indexOf(QLatin1String("Timing: About "));
+
+    if (aboutPos == -1) {
+        return false;
+    }
+
+    const int percentPos = line.indexOf('%', aboutPos);
+
+    if (percentPos == -1) {
+        return false;
+    }
+
+    bool isNumber;
+    const double percent = line.mid(aboutPos + 14, percentPos - aboutPos - 14).toDouble(&isNumber);
+
+    if (!isNumber) {
+        return false;
+    }
+
+    event = ProgressEvent();
+    event.type = ProgressEvent::TimingEvent;
+    event.phase = line.left(aboutPos).trimmed();
+    event.percent = percent;
+
+    const int etcPos = line.indexOf(QLatin1String("ETC: "), percentPos);
+    if (etcPos != -1) {
+        const int endPos = line.indexOf(' ', etcPos + 5);
+        event.etc = line.mid(etcPos + 5, endPos == -1 ? -1 : endPos - etcPos - 5);
+    }
+
+    const int openPos = line.indexOf('(', percentPos);
+    const int remainingPos = line.indexOf(QLatin1String(" remaining)"), percentPos);
+    if (openPos != -1 && remainingPos > openPos) {
+        event.remainingSeconds = parseDuration(line.mid(openPos + 1, remainingPos - openPos - 1));
+    }
+
+    return true;
+}
+
+bool ProgressParser::parseStats(const QString& line, ProgressEvent& event)
+{
+    // Stats: 0:00:12 elapsed; 0 hosts completed (1 up), 1 undergoing SYN Stealth Scan
+    const int elapsedPos = line.indexOf(QLatin1String(" elapsed"));
+
+    if (elapsedPos == -1) {
+        return false;
+    }
+
+    event = ProgressEvent();
+    event.type = ProgressEvent::StatsEvent;
+    event.elapsedSeconds = parseDuration(line.mid(7, elapsedPos - 7).trimmed());
+
+    const int completedPos = line.indexOf(QLatin1String(" hosts completed"), elapsedPos);
+    if (completedPos != -1) {
+        const int startPos = line.lastIndexOf(' ', completedPos - 1);
+        event.hostsCompleted = line.mid(startPos + 1, completedPos - startPos - 1).toInt();
+
+        const int upPos = line.indexOf(QLatin1String(" up)"), completedPos);
+        const int openPos = line.indexOf('(', completedPos);
+        if (openPos != -1 && upPos > openPos) {
+            event.hostsUp = line.mid(openPos + 1, upPos - openPos - 1).toInt();
+        }
+    }
+
+    const int undergoingPos = line.indexOf(QLatin1String(" undergoing "), elapsedPos);
+    if (undergoingPos != -1) {
+        event.phase = line.mid(undergoingPos + 12).trimmed();
+    }
+
+    return true;
+}
+
+bool ProgressParser::parseScanning(const QString& line, ProgressEvent& event)
+{
+    // Scanning host (192.168.1.1) [1000 ports]
+    if (!line.endsWith(QLatin1String(" ports]"))) {
+        return false;
+    }
+
+    const int openPos = line.lastIndexOf('[');
+
+    if (openPos == -1) {
+        return false;
+    }
+
+    bool isNumber;
+    const int ports = line.mid(openPos + 1, line.size() - openPos - 8).toInt(&isNumber);
+
+    if (!isNumber) {
+        return false;
+    }
+
+    event = ProgressEvent();
+    event.type = ProgressEvent::ScanningEvent;
+    event.totalPorts = ports;
+
+    return true;
+}
+
+bool ProgressParser::parseCompleted(const QString& line, ProgressEvent& event)
+{
+    // Completed SYN Stealth Scan at 10:31, 1.23s elapsed (1000 total ports)
+    const int atPos = line.indexOf(QLatin1String(" at "));
+
+    if (atPos == -1) {
+        return false;
+    }
+
+    event = ProgressEvent();
+    event.type = ProgressEvent::CompletedEvent;
+    event.phase = line.mid(10, atPos - 10).trimmed();
+
+    const int totalPos = line.indexOf(QLatin1String(" total ports)"), atPos);
+    if (totalPos != -1) {
+        const int openPos = line.lastIndexOf('(', totalPos);
+        event.totalPorts = line.mid(openPos + 1, totalPos - openPos - 1).toInt();
+    }
+
+    return true;
+}
+
+QString ProgressParser::phaseKey(const QString& phase)
+{
+    // "Service Scan" in the stats lines is "Service scan" in the timing lines,
+    // "Script Scan" is "NSE"
+    const QString key = phase.trimmed().toLower();
+
+    if (key == QLatin1String("nse")) {
+        return QLatin1String("script scan");
+    }
+
+    return key;
+}
+
+bool ProgressParser::isSamePhase(const QString& phase, const QString& otherPhase)
+{
+    return phaseKey(phase) == phaseKey(otherPhase);
+}
+
+bool ProgressParser::isPortScanPhase(const QString& phase)
+{
+    const QString key = phaseKey(phase);
+
+    return key.endsWith(QLatin1String(" scan")) && !key.contains(QLatin1String("ping"))
+           && key != QLatin1String("service scan") && key != QLatin1String("script scan");
+}
+
+int ProgressParser::parseDuration(const QString& duration)
+{
+    int seconds = 0;
+
+    for (const QString& value : duration.split(':')) {
+        seconds = seconds * 60 + value.toInt();
+    }
+
+    return seconds;
+}
+
+QString ProgressParser::formatDuration(int seconds)
+{
+    return QString("%1:%2:%3").arg(seconds / 3600)
+           .arg((seconds % 3600) / 60, 2, 10, QLatin1Char('0'))
+           .arg(seconds % 60, 2, 10, QLatin1Char('0'));
+}
@@ -0,0 +1,125 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROGRESSPARSER_H
+#define PROGRESSPARSER_H
+
+#include <QtCore/QString>
+#include <QtCore/QByteArray>
+
+/*!
+ * Typed progress information read from a single nmap output line.
+ */
+class ProgressEvent
+{
+
+public:
+    enum EventType {
+        TimingEvent,    // SYN Stealth Scan Timing: About 12.50% done; ETC: 10:31 (0:00:21 remaining)
+        StatsEvent,     // Stats: 0:00:12 elapsed; 0 hosts completed (1 up), 1 undergoing SYN Stealth Scan
+        ScanningEvent,  // Scanning host (192.168.1.1) [1000 ports]
+        CompletedEvent  // Completed SYN Stealth Scan at 10:31, 1.23s elapsed (1000 total ports)
+    };
+
+    ProgressEvent()
+        : type(TimingEvent), percent(0.0), remainingSeconds(-1), elapsedSeconds(-1),
+          hostsCompleted(-1), hostsUp(-1), totalPorts(-1) {};
+
+    EventType type;
+    QString phase;
+    QString etc;
+    // percent of the current phase, nmap starts again from 0 on every phase
+    double percent;
+    int remainingSeconds;
+    int elapsedSeconds;
+    int hostsCompleted;
+    int hostsUp;
+    int totalPorts;
+};
+
+/*!
+ * Scan progress of a single host built from the progress events.
+ */
+class ProgressState
+{
+
+public:
+    ProgressState()
+        : percent(0.0), progress(0.0), phaseBase(0.0), phaseSpan(0.0), phaseCount(0),
+          remainingSeconds(-1), elapsedSeconds(0), hostsCompleted(0),
+          totalPorts(0), completedPorts(0), isPortPhase(false) {};
+
+    void apply(const ProgressEvent& event);
+    /*
+     * Estimated number of ports already scanned
+     */
+    double scannedPorts() const;
+
+    QString phase;
+    QString etc;
+    // percent of the current phase, nmap starts again from 0 on every phase
+    double percent;
+    /*
+     * Percent of the host, it never goes back: every phase fills a part
+     * of the remaining range, a port scan phase the most of it
+     */
+    double progress;
+    double phaseBase;
+    double phaseSpan;
+    int phaseCount;
+    int remainingSeconds;
+    int elapsedSeconds;
+    int hostsCompleted;
+    int totalPorts;
+    int completedPorts;
+    bool isPortPhase;
+
+private:
+    void startPhase(const QString& name);
+    void updateProgress();
+};
+
+class ProgressParser
+{
+
+public:
+    /*
+     * Return true if the output block can contain a progress line,
+     * so the lines are read only when needed.
+     */
+    static bool hasProgress(const QByteArray& data);
+    static bool parseLine(const QString& line, ProgressEvent& event);
+    /*
+     * Convert "1:02:03" or "02:03" in seconds
+     */
+    static int parseDuration(const QString& duration);
+    static QString formatDuration(int seconds);
+    /*
+     * Same key for the names of a phase in the stats, timing and completed lines
+     */
+    static QString phaseKey(const QString& phase);
+    static bool isSamePhase(const QString& phase, const QString& otherPhase);
+    static bool isPortScanPhase(const QString& phase);
+
+private:
+    static bool parseTiming(const QString& line, ProgressEvent& event);
+    static bool parseStats(const QString& line, ProgressEvent& event);
+    static bool parseScanning(const QString& line, ProgressEvent& event);
+    static bool parseCompleted(const QString& line, ProgressEvent& event);
+};
+
+#endif // PROGRESSPARSER_H
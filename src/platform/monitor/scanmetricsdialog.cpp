@@ -0,0 +1,127 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "scanmetricsdialog.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QJsonDocument>
+#include <QFileDialog>
+
+ScanMetricsDialog::ScanMetricsDialog(const ScanMetrics& metrics, QWidget* parent)
+    : QDialog(parent), m_metrics(metrics)
+{
+    setupUi(this);
+
+    // numbers as data, the columns are sorted by value
+    QHash<QString, ScanMetrics::ProfileMetrics>::const_iterator i;
+    for (i = m_metrics.profiles().constBegin(); i != m_metrics.profiles().constEnd(); ++i) {
+        QTreeWidgetItem* item = new QTreeWidgetItem(treeProfiles);
+        item->setText(0, i.key().isEmpty() ? tr("(default)") : i.key());
+        item->setToolTip(0, i.key());
+        item->setData(1, Qt::DisplayRole, i.value().jobs);
+        item->setData(2, Qt::DisplayRole, i.value().failedJobs);
+        item->setData(3, Qt::DisplayRole, i.value().wallTime / 1000.0);
+        item->setData(4, Qt::DisplayRole, i.value().cpuTime / 1000.0);
+        item->setData(5, Qt::DisplayRole, i.value().peakMemory / 1024.0);
+        item->setData(6, Qt::DisplayRole, i.value().outputBytes / 1024);
+        item->setData(7, Qt::DisplayRole, i.value().parseTime / 1000.0);
+    }
+
+    for (const ScanMetrics::JobMetrics& job : m_metrics.jobs()) {
+        QTreeWidgetItem* item = new QTreeWidgetItem(treeJobs);
+        item->setText(0, job.host);
+        item->setText(1, job.profile);
+        item->setToolTip(1, job.profile);
+        item->setData(2, Qt::DisplayRole, job.process.exitCode);
+        item->setData(3, Qt::DisplayRole, job.process.wallTime / 1000.0);
+        item->setData(6, Qt::DisplayRole, job.process.outputBytes / 1024);
+        item->setData(7, Qt::DisplayRole, job.parseTime);
+
+        // -1 without procfs
+        if (job.process.cpuTime >= 0) {
+            item->setData(4, Qt::DisplayRole, job.process.cpuTime / 1000.0);
+            item->setData(5, Qt::DisplayRole, job.process.peakMemory / 1024.0);
+        }
+
+        if (job.process.isCrashed) {
+            item->setText(2, tr("crashed"));
+        }
+    }
+
+    // the most expensive profiles first
+    treeProfiles->sortByColumn(3, Qt::DescendingOrder);
+    treeJobs->sortByColumn(3, Qt::DescendingOrder);
+    treeProfiles->setColumnWidth(0, 300);
+    treeJobs->setColumnWidth(0, 200);
+    treeJobs->setColumnWidth(1, 200);
+
+    const int renderCount = m_metrics.renderCount();
+    labelRender->setText(tr("%1 results shown, %2 ms on average, %3 ms the slowest")
+                         .arg(renderCount)
+                         .arg(renderCount ? m_metrics.renderTime() / double(renderCount) : 0.0, 0, 'f', 1)
+                         .arg(m_metrics.maxRenderTime()));
+
+    const ScanMetrics::BatchMetrics& batch = m_metrics.lastBatch();
+    if (batch.hosts) {
+        labelRender->setText(labelRender->text() + '\n'
+                             + tr("Last batch: %1 hosts in %2 s, %3 hosts/s, %4 ms the slowest dispatch, %5 ms the slowest refresh")
+                             .arg(batch.hosts)
+                             .arg(batch.wallTime / 1000.0, 0, 'f', 1)
+                             .arg(batch.hostsPerSecond(), 0, 'f', 2)
+                             .arg(batch.maxDispatchTime)
+                             .arg(batch.maxUpdateTime));
+    }
+
+    connect(exportPrometheusButt, &QPushButton::clicked,
+            this, &ScanMetricsDialog::exportPrometheus);
+    connect(exportJsonButt, &QPushButton::clicked,
+            this, &ScanMetricsDialog::exportJson);
+    connect(closeButt, &QPushButton::clicked,
+            this, &ScanMetricsDialog::close);
+}
+
+ScanMetricsDialog::~ScanMetricsDialog()
+{
+}
+
+void ScanMetricsDialog::exportPrometheus()
+{
+    saveFile(tr("Export metrics"), QLatin1String("/nmapsi4.prom"), tr("Prometheus text files (*.prom)"),
+             m_metrics.toPrometheus());
+}
+
+void ScanMetricsDialog::exportJson()
+{
+    saveFile(tr("Export metrics"), QLatin1String("/nmapsi4-metrics.json"), tr("JSON files (*.json)"),
+             QJsonDocument(m_metrics.toJson()).toJson());
+}
+
+void ScanMetricsDialog::saveFile(const QString& title, const QString& fileName, const QString& filter, const QByteArray& content)
+{
+    const QString path = QFileDialog::getSaveFileName(this, title, QDir::homePath() + fileName, filter);
+
+    if (path.isEmpty()) {
+        return;
+    }
+
+    QFile file(path);
+
+    if (!file.open(QIODevice::WriteOnly) || file.write(content) != content.size()) {
+        QMessageBox::warning(this, tr("Warning - Nmapsi4"), tr("File not writable: ") + path, tr("Close"));
+    }
+}
@@ -0,0 +1,49 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCANMETRICSDIALOG_H
+#define SCANMETRICSDIALOG_H
+
+#include <QtCore/QObject>
+#include <QDialog>
+#include <QMessageBox>
+
+#include "ui_scanmetricsdialog.h"
+#include "scanmetrics.h"
+
+/*
+ * Resources of the finished scans by profile and by host
+ */
+class ScanMetricsDialog : public QDialog, private Ui::scanMetrics
+{
+    Q_OBJECT
+
+public:
+    ScanMetricsDialog(const ScanMetrics& metrics, QWidget* parent);
+    ~ScanMetricsDialog();
+
+private:
+    void saveFile(const QString& title, const QString& fileName, const QString& filter, const QByteArray& content);
+
+    const ScanMetrics& m_metrics;
+
+private slots:
+    void exportPrometheus();
+    void exportJson();
+};
+
+#endif
@@ -0,0 +1,88 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "scanoutputbuffer.h"
+
+namespace
+{
+// lines kept for every host, older lines are dropped
+const int maxBufferLines = 20000;
+}
+
+ScanOutputBuffer::ScanOutputBuffer(QObject* parent)
+    : QObject(parent), m_lines(maxBufferLines), m_size(0)
+{
+}
+
+ScanOutputBuffer::~ScanOutputBuffer()
+{
+}
+
+void ScanOutputBuffer::append(const QByteArray& data)
+{
+    if (data.isEmpty()) {
+        return;
+    }
+
+    m_size += data.size();
+
+    const int firstLine = lineCount();
+    int start = 0;
+    int pos;
+
+    // keep only complete lines, the last one can be still in progress
+    while ((pos = data.indexOf('\n', start)) != -1) {
+        int end = pos;
+        if (end > start && data.at(end - 1) == '\r') {
+            --end;
+        }
+
+        m_lines.append(QByteArray(m_pendingLine + data.mid(start, end - start)));
+        m_pendingLine.clear();
+        start = pos + 1;
+    }
+
+    m_pendingLine.append(data.mid(start));
+
+    if (lineCount() > firstLine) {
+        emit linesAppended(firstLine, lineCount() - firstLine);
+    }
+}
+
+qint64 ScanOutputBuffer::size() const
+{
+    return m_size;
+}
+
+int ScanOutputBuffer::lineCount() const
+{
+    return m_lines.isEmpty() ? 0 : m_lines.lastIndex() + 1;
+}
+
+int ScanOutputBuffer::firstLine() const
+{
+    return m_lines.isEmpty() ? 0 : m_lines.firstIndex();
+}
+
+QString ScanOutputBuffer::line(int index) const
+{
+    if (!m_lines.containsIndex(index)) {
+        return QString();
+    }
+
+    return QString::fromLocal8Bit(m_lines.at(index));
+}
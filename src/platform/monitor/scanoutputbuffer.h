@@ -0,0 +1,66 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCANOUTPUTBUFFER_H
+#define SCANOUTPUTBUFFER_H
+
+#include <QtCore/QObject>
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+#include <QtCore/QContiguousCache>
+
+/*!
+ * Realtime output of a scan for the details view. Only the last
+ * lines are kept, the complete output is in the process thread.
+ * Line numbers count from the scan start, also for dropped lines.
+ */
+class ScanOutputBuffer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ScanOutputBuffer(QObject* parent = 0);
+    ~ScanOutputBuffer();
+
+    void append(const QByteArray& data);
+    /*
+     * Bytes appended since the scan start
+     */
+    qint64 size() const;
+    /*
+     * Return the number of complete lines
+     */
+    int lineCount() const;
+    /*
+     * First line still in the buffer
+     */
+    int firstLine() const;
+    QString line(int index) const;
+
+signals:
+    /*
+     * New complete lines are available
+     */
+    void linesAppended(int firstLine, int count);
+
+private:
+    QContiguousCache<QByteArray> m_lines;
+    QByteArray m_pendingLine;
+    qint64 m_size;
+};
+
+#endif // SCANOUTPUTBUFFER_H
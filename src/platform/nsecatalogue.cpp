@@ -0,0 +1,706 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "nsecatalogue.h"
+#include "programpaths.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QDateTime>
+#include <QtCore/QSaveFile>
+#include <QtCore/QSettings>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QRegExp>
+#include <QtCore/QSet>
+
+namespace
+{
+// "NSE1", change the version when NseScript changes
+const quint32 indexMagic = 0x4e534531;
+const qint32 indexVersion = 2;
+
+QStringList quotedValues(const QByteArray& data, int start, int end)
+{
+    QStringList values;
+    int index = start;
+
+    while (index < end) {
+        const char quote = data.at(index);
+        if (quote != '"' && quote != '\'') {
+            ++index;
+            continue;
+        }
+
+        const int close = data.indexOf(quote, index + 1);
+        if (close == -1 || close > end) {
+            break;
+        }
+
+        values.append(QString::fromUtf8(data.mid(index + 1, close - index - 1)));
+        index = close + 1;
+    }
+
+    return values;
+}
+}
+
+QDataStream& operator<<(QDataStream& stream, const NseScript& script)
+{
+    stream << script.name << script.description << script.categories << script.dependencies
+           << script.arguments << script.rules << script.portRules << script.modified << script.size;
+    return stream;
+}
+
+QDataStream& operator>>(QDataStream& stream, NseScript& script)
+{
+    stream >> script.name >> script.description >> script.categories >> script.dependencies
+           >> script.arguments >> script.rules >> script.portRules >> script.modified >> script.size;
+    return stream;
+}
+
+NseCatalogue::NseCatalogue(QObject* parent)
+    : QThread(parent),
+      m_ready(0)
+{
+    m_indexFileName = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+                      + QLatin1String("/nmapsi4/nsecatalogue.db");
+}
+
+NseCatalogue::~NseCatalogue()
+{
+}
+
+QString NseCatalogue::findScriptsPath()
+{
+    QStringList pathList;
+
+    QSettings settings("nmapsi4", "nmapsi4");
+    const QString& customPath = settings.value("nseScriptsPath").toString();
+    if (!customPath.isEmpty()) {
+        pathList.append(customPath);
+    }
+
+    const QByteArray nmapDir = qgetenv("NMAPDIR");
+    if (!nmapDir.isEmpty()) {
+        pathList.append(QString::fromLocal8Bit(nmapDir) + QLatin1String("/scripts"));
+    }
+
+    QString nmapPath = ProgramPaths::path("nmap");
+    if (!QFileInfo(nmapPath).isAbsolute()) {
+        nmapPath = QStandardPaths::findExecutable(nmapPath);
+    }
+
+    if (!nmapPath.isEmpty()) {
+        const QDir binaryDir(QFileInfo(nmapPath).canonicalPath());
+        pathList.append(binaryDir.absoluteFilePath("../share/nmap/scripts"));
+        // windows installer layout
+        pathList.append(binaryDir.absoluteFilePath("scripts"));
+    }
+
+    pathList.append("/usr/share/nmap/scripts");
+    pathList.append("/usr/local/share/nmap/scripts");
+    pathList.append("/opt/local/share/nmap/scripts");
+
+    for (const QString& path : pathList) {
+        QFileInfo info(path);
+        if (info.isDir()) {
+            return info.canonicalFilePath();
+        }
+    }
+
+    return QString();
+}
+
+void NseCatalogue::run()
+{
+    m_scriptsPath = findScriptsPath();
+
+    if (m_scriptsPath.isEmpty()) {
+        qWarning() << "NseCatalogue:: nmap scripts directory not found";
+        return;
+    }
+
+    updateIndex();
+
+    if (isInterruptionRequested()) {
+        m_scripts.clear();
+        return;
+    }
+
+    buildLookup();
+
+    m_ready.storeRelease(1);
+    emit catalogueReady(m_scripts.size());
+}
+
+bool NseCatalogue::isReady() const
+{
+    return m_ready.loadAcquire() && !m_scripts.isEmpty();
+}
+
+bool NseCatalogue::contains(const QString& name) const
+{
+    return m_scripts.contains(name);
+}
+
+const NseScript NseCatalogue::script(const QString& name) const
+{
+    return m_scripts.value(name);
+}
+
+QStringList NseCatalogue::scriptNames() const
+{
+    return m_names;
+}
+
+QStringList NseCatalogue::categories() const
+{
+    return m_categories.keys();
+}
+
+void NseCatalogue::updateIndex()
+{
+    QHash<QString, NseScript> cachedScripts;
+    loadIndex(cachedScripts);
+
+    const QMap<QString, QStringList>& dbCategories = readScriptDb(m_scriptsPath + QLatin1String("/script.db"));
+    const QFileInfoList fileList = QDir(m_scriptsPath).entryInfoList(QStringList("*.nse"),
+                                                                     QDir::Files | QDir::Readable);
+
+    bool isChanged = (cachedScripts.size() != fileList.size());
+    int readScripts = 0;
+
+    for (const QFileInfo& info : fileList) {
+        if (isInterruptionRequested()) {
+            return;
+        }
+
+        const QString& name = info.completeBaseName();
+        const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+        NseScript script = cachedScripts.value(name);
+
+        if (script.name.isEmpty() || script.modified != modified || script.size != info.size()) {
+            // new or changed script
+            script = NseScript();
+            script.name = name;
+            script.modified = modified;
+            script.size = info.size();
+            readScript(info.filePath(), script);
+
+            if (script.categories.isEmpty()) {
+                script.categories = dbCategories.value(name);
+            }
+
+            isChanged = true;
+            readScripts++;
+        }
+
+        m_scripts.insert(name, script);
+    }
+
+#ifndef NSE_NO_DEBUG
+    qDebug() << "DEBUG::NseCatalogue:: scripts " << m_scripts.size() << " read " << readScripts;
+#else
+    Q_UNUSED(readScripts);
+#endif
+
+    if (isChanged) {
+        saveIndex();
+    }
+}
+
+bool NseCatalogue::loadIndex(QHash<QString, NseScript>& scripts)
+{
+    QFile file(m_indexFileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic;
+    qint32 version;
+    QString scriptsPath;
+    stream >> magic >> version;
+
+    if (magic != indexMagic || version != indexVersion) {
+        return false;
+    }
+
+    stream >> scriptsPath;
+
+    if (scriptsPath != m_scriptsPath) {
+        // another nmap installation
+        return false;
+    }
+
+    QList<NseScript> scriptList;
+    stream >> scriptList;
+
+    if (stream.status() != QDataStream::Ok) {
+        qWarning() << "NseCatalogue:: corrupted index " << m_indexFileName;
+        return false;
+    }
+
+    for (const NseScript& script : scriptList) {
+        scripts.insert(script.name, script);
+    }
+
+    return true;
+}
+
+void NseCatalogue::saveIndex()
+{
+    QDir().mkpath(QFileInfo(m_indexFileName).absolutePath());
+    QSaveFile file(m_indexFileName);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "NseCatalogue:: index not writable " << m_indexFileName;
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << indexMagic << indexVersion << m_scriptsPath << m_scripts.values();
+
+    if (!file.commit()) {
+        qWarning() << "NseCatalogue:: index not saved " << m_indexFileName;
+    }
+}
+
+void NseCatalogue::buildLookup()
+{
+    m_names = m_scripts.keys();
+    m_names.sort();
+    m_categories.clear();
+
+    QList<NseScript> scriptList;
+
+    for (const QString& name : m_names) {
+        const NseScript& script = m_scripts[name];
+        scriptList.append(script);
+
+        for (const QString& category : script.categories) {
+            m_categories[category].append(name);
+        }
+    }
+
+    m_search.build(scriptList);
+}
+
+QMap<QString, QStringList> NseCatalogue::readScriptDb(const QString& fileName)
+{
+    // Entry { filename = "acarsd-info.nse", categories = { "discovery", "safe", } }
+    QMap<QString, QStringList> categories;
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return categories;
+    }
+
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine();
+        const int nameStart = line.indexOf("filename");
+        const int categoriesStart = line.indexOf("categories");
+
+        if (nameStart == -1 || categoriesStart == -1) {
+            continue;
+        }
+
+        const int tableStart = line.indexOf('{', categoriesStart);
+
+        const QStringList names = quotedValues(line, nameStart, tableStart);
+        if (names.isEmpty()) {
+            continue;
+        }
+
+        QString name(names.first());
+        name.remove(QRegExp("\\.nse$"));
+        categories.insert(name, quotedValues(line, tableStart, line.indexOf('}', tableStart)));
+    }
+
+    return categories;
+}
+
+bool NseCatalogue::readScript(const QString& fileName, NseScript& script)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "NseCatalogue:: script not readable " << fileName;
+        return false;
+    }
+
+    const QByteArray data = file.readAll();
+
+    script.description = readLuaString(data, "description");
+    script.categories = readLuaTable(data, "categories");
+    script.dependencies = readLuaTable(data, "dependencies");
+    readArguments(data, script.arguments);
+    readRules(data, script);
+
+    return true;
+}
+
+int NseCatalogue::findAssignment(const QByteArray& data, const char* name)
+{
+    // only top level assignments, at the start of a line
+    const int nameSize = qstrlen(name);
+    int pos = 0;
+
+    while ((pos = data.indexOf(name, pos)) != -1) {
+        int index = pos + nameSize;
+
+        if (!pos || data.at(pos - 1) == '\n') {
+            while (index < data.size() && (data.at(index) == ' ' || data.at(index) == '\t')) {
+                ++index;
+            }
+
+            if (index + 1 < data.size() && data.at(index) == '=' && data.at(index + 1) != '=') {
+                return index + 1;
+            }
+        }
+
+        pos = index;
+    }
+
+    return -1;
+}
+
+QString NseCatalogue::readLuaString(const QByteArray& data, const char* name)
+{
+    int pos = findAssignment(data, name);
+
+    if (pos == -1) {
+        return QString();
+    }
+
+    while (pos < data.size() && QChar(data.at(pos)).isSpace()) {
+        ++pos;
+    }
+
+    if (pos >= data.size()) {
+        return QString();
+    }
+
+    const char quote = data.at(pos);
+
+    if (quote == '[') {
+        // long string [[ ]] or [==[ ]==]
+        int index = pos + 1;
+        while (index < data.size() && data.at(index) == '=') {
+            ++index;
+        }
+
+        if (index >= data.size() || data.at(index) != '[') {
+            return QString();
+        }
+
+        QByteArray close(index - pos - 1, '=');
+        close.prepend(']').append(']');
+        const int end = data.indexOf(close, index + 1);
+
+        if (end == -1) {
+            return QString();
+        }
+
+        return QString::fromUtf8(data.mid(index + 1, end - index - 1)).trimmed();
+    }
+
+    if (quote != '"' && quote != '\'') {
+        return QString();
+    }
+
+    QByteArray value;
+    for (int index = pos + 1; index < data.size(); ++index) {
+        const char c = data.at(index);
+
+        if (c == quote || c == '\n') {
+            break;
+        }
+
+        if (c == '\\' && index + 1 < data.size()) {
+            ++index;
+            value.append(data.at(index) == 'n' ? '\n' : data.at(index));
+        } else {
+            value.append(c);
+        }
+    }
+
+    return QString::fromUtf8(value).trimmed();
+}
+
+QStringList NseCatalogue::readLuaTable(const QByteArray& data, const char* name)
+{
+    const int pos = findAssignment(data, name);
+
+    if (pos == -1) {
+        return QStringList();
+    }
+
+    const int start = data.indexOf('{', pos);
+    const int end = data.indexOf('}', start);
+
+    if (start == -1 || end == -1 || !data.mid(pos, start - pos).trimmed().isEmpty()) {
+        return QStringList();
+    }
+
+    return quotedValues(data, start, end);
+}
+
+void NseCatalogue::readArguments(const QByteArray& data, QMap<QString, QString>& arguments)
+{
+    /*
+     * -- @args http-title.url The url to fetch. Default: /
+     * --       more help text
+     */
+    QString name;
+    QString help;
+    int pos = 0;
+
+    while (pos < data.size()) {
+        int end = data.indexOf('\n', pos);
+        if (end == -1) {
+            end = data.size();
+        }
+
+        QByteArray line = data.mid(pos, end - pos).trimmed();
+        pos = end + 1;
+
+        const bool isComment = line.startsWith("--");
+        if (isComment) {
+            line = line.mid(2).trimmed();
+        }
+
+        if (!isComment || line.isEmpty() || line.startsWith('@') || line.startsWith('-')) {
+            if (!name.isEmpty()) {
+                arguments.insert(name, help.simplified());
+                name.clear();
+                help.clear();
+            }
+
+            if (isComment && (line.startsWith("@args ") || line.startsWith("@arg "))) {
+                line = line.mid(line.indexOf(' ') + 1).trimmed();
+                const int space = line.indexOf(' ');
+                name = QString::fromUtf8(space == -1 ? line : line.left(space));
+                help = QString::fromUtf8(space == -1 ? QByteArray() : line.mid(space + 1));
+            }
+        } else if (!name.isEmpty()) {
+            help += ' ' + QString::fromUtf8(line);
+        }
+    }
+
+    if (!name.isEmpty()) {
+        arguments.insert(name, help.simplified());
+    }
+}
+
+void NseCatalogue::readRules(const QByteArray& data, NseScript& script)
+{
+    static const char* const ruleNames[] = { "prerule", "hostrule", "portrule", "postrule" };
+
+    for (const char* rule : ruleNames) {
+        if (findAssignment(data, rule) != -1) {
+            script.rules.append(QLatin1String(rule));
+        }
+    }
+
+    const int pos = findAssignment(data, "portrule");
+
+    if (pos == -1) {
+        return;
+    }
+
+    /*
+     * portrule = shortport.http
+     * portrule = shortport.port_or_service({80, 443}, {"http", "https"})
+     * portrule = function(host, port) ... end
+     */
+    int end = data.indexOf('\n', pos);
+    if (end == -1) {
+        end = data.size();
+    }
+
+    if (data.mid(pos, end - pos).contains("function")) {
+        const int bodyEnd = data.indexOf("\nend", pos);
+        end = (bodyEnd == -1) ? data.size() : bodyEnd;
+    }
+
+    const QByteArray rule = data.mid(pos, end - pos);
+    QStringList values;
+    int index = 0;
+
+    while ((index = rule.indexOf("shortport.", index)) != -1) {
+        index += qstrlen("shortport.");
+        int nameEnd = index;
+        while (nameEnd < rule.size() && (QChar(rule.at(nameEnd)).isLetterOrNumber() || rule.at(nameEnd) == '_')) {
+            ++nameEnd;
+        }
+
+        if (nameEnd < rule.size() && rule.at(nameEnd) == '(') {
+            int close = rule.indexOf(')', nameEnd);
+            if (close == -1) {
+                close = rule.size();
+            }
+            const QByteArray arguments = rule.mid(nameEnd + 1, close - nameEnd - 1);
+
+            // port numbers out of quotes and service names
+            values.append(quotedValues(arguments, 0, arguments.size()));
+            bool isQuoted = false;
+            QByteArray number;
+            for (const char c : arguments) {
+                if (c == '"' || c == '\'') {
+                    isQuoted = !isQuoted;
+                } else if (!isQuoted && c >= '0' && c <= '9') {
+                    number.append(c);
+                    continue;
+                }
+                if (!number.isEmpty()) {
+                    values.append(QString::fromLatin1(number));
+                    number.clear();
+                }
+            }
+            if (!number.isEmpty()) {
+                values.append(QString::fromLatin1(number));
+            }
+        } else if (nameEnd > index) {
+            // shortport.http, shortport.ssl
+            values.append(QString::fromLatin1(rule.mid(index, nameEnd - index)));
+        }
+
+        index = nameEnd;
+    }
+
+    index = 0;
+    while ((index = rule.indexOf("port.number", index)) != -1) {
+        index += qstrlen("port.number");
+        const QByteArray value = rule.mid(index, 16).simplified();
+        if (value.startsWith("==")) {
+            const QByteArray number = value.mid(2).trimmed();
+            int size = 0;
+            while (size < number.size() && number.at(size) >= '0' && number.at(size) <= '9') {
+                ++size;
+            }
+            if (size) {
+                values.append(QString::fromLatin1(number.left(size)));
+            }
+        }
+    }
+
+    for (const QString& value : values) {
+        const QString& lowerValue = value.toLower();
+        // protocols and port states are not facets
+        if (lowerValue == QLatin1String("tcp") || lowerValue == QLatin1String("udp")
+                || lowerValue == QLatin1String("sctp") || lowerValue.contains(QLatin1String("open"))
+                || lowerValue.contains(QLatin1String("filtered")) || lowerValue.isEmpty()) {
+            continue;
+        }
+
+        if (!script.portRules.contains(lowerValue)) {
+            script.portRules.append(lowerValue);
+        }
+    }
+}
+
+QStringList NseCatalogue::search(const QString& query, const QString& category,
+                                 const QString& rule, int maxResults) const
+{
+    return m_search.search(query, category, rule, maxResults);
+}
+
+QList<QPair<QString, int> > NseCatalogue::categoryFacets() const
+{
+    return m_search.categoryFacets();
+}
+
+QList<QPair<QString, int> > NseCatalogue::ruleFacets() const
+{
+    return m_search.ruleFacets();
+}
+
+QStringList NseCatalogue::resolve(const QString& pattern) const
+{
+    QStringList result;
+    QSet<QString> found;
+
+    for (const QString& value : pattern.split(',', QString::SkipEmptyParts)) {
+        QString term = value.trimmed().toLower();
+        if (term.endsWith(QLatin1String(".nse"))) {
+            term.chop(4);
+        }
+
+        QStringList names;
+        if (term == QLatin1String("all")) {
+            names = m_names;
+        } else if (m_categories.contains(term)) {
+            names = m_categories.value(term);
+        } else if (term.contains('*') || term.contains('?') || term.contains('[')) {
+            QRegExp wildcard(term, Qt::CaseInsensitive, QRegExp::Wildcard);
+            for (const QString& name : m_names) {
+                if (wildcard.exactMatch(name)) {
+                    names.append(name);
+                }
+            }
+        } else if (m_scripts.contains(term)) {
+            names.append(term);
+        }
+
+        for (const QString& name : names) {
+            if (!found.contains(name)) {
+                found.insert(name);
+                result.append(name);
+            }
+        }
+    }
+
+    return result;
+}
+
+QString NseCatalogue::help(const QString& pattern) const
+{
+    QString result;
+
+    for (const QString& name : resolve(pattern)) {
+        const NseScript& script = m_scripts.constFind(name).value();
+
+        result += '\n' + name + '\n';
+        result += QLatin1String("Categories: ") + script.categories.join(' ') + '\n';
+        result += QLatin1String("https://nmap.org/nsedoc/scripts/") + name + QLatin1String(".html\n");
+
+        for (const QString& line : script.description.split('\n')) {
+            result += QLatin1String("  ") + line + '\n';
+        }
+
+        if (!script.dependencies.isEmpty()) {
+            result += QLatin1String("Dependencies: ") + script.dependencies.join(", ") + '\n';
+        }
+
+        if (!script.arguments.isEmpty()) {
+            result += QLatin1String("Script Arguments:\n");
+            QMap<QString, QString>::const_iterator i;
+            for (i = script.arguments.constBegin(); i != script.arguments.constEnd(); ++i) {
+                result += QLatin1String("  ") + i.key() + '\n';
+                result += QLatin1String("      ") + i.value() + '\n';
+            }
+        }
+    }
+
+    return result;
+}
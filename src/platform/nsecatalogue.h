@@ -0,0 +1,133 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef NSECATALOGUE_H
+#define NSECATALOGUE_H
+
+#include <QtCore/QThread>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QMap>
+#include <QtCore/QList>
+#include <QtCore/QDataStream>
+#include <QtCore/QAtomicInt>
+#include <QtCore/QDebug>
+
+#include "nsesearch.h"
+#include "debug.h"
+
+/*!
+ * Values of a single nse script read from its source file.
+ */
+class NseScript
+{
+
+public:
+    NseScript() : modified(0), size(0) {};
+
+    QString name;
+    QString description;
+    QStringList categories;
+    QStringList dependencies;
+    // argument name and help text
+    QMap<QString, QString> arguments;
+    // prerule, hostrule, portrule, postrule
+    QStringList rules;
+    // services and ports of the portrule
+    QStringList portRules;
+    // file values for the index invalidation
+    qint64 modified;
+    qint64 size;
+};
+
+QDataStream& operator<<(QDataStream& stream, const NseScript& script);
+QDataStream& operator>>(QDataStream& stream, NseScript& script);
+
+class NseCatalogue : public QThread
+{
+    /*!
+     * Index of the nmap scripts directory and script.db.
+     * The index is saved on disk and only the changed scripts are
+     * read again, so help and search don't need an nmap process.
+     */
+    Q_OBJECT
+
+public:
+    explicit NseCatalogue(QObject* parent = 0);
+    ~NseCatalogue();
+
+    /*!
+     * True when the index is loaded, values are readable only
+     * from this point.
+     */
+    bool isReady() const;
+    bool contains(const QString& name) const;
+    const NseScript script(const QString& name) const;
+    QStringList scriptNames() const;
+    QStringList categories() const;
+    /*!
+     * Resolve a --script-help pattern: comma separated script names,
+     * categories, shell wildcards or "all".
+     */
+    QStringList resolve(const QString& pattern) const;
+    /*!
+     * Return the help text with the same layout of nmap --script-help.
+     */
+    QString help(const QString& pattern) const;
+    /*!
+     * Search scripts by name, description and argument names.
+     */
+    QStringList search(const QString& query, const QString& category,
+                       const QString& rule, int maxResults) const;
+    QList<QPair<QString, int> > categoryFacets() const;
+    QList<QPair<QString, int> > ruleFacets() const;
+
+    static QString findScriptsPath();
+
+signals:
+    void catalogueReady(int scriptsNumber);
+
+private:
+    QString m_scriptsPath;
+    QString m_indexFileName;
+    QHash<QString, NseScript> m_scripts;
+    QMap<QString, QStringList> m_categories;
+    QStringList m_names;
+    NseSearch m_search;
+    // set before catalogueReady, the thread is still running there
+    QAtomicInt m_ready;
+
+    bool loadIndex(QHash<QString, NseScript>& scripts);
+    void saveIndex();
+    void updateIndex();
+    void buildLookup();
+
+    static QMap<QString, QStringList> readScriptDb(const QString& fileName);
+    static bool readScript(const QString& fileName, NseScript& script);
+    static int findAssignment(const QByteArray& data, const char* name);
+    static QString readLuaString(const QByteArray& data, const char* name);
+    static QStringList readLuaTable(const QByteArray& data, const char* name);
+    static void readArguments(const QByteArray& data, QMap<QString, QString>& arguments);
+    static void readRules(const QByteArray& data, NseScript& script);
+
+protected:
+    void run();
+};
+
+#endif // NSECATALOGUE_H
@@ -17,15 +17,33 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "nsemanager.h"
 #include "profilermanager.h"
+#include "programpaths.h"
+
+#include <QCompleter>
+
+namespace
+{
+// rows of the script search tree
+const int maxSearchResults = 200;
+}
 
 NseManager::NseManager(ProfilerManager* parent)
     : QObject(parent), m_ui(parent)
 {
     nseTreeDefaultValue();
+
+    // help and search are read from the local script index when available
+    m_catalogue = new NseCatalogue(this);
+    connect(m_catalogue, &NseCatalogue::catalogueReady,
+            this, &NseManager::loadCatalogue);
+    m_catalogue->start();
 }
 
 NseManager::~NseManager()
 {
+    m_catalogue->requestInterruption();
+    m_catalogue->wait();
+
     memory::freemap<QString, QTextDocument*>::itemDeleteAll(m_nseHelpCache);
 
     if (m_documentScript) {
@@ -53,6 +71,15 @@ void NseManager::requestNseHelp(QTreeWidgetItem *item, int column)
     QHash<QString, QTextDocument*>::const_iterator i = m_nseHelpCache.find(item->text(0));
 
     if (i == m_nseHelpCache.constEnd()) {
+        const QString& help = m_catalogue->isReady() ? m_catalogue->help(item->text(0)) : QString();
+
+        if (!help.isEmpty()) {
+            QTextDocument *document = new QTextDocument(help);
+            m_nseHelpCache.insert(item->text(0), document);
+            m_ui->m_dialogUi->nseTextHelp->setDocument(document);
+            return;
+        }
+
         /*
         * not category on cache
         * start help thread for nse
@@ -61,7 +88,7 @@ void NseManager::requestNseHelp(QTreeWidgetItem *item, int column)
         parameters_.append("--script-help");
         parameters_.append(item->text(0));
 
-        m_thread = new ProcessThread("nmap", parameters_);
+        m_thread = new ProcessThread(ProgramPaths::path("nmap"), parameters_);
 
         connect(m_thread, &ProcessThread::threadEnd,
                 this, &NseManager::showNseHelp);
@@ -81,11 +108,23 @@ void NseManager::requestNseScriptHelp()
         return;
     }
 
+    const QString& help = m_catalogue->isReady() ? m_catalogue->help(searchString_) : QString();
+
+    if (!help.isEmpty()) {
+        if (m_documentScript) {
+            delete m_documentScript;
+        }
+
+        m_documentScript = new QTextDocument(help);
+        m_ui->m_dialogUi->textScriptHelp->setDocument(m_documentScript);
+        return;
+    }
+
     QStringList parameters_;
     parameters_.append("--script-help");
     parameters_.append(searchString_);
 
-    m_threadScript = new ProcessThread("nmap", parameters_);
+    m_threadScript = new ProcessThread(ProgramPaths::path("nmap"), parameters_);
 
     connect(m_threadScript, &ProcessThread::threadEnd,
             this, &NseManager::showNseScriptHelp);
@@ -93,9 +132,8 @@ void NseManager::requestNseScriptHelp()
     m_threadScript->start();
 }
 
-void NseManager::showNseHelp(const QStringList parameters, QByteArray result, QByteArray errors)
+void NseManager::showNseHelp(const ScanOutput& output)
 {
-    Q_UNUSED(errors);
     // show help result for nse
     if (m_thread) {
         m_thread->quit();
@@ -103,19 +141,17 @@ void NseManager::showNseHelp(const QStringList parameters, QByteArray result, QB
         delete m_thread;
     }
 
-    QString result_(result);
+    QString result_(output.output());
     QTextDocument *document = new QTextDocument(result_);
     // insert document on cache
-    m_nseHelpCache.insert(parameters[parameters.size() - 1], document);
+    m_nseHelpCache.insert(output.target(), document);
     // load document
     m_ui->m_dialogUi->nseTextHelp->setDocument(document);
 }
 
-void NseManager::showNseScriptHelp(const QStringList parameters, QByteArray result, QByteArray errors)
+void NseManager::showNseScriptHelp(const ScanOutput& output)
 {
     // result for script search
-    Q_UNUSED(errors);
-    Q_UNUSED(parameters);
     // show help result for nse
     if (m_threadScript) {
         m_threadScript->quit();
@@ -123,7 +159,7 @@ void NseManager::showNseScriptHelp(const QStringList parameters, QByteArray resu
         delete m_threadScript;
     }
 
-    QString result_(result);
+    QString result_(output.output());
 
     if (m_documentScript) {
         delete m_documentScript;
@@ -133,10 +169,138 @@ void NseManager::showNseScriptHelp(const QStringList parameters, QByteArray resu
     m_ui->m_dialogUi->textScriptHelp->setDocument(m_documentScript);
 }
 
+void NseManager::loadCatalogue(int scriptsNumber)
+{
+#ifndef NSE_NO_DEBUG
+    qDebug() << "DEBUG:: nse catalogue scripts: " << scriptsNumber;
+#else
+    Q_UNUSED(scriptsNumber);
+#endif
+
+    QCompleter* completer = new QCompleter(m_catalogue->categories() + m_catalogue->scriptNames(),
+                                           m_ui->m_dialogUi->comboScriptHelp);
+    completer->setCaseSensitivity(Qt::CaseInsensitive);
+    completer->setFilterMode(Qt::MatchContains);
+    m_ui->m_dialogUi->comboScriptHelp->setCompleter(completer);
+
+    connect(completer, static_cast<void (QCompleter::*)(const QString&)>(&QCompleter::activated),
+            this, &NseManager::requestNseScriptHelp);
+
+    // categories of the installed nmap
+    const QStringList& categories = m_catalogue->categories();
+    if (!categories.isEmpty()) {
+        m_nseCategoryList = categories;
+        m_nseScriptAvailList.clear();
+
+        for (const QString& category : m_nseCategoryList) {
+            if (!m_nseScriptActiveList.contains(category)) {
+                m_nseScriptAvailList.append(category);
+            }
+        }
+
+        nseTreeAvailRestoreValues();
+    }
+
+    // search facets
+    QComboBox* categoryFacet = m_ui->m_dialogUi->nseCategoryFacet;
+    categoryFacet->blockSignals(true);
+    categoryFacet->clear();
+    categoryFacet->addItem(tr("All categories"));
+    for (const QPair<QString, int>& facet : m_catalogue->categoryFacets()) {
+        categoryFacet->addItem(facet.first + " (" + QString::number(facet.second) + ")", facet.first);
+    }
+    categoryFacet->blockSignals(false);
+
+    QComboBox* ruleFacet = m_ui->m_dialogUi->nseRuleFacet;
+    ruleFacet->blockSignals(true);
+    ruleFacet->clear();
+    ruleFacet->addItem(tr("All rules"));
+    for (const QPair<QString, int>& facet : m_catalogue->ruleFacets()) {
+        ruleFacet->addItem(facet.first + " (" + QString::number(facet.second) + ")", facet.first);
+    }
+    ruleFacet->blockSignals(false);
+
+    m_ui->m_dialogUi->nseSearchEdit->setEnabled(true);
+    categoryFacet->setEnabled(true);
+    ruleFacet->setEnabled(true);
+
+    searchScripts();
+}
+
+void NseManager::searchScripts()
+{
+    if (!m_catalogue->isReady()) {
+        return;
+    }
+
+    const QStringList& names = m_catalogue->search(m_ui->m_dialogUi->nseSearchEdit->text(),
+                                                   m_ui->m_dialogUi->nseCategoryFacet->currentData().toString(),
+                                                   m_ui->m_dialogUi->nseRuleFacet->currentData().toString(),
+                                                   maxSearchResults);
+
+    QTreeWidget* tree = m_ui->m_dialogUi->nseSearchTree;
+    tree->setUpdatesEnabled(false);
+    tree->clear();
+
+    for (const QString& name : names) {
+        const NseScript& script = m_catalogue->script(name);
+        QTreeWidgetItem *root = new QTreeWidgetItem(tree);
+        root->setSizeHint(0, QSize(22, 22));
+        root->setIcon(0, QIcon(QString::fromUtf8(":/images/images/code-function.png")));
+        root->setText(0, name);
+        root->setText(1, script.categories.join(", "));
+        root->setText(2, (script.rules + script.portRules).join(", "));
+        root->setToolTip(0, script.description.section('\n', 0, 0));
+    }
+
+    tree->setUpdatesEnabled(true);
+    m_ui->m_dialogUi->nseSearchAddBut->setEnabled(false);
+}
+
+void NseManager::showSearchedScript()
+{
+    const QList<QTreeWidgetItem*>& items = m_ui->m_dialogUi->nseSearchTree->selectedItems();
+
+    if (items.isEmpty()) {
+        m_ui->m_dialogUi->nseSearchAddBut->setEnabled(false);
+        return;
+    }
+
+    const QString& name = items.first()->text(0);
+    m_ui->m_dialogUi->nseSearchHelp->setPlainText(m_catalogue->help(name));
+    m_ui->m_dialogUi->nseSearchAddBut->setEnabled(!m_nseScriptActiveList.contains(name));
+}
+
+void NseManager::activeSearchedScript()
+{
+    const QList<QTreeWidgetItem*>& items = m_ui->m_dialogUi->nseSearchTree->selectedItems();
+
+    if (items.isEmpty()) {
+        return;
+    }
+
+    if (activeScript(items.first()->text(0))) {
+        m_ui->m_dialogUi->nseSearchAddBut->setEnabled(false);
+    }
+}
+
+bool NseManager::activeScript(const QString& script)
+{
+    if (m_nseScriptActiveList.contains(script)) {
+        return false;
+    }
+
+    m_nseScriptActiveList.append(script);
+    nseTreeActiveRestoreValues();
+
+    return true;
+}
+
 void NseManager::nseTreeDefaultValue()
 {
     m_nseScriptActiveList.clear();
     m_nseScriptAvailList.clear();
+    // replaced by the catalogue categories when the index is loaded
     m_nseScriptAvailList.append("auth");
     m_nseScriptAvailList.append("broadcast");
     m_nseScriptAvailList.append("brute");
@@ -151,6 +315,7 @@ void NseManager::nseTreeDefaultValue()
     m_nseScriptAvailList.append("safe");
     m_nseScriptAvailList.append("version");
     m_nseScriptAvailList.append("vuln");
+    m_nseCategoryList = m_nseScriptAvailList;
 
     nseTreeAvailRestoreValues();
 }
@@ -208,7 +373,10 @@ void NseManager::nseTreeRemoveItem()
 
     if (indexNseItem != -1) {
         QString tmpElem_ = m_nseScriptActiveList.takeAt(indexNseItem);
-        m_nseScriptAvailList.append(tmpElem_);
+        // single scripts are only in the search tab
+        if (m_nseCategoryList.contains(tmpElem_)) {
+            m_nseScriptAvailList.append(tmpElem_);
+        }
         nseTreeAvailRestoreValues();
         nseTreeActiveRestoreValues();
         if (!m_nseScriptActiveList.size()) {
@@ -220,7 +388,9 @@ void NseManager::nseTreeRemoveItem()
 void NseManager::nseTreeResetItem()
 {
     for (const QString & token : m_nseScriptActiveList) {
-        m_nseScriptAvailList.append(token);
+        if (m_nseCategoryList.contains(token)) {
+            m_nseScriptAvailList.append(token);
+        }
     }
     m_nseScriptActiveList.clear();
     nseTreeAvailRestoreValues();
@@ -237,7 +407,8 @@ void NseManager::nseTreeActiveScriptValues(const QStringList scripts)
 bool NseManager::nseTreeActiveSingleScript(const QString script)
 {
     if (!m_nseScriptAvailList.contains(script)) {
-        return false;
+        // a single script known by the local index
+        return m_catalogue->isReady() && m_catalogue->contains(script) && activeScript(script);
     }
 
     m_nseScriptActiveList.append(m_nseScriptAvailList.takeAt(m_nseScriptAvailList.indexOf(script)));
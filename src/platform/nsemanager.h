@@ -26,6 +26,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "processthread.h"
 #include "memorytools.h"
+#include "nsecatalogue.h"
 
 class ProfilerManager;
 
@@ -47,8 +48,10 @@ public:
 private:
     void nseTreeAvailRestoreValues();
     void nseTreeActiveRestoreValues();
+    bool activeScript(const QString& script);
 
     ProfilerManager* m_ui;
+    NseCatalogue* m_catalogue;
     QPointer<ProcessThread> m_thread;
     QPointer<ProcessThread> m_threadScript;
     QPointer<QTextDocument> m_documentScript;
@@ -57,15 +60,29 @@ private:
     QHash<QString, QTextDocument*> m_nseHelpCache;
     QStringList m_nseScriptAvailList;
     QStringList m_nseScriptActiveList;
+    // categories that return to the available tree
+    QStringList m_nseCategoryList;
 
 public slots:
     void requestNseHelp(QTreeWidgetItem *item, int column);
     void requestNseScriptHelp();
-    void showNseHelp(const QStringList parameters, QByteArray result, QByteArray errors);
-    void showNseScriptHelp(const QStringList parameters, QByteArray result, QByteArray errors);
+    void showNseHelp(const ScanOutput& output);
+    void showNseScriptHelp(const ScanOutput& output);
     void nseTreeDefaultValue();
     void nseTreeActiveItem();
     void nseTreeRemoveItem();
+    /*
+     * Search single scripts while typing
+     */
+    void searchScripts();
+    void showSearchedScript();
+    void activeSearchedScript();
+
+private slots:
+    /*
+     * Enable script names completion when the local index is ready
+     */
+    void loadCatalogue(int scriptsNumber);
 
 public slots:
     void nseTreeResetItem();
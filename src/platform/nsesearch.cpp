@@ -0,0 +1,342 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "nsesearch.h"
+#include "nsecatalogue.h"
+
+#include <algorithm>
+
+namespace
+{
+// shared trigrams needed for a misspelled word, in percent
+const int minTrigramMatch = 50;
+// description words shorter than this are not indexed
+const int minDescriptionToken = 3;
+
+bool childLessThan(const QPair<QChar, int>& child, const QChar& c)
+{
+    return child.first < c;
+}
+
+bool scoreGreaterThan(const QPair<int, QString>& first, const QPair<int, QString>& second)
+{
+    if (first.first != second.first) {
+        return first.first > second.first;
+    }
+
+    return first.second < second.second;
+}
+
+QList<QPair<QString, int> > facetList(const QMap<QString, int>& counts)
+{
+    QList<QPair<QString, int> > facets;
+    QMap<QString, int>::const_iterator i;
+    for (i = counts.constBegin(); i != counts.constEnd(); ++i) {
+        facets.append(qMakePair(i.key(), i.value()));
+    }
+
+    return facets;
+}
+}
+
+NseSearch::NseSearch()
+{
+    clear();
+}
+
+void NseSearch::clear()
+{
+    m_nodes.clear();
+    m_nodes.append(TrieNode());
+    m_trigrams.clear();
+    m_names.clear();
+    m_categories.clear();
+    m_rules.clear();
+    m_categoryCounts.clear();
+    m_ruleCounts.clear();
+}
+
+void NseSearch::build(const QList<NseScript>& scripts)
+{
+    clear();
+
+    for (const NseScript& script : scripts) {
+        const int document = m_names.size();
+        m_names.append(script.name);
+        m_categories.append(script.categories);
+        m_rules.append(script.rules + script.portRules);
+
+        // the full name and its words
+        insertToken(script.name.toLower(), document, NameField);
+        insertText(script.name, document, NameField, 1);
+        insertTrigrams(script.name.toLower(), document);
+
+        QMap<QString, QString>::const_iterator i;
+        for (i = script.arguments.constBegin(); i != script.arguments.constEnd(); ++i) {
+            insertToken(i.key().toLower(), document, ArgumentField);
+            insertText(i.key(), document, ArgumentField, 1);
+            insertTrigrams(i.key().toLower(), document);
+        }
+
+        for (const QString& category : script.categories) {
+            insertToken(category.toLower(), document, CategoryField);
+            m_categoryCounts[category]++;
+        }
+
+        for (const QString& rule : m_rules.last()) {
+            m_ruleCounts[rule]++;
+        }
+
+        insertText(script.description, document, DescriptionField, minDescriptionToken);
+    }
+}
+
+QList<QPair<QString, int> > NseSearch::categoryFacets() const
+{
+    return facetList(m_categoryCounts);
+}
+
+QList<QPair<QString, int> > NseSearch::ruleFacets() const
+{
+    return facetList(m_ruleCounts);
+}
+
+void NseSearch::insertToken(const QString& token, int document, FieldType field)
+{
+    if (token.isEmpty()) {
+        return;
+    }
+
+    int node = 0;
+
+    for (const QChar& c : token) {
+        const QVector<QPair<QChar, int> >& children = m_nodes[node].children;
+        QVector<QPair<QChar, int> >::const_iterator i =
+            std::lower_bound(children.constBegin(), children.constEnd(), c, childLessThan);
+
+        if (i != children.constEnd() && i->first == c) {
+            node = i->second;
+        } else {
+            const int position = i - children.constBegin();
+            const int child = m_nodes.size();
+            // append first, the node reference is not valid after a resize
+            m_nodes.append(TrieNode());
+            m_nodes[node].children.insert(position, qMakePair(c, child));
+            node = child;
+        }
+    }
+
+    // documents are inserted in order, a repeated word is the last posting
+    QVector<quint32>& postings = m_nodes[node].postings;
+    const quint32 posting = document * 4 + field;
+
+    if (postings.isEmpty() || postings.last() != posting) {
+        postings.append(posting);
+    }
+}
+
+void NseSearch::insertText(const QString& text, int document, FieldType field, int minSize)
+{
+    for (const QString& token : tokenize(text, minSize)) {
+        insertToken(token, document, field);
+    }
+}
+
+void NseSearch::insertTrigrams(const QString& text, int document)
+{
+    for (quint64 trigram : trigrams(text)) {
+        QVector<int>& documents = m_trigrams[trigram];
+        if (documents.isEmpty() || documents.last() != document) {
+            documents.append(document);
+        }
+    }
+}
+
+int NseSearch::findNode(const QString& prefix) const
+{
+    int node = 0;
+
+    for (const QChar& c : prefix) {
+        const QVector<QPair<QChar, int> >& children = m_nodes[node].children;
+        QVector<QPair<QChar, int> >::const_iterator i =
+            std::lower_bound(children.constBegin(), children.constEnd(), c, childLessThan);
+
+        if (i == children.constEnd() || i->first != c) {
+            return -1;
+        }
+
+        node = i->second;
+    }
+
+    return node;
+}
+
+void NseSearch::termScores(const QString& term, QHash<int, int>& scores) const
+{
+    const int node = findNode(term);
+
+    if (node != -1) {
+        // exact words count double, then all the words with this prefix
+        QVector<int> stack;
+        stack.append(node);
+
+        while (!stack.isEmpty()) {
+            const int current = stack.takeLast();
+            const int factor = (current == node) ? 2 : 1;
+
+            for (quint32 posting : m_nodes[current].postings) {
+                int& score = scores[posting / 4];
+                score = qMax(score, fieldWeight(posting % 4) * factor);
+            }
+
+            for (const QPair<QChar, int>& child : m_nodes[current].children) {
+                stack.append(child.second);
+            }
+        }
+    }
+
+    const QVector<quint64> termTrigrams = trigrams(term);
+
+    if (termTrigrams.size() < 2) {
+        return;
+    }
+
+    // misspelled names and argument names
+    QHash<int, int> trigramCounts;
+    for (quint64 trigram : termTrigrams) {
+        for (int document : m_trigrams.value(trigram)) {
+            trigramCounts[document]++;
+        }
+    }
+
+    QHash<int, int>::const_iterator i;
+    for (i = trigramCounts.constBegin(); i != trigramCounts.constEnd(); ++i) {
+        const int match = i.value() * 100 / termTrigrams.size();
+        if (match >= minTrigramMatch && !scores.contains(i.key())) {
+            scores.insert(i.key(), qMax(1, fieldWeight(ArgumentField) * match / 100));
+        }
+    }
+}
+
+QStringList NseSearch::search(const QString& query, const QString& category,
+                              const QString& rule, int maxResults) const
+{
+    const QStringList terms = query.toLower().split(' ', QString::SkipEmptyParts);
+    QHash<int, int> scores;
+
+    if (terms.isEmpty()) {
+        for (int document = 0; document < m_names.size(); ++document) {
+            scores.insert(document, 0);
+        }
+    }
+
+    for (int index = 0; index < terms.size(); ++index) {
+        QHash<int, int> current;
+        termScores(terms[index], current);
+
+        if (!index) {
+            scores = current;
+            continue;
+        }
+
+        // every term must match
+        QHash<int, int>::iterator i = scores.begin();
+        while (i != scores.end()) {
+            QHash<int, int>::const_iterator termScore = current.constFind(i.key());
+            if (termScore == current.constEnd()) {
+                i = scores.erase(i);
+            } else {
+                i.value() += termScore.value();
+                ++i;
+            }
+        }
+    }
+
+    QVector<QPair<int, QString> > results;
+    QHash<int, int>::const_iterator i;
+    for (i = scores.constBegin(); i != scores.constEnd(); ++i) {
+        if (!category.isEmpty() && !m_categories[i.key()].contains(category)) {
+            continue;
+        }
+        if (!rule.isEmpty() && !m_rules[i.key()].contains(rule)) {
+            continue;
+        }
+        results.append(qMakePair(i.value(), m_names[i.key()]));
+    }
+
+    std::sort(results.begin(), results.end(), scoreGreaterThan);
+
+    QStringList names;
+    for (int index = 0; index < results.size() && index < maxResults; ++index) {
+        names.append(results[index].second);
+    }
+
+    return names;
+}
+
+QStringList NseSearch::tokenize(const QString& text, int minSize)
+{
+    QStringList tokens;
+    QString token;
+
+    for (const QChar& c : text) {
+        if (c.isLetterOrNumber() || c == '_') {
+            token.append(c.toLower());
+        } else if (!token.isEmpty()) {
+            if (token.size() >= minSize) {
+                tokens.append(token);
+            }
+            token.clear();
+        }
+    }
+
+    if (token.size() >= minSize && !token.isEmpty()) {
+        tokens.append(token);
+    }
+
+    return tokens;
+}
+
+QVector<quint64> NseSearch::trigrams(const QString& text)
+{
+    QVector<quint64> values;
+
+    for (int index = 0; index + 2 < text.size(); ++index) {
+        const quint64 trigram = (quint64(text.at(index).unicode()) << 32)
+                                | (quint64(text.at(index + 1).unicode()) << 16)
+                                | text.at(index + 2).unicode();
+        if (!values.contains(trigram)) {
+            values.append(trigram);
+        }
+    }
+
+    return values;
+}
+
+int NseSearch::fieldWeight(int field)
+{
+    switch (field) {
+    case NameField:
+        return 8;
+    case ArgumentField:
+        return 4;
+    case CategoryField:
+        return 3;
+    default:
+        return 1;
+    }
+}
@@ -0,0 +1,93 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef NSESEARCH_H
+#define NSESEARCH_H
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+#include <QtCore/QHash>
+#include <QtCore/QMap>
+#include <QtCore/QPair>
+#include <QtCore/QList>
+
+class NseScript;
+
+/*!
+ * Search engine over the nse scripts.
+ * Words of names, argument names, categories and descriptions are
+ * stored in a prefix trie, names and argument names also in a trigram
+ * index to match misspelled words. Category and rule facets filter
+ * the result.
+ */
+class NseSearch
+{
+
+public:
+    NseSearch();
+    ~NseSearch() {};
+
+    void clear();
+    void build(const QList<NseScript>& scripts);
+    /*
+     * Return script names ordered by relevance, an empty query
+     * returns all scripts of the facets
+     */
+    QStringList search(const QString& query, const QString& category,
+                       const QString& rule, int maxResults) const;
+    /*
+     * Facet values with the number of scripts
+     */
+    QList<QPair<QString, int> > categoryFacets() const;
+    QList<QPair<QString, int> > ruleFacets() const;
+
+private:
+    enum FieldType {
+        NameField,
+        ArgumentField,
+        CategoryField,
+        DescriptionField
+    };
+
+    struct TrieNode {
+        // sorted by character
+        QVector<QPair<QChar, int> > children;
+        // document * 4 + field
+        QVector<quint32> postings;
+    };
+
+    QVector<TrieNode> m_nodes;
+    QHash<quint64, QVector<int> > m_trigrams;
+    QVector<QString> m_names;
+    QVector<QStringList> m_categories;
+    QVector<QStringList> m_rules;
+    QMap<QString, int> m_categoryCounts;
+    QMap<QString, int> m_ruleCounts;
+
+    void insertToken(const QString& token, int document, FieldType field);
+    void insertText(const QString& text, int document, FieldType field, int minSize);
+    void insertTrigrams(const QString& text, int document);
+    int findNode(const QString& prefix) const;
+    void termScores(const QString& term, QHash<int, int>& scores) const;
+
+    static QStringList tokenize(const QString& text, int minSize);
+    static QVector<quint64> trigrams(const QString& text);
+    static int fieldWeight(int field);
+};
+
+#endif // NSESEARCH_H
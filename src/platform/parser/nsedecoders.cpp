@@ -0,0 +1,288 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "nsedecoders.h"
+
+#include <QtCore/QRegExp>
+
+namespace
+{
+/*
+ * Split "Key: value", return false for lines without a key
+ */
+bool splitValue(const QString& line, QString& key, QString& value)
+{
+    const int pos = line.indexOf(QLatin1String(": "));
+
+    if (pos <= 0) {
+        if (!line.endsWith(QLatin1Char(':'))) {
+            return false;
+        }
+        key = line.left(line.size() - 1).trimmed();
+        value.clear();
+        return true;
+    }
+
+    key = line.left(pos).trimmed();
+    value = line.mid(pos + 2).trimmed();
+
+    return true;
+}
+
+QDateTime readDate(const QString& value)
+{
+    // 2021-04-01T00:00:00, 2021-01-01T12:00:00+01:00
+    QDateTime date = QDateTime::fromString(value, Qt::ISODate);
+
+    if (!date.isValid()) {
+        date = QDateTime::fromString(value.left(19), "yyyy-MM-ddThh:mm:ss");
+    }
+
+    return date;
+}
+
+QString removeNull(QString value)
+{
+    // NetBIOS names end with \x00
+    value.remove(QLatin1String("\\x00"));
+    return value.trimmed();
+}
+}
+
+QString SslCertDecoder::scriptName() const
+{
+    return QLatin1String("ssl-cert");
+}
+
+QVariantMap SslCertDecoder::readDistinguishedName(const QString& value)
+{
+    // commonName=scanme.nmap.org/organizationName=Example/countryName=US
+    QVariantMap name;
+
+    for (const QString& token : value.split(QLatin1Char('/'), QString::SkipEmptyParts)) {
+        const int pos = token.indexOf(QLatin1Char('='));
+        if (pos > 0) {
+            name.insert(token.left(pos), token.mid(pos + 1));
+        }
+    }
+
+    return name;
+}
+
+QVariantMap SslCertDecoder::decode(const QStringList& lines) const
+{
+    QVariantMap fields;
+    QString key;
+    QString value;
+
+    for (const QString& line : lines) {
+        if (!splitValue(line, key, value)) {
+            continue;
+        }
+
+        if (key == QLatin1String("Subject")) {
+            const QVariantMap subject = readDistinguishedName(value);
+            fields.insert("subject", subject);
+            fields.insert("commonName", subject.value("commonName"));
+        } else if (key == QLatin1String("Issuer")) {
+            const QVariantMap issuer = readDistinguishedName(value);
+            fields.insert("issuer", issuer);
+            fields.insert("issuerCommonName", issuer.value("commonName"));
+        } else if (key == QLatin1String("Subject Alternative Name")) {
+            QStringList names;
+            for (const QString& token : value.split(QLatin1Char(','), QString::SkipEmptyParts)) {
+                const QString& name = token.trimmed();
+                names.append(name.mid(name.indexOf(QLatin1Char(':')) + 1));
+            }
+            fields.insert("subjectAltNames", names);
+        } else if (key == QLatin1String("Public Key type")) {
+            fields.insert("keyType", value);
+        } else if (key == QLatin1String("Public Key bits")) {
+            fields.insert("keyBits", value.toInt());
+        } else if (key == QLatin1String("Signature Algorithm")) {
+            fields.insert("signatureAlgorithm", value);
+        } else if (key == QLatin1String("Not valid before")) {
+            fields.insert("notBefore", readDate(value));
+        } else if (key == QLatin1String("Not valid after")) {
+            const QDateTime notAfter = readDate(value);
+            fields.insert("notAfter", notAfter);
+            if (notAfter.isValid()) {
+                fields.insert("expired", notAfter < QDateTime::currentDateTimeUtc());
+            }
+        } else if (key == QLatin1String("MD5")) {
+            fields.insert("md5", value.remove(QLatin1Char(' ')));
+        } else if (key == QLatin1String("SHA-1")) {
+            fields.insert("sha1", value.remove(QLatin1Char(' ')));
+        }
+    }
+
+    return fields;
+}
+
+QString HttpTitleDecoder::scriptName() const
+{
+    return QLatin1String("http-title");
+}
+
+QVariantMap HttpTitleDecoder::decode(const QStringList& lines) const
+{
+    QVariantMap fields;
+
+    if (lines.isEmpty()) {
+        return fields;
+    }
+
+    const QString& first = lines.first();
+
+    if (first.startsWith(QLatin1String("Site doesn't have a title"))) {
+        // Site doesn't have a title (text/html; charset=UTF-8).
+        fields.insert("hasTitle", false);
+        fields.insert("title", QString());
+
+        const int start = first.indexOf(QLatin1Char('('));
+        const int end = first.lastIndexOf(QLatin1Char(')'));
+        if (start != -1 && end > start) {
+            fields.insert("contentType", first.mid(start + 1, end - start - 1));
+        }
+    } else {
+        fields.insert("hasTitle", true);
+        fields.insert("title", first);
+    }
+
+    for (const QString& line : lines) {
+        if (line.startsWith(QLatin1String("Requested resource was "))) {
+            fields.insert("redirectUrl", line.mid(qstrlen("Requested resource was ")).trimmed());
+        } else if (line.startsWith(QLatin1String("Did not follow redirect to "))) {
+            fields.insert("redirectUrl", line.mid(qstrlen("Did not follow redirect to ")).trimmed());
+        }
+    }
+
+    return fields;
+}
+
+QString SmbOsDiscoveryDecoder::scriptName() const
+{
+    return QLatin1String("smb-os-discovery");
+}
+
+QVariantMap SmbOsDiscoveryDecoder::decode(const QStringList& lines) const
+{
+    QVariantMap fields;
+    QString key;
+    QString value;
+
+    for (const QString& line : lines) {
+        if (!splitValue(line, key, value)) {
+            continue;
+        }
+
+        if (key == QLatin1String("OS")) {
+            fields.insert("os", value);
+        } else if (key == QLatin1String("OS CPE")) {
+            fields.insert("osCpe", value);
+        } else if (key == QLatin1String("Computer name")) {
+            fields.insert("computerName", removeNull(value));
+        } else if (key == QLatin1String("NetBIOS computer name")) {
+            fields.insert("netbiosComputerName", removeNull(value));
+        } else if (key == QLatin1String("Domain name")) {
+            fields.insert("domainName", removeNull(value));
+        } else if (key == QLatin1String("Forest name")) {
+            fields.insert("forestName", removeNull(value));
+        } else if (key == QLatin1String("FQDN")) {
+            fields.insert("fqdn", removeNull(value));
+        } else if (key == QLatin1String("Workgroup")) {
+            fields.insert("workgroup", removeNull(value));
+        } else if (key == QLatin1String("System time")) {
+            fields.insert("systemTime", readDate(value));
+        }
+    }
+
+    return fields;
+}
+
+QString VulnersDecoder::scriptName() const
+{
+    return QLatin1String("vulners");
+}
+
+QVariantMap VulnersDecoder::decode(const QStringList& lines) const
+{
+    /*
+     * cpe:/a:openbsd:openssh:7.4:
+     *     CVE-2018-15919  5.0  https://vulners.com/cve/CVE-2018-15919
+     *     SSV:92579       7.5  https://vulners.com/seebug/SSV:92579  *EXPLOIT*
+     */
+    QVariantList cpeList;
+    QVariantList vulnerabilityList;
+    QStringList ids;
+    QVariantMap currentCpe;
+    QVariantList currentVulnerabilities;
+    double maxCvss = 0;
+    const QRegExp whiteSpace("\\s+");
+
+    for (const QString& line : lines) {
+        const QString& text = line.trimmed();
+
+        if (text.startsWith(QLatin1String("cpe:/"))) {
+            if (!currentCpe.isEmpty()) {
+                currentCpe.insert("vulnerabilities", currentVulnerabilities);
+                cpeList.append(currentCpe);
+            }
+
+            currentCpe.clear();
+            currentVulnerabilities.clear();
+            currentCpe.insert("cpe", text.endsWith(QLatin1Char(':')) ? text.left(text.size() - 1) : text);
+            continue;
+        }
+
+        const QStringList values = text.split(whiteSpace, QString::SkipEmptyParts);
+        if (values.size() < 2) {
+            continue;
+        }
+
+        bool isNumber = false;
+        const double cvss = values[1].toDouble(&isNumber);
+        if (!isNumber) {
+            continue;
+        }
+
+        QVariantMap vulnerability;
+        vulnerability.insert("id", values[0]);
+        vulnerability.insert("cvss", cvss);
+        vulnerability.insert("url", values.size() > 2 ? values[2] : QString());
+        vulnerability.insert("exploit", text.contains(QLatin1String("*EXPLOIT*")));
+        vulnerability.insert("cpe", currentCpe.value("cpe"));
+
+        currentVulnerabilities.append(vulnerability);
+        vulnerabilityList.append(vulnerability);
+        ids.append(values[0]);
+        maxCvss = qMax(maxCvss, cvss);
+    }
+
+    if (!currentCpe.isEmpty()) {
+        currentCpe.insert("vulnerabilities", currentVulnerabilities);
+        cpeList.append(currentCpe);
+    }
+
+    QVariantMap fields;
+    fields.insert("cpes", cpeList);
+    fields.insert("vulnerabilities", vulnerabilityList);
+    fields.insert("ids", ids);
+    fields.insert("maxCvss", maxCvss);
+
+    return fields;
+}
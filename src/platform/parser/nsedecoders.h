@@ -0,0 +1,77 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef NSEDECODERS_H
+#define NSEDECODERS_H
+
+#include <QtCore/QDateTime>
+#include <QtCore/QVariant>
+
+#include "nseresultparser.h"
+
+/*
+ * subject, issuer (QVariantMap), commonName, issuerCommonName,
+ * subjectAltNames, keyType, keyBits (int), signatureAlgorithm,
+ * notBefore, notAfter (QDateTime), expired (bool), md5, sha1
+ */
+class SslCertDecoder : public NseDecoder
+{
+
+public:
+    QString scriptName() const;
+    QVariantMap decode(const QStringList& lines) const;
+
+private:
+    static QVariantMap readDistinguishedName(const QString& value);
+};
+
+/*
+ * title, hasTitle (bool), contentType, redirectUrl
+ */
+class HttpTitleDecoder : public NseDecoder
+{
+
+public:
+    QString scriptName() const;
+    QVariantMap decode(const QStringList& lines) const;
+};
+
+/*
+ * os, osCpe, computerName, netbiosComputerName, domainName,
+ * forestName, fqdn, workgroup, systemTime (QDateTime)
+ */
+class SmbOsDiscoveryDecoder : public NseDecoder
+{
+
+public:
+    QString scriptName() const;
+    QVariantMap decode(const QStringList& lines) const;
+};
+
+/*
+ * cpes (list of cpe, vulnerabilities), vulnerabilities (list of id,
+ * cvss (double), url, exploit (bool), cpe), ids, maxCvss (double)
+ */
+class VulnersDecoder : public NseDecoder
+{
+
+public:
+    QString scriptName() const;
+    QVariantMap decode(const QStringList& lines) const;
+};
+
+#endif // NSEDECODERS_H
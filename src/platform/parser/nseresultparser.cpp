@@ -0,0 +1,143 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "nseresultparser.h"
+#include "nsedecoders.h"
+
+#include <QtCore/QMutexLocker>
+#include <QtCore/QMetaObject>
+
+QMutex& NseResultParser::decodersMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+QHash<QString, QSharedPointer<const NseDecoder> >& NseResultParser::decoders()
+{
+    static QHash<QString, QSharedPointer<const NseDecoder> > decoderHash;
+
+    if (decoderHash.isEmpty()) {
+        // default decoders
+        QList<NseDecoder*> decoderList;
+        decoderList << new SslCertDecoder() << new HttpTitleDecoder()
+                    << new SmbOsDiscoveryDecoder() << new VulnersDecoder();
+
+        for (NseDecoder* decoder : decoderList) {
+            decoderHash.insert(decoder->scriptName(), QSharedPointer<const NseDecoder>(decoder));
+        }
+    }
+
+    return decoderHash;
+}
+
+void NseResultParser::registerDecoder(NseDecoder* decoder)
+{
+    QMutexLocker locker(&decodersMutex());
+    // a replaced decoder is deleted by the last task using it
+    decoders().insert(decoder->scriptName(), QSharedPointer<const NseDecoder>(decoder));
+}
+
+bool NseResultParser::hasDecoder(const QString& scriptName)
+{
+    QMutexLocker locker(&decodersMutex());
+    return decoders().contains(scriptName);
+}
+
+void NseResultParser::decode(NseScriptResult& result)
+{
+    QSharedPointer<const NseDecoder> decoder;
+    {
+        QMutexLocker locker(&decodersMutex());
+        decoder = decoders().value(result.scriptName);
+    }
+
+    if (decoder) {
+        result.fields = decoder->decode(result.lines);
+    }
+}
+
+QString NseResultParser::cleanLine(const QString& line, int& indent)
+{
+    int pos = 0;
+
+    if (line.startsWith(QLatin1String("|_"))) {
+        pos = 2;
+    } else if (line.startsWith(QLatin1Char('|'))) {
+        pos = 1;
+    }
+
+    // a single pass, the line is copied once
+    const int textStart = pos;
+    while (pos < line.size() && line.at(pos) == QLatin1Char(' ')) {
+        ++pos;
+    }
+
+    indent = pos - textStart;
+    return line.mid(pos);
+}
+
+bool NseResultParser::isScriptHeader(const QString& text, int indent, QString& name, QString& value)
+{
+    // "| ssl-cert: Subject: ..." or "|_http-title: ...", values have more indentation
+    if (indent > 1) {
+        return false;
+    }
+
+    // script names are lower case, "| Issuer: ..." is a value of ssl-cert
+    int pos = 0;
+    while (pos < text.size()) {
+        const QChar c = text.at(pos);
+        if (!c.isLower() && !c.isDigit() && c != QLatin1Char('-') && c != QLatin1Char('_') && c != QLatin1Char('.')) {
+            break;
+        }
+        ++pos;
+    }
+
+    if (!pos || pos >= text.size() || text.at(pos) != QLatin1Char(':')) {
+        return false;
+    }
+
+    if (pos + 1 < text.size() && !text.at(pos + 1).isSpace()) {
+        // "cpe:/a:..." is not a script
+        return false;
+    }
+
+    name = text.left(pos);
+    value = text.mid(pos + 1).trimmed();
+
+    return true;
+}
+
+NseDecodeTask::NseDecodeTask(QObject* receiver, const char* member, int serial,
+                             const QList<NseScriptResult>& scripts)
+    : m_receiver(receiver), m_member(member), m_serial(serial), m_scripts(scripts)
+{
+}
+
+void NseDecodeTask::run()
+{
+    for (NseScriptResult& script : m_scripts) {
+        NseResultParser::decode(script);
+    }
+
+    if (m_receiver) {
+        QMetaObject::invokeMethod(m_receiver, m_member, Qt::QueuedConnection,
+                                  Q_ARG(int, m_serial),
+                                  Q_ARG(QList<NseScriptResult>, m_scripts));
+    }
+}
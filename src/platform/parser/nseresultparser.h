@@ -0,0 +1,96 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef NSERESULTPARSER_H
+#define NSERESULTPARSER_H
+
+#include <QtCore/QObject>
+#include <QtCore/QPointer>
+#include <QtCore/QRunnable>
+#include <QtCore/QMutex>
+#include <QtCore/QHash>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include "pobjects.h"
+
+/*!
+ * Decoder of the output of a single nse script,
+ * decode() is called from worker threads.
+ */
+class NseDecoder
+{
+
+public:
+    virtual ~NseDecoder() {};
+
+    virtual QString scriptName() const = 0;
+    virtual QVariantMap decode(const QStringList& lines) const = 0;
+};
+
+class NseResultParser
+{
+
+public:
+    /*!
+     * Add a decoder, the parser takes the ownership.
+     * A decoder for the same script replaces the previous one,
+     * running decodes keep the old one until they end.
+     */
+    static void registerDecoder(NseDecoder* decoder);
+    static bool hasDecoder(const QString& scriptName);
+    /*!
+     * Fill the result fields with the script decoder.
+     */
+    static void decode(NseScriptResult& result);
+    /*!
+     * Remove the "|" or "|_" prefix and the indentation,
+     * indent returns the removed spaces.
+     */
+    static QString cleanLine(const QString& line, int& indent);
+    /*!
+     * Check for the first line of a script block: "name: value"
+     */
+    static bool isScriptHeader(const QString& text, int indent, QString& name, QString& value);
+
+private:
+    static QHash<QString, QSharedPointer<const NseDecoder> >& decoders();
+    static QMutex& decodersMutex();
+};
+
+class NseDecodeTask : public QRunnable
+{
+    /*!
+     * Decode the scripts of a host on the thread pool, the result is
+     * returned with a queued call of member(int serial, QList<NseScriptResult>).
+     */
+
+public:
+    NseDecodeTask(QObject* receiver, const char* member, int serial, const QList<NseScriptResult>& scripts);
+    ~NseDecodeTask() {};
+
+    void run();
+
+private:
+    QPointer<QObject> m_receiver;
+    const char* m_member;
+    int m_serial;
+    QList<NseScriptResult> m_scripts;
+};
+
+#endif // NSERESULTPARSER_H
@@ -19,7 +19,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "mainwindow.h"
 
 ParserManager::ParserManager(MainWindow* parent)
-    : QObject(parent), m_ui(parent)
+    : QObject(parent), m_ui(parent), m_lastParseTime(0)
 {
     m_rawlogHorizontalSplitter = new QSplitter(m_ui);
     m_rawlogHorizontalSplitter->setOrientation(Qt::Horizontal);
@@ -38,10 +38,34 @@ ParserManager::ParserManager(MainWindow* parent)
             this, &ParserManager::showParserResult);
     connect(m_ui->m_scanWidget->treeTraceroot, &QTreeWidget::itemActivated,
             this, &ParserManager::showParserTracerouteResult);
+
+    m_searchTimer.setSingleShot(true);
+    m_searchTimer.setInterval(250);
+    connect(m_ui->m_scanWidget->searchResultsEdit, &QLineEdit::textChanged,
+            &m_searchTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
+    connect(&m_searchTimer, &QTimer::timeout,
+            this, &ParserManager::searchResults);
+
+    qRegisterMetaType< QList<NseScriptResult> >("QList<NseScriptResult>");
+    qRegisterMetaType< QList<CveMatch> >("QList<CveMatch>");
+    qRegisterMetaType<PObject*>("PObject*");
+    qRegisterMetaType< QList<IndexFields> >("QList<IndexFields>");
+    m_nseDecodeSerial = 0;
+    m_cveCorrelateSerial = 0;
+    m_logRecordParseSerial = 0;
+    m_logIndexGeneration = 0;
 }
 
 ParserManager::~ParserManager()
 {
+    if (m_logReader) {
+        m_logReader->requestInterruption();
+        m_logReader->wait();
+    }
+
+    m_workerPool.clear();
+    m_workerPool.waitForDone();
+
     memory::freelist<PObject*>::itemDeleteAll(m_parserObjList);
     memory::freelist<PObjectLookup*>::itemDeleteAll(m_parserObjUtilList);
 }
@@ -54,6 +78,20 @@ void ParserManager::syncSettings()
 
 void ParserManager::clearParserItems()
 {
+    if (m_logReader) {
+        // stop a running import, the records are not longer useful
+        disconnect(m_logReader, &LogReader::recordsReady, this, &ParserManager::readLogRecords);
+        m_logReader->requestInterruption();
+    }
+
+    m_logRecords.clear();
+    m_resultIndex.clear();
+    m_logIndexGeneration++;
+    // decoded results of removed objects are dropped
+    m_nseDecodes.clear();
+    m_cveCorrelations.clear();
+    m_logRecordParses.clear();
+    m_saveAllPath.clear();
     memory::freelist<PObject*>::itemDeleteAll(m_parserObjList);
     memory::freelist<PObjectLookup*>::itemDeleteAll(m_parserObjUtilList);
     memory::freelist<QTreeWidgetItem*>::itemDeleteAll(m_itemListScan);
@@ -69,7 +107,7 @@ void ParserManager::addUtilObject(PObjectLookup* object)
     m_parserObjUtilList.append(object);
 }
 
-void ParserManager::startParser(const QStringList parList, QByteArray dataBuffer, QByteArray errorBuffer, int id)
+PObject* ParserManager::startParser(const QStringList& parList, const QByteArray& dataBuffer, const QByteArray& errorBuffer, int id)
 {
     /*
      * TODO: remove this check with QT5 QStandardPaths::findExecutable.
@@ -79,7 +117,7 @@ void ParserManager::startParser(const QStringList parList, QByteArray dataBuffer
         QMessageBox::critical(m_ui, "NmapSI4", tr("Error: check nmap Installation.\n")
                               + "\n\n"
                               + QString(errorBuffer), tr("Close"));
-        return;
+        return 0;
     }
 
     // create a scan host item.
@@ -88,7 +126,10 @@ void ParserManager::startParser(const QStringList parList, QByteArray dataBuffer
     scanTreeItem->setSizeHint(0, QSize(32, 32));
 
     // call real parser
+    QElapsedTimer parseTimer;
+    parseTimer.start();
     PObject* elemObj = parserCore(parList, dataBuffer, errorBuffer, scanTreeItem);
+    m_lastParseTime = parseTimer.elapsed();
 
     elemObj->setParameters(parList.join(" "));
     elemObj->setId(id);
@@ -98,139 +139,52 @@ void ParserManager::startParser(const QStringList parList, QByteArray dataBuffer
     // TODO: no action
     //Notify::notificationMessage(parList[parList.size()-1], message);
 
-    if (!m_ui->m_monitor->monitorHostNumber()) {
-        m_ui->m_monitor->m_monitorWidget->scanProgressBar->setMaximum(100);
-        m_ui->m_monitor->m_monitorWidget->monitorStopAllScanButt->setEnabled(false);
-        m_ui->m_monitor->m_monitorWidget->monitorStopCurrentScanButt->setEnabled(false);
-        m_ui->m_monitor->m_monitorWidget->monitorDetailsScanButt->setEnabled(false);
-        m_ui->m_mainTabWidget->setTabIcon(m_ui->m_mainTabWidget->indexOf(m_ui->m_monitor->m_monitorWidget),
-                                QIcon(QString::fromUtf8(":/images/images/utilities-system-monitor.png")));
-        Notify::clearButtonNotify(m_ui->m_collections->m_collectionsButton.value("scan-sez"));
-    }
-
     m_ui->m_collections->m_collectionsScanSection.value("scan-action")->setEnabled(true);
     m_ui->m_collections->enableSaveActions();
 
-    if (!m_ui->m_monitor->monitorHostNumber()) {
-        m_ui->m_monitor->clearHostMonitor();
+    m_parserObjList.append(elemObj);
+    m_resultIndex.addObject(m_parserObjList.size() - 1, elemObj);
+    decodeNseScripts(elemObj);
+    correlateCves(elemObj);
+
+    if (!m_ui->m_scanWidget->searchResultsEdit->text().isEmpty()) {
+        m_searchTimer.start();
     }
 
-    m_parserObjList.append(elemObj);
+    return elemObj;
 }
 
-PObject* ParserManager::parserCore(const QStringList parList, QByteArray StdoutStr,
-                                   QByteArray StderrorStr, QTreeWidgetItem* mainScanTreeElem)
+qint64 ParserManager::lastParseTime() const
 {
-    // Create parser Object
-    PObject *parserObjectElem = new PObject();
-    QString hostName(parList[parList.size() - 1]);
-    parserObjectElem->setHostName(hostName);
-
-    QRegExp portRx(matchPorts);
-    QRegExp tracerouteRx(matchTraceroute);
-
-    QStringList infoParserStringList;
-    infoParserStringList << "MAC" << "Running" << "OS details:" << "Aggressive OS guesses:"
-                     << "OS CPE:" << "Device type:" << "Uptime:" << "Uptime guess:" << "TCP Sequence Prediction:"
-                     << "IPID Sequence Generation:" << "IP ID Sequence Generation:" << "Service Info:"
-                     << "Initiating Ping " << "Completed Ping " << "Network Distance:" << "Note:"
-                     << "Nmap done:" << "Hosts";
-
-    QTextStream stream(&StdoutStr);
-    QString tmpBufferLine;
-    QString nseBuffer;
-    QString bufferInfo;
-
-    while (!stream.atEnd()) {
-        tmpBufferLine = stream.readLine();
-
-        if (portRx.indexIn(tmpBufferLine) != -1) {
-            if (tmpBufferLine.contains("open") || tmpBufferLine.contains("filtered")
-                    || tmpBufferLine.contains("unfiltered")) {
-
-                if (tmpBufferLine.contains("open")) {
-                    parserObjectElem->setPortOpen(tmpBufferLine);
-                } else {
-                    parserObjectElem->setPortFiltered(tmpBufferLine);
-                }
-
-            } else {
-                parserObjectElem->setPortClose(tmpBufferLine);
-            }
-
-            // Insert new elem to nse buffer result
-            nseBuffer.append("|--" + tmpBufferLine + '\n');
-        }
-
-        if (tmpBufferLine.startsWith(QLatin1String("Host script results:"))) {
-            nseBuffer.append("|--" + tmpBufferLine + '\n');
-        }
-
-        bool isInfoStringFounded = false;
-        // check for specific info
-        for (const QString& infoString : infoParserStringList) {
-            if (tmpBufferLine.startsWith(infoString)) {
-                bufferInfo.append(tmpBufferLine);
-                bufferInfo.append("\n");
-                isInfoStringFounded = true;
-                break;
-            }
-        }
-
-        if (!isInfoStringFounded
-                && tmpBufferLine.startsWith(QLatin1String("Host"))
-                && !tmpBufferLine.contains("Host script results:")
-                && !tmpBufferLine.contains("Probes")) {
-            bufferInfo.append(tmpBufferLine);
-            bufferInfo.append("\n");
-        }
-
-        // check for nse subtree service
-        if (tmpBufferLine.startsWith(QLatin1String("|")) && !nseBuffer.isEmpty()) {
-            QString tmpClean(tmpBufferLine);
-            if (tmpClean.startsWith(QLatin1String("|"))) {
-                tmpClean.remove('|');
-            }
-
-            if (tmpClean.startsWith(QLatin1String("_"))) {
-                tmpClean.remove('_');
-            }
-
-            int pos;
-            while (tmpClean.startsWith(QLatin1String(" "))) {
-                // remove space at begin of string
-                pos = tmpClean.indexOf(" ");
-                if (pos == 0) {
-                    tmpClean.remove(pos, 1);
-                }
-            }
-
-            nseBuffer.append(tmpClean + '\n');
-        }
+    return m_lastParseTime;
+}
 
-        // collect trace route information
-        if ((tracerouteRx.indexIn(tmpBufferLine) != -1) && (!tmpBufferLine.contains("/"))) {
-            if (!tmpBufferLine.isEmpty() && !tmpBufferLine.contains("guessing hop")) {
-                parserObjectElem->setTraceRouteInfo(tmpBufferLine);
-            }
-        }
+PObject* ParserManager::parserCore(const QStringList& parList, const QByteArray& StdoutStr,
+                                   const QByteArray& StderrorStr, QTreeWidgetItem* mainScanTreeElem)
+{
+    // parse without widgets, then set the host icon
+    PObject *parserObjectElem = ScanParser::parse(parList, StdoutStr, StderrorStr);
+    showHostItem(parserObjectElem, mainScanTreeElem);
 
-    } // End first While
+    return parserObjectElem;
+}
 
-    parserObjectElem->setScanDate(QDateTime::currentDateTime().toString("M/d/yyyy - hh:mm:ss"));
+void ParserManager::showHostItem(PObject* parserObjectElem, QTreeWidgetItem* mainScanTreeElem)
+{
+    const QString& hostName = parserObjectElem->getHostName();
 
     mainScanTreeElem->setText(0, hostName + " (" + parserObjectElem->scanDate() + ')');
     mainScanTreeElem->setToolTip(0, startRichTextTags + hostName
                                  + " (" + parserObjectElem->scanDate() + ')' + endRichTextTags);
 
-    QTextStream bufferInfoStream(&bufferInfo); // Host info
-    QString bufferInfoStream_line;
-
     // check for Host information
     bool isOsFound = false;
     bool osGuessesFound = false;
-    while (!bufferInfoStream.atEnd()) {
-        bufferInfoStream_line = bufferInfoStream.readLine();
+    bool isHostUp = false;
+    for (const QString& bufferInfoStream_line : parserObjectElem->getHostInfo()) {
+        if (bufferInfoStream_line.contains("Host is up")) {
+            isHostUp = true;
+        }
 
         // check for specific device type
         if (bufferInfoStream_line.startsWith(QLatin1String("Device type:")) && bufferInfoStream_line.contains("switch")) {
@@ -268,84 +222,18 @@ PObject* ParserManager::parserCore(const QStringList parList, QByteArray StdoutS
             // OS was found ?
             isOsFound = HostTools::checkViewOS(bufferInfoStream_line, mainScanTreeElem);
         }
+    } // end for
 
-        parserObjectElem->setHostInfo(bufferInfoStream_line);
-    } // end while
-
-    if (mainScanTreeElem->icon(0).isNull() && !bufferInfo.isEmpty()) {
+    if (mainScanTreeElem->icon(0).isNull() && parserObjectElem->isValidObject()) {
         mainScanTreeElem->setIcon(0, QIcon(QString::fromUtf8(":/images/images/no-os.png")));
     }
 
-    // set validity of parser object
-    if (!bufferInfo.isEmpty()) {
-        parserObjectElem->setValidity(true);
-    } else {
-        parserObjectElem->setValidity(false);
-    }
-
-    QTextStream nseStream(&nseBuffer);
-    QString nseStreamLine = nseStream.readLine();
-    QHash<QString, QStringList> nseResult;
-
-    while (!nseStream.atEnd()) {
-        QString service;
-        QStringList serviceNseResult;
-
-        if (nseStreamLine.startsWith(QLatin1String("|--"))) {
-            service = nseStreamLine.remove("|--");
-            nseStreamLine = nseStream.readLine();
-        }
-
-        while (!nseStreamLine.startsWith(QLatin1String("|--")) && !nseStream.atEnd()) {
-            if (!nseStreamLine.isEmpty()) {
-                serviceNseResult.append(nseStreamLine);
-            }
-            nseStreamLine = nseStream.readLine();
-
-            // Save nse vulnerabilies url discovered
-            if ((nseStreamLine.startsWith(QLatin1String("http://"))
-                    || nseStreamLine.startsWith(QLatin1String("https://")))
-                    && !nseStreamLine.contains(hostName)
-                    && !nseStreamLine.contains("localhost")) {
-                parserObjectElem->setVulnDiscoverd(nseStreamLine);
-            }
-        }
-
-        if (!service.isEmpty() && serviceNseResult.size()) {
-            nseResult.insert(service, serviceNseResult);
-        }
-    }
-
-    // save nse result with QHash
-    parserObjectElem->setNseResult(nseResult);
     m_ui->m_collections->m_collectionsScanSection.value("clearHistory-action")->setEnabled(true);
 
-    QTextStream bufferLogStream(&StdoutStr);
-    QString bufferLogStream_line;
-
-    // check for full log scan
-    while (!bufferLogStream.atEnd()) {
-        bufferLogStream_line = bufferLogStream.readLine();
-        if (!bufferLogStream_line.isEmpty()) {
-            parserObjectElem->setFullScanLog(bufferLogStream_line);
-        }
-    }
-
-    QTextStream bufferErrorStream(&StderrorStr);
-    QString bufferErrorStream_line;
-
-    // check for scan error
-    while (!bufferErrorStream.atEnd()) {
-        bufferErrorStream_line = bufferErrorStream.readLine();
-        parserObjectElem->setErrorScan(bufferErrorStream_line);
-    }
-
     // no result for scan and ip is down
-    if (bufferInfo.isEmpty() || (!bufferInfo.isEmpty() && !bufferInfo.contains("Host is up"))) {
+    if (!isHostUp) {
         mainScanTreeElem->setIcon(0, QIcon(QString::fromUtf8(":/images/images/viewmagfit_noresult.png")));
     }
-
-    return parserObjectElem;
 }
 
 void ParserManager::showParserResult(QTreeWidgetItem *item, int column)
@@ -364,10 +252,18 @@ void ParserManager::showParserResult(QTreeWidgetItem *item, int column)
 
     int indexObj = m_ui->m_scanWidget->treeMain->indexOfTopLevelItem(item);
 
-    if (indexObj != -1) {
-        showParserObj(indexObj);
-        showParserObjPlugins(indexObj);
+    if (indexObj == -1) {
+        return;
     }
+
+    if (m_logRecords.contains(m_parserObjList[indexObj])) {
+        // shown by logRecordParsed
+        requestLogRecord(indexObj);
+        return;
+    }
+
+    showParserObj(indexObj);
+    showParserObjPlugins(indexObj);
 }
 
 void ParserManager::showParserTracerouteResult(QTreeWidgetItem *item, int column)
@@ -420,8 +316,74 @@ void ParserManager::setPortItem(QTreeWidgetItem* item, const QStringList& detail
     }
 }
 
+void ParserManager::showCveMatches(int hostIndex)
+{
+    const QList<CveMatch>& matches = m_parserObjList[hostIndex]->getCveMatches();
+
+    if (matches.isEmpty()) {
+        return;
+    }
+
+    // matches are sorted by cvss, the first one is the max value
+    QHash<QString, QList<CveMatch> > portMatches;
+    for (const CveMatch& match : matches) {
+        portMatches[match.port].append(match);
+    }
+
+    QHash<QString, QList<CveMatch> >::const_iterator i;
+    for (i = portMatches.constBegin(); i != portMatches.constEnd(); ++i) {
+        const QList<CveMatch>& values = i.value();
+        const double maxCvss = values.first().cvss;
+
+        QString text = tr("%1 CVE, CVSS %2").arg(values.size()).arg(maxCvss, 0, 'f', 1);
+        QString toolTip;
+        for (int index = 0; index < values.size() && index < 25; ++index) {
+            toolTip.append(values[index].cveId + QLatin1String(" (") + QString::number(values[index].cvss, 'f', 1)
+                           + QLatin1String(") ") + values[index].cpe);
+            if (values[index].isPossible) {
+                toolTip.append(QLatin1Char(' ') + tr("(possible)"));
+            }
+            toolTip.append(QLatin1String("<br/>"));
+        }
+        if (values.size() > 25) {
+            toolTip.append(tr("%1 more").arg(values.size() - 25));
+        }
+
+        QColor color(255, 134, 12);
+        if (maxCvss >= 7.0) {
+            color = QColor(255, 0, 0);
+        } else if (maxCvss < 4.0) {
+            color = QColor(0, 0, 255, 127);
+        }
+
+        if (i.key().isEmpty()) {
+            // operating system
+            QTreeWidgetItem *root = new QTreeWidgetItem(m_ui->m_scanWidget->treeHostDet);
+            m_itemListScan.push_front(root);
+            root->setSizeHint(0, QSize(22, 22));
+            root->setIcon(0, QIcon(QString::fromUtf8(":/images/images/messagebox_critical.png")));
+            root->setForeground(0, QBrush(color));
+            root->setText(0, tr("OS vulnerabilities: ") + text);
+            root->setToolTip(0, startRichTextTags + toolTip + endRichTextTags);
+            continue;
+        }
+
+        for (int index = 0; index < m_ui->m_scanWidget->listWscan->topLevelItemCount(); ++index) {
+            QTreeWidgetItem* item = m_ui->m_scanWidget->listWscan->topLevelItem(index);
+            if (item->text(0) == i.key()) {
+                item->setText(4, text);
+                item->setForeground(4, QBrush(color));
+                item->setToolTip(4, startRichTextTags + toolTip + endRichTextTags);
+            }
+        }
+    }
+}
+
 void ParserManager::showParserObj(int hostIndex)
 {
+    QElapsedTimer renderTimer;
+    renderTimer.start();
+
     // Clear widget
     memory::freelist<QTreeWidgetItem*>::itemDeleteAll(m_itemListScan);
     m_ui->m_scanWidget->listWscan->clear();
@@ -487,6 +449,8 @@ void ParserManager::showParserObj(int hostIndex)
         setPortItem(root, split, isPortDescriptionPresent);
     }
 
+    showCveMatches(hostIndex);
+
     if (isPortDescriptionPresent) {
         Notify::startButtonNotify(m_ui->m_collections->m_collectionsButton.value("vuln-sez"));
     } else {
@@ -580,6 +544,8 @@ void ParserManager::showParserObj(int hostIndex)
         root->setText(0, token);
         root->setToolTip(0, token);
     }
+
+    m_ui->m_monitor->metrics().addRenderTime(renderTimer.elapsed());
 }
 
 void ParserManager::showParserObjPlugins(int hostIndex)
@@ -650,6 +616,7 @@ void ParserManager::callSaveSingleLogWriter()
     }
 
     int selectedItemsIndex = m_ui->m_scanWidget->treeMain->indexOfTopLevelItem(m_ui->m_scanWidget->treeMain->selectedItems()[0]);
+    loadLogRecord(selectedItemsIndex);
     PObject *object = m_parserObjList[selectedItemsIndex];
 
     if (!object->isValidObject()) {
@@ -686,6 +653,59 @@ void ParserManager::callSaveAllLogWriter()
         return;
     }
 
+    const QString& directoryPath = QFileDialog::getExistingDirectory(
+                                       m_ui,
+                                       tr("Open Directory"),
+                                       QDir::homePath(),
+                                       QFileDialog::ShowDirsOnly | QFileDialog::DontResolveSymlinks
+                                   );
+
+    if (directoryPath.isEmpty()) {
+        return;
+    }
+
+    // the imported hosts not yet loaded are parsed on the thread pool,
+    // the logs are written by logRecordParsed when the last one is ready
+    m_saveAllPath = directoryPath;
+
+    for (int index = 0; index < m_parserObjList.size(); ++index) {
+        if (m_logRecords.contains(m_parserObjList[index])) {
+            requestLogRecord(index);
+        }
+    }
+
+    saveAllLogs();
+}
+
+void ParserManager::saveAllLogs()
+{
+    if (m_saveAllPath.isEmpty() || !m_logRecordParses.isEmpty()) {
+        return;
+    }
+
+    LogWriter *writer = new LogWriter();
+    writer->writeAllLogFile(m_parserObjList, m_saveAllPath);
+    delete writer;
+
+    m_saveAllPath.clear();
+}
+
+void ParserManager::callLoadLogFiles()
+{
+    const QStringList& fileList = QFileDialog::getOpenFileNames(
+                                      m_ui,
+                                      tr("Open Scan Logs"),
+                                      QDir::homePath(),
+                                      tr("Nmap logs (*.nmap *.xml *.gnmap *.log *.txt);;All files (*)")
+                                  );
+
+    if (!fileList.isEmpty()) {
+        startLogReader(fileList);
+    }
+}
+
+void ParserManager::callLoadLogDirectory()
+{
     const QString& directoryPath = QFileDialog::getExistingDirectory(
                                        m_ui,
                                        tr("Open Directory"),
@@ -694,8 +714,314 @@ void ParserManager::callSaveAllLogWriter()
                                    );
 
     if (!directoryPath.isEmpty()) {
-        LogWriter *writer = new LogWriter();
-        writer->writeAllLogFile(m_parserObjList, directoryPath);
-        delete writer;
+        startLogReader(QStringList(directoryPath));
+    }
+}
+
+void ParserManager::startLogReader(const QStringList& pathList)
+{
+    if (m_logReader) {
+        QMessageBox::information(m_ui, "NmapSI4", tr("Logs import already in progress."), tr("Close"));
+        return;
+    }
+
+    m_logReader = new LogReader(pathList);
+
+    connect(m_logReader, &LogReader::recordsReady,
+            this, &ParserManager::readLogRecords);
+    connect(m_logReader, &LogReader::finished,
+            this, &ParserManager::logReaderFinished);
+
+    m_ui->m_collections->m_collectionsScanSection.value("load-action")->setEnabled(false);
+    m_ui->m_collections->m_collectionsScanSection.value("loadDirectory-action")->setEnabled(false);
+
+    m_logReader->start();
+}
+
+void ParserManager::readLogRecords(const QList<LogRecord> records)
+{
+    QTreeWidget* treeMain = m_ui->m_scanWidget->treeMain;
+    treeMain->setUpdatesEnabled(false);
+
+    /*
+     * Only a placeholder object is created for every host,
+     * the log is parsed with parserCore when the host is selected.
+     */
+    for (const LogRecord& record : records) {
+        QTreeWidgetItem *scanTreeItem = new QTreeWidgetItem(treeMain);
+        m_treeItems.push_front(scanTreeItem);
+        scanTreeItem->setSizeHint(0, QSize(32, 32));
+        scanTreeItem->setIcon(0, QIcon(QString::fromUtf8(":/images/images/document-preview-archive.png")));
+        scanTreeItem->setText(0, record.hostName + " (" + record.scanDate + ')');
+        scanTreeItem->setToolTip(0, startRichTextTags + record.hostName + " (" + record.scanDate + ')'
+                                 + "<br/>" + record.fileName + endRichTextTags);
+
+        PObject* elemObj = new PObject();
+        elemObj->setHostName(record.hostName);
+        elemObj->setParameters(record.parameters);
+        elemObj->setScanDate(record.scanDate);
+        elemObj->setValidity(true);
+        elemObj->setId(-1);
+
+        m_parserObjList.append(elemObj);
+        m_logRecords.insert(elemObj, record);
+        m_resultIndex.addHostName(m_parserObjList.size() - 1, record.hostName);
+    }
+
+    // only the searched fields are read, the host is parsed when selected
+    m_workerPool.start(new LogRecordIndexTask(this, "logRecordsIndexed", m_logIndexGeneration,
+                       m_parserObjList.size() - records.size(), records));
+
+    treeMain->setUpdatesEnabled(true);
+
+    m_ui->m_collections->m_collectionsScanSection.value("clearHistory-action")->setEnabled(true);
+    m_ui->m_collections->enableSaveActions();
+}
+
+void ParserManager::logReaderFinished()
+{
+    m_logReader->deleteLater();
+    m_logReader = 0;
+
+    m_ui->m_collections->m_collectionsScanSection.value("load-action")->setEnabled(true);
+    m_ui->m_collections->m_collectionsScanSection.value("loadDirectory-action")->setEnabled(true);
+}
+
+void ParserManager::loadLogRecord(int hostIndex)
+{
+    PObject* placeholder = m_parserObjList[hostIndex];
+
+    if (!m_logRecords.contains(placeholder)) {
+        return;
     }
+
+    setLogRecordObject(hostIndex, LogReader::parseRecord(m_logRecords.value(placeholder)));
+    // its pending parse is dropped
+    saveAllLogs();
+}
+
+void ParserManager::requestLogRecord(int hostIndex)
+{
+    PObject* placeholder = m_parserObjList[hostIndex];
+
+    QHash<int, PObject*>::const_iterator i;
+    for (i = m_logRecordParses.constBegin(); i != m_logRecordParses.constEnd(); ++i) {
+        if (i.value() == placeholder) {
+            // already on the thread pool
+            return;
+        }
+    }
+
+    const int serial = ++m_logRecordParseSerial;
+    m_logRecordParses.insert(serial, placeholder);
+    m_workerPool.start(new LogRecordParseTask(this, "logRecordParsed", serial, m_logRecords.value(placeholder)));
+}
+
+void ParserManager::logRecordParsed(int serial, PObject* object)
+{
+    PObject* placeholder = m_logRecordParses.take(serial);
+    const int hostIndex = placeholder ? m_parserObjList.indexOf(placeholder) : -1;
+
+    if (hostIndex == -1 || !m_logRecords.contains(placeholder)) {
+        // results cleared or host loaded while parsing
+        delete object;
+        saveAllLogs();
+        return;
+    }
+
+    setLogRecordObject(hostIndex, object);
+
+    QTreeWidgetItem* currentItem = m_ui->m_scanWidget->treeMain->currentItem();
+    if (currentItem && m_ui->m_scanWidget->treeMain->indexOfTopLevelItem(currentItem) == hostIndex) {
+        showParserObj(hostIndex);
+        showParserObjPlugins(hostIndex);
+    }
+
+    saveAllLogs();
+}
+
+void ParserManager::setLogRecordObject(int hostIndex, PObject* elemObj)
+{
+    PObject* placeholder = m_parserObjList[hostIndex];
+    const LogRecord record = m_logRecords.take(placeholder);
+
+    QHash<int, PObject*>::iterator i = m_logRecordParses.begin();
+    while (i != m_logRecordParses.end()) {
+        // a pending parse of the same host is dropped
+        if (i.value() == placeholder) {
+            i = m_logRecordParses.erase(i);
+        } else {
+            ++i;
+        }
+    }
+
+    QTreeWidgetItem* scanTreeItem = m_ui->m_scanWidget->treeMain->topLevelItem(hostIndex);
+    scanTreeItem->setIcon(0, QIcon());
+    showHostItem(elemObj, scanTreeItem);
+    elemObj->setId(placeholder->getId());
+
+    // keep the archive date
+    scanTreeItem->setText(0, record.hostName + " (" + record.scanDate + ')');
+
+    m_parserObjList[hostIndex] = elemObj;
+    m_resultIndex.addObject(hostIndex, elemObj);
+    decodeNseScripts(elemObj);
+    correlateCves(elemObj);
+    delete placeholder;
+}
+
+void ParserManager::decodeNseScripts(PObject* object)
+{
+    bool isDecoderFound = false;
+    for (const NseScriptResult& script : object->getNseScripts()) {
+        if (NseResultParser::hasDecoder(script.scriptName)) {
+            isDecoderFound = true;
+            break;
+        }
+    }
+
+    if (!isDecoderFound) {
+        return;
+    }
+
+    const int serial = ++m_nseDecodeSerial;
+    m_nseDecodes.insert(serial, object);
+    m_workerPool.start(new NseDecodeTask(this, "nseScriptsDecoded", serial, object->getNseScripts()));
+}
+
+void ParserManager::nseScriptsDecoded(int serial, const QList<NseScriptResult> scripts)
+{
+    PObject* object = m_nseDecodes.take(serial);
+
+    if (!object) {
+        // results cleared while decoding
+        return;
+    }
+
+    object->setNseScripts(scripts);
+
+    const int hostIndex = m_parserObjList.indexOf(object);
+    if (hostIndex != -1) {
+        m_resultIndex.addScripts(hostIndex, scripts);
+    }
+}
+
+QList<VulnerabilityTarget> ParserManager::vulnerabilityTargets()
+{
+    QList<VulnerabilityTarget> targets;
+
+    for (int hostIndex = 0; hostIndex < m_parserObjList.size(); ++hostIndex) {
+        PObject* object = m_parserObjList[hostIndex];
+
+        VulnerabilityTarget target;
+        target.hostName = object->getHostName();
+
+        if (m_logRecords.contains(object)) {
+            // imported hosts not yet parsed are read from the index
+            IndexFields fields;
+            if (!m_resultIndex.fields(hostIndex, fields)) {
+                // the light pass of the block is not yet completed
+                ResultIndex::readFields(LogReader::readRecord(m_logRecords.value(object)), fields);
+            }
+
+            for (const QString& line : fields.portLines) {
+                if (line.contains("open") || line.contains("filtered")) {
+                    target.ports.append(line);
+                }
+            }
+            target.hostInfo = fields.hostInfo;
+            target.scripts = fields.scripts;
+        } else {
+            // closed ports are not useful
+            target.ports << object->getPortOpen() << object->getPortFiltered();
+            target.hostInfo = object->getHostInfo();
+            target.scripts = object->getNseScripts();
+        }
+
+        targets.append(target);
+    }
+
+    return targets;
+}
+
+void ParserManager::correlateCves(PObject* object)
+{
+    const QSharedPointer<const CveIndex> index = m_ui->m_vulnerability->cveIndex();
+
+    if (!index || index->isEmpty()) {
+        return;
+    }
+
+    const int serial = ++m_cveCorrelateSerial;
+    m_cveCorrelations.insert(serial, object);
+    m_workerPool.start(new CveCorrelateTask(this, "cvesCorrelated", serial, index, object));
+}
+
+void ParserManager::correlateAllCves()
+{
+    m_cveCorrelations.clear();
+
+    for (PObject* object : m_parserObjList) {
+        // imported hosts are correlated on first use
+        if (!m_logRecords.contains(object)) {
+            correlateCves(object);
+        }
+    }
+}
+
+void ParserManager::cvesCorrelated(int serial, const QList<CveMatch> matches)
+{
+    PObject* object = m_cveCorrelations.take(serial);
+
+    if (!object) {
+        return;
+    }
+
+    object->setCveMatches(matches);
+
+    const int hostIndex = m_parserObjList.indexOf(object);
+    QTreeWidgetItem* currentItem = m_ui->m_scanWidget->treeMain->currentItem();
+
+    if (hostIndex != -1 && currentItem
+            && m_ui->m_scanWidget->treeMain->indexOfTopLevelItem(currentItem) == hostIndex) {
+        showParserObj(hostIndex);
+    }
+}
+
+void ParserManager::logRecordsIndexed(int generation, const QList<IndexFields> fieldsList)
+{
+    if (generation != m_logIndexGeneration) {
+        return;
+    }
+
+    for (const IndexFields& fields : fieldsList) {
+        if (fields.id < m_parserObjList.size()) {
+            m_resultIndex.addFields(fields);
+        }
+    }
+
+    if (!m_ui->m_scanWidget->searchResultsEdit->text().isEmpty()) {
+        m_searchTimer.start();
+    }
+}
+
+void ParserManager::searchResults()
+{
+    QTreeWidget* treeMain = m_ui->m_scanWidget->treeMain;
+    const QString& query = m_ui->m_scanWidget->searchResultsEdit->text().trimmed();
+
+    treeMain->setUpdatesEnabled(false);
+
+    if (query.isEmpty()) {
+        for (int index = 0; index < treeMain->topLevelItemCount(); ++index) {
+            treeMain->topLevelItem(index)->setHidden(false);
+        }
+    } else {
+        const QSet<int> matches = m_resultIndex.search(query);
+        for (int index = 0; index < treeMain->topLevelItemCount(); ++index) {
+            treeMain->topLevelItem(index)->setHidden(!matches.contains(index));
+        }
+    }
+
+    treeMain->setUpdatesEnabled(true);
 }
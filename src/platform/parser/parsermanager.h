@@ -21,6 +21,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QtCore/QObject>
 #include <QtCore/QDir>
 #include <QtCore/QDateTime>
+#include <QtCore/QPointer>
+#include <QtCore/QTimer>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QThreadPool>
 #include <QTreeWidgetItem>
 #include <QMessageBox>
 #include <QSplitter>
@@ -29,6 +33,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "pobjects.h"
 #include "memorytools.h"
 #include "logwriter.h"
+#include "logreader.h"
+#include "resultindex.h"
+#include "nseresultparser.h"
+#include "scanparser.h"
+#include "cvedatabase.h"
+#include "vulnerabilitylookup.h"
 #include "regularexpression.h"
 #include "notify.h"
 
@@ -50,24 +60,89 @@ public:
      */
     void addUtilObject(PObjectLookup* object);
     void syncSettings();
-    void startParser(const QStringList parList, QByteArray dataBuffer,  QByteArray errorBuffer, int id);
+    /*
+     * Parse and show a scan result, the object is owned by the parser.
+     * Return null when nmap is not started.
+     */
+    PObject* startParser(const QStringList& parList, const QByteArray& dataBuffer, const QByteArray& errorBuffer, int id);
+    /*
+     * Parse time in msecs of the last startParser
+     */
+    qint64 lastParseTime() const;
+    /*
+     * Values of all hosts for the vulnerability lookup,
+     * not yet loaded log records are read from the result index
+     */
+    QList<VulnerabilityTarget> vulnerabilityTargets();
 
 private:
     void showParserObj(int hostIndex);
     void showParserObjPlugins(int hostIndex);
     void setPortItem(QTreeWidgetItem* item, const QStringList& details, bool& isPortDescriptionPresent);
-    PObject* parserCore(const QStringList parList, QByteArray StdoutStr, QByteArray StderrorStr, QTreeWidgetItem* mainTreeE);
+    PObject* parserCore(const QStringList& parList, const QByteArray& StdoutStr, const QByteArray& StderrorStr, QTreeWidgetItem* mainTreeE);
+    /*
+     * Set the host icon and tooltip from a parsed object
+     */
+    void showHostItem(PObject* object, QTreeWidgetItem* scanTreeItem);
+    /*
+     * Start the log reader thread for files or directories
+     */
+    void startLogReader(const QStringList& pathList);
+    /*
+     * Parse an imported host from its log file on first use,
+     * requestLogRecord parses it on the thread pool.
+     */
+    void loadLogRecord(int hostIndex);
+    void requestLogRecord(int hostIndex);
+    void setLogRecordObject(int hostIndex, PObject* elemObj);
+    /*
+     * Write the logs of "save all" when no imported host is parsing
+     */
+    void saveAllLogs();
+    /*
+     * Decode the nse script output on the thread pool
+     */
+    void decodeNseScripts(PObject* object);
+    /*
+     * Match the host services with the offline CVE index on the thread pool
+     */
+    void correlateCves(PObject* object);
+    void showCveMatches(int hostIndex);
 
     MainWindow* m_ui;
     QList<PObject*> m_parserObjList;
+    QHash<PObject*, LogRecord> m_logRecords;
+    QPointer<LogReader> m_logReader;
+    ResultIndex m_resultIndex;
+    // light index of the imported hosts, dropped on clear
+    int m_logIndexGeneration;
+    QTimer m_searchTimer;
+    // nse decode and cve correlation tasks
+    QThreadPool m_workerPool;
+    QHash<int, PObject*> m_nseDecodes;
+    int m_nseDecodeSerial;
+    QHash<int, PObject*> m_cveCorrelations;
+    int m_cveCorrelateSerial;
+    // placeholders of the imported hosts parsed on the thread pool
+    QHash<int, PObject*> m_logRecordParses;
+    int m_logRecordParseSerial;
+    // directory of a "save all" waiting for the imported hosts
+    QString m_saveAllPath;
     QList<PObjectLookup*> m_parserObjUtilList;
     QList<QTreeWidgetItem*> m_itemListScan;
     QList<QTreeWidgetItem*> m_treeItems;
     QSplitter *m_rawlogHorizontalSplitter;
+    qint64 m_lastParseTime;
 
 public slots:
     void callSaveSingleLogWriter();
     void callSaveAllLogWriter();
+    void callLoadLogFiles();
+    void callLoadLogDirectory();
+    /*
+     * Correlate every parsed host again, the CVE index is changed
+     */
+    void correlateAllCves();
 
 private slots:
     /*
@@ -75,6 +150,16 @@ private slots:
      */
     void showParserResult(QTreeWidgetItem *item, int column);
     void showParserTracerouteResult(QTreeWidgetItem *item, int column);
+    void readLogRecords(const QList<LogRecord> records);
+    void logReaderFinished();
+    /*
+     * Add the fields of imported hosts read on the thread pool
+     */
+    void logRecordsIndexed(int generation, const QList<IndexFields> fieldsList);
+    void searchResults();
+    void nseScriptsDecoded(int serial, const QList<NseScriptResult> scripts);
+    void cvesCorrelated(int serial, const QList<CveMatch> matches);
+    void logRecordParsed(int serial, PObject* object);
 };
 
 #endif // PARSER_H
@@ -0,0 +1,572 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "resultindex.h"
+#include "scanparser.h"
+#include "regularexpression.h"
+
+#include <QtCore/QRegExp>
+
+namespace
+{
+QSet<int> intersectSet(const QSet<int>& first, const QSet<int>& second)
+{
+    // walk the smaller set
+    const QSet<int>& small = first.size() < second.size() ? first : second;
+    const QSet<int>& big = first.size() < second.size() ? second : first;
+
+    QSet<int> result;
+    for (int id : small) {
+        if (big.contains(id)) {
+            result.insert(id);
+        }
+    }
+
+    return result;
+}
+}
+
+ResultIndex::ResultIndex()
+{
+}
+
+void ResultIndex::clear()
+{
+    m_postings.clear();
+    m_ports.clear();
+    m_documents.clear();
+    m_objectDocuments.clear();
+    m_fields.clear();
+}
+
+void ResultIndex::addHostName(int id, const QString& hostName)
+{
+    m_documents.insert(id);
+    addToken("host", hostName.toLower(), id);
+    addText("host", hostName, id);
+}
+
+void ResultIndex::addObject(int id, PObject* object)
+{
+    if (m_objectDocuments.contains(id)) {
+        return;
+    }
+
+    m_objectDocuments.insert(id);
+    addHostName(id, object->getHostName());
+    // ports of a light pass are read again from the object
+    m_ports.remove(id);
+    m_fields.remove(id);
+
+    for (const QString& line : object->getPortOpen()) {
+        addPortLine(line, id);
+    }
+
+    for (const QString& line : object->getPortFiltered()) {
+        addPortLine(line, id);
+    }
+
+    for (const QString& line : object->getPortClose()) {
+        addPortLine(line, id);
+    }
+
+    for (const QString& line : object->getHostInfo()) {
+        addHostInfo(line, id);
+    }
+
+    const QHash<QString, QStringList>& nseResult = object->getNseResult();
+    QHash<QString, QStringList>::const_iterator i;
+    for (i = nseResult.constBegin(); i != nseResult.constEnd(); ++i) {
+        for (const QString& line : i.value()) {
+            addText("nse", line, id);
+        }
+    }
+
+    for (const QString& url : object->getVulnDiscoverd()) {
+        addToken("url", url.toLower(), id);
+        addText("url", url, id);
+    }
+
+    for (const NseScriptResult& script : object->getNseScripts()) {
+        addToken("script", script.scriptName, id);
+    }
+
+    addScripts(id, object->getNseScripts());
+}
+
+void ResultIndex::addFields(const IndexFields& fields)
+{
+    if (m_objectDocuments.contains(fields.id)) {
+        return;
+    }
+
+    m_documents.insert(fields.id);
+    m_ports.remove(fields.id);
+
+    for (const QString& line : fields.portLines) {
+        addPortLine(line, fields.id);
+    }
+
+    for (const QString& line : fields.hostInfo) {
+        addHostInfo(line, fields.id);
+    }
+
+    m_fields.insert(fields.id, fields);
+}
+
+bool ResultIndex::fields(int id, IndexFields& fields) const
+{
+    QHash<int, IndexFields>::const_iterator i = m_fields.constFind(id);
+
+    if (i == m_fields.constEnd()) {
+        return false;
+    }
+
+    fields = i.value();
+    return true;
+}
+
+void ResultIndex::readFields(const QByteArray& output, IndexFields& fields)
+{
+    QRegExp portRx(matchPorts);
+    // port line or "Host script results:" of the nse lines
+    QString target;
+    int start = 0;
+
+    while (start < output.size()) {
+        int end = output.indexOf('\n', start);
+        if (end == -1) {
+            end = output.size();
+        }
+
+        const int size = (end > start && output.at(end - 1) == '\r') ? end - start - 1 : end - start;
+        const QString line(QString::fromUtf8(output.constData() + start, size));
+        start = end + 1;
+
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        if (line.at(0) == '|') {
+            // nse lines are the most, only the cpe values are read
+            const int cpe = line.indexOf(QLatin1String("cpe:/"));
+            if (cpe != -1 && !target.isEmpty()) {
+                if (fields.scripts.isEmpty() || fields.scripts.last().target != target) {
+                    NseScriptResult script;
+                    script.target = target;
+                    fields.scripts.append(script);
+                }
+                fields.scripts.last().lines.append(line.mid(cpe).section(QLatin1Char(' '), 0, 0));
+            }
+        } else if (line.at(0).isDigit()) {
+            if (portRx.indexIn(line) != -1) {
+                fields.portLines.append(line);
+                target = line;
+            }
+        } else if (line.startsWith(QLatin1String("Host script results:"))) {
+            target = line;
+        } else if (ScanParser::isHostInfoLine(line)) {
+            fields.hostInfo.append(line);
+        }
+    }
+}
+
+void ResultIndex::addScripts(int id, const QList<NseScriptResult>& scripts)
+{
+    for (const NseScriptResult& script : scripts) {
+        const QVariantMap& fields = script.fields;
+
+        if (fields.isEmpty()) {
+            continue;
+        }
+
+        if (script.scriptName == QLatin1String("vulners")) {
+            for (const QString& vulnerability : fields.value("ids").toStringList()) {
+                addToken("cve", vulnerability.toLower(), id);
+            }
+        } else if (script.scriptName == QLatin1String("http-title")) {
+            addText("title", fields.value("title").toString(), id);
+        } else if (script.scriptName == QLatin1String("ssl-cert")) {
+            addToken("cert", fields.value("commonName").toString().toLower(), id);
+            for (const QString& name : fields.value("subjectAltNames").toStringList()) {
+                addToken("cert", name.toLower(), id);
+            }
+        } else if (script.scriptName == QLatin1String("smb-os-discovery")) {
+            addText("os", fields.value("os").toString(), id);
+            addToken("domain", fields.value("domainName").toString().toLower(), id);
+            addToken("host", fields.value("fqdn").toString().toLower(), id);
+        }
+    }
+}
+
+void ResultIndex::addPortLine(const QString& line, int id)
+{
+    // 443/tcp open https nginx 1.4.6 (Ubuntu)
+    const QStringList values = line.split(' ', QString::SkipEmptyParts);
+
+    if (values.size() < 3) {
+        return;
+    }
+
+    PortRecord record;
+    const int slash = values[0].indexOf('/');
+    record.port = values[0].left(slash).toInt();
+    record.protocol = values[0].mid(slash + 1).toLower();
+    record.state = values[1].toLower();
+    record.service = values[2].toLower();
+
+    // product tokens are before the first version number
+    for (int index = 3; index < values.size(); ++index) {
+        const QString& value = values[index];
+        if (value.at(0).isDigit()) {
+            record.version = value.toLower();
+            break;
+        }
+        if (value.startsWith('(')) {
+            break;
+        }
+        record.product.append(value.toLower());
+    }
+
+    m_ports[id].append(record);
+
+    addToken("port", QString::number(record.port), id);
+    addToken("proto", record.protocol, id);
+    addToken("state", record.state, id);
+    addToken("service", record.service, id);
+    addText("service", record.service, id);
+
+    for (const QString& product : record.product) {
+        addText("product", product, id);
+        addText("service", product, id);
+    }
+
+    if (!record.version.isEmpty()) {
+        addToken("version", record.version, id);
+    }
+
+    addText("any", line, id);
+}
+
+void ResultIndex::addHostInfo(const QString& line, int id)
+{
+    if (line.contains("OS") || line.startsWith(QLatin1String("Running"))
+            || line.startsWith(QLatin1String("Device type:"))) {
+        addText("os", line.mid(line.indexOf(':') + 1), id);
+    } else {
+        addText("any", line, id);
+    }
+}
+
+void ResultIndex::addToken(const QString& field, const QString& token, int id)
+{
+    if (token.isEmpty()) {
+        return;
+    }
+
+    m_postings[field + ':' + token].insert(id);
+
+    if (field != QLatin1String("any")) {
+        m_postings["any:" + token].insert(id);
+    }
+}
+
+void ResultIndex::addText(const QString& field, const QString& text, int id)
+{
+    for (const QString& token : tokenize(text)) {
+        addToken(field, token, id);
+    }
+}
+
+QStringList ResultIndex::tokenize(const QString& text)
+{
+    QStringList tokens;
+    QString token;
+
+    for (const QChar& c : text) {
+        const QChar lower = c.toLower();
+        if (lower.isLetterOrNumber() || lower == '.' || lower == '-' || lower == '_') {
+            token.append(lower);
+        } else if (!token.isEmpty()) {
+            tokens.append(token);
+            token.clear();
+        }
+    }
+
+    if (!token.isEmpty()) {
+        tokens.append(token);
+    }
+
+    QStringList result;
+    for (QString& value : tokens) {
+        while (value.endsWith('.') || value.endsWith('-') || value.endsWith('_')) {
+            value.chop(1);
+        }
+        if (value.size() > 1 || (value.size() == 1 && value.at(0).isDigit())) {
+            result.append(value);
+        }
+    }
+
+    return result;
+}
+
+bool ResultIndex::isPortField(const QString& field)
+{
+    return field == QLatin1String("port") || field == QLatin1String("proto")
+           || field == QLatin1String("state") || field == QLatin1String("service")
+           || field == QLatin1String("product") || field == QLatin1String("version");
+}
+
+bool ResultIndex::parseTerm(const QString& text, QueryTerm& term)
+{
+    int pos = -1;
+    for (int index = 1; index < text.size(); ++index) {
+        const QChar c = text.at(index);
+        if (c == ':' || c == '=' || c == '<' || c == '>') {
+            pos = index;
+            break;
+        }
+    }
+
+    term.compare = Equal;
+
+    if (pos == -1) {
+        term.field = "any";
+        term.value = text.toLower();
+    } else {
+        term.field = text.left(pos).toLower();
+        int valuePos = pos + 1;
+
+        if (text.at(pos) == '<' || text.at(pos) == '>') {
+            const bool isEqual = (valuePos < text.size() && text.at(valuePos) == '=');
+            if (text.at(pos) == '<') {
+                term.compare = isEqual ? LessEqual : Less;
+            } else {
+                term.compare = isEqual ? GreaterEqual : Greater;
+            }
+            if (isEqual) {
+                valuePos++;
+            }
+        }
+
+        term.value = text.mid(valuePos).toLower();
+    }
+
+    term.isPrefix = term.value.endsWith('*');
+    if (term.isPrefix) {
+        term.value.chop(1);
+    }
+
+    if (term.compare != Equal && term.field != QLatin1String("port")
+            && term.field != QLatin1String("version")) {
+        // range search only for numeric fields
+        term.compare = Equal;
+    }
+
+    return !term.value.isEmpty();
+}
+
+QSet<int> ResultIndex::termDocuments(const QueryTerm& term) const
+{
+    const QString key(term.field + ':' + term.value);
+
+    if (!term.isPrefix) {
+        return m_postings.value(key);
+    }
+
+    // terms are sorted, the prefix terms follow the key
+    QSet<int> result;
+    QMap<QString, QSet<int> >::const_iterator i;
+    for (i = m_postings.lowerBound(key); i != m_postings.constEnd() && i.key().startsWith(key); ++i) {
+        result.unite(i.value());
+    }
+
+    return result;
+}
+
+QSet<int> ResultIndex::search(const QString& query) const
+{
+    QList<QueryTerm> portTerms;
+    QList<QSet<int> > candidateList;
+
+    for (const QString& text : query.split(' ', QString::SkipEmptyParts)) {
+        QueryTerm term;
+        if (!parseTerm(text, term)) {
+            continue;
+        }
+
+        if (isPortField(term.field)) {
+            portTerms.append(term);
+        }
+
+        if (term.compare == Equal) {
+            candidateList.append(termDocuments(term));
+        }
+    }
+
+    QSet<int> result;
+
+    if (candidateList.isEmpty()) {
+        if (portTerms.isEmpty()) {
+            return result;
+        }
+        result = m_documents;
+    } else {
+        // start from the smaller posting list
+        int smallIndex = 0;
+        for (int index = 1; index < candidateList.size(); ++index) {
+            if (candidateList[index].size() < candidateList[smallIndex].size()) {
+                smallIndex = index;
+            }
+        }
+
+        result = candidateList[smallIndex];
+        for (int index = 0; index < candidateList.size() && !result.isEmpty(); ++index) {
+            if (index != smallIndex) {
+                result = intersectSet(result, candidateList[index]);
+            }
+        }
+    }
+
+    if (portTerms.isEmpty() || result.isEmpty()) {
+        return result;
+    }
+
+    // the port values must be found on the same port
+    QSet<int> portResult;
+    for (int id : result) {
+        for (const PortRecord& record : m_ports.value(id)) {
+            if (portMatches(record, portTerms)) {
+                portResult.insert(id);
+                break;
+            }
+        }
+    }
+
+    return portResult;
+}
+
+bool ResultIndex::portMatches(const PortRecord& record, const QList<QueryTerm>& terms) const
+{
+    for (const QueryTerm& term : terms) {
+        if (term.field == QLatin1String("port")) {
+            if (term.isPrefix) {
+                if (!matchValue(QString::number(record.port), term)) {
+                    return false;
+                }
+            } else if (!compareValues(record.port - term.value.toInt(), term.compare)) {
+                return false;
+            }
+        } else if (term.field == QLatin1String("version")) {
+            if (record.version.isEmpty()) {
+                return false;
+            }
+            if (term.compare == Equal) {
+                if (!matchValue(record.version, term)) {
+                    return false;
+                }
+            } else if (!compareValues(compareVersion(record.version, term.value), term.compare)) {
+                return false;
+            }
+        } else if (term.field == QLatin1String("proto")) {
+            if (!matchValue(record.protocol, term)) {
+                return false;
+            }
+        } else if (term.field == QLatin1String("state")) {
+            if (!matchValue(record.state, term)) {
+                return false;
+            }
+        } else {
+            bool isFound = (term.field == QLatin1String("service")) && matchValue(record.service, term);
+            for (int index = 0; !isFound && index < record.product.size(); ++index) {
+                isFound = matchValue(record.product[index], term);
+            }
+            if (!isFound && term.field == QLatin1String("service")) {
+                // ssl/http
+                for (const QString& token : tokenize(record.service)) {
+                    if (matchValue(token, term)) {
+                        isFound = true;
+                        break;
+                    }
+                }
+            }
+            if (!isFound) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool ResultIndex::matchValue(const QString& value, const QueryTerm& term)
+{
+    return term.isPrefix ? value.startsWith(term.value) : value == term.value;
+}
+
+bool ResultIndex::compareValues(int result, CompareType compare)
+{
+    switch (compare) {
+    case Equal:
+        return result == 0;
+    case Less:
+        return result < 0;
+    case LessEqual:
+        return result <= 0;
+    case Greater:
+        return result > 0;
+    case GreaterEqual:
+        return result >= 0;
+    }
+
+    return false;
+}
+
+int ResultIndex::compareVersion(const QString& first, const QString& second)
+{
+    // compare numeric groups: 1.4.6 < 1.18, 5.9p1 > 5.9
+    QVector<int> firstParts;
+    QVector<int> secondParts;
+    const QString* values[2] = { &first, &second };
+    QVector<int>* parts[2] = { &firstParts, &secondParts };
+
+    for (int index = 0; index < 2; ++index) {
+        int number = -1;
+        for (const QChar& c : *values[index]) {
+            if (c.isDigit()) {
+                number = (number == -1) ? c.digitValue() : number * 10 + c.digitValue();
+            } else if (number != -1) {
+                parts[index]->append(number);
+                number = -1;
+            }
+        }
+        if (number != -1) {
+            parts[index]->append(number);
+        }
+    }
+
+    const int size = qMax(firstParts.size(), secondParts.size());
+    for (int index = 0; index < size; ++index) {
+        const int firstValue = firstParts.value(index, 0);
+        const int secondValue = secondParts.value(index, 0);
+        if (firstValue != secondValue) {
+            return firstValue < secondValue ? -1 : 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,154 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef RESULTINDEX_H
+#define RESULTINDEX_H
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QHash>
+#include <QtCore/QMap>
+#include <QtCore/QSet>
+#include <QtCore/QVector>
+#include <QtCore/QList>
+#include <QtCore/QByteArray>
+#include <QtCore/QMetaType>
+
+#include "pobjects.h"
+
+/*!
+ * Port and host info lines of a not yet parsed host,
+ * read with a light pass over the nmap output.
+ */
+class IndexFields
+{
+
+public:
+    IndexFields() : id(-1) {};
+
+    int id;
+    QStringList portLines;
+    QStringList hostInfo;
+    // only the cpe lines of the nse output
+    QList<NseScriptResult> scripts;
+};
+
+Q_DECLARE_METATYPE(QList<IndexFields>)
+
+/*!
+ * Inverted index over parsed scan results.
+ * Every host is a document identified by its position in the
+ * parser list, the query syntax is a list of terms:
+ *
+ *   nginx                 free text on every field
+ *   port:443              port, proto, state, service, product, version
+ *   host:192.168.1.1      host, os, nse, url, script
+ *   cve:cve-2018-15919    cve, title, cert, domain from decoded scripts
+ *   version<1.18          <, <=, >, >= for port and version fields
+ *   service:http*         prefix match, field values are exact
+ *                         otherwise: version:2 does not match 2.4
+ *
+ * Port fields of a query must match the same port of the host.
+ */
+class ResultIndex
+{
+
+public:
+    ResultIndex();
+    ~ResultIndex() {};
+
+    void clear();
+    /*
+     * Add only the host name for a not yet parsed host
+     */
+    void addHostName(int id, const QString& hostName);
+    /*
+     * Add all values of a parsed host
+     */
+    void addObject(int id, PObject* object);
+    /*
+     * Add the port and host info lines of a not yet parsed host,
+     * ignored when the object is already indexed
+     */
+    void addFields(const IndexFields& fields);
+    /*
+     * Fields of a host added with addFields, false when the host is
+     * parsed or not yet indexed
+     */
+    bool fields(int id, IndexFields& fields) const;
+    /*
+     * Add the decoded fields of the nse scripts
+     */
+    void addScripts(int id, const QList<NseScriptResult>& scripts);
+    QSet<int> search(const QString& query) const;
+    /*
+     * Read only the indexed lines from the nmap output, of the nse
+     * output only the cpe values, it is indexed when the host is parsed
+     */
+    static void readFields(const QByteArray& output, IndexFields& fields);
+    /*
+     * Compare the numeric groups of two versions, returns -1, 0 or 1
+     */
+    static int compareVersion(const QString& first, const QString& second);
+
+private:
+    enum CompareType {
+        Equal,
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual
+    };
+
+    struct PortRecord {
+        int port;
+        QString protocol;
+        QString state;
+        QString service;
+        QStringList product;
+        QString version;
+    };
+
+    struct QueryTerm {
+        QString field;
+        QString value;
+        CompareType compare;
+        bool isPrefix;
+    };
+
+    // sorted by term for the prefix lookups
+    QMap<QString, QSet<int> > m_postings;
+    QHash<int, QVector<PortRecord> > m_ports;
+    QSet<int> m_documents;
+    QSet<int> m_objectDocuments;
+    QHash<int, IndexFields> m_fields;
+
+    void addToken(const QString& field, const QString& token, int id);
+    void addText(const QString& field, const QString& text, int id);
+    void addPortLine(const QString& line, int id);
+    void addHostInfo(const QString& line, int id);
+    QSet<int> termDocuments(const QueryTerm& term) const;
+    bool portMatches(const PortRecord& record, const QList<QueryTerm>& terms) const;
+
+    static QStringList tokenize(const QString& text);
+    static bool parseTerm(const QString& text, QueryTerm& term);
+    static bool isPortField(const QString& field);
+    static bool compareValues(int result, CompareType compare);
+    static bool matchValue(const QString& value, const QueryTerm& term);
+};
+
+#endif // RESULTINDEX_H
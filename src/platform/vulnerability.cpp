@@ -18,6 +18,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "vulnerability.h"
 #include "mainwindow.h"
 
+#include <QFileDialog>
+
 VulnerabilityWidget::VulnerabilityWidget(QWidget* parent): QWidget(parent)
 {
     setupUi(this);
@@ -26,12 +28,32 @@ VulnerabilityWidget::VulnerabilityWidget(QWidget* parent): QWidget(parent)
 Vulnerability::Vulnerability(MainWindow* parent)
     : QObject(parent), m_ui(parent), m_completerVuln(0), m_vulnModel(0)
 {
+    m_cveDatabase = new CveDatabase(this);
+    connect(m_cveDatabase, &CveDatabase::databaseReady,
+            this, &Vulnerability::cveDatabaseReady);
+    connect(m_cveDatabase, &CveDatabase::databaseReady,
+            m_ui->m_parser, &ParserManager::correlateAllCves);
+    connect(m_cveDatabase, &CveDatabase::importFailed,
+            this, &Vulnerability::cveImportFailed);
+    // load the local index
+    m_cveDatabase->start();
+
+    m_lookup = new VulnerabilityLookup(this);
+    connect(m_cveDatabase, &CveDatabase::databaseReady,
+            m_lookup, &VulnerabilityLookup::clearCache);
 
     m_vulnerabilityWidget = new VulnerabilityWidget(m_ui);
 
     m_vulnerabilityWidget->tWresult->setTabsClosable(true);
     m_vulnerabilityWidget->tWresult->removeTab(0);
     m_vulnerabilityWidget->tWresult->setVisible(false);
+
+    m_webTabs = new WebTabManager(m_vulnerabilityWidget->tWresult, this);
+    updateWebViewBudget();
+    connect(m_webTabs, &WebTabManager::loadProgress,
+            m_vulnerabilityWidget->progressWeb, &QProgressBar::setValue);
+    connect(m_webTabs, &WebTabManager::loadFinished,
+            this, &Vulnerability::vulnPostScan);
     updateCompleter();
     loadSearchUrlIntoCombo();
 
@@ -94,6 +116,72 @@ void Vulnerability::syncSettings()
     settings.setValue("vulnUrlComboIndex", m_vulnerabilityWidget->comboWebV->currentIndex());
 }
 
+void Vulnerability::updateWebViewBudget()
+{
+    QSettings settings("nmapsi4", "nmapsi4");
+    m_webTabs->setMemoryBudget(settings.value("webViewMemoryBudget", 600).toInt());
+}
+
+QSharedPointer<const CveIndex> Vulnerability::cveIndex() const
+{
+    return m_cveDatabase->index();
+}
+
+void Vulnerability::importCveFeeds()
+{
+    const QStringList fileNames = QFileDialog::getOpenFileNames(m_ui, tr("Import NVD CVE feeds"),
+                                  QDir::homePath(), tr("NVD JSON feeds (*.json);;All files (*)"));
+
+    if (fileNames.isEmpty()) {
+        return;
+    }
+
+    if (!m_cveDatabase->importFeeds(fileNames)) {
+        QMessageBox::warning(m_ui, "NmapSI4", tr("An import of CVE feeds is already running."), tr("Close"));
+        return;
+    }
+
+    m_ui->m_collections->m_collectionsVulnerability.value("import-cve-act")->setEnabled(false);
+}
+
+void Vulnerability::checkAllHosts()
+{
+    if (m_lookup->isRunning()) {
+        QMessageBox::warning(m_ui, "NmapSI4", tr("A vulnerability lookup is already running."), tr("Close"));
+        return;
+    }
+
+    const QList<VulnerabilityTarget> targets = m_ui->m_parser->vulnerabilityTargets();
+
+    if (targets.isEmpty()) {
+        QMessageBox::information(m_ui, "NmapSI4", tr("No scan results to check."), tr("Close"));
+        return;
+    }
+
+    VulnerabilityMatrixDialog* dialog = new VulnerabilityMatrixDialog(m_lookup, m_ui);
+    dialog->show();
+
+    if (!m_lookup->start(targets, cveIndex())) {
+        dialog->close();
+        QMessageBox::warning(m_ui, "NmapSI4",
+                             tr("No vulnerability source: import a CVE feed or set a local mirror address."),
+                             tr("Close"));
+    }
+}
+
+void Vulnerability::cveDatabaseReady(int cveNumber)
+{
+    m_ui->m_collections->m_collectionsVulnerability.value("import-cve-act")->setEnabled(true);
+    m_ui->m_collections->m_collectionsVulnerability.value("import-cve-act")->setToolTip(
+        tr("Offline CVE index: %1 vulnerabilities").arg(cveNumber));
+}
+
+void Vulnerability::cveImportFailed(const QString& error)
+{
+    m_ui->m_collections->m_collectionsVulnerability.value("import-cve-act")->setEnabled(true);
+    QMessageBox::warning(m_ui, "NmapSI4", tr("CVE feed import failed:\n") + error, tr("Close"));
+}
+
 void Vulnerability::updateCompleter()
 {
     // load vulnerability services string model
@@ -188,18 +276,12 @@ void Vulnerability::openTab(const QUrl& address, const QString& tabName)
 
     m_welcomeQml->setVisible(false);
     // make tabBar visible for the first search
-    if (!m_webViewList.size()) {
+    if (!m_webTabs->count()) {
         m_vulnerabilityWidget->tWresult->setVisible(true);
     }
 
-    // create new tab with a QWebEngineView
-    QWebEngineView *page = new QWebEngineView(m_ui);
-    page->setContextMenuPolicy(Qt::NoContextMenu);
-    m_webViewList.push_back(page);
-    page->load(address);
-    m_vulnerabilityWidget->tWresult->addTab(page, tabName);
-    connect(page, &QWebEngineView::loadProgress, m_vulnerabilityWidget->progressWeb, &QProgressBar::setValue);
-    connect(page, &QWebEngineView::loadFinished, this, &Vulnerability::vulnPostScan);
+    // views are reused from the pool of the tab manager
+    m_webTabs->openTab(address, tabName);
 }
 
 void Vulnerability::searchVulnFromTreeWidget()
@@ -218,11 +300,9 @@ void Vulnerability::searchVulnFromTreeWidget()
 
 void Vulnerability::closeVulnTab(int index)
 {
-    QWebEngineView *page = m_webViewList.takeAt(index);
-    m_vulnerabilityWidget->tWresult->removeTab(index);
-    delete page;
+    m_webTabs->closeTab(index);
 
-    if (!m_webViewList.size()) {
+    if (!m_webTabs->count()) {
         m_vulnerabilityWidget->tWresult->setVisible(false);
         m_welcomeQml->setVisible(true);
         // disable search action in vulnerability toolBar
@@ -232,17 +312,29 @@ void Vulnerability::closeVulnTab(int index)
 
 void Vulnerability::tabWebBack()
 {
-    m_webViewList[m_vulnerabilityWidget->tWresult->currentIndex()]->triggerPageAction(QWebEnginePage::Back);
+    QWebEngineView* view = m_webTabs->currentView();
+
+    if (view) {
+        view->triggerPageAction(QWebEnginePage::Back);
+    }
 }
 
 void Vulnerability::tabWebForward()
 {
-    m_webViewList[m_vulnerabilityWidget->tWresult->currentIndex()]->triggerPageAction(QWebEnginePage::Forward);
+    QWebEngineView* view = m_webTabs->currentView();
+
+    if (view) {
+        view->triggerPageAction(QWebEnginePage::Forward);
+    }
 }
 
 void Vulnerability::tabWebStop()
 {
-    m_webViewList[m_vulnerabilityWidget->tWresult->currentIndex()]->triggerPageAction(QWebEnginePage::Stop);
+    QWebEngineView* view = m_webTabs->currentView();
+
+    if (view) {
+        view->triggerPageAction(QWebEnginePage::Stop);
+    }
 }
 
 void Vulnerability::vulnPostScan()
@@ -31,10 +31,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QWebEnginePage>
 #include <QtQuick/QQuickView>
 #include <QPointer>
+#include <QtCore/QSharedPointer>
 
 // local include
 #include "addvulnerabilityurl.h"
 #include "package.h"
+#include "cvedatabase.h"
+#include "vulnerabilitylookup.h"
+#include "vulnerabilitymatrixdialog.h"
+#include "webtabmanager.h"
 
 class MainWindow;
 
@@ -57,6 +62,14 @@ public:
     **/
     void loadSearchUrlIntoCombo();
     void syncSettings();
+    /**
+    * Offline CVE index, null until it is loaded.
+    **/
+    QSharedPointer<const CveIndex> cveIndex() const;
+    /**
+    * Read the memory budget of the web pages from the settings.
+    **/
+    void updateWebViewBudget();
 
     VulnerabilityWidget* m_vulnerabilityWidget;
     QSplitter* m_mainHorizontalLeftSplitter;
@@ -66,11 +79,13 @@ private:
     void updateCompleter();
     const QList< QPair<QString, QString> > getDefaultUrlList();
 
-    QList<QWebEngineView*> m_webViewList;
+    WebTabManager* m_webTabs;
     MainWindow* m_ui;
     QQuickView* m_welcomeQml;
     QCompleter* m_completerVuln;
     QStringListModel* m_vulnModel;
+    CveDatabase* m_cveDatabase;
+    VulnerabilityLookup* m_lookup;
 
 public slots:
     /**
@@ -86,6 +101,11 @@ public slots:
     void showAddUrlUi();
     void openUrlFromScanPortsTree();
     void removeUrlToBookmarks();
+    void importCveFeeds();
+    /**
+     * Check the services of all hosts and show the vulnerability matrix
+     **/
+    void checkAllHosts();
 
 private slots:
     void vulnPostScan();
@@ -95,6 +115,8 @@ private slots:
     void updateComboServicesProperties();
     void updateComboVuln(const QString& value);
     void searchVulnFromTreeWidget();
+    void cveDatabaseReady(int cveNumber);
+    void cveImportFailed(const QString& error);
 };
 
 #endif // VULNERABILITY_H
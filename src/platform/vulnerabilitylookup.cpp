@@ -0,0 +1,374 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "vulnerabilitylookup.h"
+
+#include <QtCore/QSettings>
+#include <QtCore/QRegExp>
+#include <QtCore/QUrl>
+#include <QtCore/QMetaObject>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QJsonArray>
+#include <QtNetwork/QNetworkRequest>
+
+#include <algorithm>
+
+VulnerabilityLookup::VulnerabilityLookup(QObject* parent)
+    : QObject(parent), m_network(new QNetworkAccessManager(this)), m_unresolved(0), m_total(0), m_serial(0)
+{
+    qRegisterMetaType<CveMatchHash>("CveMatchHash");
+    m_pool.setMaxThreadCount(2);
+}
+
+VulnerabilityLookup::~VulnerabilityLookup()
+{
+    cancel();
+    m_pool.waitForDone();
+}
+
+bool VulnerabilityLookup::isRunning() const
+{
+    return m_unresolved > 0;
+}
+
+void VulnerabilityLookup::cancel()
+{
+    // results of old tasks are dropped by the serial
+    ++m_serial;
+    m_pool.clear();
+    m_pendingKeys.clear();
+
+    const QList<QNetworkReply*> replies = m_replies;
+    m_replies.clear();
+    for (QNetworkReply* reply : replies) {
+        reply->abort();
+        reply->deleteLater();
+    }
+
+    m_hosts.clear();
+    m_unresolved = 0;
+}
+
+void VulnerabilityLookup::clearCache()
+{
+    m_cache.clear();
+}
+
+bool VulnerabilityLookup::start(const QList<VulnerabilityTarget>& targets, QSharedPointer<const CveIndex> index)
+{
+    if (isRunning()) {
+        return false;
+    }
+
+    QSettings settings("nmapsi4", "nmapsi4");
+    m_mirrorUrl = settings.value("vulnerabilityMirrorUrl").toString().trimmed();
+
+    if (m_mirrorUrl.isEmpty() && (!index || index->isEmpty())) {
+        return false;
+    }
+
+    // cached values are valid only for the same source
+    const QString source = m_mirrorUrl.isEmpty() ? QString("local") : m_mirrorUrl;
+    if (source != m_cacheSource) {
+        m_cache.clear();
+        m_cacheSource = source;
+    }
+
+    m_hosts.clear();
+    m_errors.clear();
+    QSet<QString> keys;
+
+    for (const VulnerabilityTarget& target : targets) {
+        HostKeys host;
+        host.hostName = target.hostName;
+
+        // 22/tcp open ssh OpenSSH 7.4 (protocol 2.0)
+        for (const QString& line : target.ports) {
+            const QStringList values = line.split(QLatin1Char(' '), QString::SkipEmptyParts);
+            QString product;
+            QString version;
+            if (values.size() > 3
+                    && CveIndex::readService(QStringList(values.mid(3)).join(QLatin1Char(' ')), product, version)) {
+                addKey(host, values[0], QLatin1String("service:") + product + QLatin1Char(' ') + version, keys);
+            }
+        }
+
+        for (const QString& line : target.hostInfo) {
+            for (const QString& token : line.split(QRegExp("[\\s,;]+"), QString::SkipEmptyParts)) {
+                if (token.startsWith(QLatin1String("cpe:/"))) {
+                    addKey(host, QString(), token, keys);
+                }
+            }
+        }
+
+        for (const NseScriptResult& script : target.scripts) {
+            QString port;
+            if (!script.target.startsWith(QLatin1String("Host script results:"))) {
+                port = script.target.left(script.target.indexOf(QLatin1Char(' ')));
+            }
+
+            for (const QString& line : script.lines) {
+                QString token = line.trimmed();
+                if (token.startsWith(QLatin1String("cpe:/"))) {
+                    if (token.endsWith(QLatin1Char(':'))) {
+                        token.chop(1);
+                    }
+                    addKey(host, port, token, keys);
+                }
+            }
+        }
+
+        m_hosts.append(host);
+    }
+
+    // every distinct tuple is resolved once
+    QStringList newKeys;
+    for (const QString& key : keys) {
+        if (!m_cache.contains(key)) {
+            newKeys.append(key);
+        }
+    }
+
+    m_total = keys.size();
+    m_unresolved = newKeys.size();
+
+    if (!m_unresolved) {
+        buildMatrix();
+        return true;
+    }
+
+    emit progress(m_total - m_unresolved, m_total);
+
+    if (!m_mirrorUrl.isEmpty()) {
+        m_pendingKeys = newKeys;
+        startRequests();
+    } else {
+        for (int start = 0; start < newKeys.size(); start += localBatchSize) {
+            m_pool.start(new CveLookupTask(this, "keysResolved", m_serial, index,
+                                           newKeys.mid(start, localBatchSize)));
+        }
+    }
+
+    return true;
+}
+
+void VulnerabilityLookup::addKey(HostKeys& host, const QString& port, const QString& key, QSet<QString>& keys)
+{
+    const QPair<QString, QString> value(port, key);
+
+    if (!host.keys.contains(value)) {
+        host.keys.append(value);
+    }
+
+    keys.insert(key);
+}
+
+QString VulnerabilityLookup::keyCpe(const QString& key)
+{
+    if (key.startsWith(QLatin1String("cpe:"))) {
+        return key;
+    }
+
+    // service:apache httpd 2.4.6 -> cpe:2.3:a:apache:http_server:2.4.6
+    const QString service = key.mid(key.indexOf(QLatin1Char(':')) + 1);
+    const int versionIndex = service.lastIndexOf(QLatin1Char(' '));
+
+    return QLatin1String("cpe:2.3:a:") + CveIndex::productKeys(service.left(versionIndex)).first()
+           + QLatin1Char(':') + service.mid(versionIndex + 1);
+}
+
+void VulnerabilityLookup::startRequests()
+{
+    while (m_replies.size() < maxConcurrentRequests && !m_pendingKeys.isEmpty()) {
+        const QString key = m_pendingKeys.takeFirst();
+        const QByteArray cpe = QUrl::toPercentEncoding(keyCpe(key));
+
+        QString address = m_mirrorUrl;
+        if (address.contains(QLatin1String("%1"))) {
+            address = address.arg(QString::fromLatin1(cpe));
+        } else {
+            address.append(QString::fromLatin1(cpe));
+        }
+
+        QNetworkRequest request((QUrl(address)));
+        request.setAttribute(QNetworkRequest::User, key);
+        request.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
+
+        QNetworkReply* reply = m_network->get(request);
+        m_replies.append(reply);
+        connect(reply, &QNetworkReply::finished, this, &VulnerabilityLookup::replyFinished);
+    }
+}
+
+void VulnerabilityLookup::replyFinished()
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+
+    if (!reply || !m_replies.removeOne(reply)) {
+        // cancelled lookup
+        return;
+    }
+
+    reply->deleteLater();
+    const QString key = reply->request().attribute(QNetworkRequest::User).toString();
+
+    if (reply->error() != QNetworkReply::NoError) {
+        m_errors.append(key + QLatin1String(": ") + reply->errorString());
+        keyResolved();
+        startRequests();
+        return;
+    }
+
+    // cve-search returns a list of cve objects, other mirrors wrap it
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(reply->readAll(), &parseError);
+    QJsonArray values = document.array();
+    bool isValid = document.isArray();
+
+    if (document.isObject()) {
+        const QJsonObject root = document.object();
+        const QString listKey = root.contains(QLatin1String("results")) ? QString("results") : QString("data");
+        isValid = root.value(listKey).isArray();
+        values = root.value(listKey).toArray();
+    }
+
+    if (!isValid) {
+        // not cached, the next lookup asks again
+        m_errors.append(key + QLatin1String(": ") + (document.isNull() ? parseError.errorString()
+                        : tr("unknown reply format")));
+        keyResolved();
+        startRequests();
+        return;
+    }
+
+    QList<CveMatch> matches;
+    for (const QJsonValue& value : values) {
+        const QJsonObject object = value.toObject();
+
+        CveMatch match;
+        match.cpe = keyCpe(key);
+        match.cveId = object.value(QLatin1String("id")).toString();
+        match.cvss = object.value(QLatin1String("cvss3")).toDouble(object.value(QLatin1String("cvss")).toDouble());
+
+        if (!match.cveId.isEmpty()) {
+            matches.append(match);
+        }
+    }
+
+    // only parsed answers are cached
+    m_cache.insert(key, matches);
+    keyResolved();
+    startRequests();
+}
+
+void VulnerabilityLookup::keysResolved(int serial, const CveMatchHash matches)
+{
+    if (serial != m_serial) {
+        return;
+    }
+
+    CveMatchHash::const_iterator i;
+    for (i = matches.constBegin(); i != matches.constEnd(); ++i) {
+        m_cache.insert(i.key(), i.value());
+        keyResolved();
+    }
+}
+
+void VulnerabilityLookup::keyResolved()
+{
+    --m_unresolved;
+    emit progress(m_total - m_unresolved, m_total);
+
+    if (!m_unresolved) {
+        buildMatrix();
+    }
+}
+
+void VulnerabilityLookup::buildMatrix()
+{
+    VulnerabilityMatrix matrix;
+    QHash<QString, double> cvssValues;
+
+    for (const HostKeys& host : m_hosts) {
+        for (const QPair<QString, QString>& value : host.keys) {
+            for (const CveMatch& match : m_cache.value(value.second)) {
+                cvssValues.insert(match.cveId, qMax(cvssValues.value(match.cveId), match.cvss));
+            }
+        }
+    }
+
+    // columns sorted by CVSS
+    QList<QPair<double, QString> > columns;
+    QHash<QString, double>::const_iterator i;
+    for (i = cvssValues.constBegin(); i != cvssValues.constEnd(); ++i) {
+        columns.append(qMakePair(-i.value(), i.key()));
+    }
+    std::sort(columns.begin(), columns.end());
+
+    QHash<QString, int> columnIndex;
+    for (const QPair<double, QString>& column : columns) {
+        columnIndex.insert(column.second, matrix.cveIds.size());
+        matrix.cveIds.append(column.second);
+        matrix.cvss.append(-column.first);
+    }
+
+    for (const HostKeys& host : m_hosts) {
+        QHash<int, QStringList> row;
+
+        for (const QPair<QString, QString>& value : host.keys) {
+            for (const CveMatch& match : m_cache.value(value.second)) {
+                QStringList& ports = row[columnIndex.value(match.cveId)];
+                const QString port = value.first.isEmpty() ? tr("host") : value.first;
+                if (!ports.contains(port)) {
+                    ports.append(port);
+                }
+            }
+        }
+
+        matrix.hosts.append(host.hostName);
+        matrix.cells.append(row);
+    }
+
+    m_hosts.clear();
+    emit finished(matrix, m_errors);
+}
+
+CveLookupTask::CveLookupTask(QObject* receiver, const char* member, int serial,
+                             QSharedPointer<const CveIndex> index, const QStringList& keys)
+    : m_receiver(receiver), m_member(member), m_serial(serial), m_index(index), m_keys(keys)
+{
+}
+
+void CveLookupTask::run()
+{
+    CveMatchHash matches;
+
+    for (const QString& key : m_keys) {
+        if (key.startsWith(QLatin1String("cpe:"))) {
+            matches.insert(key, m_index->matchCpe(key, QString()));
+        } else {
+            matches.insert(key, m_index->matchService(key.mid(key.indexOf(QLatin1Char(':')) + 1), QString()));
+        }
+    }
+
+    if (m_receiver) {
+        QMetaObject::invokeMethod(m_receiver, m_member, Qt::QueuedConnection,
+                                  Q_ARG(int, m_serial),
+                                  Q_ARG(CveMatchHash, matches));
+    }
+}
@@ -0,0 +1,158 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef VULNERABILITYLOOKUP_H
+#define VULNERABILITYLOOKUP_H
+
+#include <QtCore/QObject>
+#include <QtCore/QRunnable>
+#include <QtCore/QPointer>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QThreadPool>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QHash>
+#include <QtCore/QSet>
+#include <QtCore/QVector>
+#include <QtCore/QPair>
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkReply>
+
+#include "pobjects.h"
+#include "cvedatabase.h"
+
+typedef QHash<QString, QList<CveMatch> > CveMatchHash;
+Q_DECLARE_METATYPE(CveMatchHash);
+
+/*
+ * Values of a host used by the vulnerability lookup
+ */
+class VulnerabilityTarget
+{
+
+public:
+    QString hostName;
+    QStringList ports;
+    QStringList hostInfo;
+    QList<NseScriptResult> scripts;
+};
+
+/*
+ * Hosts (rows) and vulnerabilities (columns) sorted by CVSS,
+ * a cell is the list of the affected ports.
+ */
+class VulnerabilityMatrix
+{
+
+public:
+    QStringList hosts;
+    QStringList cveIds;
+    QVector<double> cvss;
+    QVector< QHash<int, QStringList> > cells;
+
+    bool isEmpty() const
+    {
+        return cveIds.isEmpty();
+    }
+};
+
+class VulnerabilityLookup : public QObject
+{
+    /*!
+     * Resolve the distinct services of all hosts once against the local
+     * CVE index or a local HTTP mirror (cve-search "/api/cvefor/%1"),
+     * results are cached until the index or the mirror change.
+     */
+    Q_OBJECT
+
+public:
+    explicit VulnerabilityLookup(QObject* parent = 0);
+    ~VulnerabilityLookup();
+
+    /*!
+     * Start the lookup, false when a lookup is running or
+     * no source is available.
+     */
+    bool start(const QList<VulnerabilityTarget>& targets, QSharedPointer<const CveIndex> index);
+    bool isRunning() const;
+    void cancel();
+
+    static const int maxConcurrentRequests = 4;
+    static const int localBatchSize = 256;
+
+public slots:
+    void clearCache();
+
+signals:
+    void progress(int resolved, int total);
+    void finished(const VulnerabilityMatrix& matrix, const QStringList& errors);
+
+private:
+    struct HostKeys {
+        QString hostName;
+        // port and lookup key
+        QList<QPair<QString, QString> > keys;
+    };
+
+    QThreadPool m_pool;
+    QNetworkAccessManager* m_network;
+    QList<QNetworkReply*> m_replies;
+    QString m_mirrorUrl;
+    QString m_cacheSource;
+    CveMatchHash m_cache;
+    QVector<HostKeys> m_hosts;
+    QStringList m_pendingKeys;
+    QStringList m_errors;
+    int m_unresolved;
+    int m_total;
+    int m_serial;
+
+    void addKey(HostKeys& host, const QString& port, const QString& key, QSet<QString>& keys);
+    void startRequests();
+    void keyResolved();
+    void buildMatrix();
+
+    static QString keyCpe(const QString& key);
+
+private slots:
+    void keysResolved(int serial, const CveMatchHash matches);
+    void replyFinished();
+};
+
+class CveLookupTask : public QRunnable
+{
+    /*!
+     * Resolve lookup keys with the local index, the result is returned
+     * with a queued call of member(int serial, CveMatchHash).
+     */
+
+public:
+    CveLookupTask(QObject* receiver, const char* member, int serial,
+                  QSharedPointer<const CveIndex> index, const QStringList& keys);
+    ~CveLookupTask() {};
+
+    void run();
+
+private:
+    QPointer<QObject> m_receiver;
+    const char* m_member;
+    int m_serial;
+    QSharedPointer<const CveIndex> m_index;
+    QStringList m_keys;
+};
+
+#endif // VULNERABILITYLOOKUP_H
@@ -0,0 +1,188 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "vulnerabilitymatrixdialog.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QTextStream>
+#include <QFileDialog>
+#include <QColor>
+
+VulnerabilityMatrixModel::VulnerabilityMatrixModel(QObject* parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+void VulnerabilityMatrixModel::setMatrix(const VulnerabilityMatrix& matrix)
+{
+    beginResetModel();
+    m_matrix = matrix;
+    endResetModel();
+}
+
+const VulnerabilityMatrix& VulnerabilityMatrixModel::matrix() const
+{
+    return m_matrix;
+}
+
+int VulnerabilityMatrixModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_matrix.hosts.size();
+}
+
+int VulnerabilityMatrixModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_matrix.cveIds.size();
+}
+
+QVariant VulnerabilityMatrixModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+
+    const QHash<int, QStringList>& row = m_matrix.cells[index.row()];
+
+    if (!row.contains(index.column())) {
+        return QVariant();
+    }
+
+    if (role == Qt::DisplayRole) {
+        return row.value(index.column()).join(QLatin1String(", "));
+    }
+
+    if (role == Qt::ToolTipRole) {
+        return m_matrix.hosts[index.row()] + QLatin1String(" - ") + m_matrix.cveIds[index.column()];
+    }
+
+    if (role == Qt::BackgroundRole) {
+        const double cvss = m_matrix.cvss[index.column()];
+        if (cvss >= 7.0) {
+            return QColor(255, 0, 0, 80);
+        } else if (cvss >= 4.0) {
+            return QColor(255, 134, 12, 80);
+        }
+        return QColor(0, 0, 255, 40);
+    }
+
+    return QVariant();
+}
+
+QVariant VulnerabilityMatrixModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole && role != Qt::ToolTipRole) {
+        return QVariant();
+    }
+
+    if (orientation == Qt::Vertical) {
+        return m_matrix.hosts.value(section);
+    }
+
+    if (section < 0 || section >= m_matrix.cveIds.size()) {
+        return QVariant();
+    }
+
+    return m_matrix.cveIds[section] + QLatin1String("\n") + QString::number(m_matrix.cvss[section], 'f', 1);
+}
+
+VulnerabilityMatrixDialog::VulnerabilityMatrixDialog(VulnerabilityLookup* lookup, QWidget* parent)
+    : QDialog(parent), m_lookup(lookup)
+{
+    setupUi(this);
+    setAttribute(Qt::WA_DeleteOnClose);
+
+    m_model = new VulnerabilityMatrixModel(this);
+    matrixView->setModel(m_model);
+
+    connect(m_lookup, &VulnerabilityLookup::progress,
+            this, &VulnerabilityMatrixDialog::updateProgress);
+    connect(m_lookup, &VulnerabilityLookup::finished,
+            this, &VulnerabilityMatrixDialog::showMatrix);
+    connect(exportButt, &QPushButton::clicked,
+            this, &VulnerabilityMatrixDialog::exportCsv);
+    connect(closeButt, &QPushButton::clicked,
+            this, &VulnerabilityMatrixDialog::close);
+}
+
+VulnerabilityMatrixDialog::~VulnerabilityMatrixDialog()
+{
+    if (m_lookup->isRunning()) {
+        m_lookup->cancel();
+    }
+}
+
+void VulnerabilityMatrixDialog::updateProgress(int resolved, int total)
+{
+    progressLookup->setMaximum(total);
+    progressLookup->setValue(resolved);
+    labelStatus->setText(tr("Looking up %1 of %2 services...").arg(resolved).arg(total));
+}
+
+void VulnerabilityMatrixDialog::showMatrix(const VulnerabilityMatrix& matrix, const QStringList& errors)
+{
+    m_model->setMatrix(matrix);
+    progressLookup->setVisible(false);
+    exportButt->setEnabled(!matrix.isEmpty());
+
+    if (matrix.isEmpty()) {
+        labelStatus->setText(tr("No vulnerabilities found on %1 hosts").arg(matrix.hosts.size()));
+    } else {
+        labelStatus->setText(tr("%1 vulnerabilities on %2 hosts").arg(matrix.cveIds.size()).arg(matrix.hosts.size()));
+    }
+
+    if (!errors.isEmpty()) {
+        labelStatus->setToolTip(errors.join(QLatin1Char('\n')));
+        labelStatus->setText(labelStatus->text() + tr(", %1 lookups failed").arg(errors.size()));
+    }
+}
+
+void VulnerabilityMatrixDialog::exportCsv()
+{
+    const QString fileName = QFileDialog::getSaveFileName(this, tr("Export vulnerabilities"),
+                             QDir::homePath() + QLatin1String("/vulnerabilities.csv"),
+                             tr("CSV files (*.csv)"));
+
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        QMessageBox::warning(this, tr("Warning - Nmapsi4"), tr("File not writable: ") + fileName, tr("Close"));
+        return;
+    }
+
+    const VulnerabilityMatrix& matrix = m_model->matrix();
+    QTextStream stream(&file);
+
+    stream << "host";
+    for (int column = 0; column < matrix.cveIds.size(); ++column) {
+        stream << ',' << matrix.cveIds[column] << " (" << QString::number(matrix.cvss[column], 'f', 1) << ')';
+    }
+    stream << '\n';
+
+    for (int row = 0; row < matrix.hosts.size(); ++row) {
+        stream << matrix.hosts[row];
+        for (int column = 0; column < matrix.cveIds.size(); ++column) {
+            // ports are separated by spaces, the separator is reserved
+            stream << ',' << matrix.cells[row].value(column).join(QLatin1Char(' '));
+        }
+        stream << '\n';
+    }
+}
@@ -0,0 +1,69 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef VULNERABILITYMATRIXDIALOG_H
+#define VULNERABILITYMATRIXDIALOG_H
+
+#include <QtCore/QObject>
+#include <QtCore/QAbstractTableModel>
+#include <QDialog>
+#include <QMessageBox>
+
+#include "ui_vulnerabilitymatrixdialog.h"
+#include "vulnerabilitylookup.h"
+
+/*
+ * Hosts as rows and CVEs as columns, cells are the affected ports
+ */
+class VulnerabilityMatrixModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit VulnerabilityMatrixModel(QObject* parent = 0);
+
+    void setMatrix(const VulnerabilityMatrix& matrix);
+    const VulnerabilityMatrix& matrix() const;
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+private:
+    VulnerabilityMatrix m_matrix;
+};
+
+class VulnerabilityMatrixDialog : public QDialog, private Ui::vulnerabilityMatrix
+{
+    Q_OBJECT
+
+public:
+    explicit VulnerabilityMatrixDialog(VulnerabilityLookup* lookup, QWidget* parent);
+    ~VulnerabilityMatrixDialog();
+
+private:
+    VulnerabilityLookup* m_lookup;
+    VulnerabilityMatrixModel* m_model;
+
+private slots:
+    void updateProgress(int resolved, int total);
+    void showMatrix(const VulnerabilityMatrix& matrix, const QStringList& errors);
+    void exportCsv();
+};
+
+#endif
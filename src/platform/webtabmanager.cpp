@@ -0,0 +1,263 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "webtabmanager.h"
+
+#include <QVBoxLayout>
+
+WebTabManager::WebTabManager(QTabWidget* tabWidget, QObject* parent)
+    : QObject(parent), m_tabWidget(tabWidget), m_maxViews(4)
+{
+    connect(m_tabWidget, &QTabWidget::currentChanged,
+            this, &WebTabManager::currentTabChanged);
+}
+
+WebTabManager::~WebTabManager()
+{
+    // views are children of the tab widget
+}
+
+int WebTabManager::count() const
+{
+    return m_tabs.size();
+}
+
+int WebTabManager::maxViews() const
+{
+    return m_maxViews;
+}
+
+int WebTabManager::indexOfContainer(QWidget* container) const
+{
+    for (int index = 0; index < m_tabs.size(); ++index) {
+        if (m_tabs[index].container == container) {
+            return index;
+        }
+    }
+
+    return -1;
+}
+
+int WebTabManager::viewsNumber() const
+{
+    return m_recentTabs.size() + m_freeViews.size();
+}
+
+QWebEngineView* WebTabManager::currentView() const
+{
+    const int index = indexOfContainer(m_tabWidget->currentWidget());
+
+    if (index == -1) {
+        return 0;
+    }
+
+    return m_tabs[index].view;
+}
+
+void WebTabManager::openTab(const QUrl& url, const QString& name)
+{
+    QWidget* container = new QWidget(m_tabWidget);
+    QVBoxLayout* layout = new QVBoxLayout(container);
+    layout->setContentsMargins(0, 0, 0, 0);
+
+    WebTab tab;
+    tab.container = container;
+    tab.url = url;
+    tab.view = 0;
+    m_tabs.append(tab);
+
+    // the view is attached by the focus
+    const int index = m_tabWidget->addTab(container, name);
+    m_tabWidget->setCurrentIndex(index);
+
+    if (!m_tabs.last().view) {
+        // first tab, currentChanged is already sent
+        currentTabChanged(index);
+    }
+}
+
+void WebTabManager::closeTab(int index)
+{
+    QWidget* container = m_tabWidget->widget(index);
+    const int tabIndex = indexOfContainer(container);
+
+    if (tabIndex == -1) {
+        return;
+    }
+
+    const WebTab tab = m_tabs.takeAt(tabIndex);
+
+    if (tab.view) {
+        m_recentTabs.removeOne(container);
+        container->layout()->removeWidget(tab.view);
+        releaseView(tab.view);
+    }
+
+    m_tabWidget->removeTab(index);
+    delete container;
+}
+
+void WebTabManager::setMemoryBudget(int megabytes)
+{
+    m_maxViews = qMax(1, megabytes / viewMemoryEstimate);
+
+    while (viewsNumber() > m_maxViews && !m_freeViews.isEmpty()) {
+        delete m_freeViews.takeLast();
+    }
+
+    // the current tab always keeps its view
+    for (int index = m_recentTabs.size() - 1; index >= 0 && viewsNumber() > m_maxViews; --index) {
+        if (m_recentTabs[index] != m_tabWidget->currentWidget()) {
+            // over budget, the view is deleted
+            detachView(indexOfContainer(m_recentTabs[index]));
+        }
+    }
+}
+
+QWebEngineView* WebTabManager::takeView()
+{
+    if (!m_freeViews.isEmpty()) {
+        return m_freeViews.takeFirst();
+    }
+
+    if (viewsNumber() >= m_maxViews) {
+        // discard the least recently used background tab
+        for (int index = m_recentTabs.size() - 1; index >= 0; --index) {
+            if (m_recentTabs[index] != m_tabWidget->currentWidget()) {
+                detachView(indexOfContainer(m_recentTabs[index]));
+                break;
+            }
+        }
+
+        if (!m_freeViews.isEmpty()) {
+            return m_freeViews.takeFirst();
+        }
+    }
+
+    QWebEngineView* view = new QWebEngineView(m_tabWidget);
+    view->setContextMenuPolicy(Qt::NoContextMenu);
+    connect(view, &QWebEngineView::loadProgress, this, &WebTabManager::viewLoadProgress);
+    connect(view, &QWebEngineView::loadFinished, this, &WebTabManager::viewLoadFinished);
+
+    return view;
+}
+
+void WebTabManager::attachView(int index)
+{
+    if (m_tabs[index].view) {
+        suspendView(m_tabs[index].view, false);
+        m_recentTabs.removeOne(m_tabs[index].container);
+        m_recentTabs.prepend(m_tabs[index].container);
+        return;
+    }
+
+    // takeView can detach other tabs, m_tabs is read after
+    QWebEngineView* view = takeView();
+    WebTab& tab = m_tabs[index];
+
+    tab.view = view;
+    tab.container->layout()->addWidget(view);
+    view->show();
+    suspendView(view, false);
+    view->load(tab.url);
+
+    m_recentTabs.prepend(tab.container);
+}
+
+void WebTabManager::detachView(int index)
+{
+    WebTab& tab = m_tabs[index];
+    QWebEngineView* view = tab.view;
+
+    if (!view) {
+        return;
+    }
+
+    // restored from the url on focus
+    if (view->url().isValid() && !view->url().isEmpty()) {
+        tab.url = view->url();
+    }
+
+    tab.view = 0;
+    m_recentTabs.removeOne(tab.container);
+    tab.container->layout()->removeWidget(view);
+    releaseView(view);
+}
+
+void WebTabManager::releaseView(QWebEngineView* view)
+{
+    view->stop();
+    view->hide();
+
+    if (viewsNumber() >= m_maxViews) {
+        view->deleteLater();
+        return;
+    }
+
+    // a blank page releases the memory of the renderer
+    suspendView(view, false);
+    view->setParent(m_tabWidget);
+    view->setUrl(QUrl(QLatin1String("about:blank")));
+    m_freeViews.append(view);
+}
+
+void WebTabManager::suspendView(QWebEngineView* view, bool suspended)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    if (suspended) {
+        view->page()->setLifecycleState(QWebEnginePage::LifecycleState::Frozen);
+    } else {
+        view->page()->setLifecycleState(QWebEnginePage::LifecycleState::Active);
+    }
+#else
+    // not supported, background views are only hidden
+    Q_UNUSED(view);
+    Q_UNUSED(suspended);
+#endif
+}
+
+void WebTabManager::currentTabChanged(int index)
+{
+    const int tabIndex = indexOfContainer(m_tabWidget->widget(index));
+
+    if (tabIndex == -1) {
+        return;
+    }
+
+    attachView(tabIndex);
+
+    // background tabs don't run scripts and timers
+    for (QWidget* container : m_recentTabs) {
+        if (container != m_tabs[tabIndex].container) {
+            suspendView(m_tabs[indexOfContainer(container)].view, true);
+        }
+    }
+}
+
+void WebTabManager::viewLoadProgress(int progress)
+{
+    if (sender() == currentView()) {
+        emit loadProgress(progress);
+    }
+}
+
+void WebTabManager::viewLoadFinished(bool ok)
+{
+    if (sender() == currentView()) {
+        emit loadFinished(ok);
+    }
+}
@@ -0,0 +1,91 @@
+/*
+Copyright 2014  Francesco Cecconi <francesco.cecconi@gmail.com>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef WEBTABMANAGER_H
+#define WEBTABMANAGER_H
+
+#include <QtCore/QObject>
+#include <QtCore/QList>
+#include <QtCore/QUrl>
+#include <QTabWidget>
+#include <QWebEngineView>
+#include <QWebEnginePage>
+
+class WebTabManager : public QObject
+{
+    /*!
+     * Tabs of web pages backed by a small pool of views.
+     * Only the recently used tabs keep a view, the other tabs keep
+     * their url and are loaded again when they get the focus.
+     * The pool size is the memory budget divided by the memory
+     * estimate of a view.
+     */
+    Q_OBJECT
+
+public:
+    WebTabManager(QTabWidget* tabWidget, QObject* parent);
+    ~WebTabManager();
+
+    void openTab(const QUrl& url, const QString& name);
+    void closeTab(int index);
+    int count() const;
+    /*!
+     * View of the current tab, null without tabs.
+     */
+    QWebEngineView* currentView() const;
+    /*!
+     * Set the memory budget in MB of all views.
+     */
+    void setMemoryBudget(int megabytes);
+    int maxViews() const;
+
+    // private memory of a renderer with a search page
+    static const int viewMemoryEstimate = 150;
+
+signals:
+    void loadProgress(int progress);
+    void loadFinished(bool ok);
+
+private:
+    struct WebTab {
+        QWidget* container;
+        QUrl url;
+        QWebEngineView* view;
+    };
+
+    QTabWidget* m_tabWidget;
+    QList<WebTab> m_tabs;
+    QList<QWebEngineView*> m_freeViews;
+    // tabs with a view, the first one is the most recent
+    QList<QWidget*> m_recentTabs;
+    int m_maxViews;
+
+    int indexOfContainer(QWidget* container) const;
+    int viewsNumber() const;
+    QWebEngineView* takeView();
+    void attachView(int index);
+    void detachView(int index);
+    void releaseView(QWebEngineView* view);
+    void suspendView(QWebEngineView* view, bool suspended);
+
+private slots:
+    void currentTabChanged(int index);
+    void viewLoadProgress(int progress);
+    void viewLoadFinished(bool ok);
+};
+
+#endif // WEBTABMANAGER_H